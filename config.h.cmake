@@ -14,5 +14,8 @@
 #define PACKAGE "@GSTMGS_PACKAGE@"
 
 #cmakedefine GSOAP_FOUND
+#cmakedefine HAVE_LIBURING
+#cmakedefine HAVE_LINUX_IF_PACKET_H
+#cmakedefine HAVE_LINUX_SOCK_DIAG_H
 
 #endif
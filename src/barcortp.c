@@ -14,6 +14,20 @@
 
 #include "gstrtpsink.h"
 #include "gstrtpsrc.h"
+#include "gstrtpfecenc.h"
+#include "gstrtpfecdec.h"
+#include "gstrtpmerge.h"
+#include "gstrtpmp2t.h"
+#include "gstrtpmp2tpace.h"
+#include "gstrtpburst.h"
+#include "gstrtplatencytracer.h"
+#ifdef HAVE_LIBURING
+#include "gstrtpuringsrc.h"
+#include "gstrtpuringsink.h"
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+#include "gstrtpcapturesrc.h"
+#endif
 
 /* top level library code; initialise the plugins part of this library */
 
@@ -32,6 +46,20 @@ plugin_init (GstPlugin * plugin)
 
   ret = rtp_sink_init (plugin);
   ret &= rtp_src_init (plugin);
+  ret &= rtp_fec_enc_init (plugin);
+  ret &= rtp_fec_dec_init (plugin);
+  ret &= rtp_merge_init (plugin);
+  ret &= rtp_mp2t_init (plugin);
+  ret &= rtp_mp2t_pace_init (plugin);
+  ret &= rtp_burst_init (plugin);
+  ret &= rtp_latency_tracer_init (plugin);
+#ifdef HAVE_LIBURING
+  ret &= rtp_uring_src_init (plugin);
+  ret &= rtp_uring_sink_init (plugin);
+#endif
+#ifdef HAVE_LINUX_IF_PACKET_H
+  ret &= rtp_capture_src_init (plugin);
+#endif
 
   return ret;
 }
@@ -101,6 +101,18 @@ gst_object_set_properties_from_uri_query_parameters (GObject *obj, const GstUri
                   (gchar *) g_hash_table_lookup (hash_table, key->data));
               g_object_set (obj, key->data, caps, NULL);
               gst_caps_unref (caps);
+            } else if (G_TYPE_IS_ENUM (spec->value_type)) {
+              /* Enums are passed by nick (or value) */
+              const gchar *s = g_hash_table_lookup (hash_table, key->data);
+              GEnumClass *klass = g_type_class_ref (spec->value_type);
+              GEnumValue *val = g_enum_get_value_by_nick (klass, s);
+
+              if (val)
+                g_object_set (obj, key->data, val->value, NULL);
+              else
+                g_object_set (obj, key->data,
+                    (gint) g_ascii_strtoll (s, NULL, 0), NULL);
+              g_type_class_unref (klass);
             } else if (spec->value_type == GST_TYPE_FRACTION) {
               /* In the case of a fraction, the notation is
                * numerator/denominator (%u/%u). We are not yet aware of a
@@ -13,8 +13,29 @@
 #endif
 
 #include <gst/gst.h>
+#include <gio/gnetworking.h>
 #include <string.h>
 
+#ifdef HAVE_LIBURING
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <liburing.h>
+#endif
+
+#ifdef HAVE_LINUX_IF_PACKET_H
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#endif
+
+#ifdef HAVE_LINUX_SOCK_DIAG_H
+#include <sys/socket.h>
+#include <linux/sock_diag.h>
+#endif
+
 #ifdef WIN32
 #include "../src/gstbarcomgs_common.h"
 #else
@@ -46,3 +67,261 @@ gst_barco_is_ipv4 (GstUri* uri)
 
   return res;
 }
+
+/**
+ * gst_barco_is_shm:
+ * @uri: an rtp:// or rtp+shm:// URI
+ *
+ * Returns: TRUE if the RTP packets of @uri go through shared memory
+ * instead of UDP
+ */
+gboolean
+gst_barco_is_shm (GstUri * uri)
+{
+  g_return_val_if_fail (uri != NULL, FALSE);
+
+  return g_strcmp0 (gst_uri_get_scheme (uri), "rtp+shm") == 0;
+}
+
+/**
+ * gst_barco_shm_socket_path:
+ * @uri: an rtp+shm:// URI
+ * @n: index of the stream sent to @uri
+ *
+ * The control socket of the shared memory of a stream is derived from the
+ * port, so sender and receiver find each other the way they do with UDP.
+ * Only the first stream is received by rtpsrc.
+ *
+ * Returns: (transfer full): the socket path of stream @n
+ */
+gchar *
+gst_barco_shm_socket_path (GstUri * uri, guint n)
+{
+  g_return_val_if_fail (uri != NULL, NULL);
+
+  if (n == 0)
+    return g_strdup_printf ("%s/barcortp-%d", g_get_tmp_dir (),
+        gst_uri_get_port (uri));
+
+  return g_strdup_printf ("%s/barcortp-%d.%u", g_get_tmp_dir (),
+      gst_uri_get_port (uri), n);
+}
+
+/**
+ * gst_barco_uring_supported:
+ *
+ * Check once whether the running kernel has everything the io_uring socket
+ * engine uses: provided buffer rings (5.19) and multishot recvmsg (6.0).
+ * Older kernels reject the multishot request right away.
+ *
+ * Returns: TRUE if barcortpuringsrc and barcortpuringsink can be used
+ */
+gboolean
+gst_barco_uring_supported (void)
+{
+#ifdef HAVE_LIBURING
+  static gsize supported = 0;
+
+  if (g_once_init_enter (&supported)) {
+    struct io_uring ring;
+    struct io_uring_buf_ring *br = NULL;
+    struct io_uring_sqe *sqe;
+    struct io_uring_cqe *cqe;
+    struct __kernel_timespec ts = { 0, 0 };
+    struct msghdr msg;
+    gsize res = 1;
+    int fd, ret;
+
+    memset (&msg, 0, sizeof (msg));
+    fd = socket (AF_INET, SOCK_DGRAM, 0);
+    if (fd >= 0 && io_uring_queue_init (4, &ring, 0) == 0) {
+      br = io_uring_setup_buf_ring (&ring, 1, 0, 0, &ret);
+      if (br) {
+        sqe = io_uring_get_sqe (&ring);
+        io_uring_prep_recvmsg_multishot (sqe, fd, &msg, 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        io_uring_submit (&ring);
+
+        ret = io_uring_wait_cqe_timeout (&ring, &cqe, &ts);
+        if (ret == -ETIME)
+          res = 2;
+        else if (ret == 0)
+          io_uring_cqe_seen (&ring, cqe);
+        io_uring_free_buf_ring (&ring, br, 1, 0);
+      }
+      io_uring_queue_exit (&ring);
+    }
+    if (fd >= 0)
+      close (fd);
+
+    GST_INFO ("io_uring socket engine %s",
+        res == 2 ? "supported" : "not supported");
+    g_once_init_leave (&supported, res);
+  }
+
+  return supported == 2;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * gst_barco_capture_supported:
+ *
+ * Check once whether packet sockets can be opened, which takes
+ * CAP_NET_RAW.
+ *
+ * Returns: TRUE if barcortpcapturesrc can be used
+ */
+gboolean
+gst_barco_capture_supported (void)
+{
+#ifdef HAVE_LINUX_IF_PACKET_H
+  static gsize supported = 0;
+
+  if (g_once_init_enter (&supported)) {
+    int fd = socket (AF_PACKET, SOCK_DGRAM, htons (ETH_P_IP));
+
+    if (fd >= 0)
+      close (fd);
+    GST_INFO ("Packet capture %s", fd >= 0 ? "supported" : "not permitted");
+    g_once_init_leave (&supported, fd >= 0 ? 2 : 1);
+  }
+
+  return supported == 2;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * gst_barco_socket_get_drops:
+ * @socket: a UDP socket
+ * @drops: (out): packets dropped because the receive buffer was full
+ *
+ * Read the SO_MEMINFO drop counter of @socket, for receivers that cannot
+ * read the SO_RXQ_OVFL control messages.
+ *
+ * Returns: TRUE if @drops was set
+ */
+gboolean
+gst_barco_socket_get_drops (GSocket * socket, guint64 * drops)
+{
+#if defined (HAVE_LINUX_SOCK_DIAG_H) && defined (SO_MEMINFO)
+  guint32 meminfo[SK_MEMINFO_VARS];
+  socklen_t len = sizeof (meminfo);
+
+  if (getsockopt (g_socket_get_fd (socket), SOL_SOCKET, SO_MEMINFO, meminfo,
+          &len) < 0 || len <= SK_MEMINFO_DROPS * sizeof (guint32))
+    return FALSE;
+
+  *drops = meminfo[SK_MEMINFO_DROPS];
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * gst_barco_socket_grow_rcvbuf:
+ * @socket: a UDP socket
+ * @size: receive buffer size to ask for in bytes
+ *
+ * Grow the receive buffer of @socket to @size, beyond net.core.rmem_max
+ * when the process has CAP_NET_ADMIN. The buffer never shrinks.
+ *
+ * Returns: the receive buffer size now used, 0 if it could not be read
+ */
+gint
+gst_barco_socket_grow_rcvbuf (GSocket * socket, gint size)
+{
+  gint current = 0;
+
+  /* the kernel reports twice the size it was asked for, the other half
+   * is its bookkeeping overhead */
+  if (!g_socket_get_option (socket, SOL_SOCKET, SO_RCVBUF, &current, NULL))
+    return 0;
+  current /= 2;
+  if (size <= current)
+    return current;
+
+#ifdef SO_RCVBUFFORCE
+  if (!g_socket_set_option (socket, SOL_SOCKET, SO_RCVBUFFORCE, size, NULL))
+#endif
+    g_socket_set_option (socket, SOL_SOCKET, SO_RCVBUF, size, NULL);
+
+  if (!g_socket_get_option (socket, SOL_SOCKET, SO_RCVBUF, &current, NULL))
+    return 0;
+
+  return current / 2;
+}
+
+static GstStaticCaps unix_timestamp_caps =
+GST_STATIC_CAPS ("timestamp/x-unix");
+
+/**
+ * gst_barco_buffer_add_arrival:
+ * @buffer: a writable buffer
+ * @realtime: time the kernel received @buffer, in ns since the epoch
+ *
+ * Attach the kernel receive time as a timestamp/x-unix reference
+ * timestamp.
+ */
+void
+gst_barco_buffer_add_arrival (GstBuffer * buffer, GstClockTime realtime)
+{
+  GstCaps *caps = gst_static_caps_get (&unix_timestamp_caps);
+
+  gst_buffer_add_reference_timestamp_meta (buffer, caps, realtime,
+      GST_CLOCK_TIME_NONE);
+  gst_caps_unref (caps);
+}
+
+/**
+ * gst_barco_buffer_stamp_arrival:
+ * @element: the source that received @buffer
+ * @buffer: (transfer full): a buffer
+ *
+ * Turn the kernel receive time of @buffer into the running time of
+ * @element and use it as DTS and PTS. The age of the packet is measured
+ * on the wall clock and taken off the pipeline clock, so the scheduling
+ * delay of the receiving thread does not end up in the jitter and skew
+ * rtpjitterbuffer computes from the DTS.
+ *
+ * Returns: (transfer full): @buffer, made writable if it was stamped
+ */
+GstBuffer *
+gst_barco_buffer_stamp_arrival (GstElement * element, GstBuffer * buffer)
+{
+  GstReferenceTimestampMeta *meta;
+  GstClockTime now, base_time, age;
+  GstClock *clock;
+  GstCaps *caps;
+  gint64 realtime;
+
+  caps = gst_static_caps_get (&unix_timestamp_caps);
+  meta = gst_buffer_get_reference_timestamp_meta (buffer, caps);
+  gst_caps_unref (caps);
+  if (meta == NULL)
+    return buffer;
+
+  clock = gst_element_get_clock (element);
+  if (clock == NULL)
+    return buffer;
+
+  realtime = g_get_real_time () * GST_USECOND;
+  now = gst_clock_get_time (clock);
+  base_time = gst_element_get_base_time (element);
+  gst_object_unref (clock);
+
+  age = realtime > (gint64) meta->timestamp ? realtime - meta->timestamp : 0;
+  if (now < base_time + age)
+    return buffer;
+
+  buffer = gst_buffer_make_writable (buffer);
+  GST_BUFFER_DTS (buffer) = now - age - base_time;
+  GST_BUFFER_PTS (buffer) = GST_BUFFER_DTS (buffer);
+
+  return buffer;
+}
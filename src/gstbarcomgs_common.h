@@ -42,5 +42,15 @@
   }
 
 gboolean gst_barco_is_ipv4(GstUri *uri);
+gboolean gst_barco_is_shm (GstUri * uri);
+gchar *gst_barco_shm_socket_path (GstUri * uri, guint n);
+gboolean gst_barco_uring_supported (void);
+gboolean gst_barco_capture_supported (void);
+gboolean gst_barco_socket_get_drops (GSocket * socket, guint64 * drops);
+gint gst_barco_socket_grow_rcvbuf (GSocket * socket, gint size);
+
+void gst_barco_buffer_add_arrival (GstBuffer * buffer, GstClockTime realtime);
+GstBuffer *gst_barco_buffer_stamp_arrival (GstElement * element,
+    GstBuffer * buffer);
 
 #endif
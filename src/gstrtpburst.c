@@ -0,0 +1,753 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * RFC 6285 rapid acquisition (burst-on-join) server used by rtpsink.
+ *
+ * RTP packets are passed through unmodified from sink to src while the
+ * packets since the last keyframe are kept. RTCP from the receivers is
+ * passed through from rtcp_sink to rtcp_src; a RAMS-R request in it
+ * starts a unicast burst of the cached packets to the RTP port of the
+ * requester.
+ *
+ * The burst is sent on the socket of the stream, so the receiver sees it
+ * come from the same address as the stream. The RTP port of the requester
+ * is its RTCP port shifted like the rtp-port and rtcp-port of the stream,
+ * which are the same with rtcp-mux.
+ *
+ * A burst is much larger than the request that starts it, and the source
+ * address of a UDP request can be spoofed: requests have to name the
+ * SSRC of the stream and every address gets at most one burst per
+ * cooldown. Only enable bursts where receivers are trusted.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gst/net/gstnet.h>
+
+#include "gstrtpburst.h"
+#include "gstrtpgopcache.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_burst_debug);
+#define GST_CAT_DEFAULT rtp_burst_debug
+
+/* RFC 6285: RAMS is transport layer feedback, FMT 6, the first byte of
+ * the FCI is the sub type */
+#define GST_RTCP_TYPE_RTPFB           (205)
+#define GST_RTCP_RTPFB_TYPE_RAMS      (6)
+#define GST_RAMS_SFMT_RAMS_R          (1)
+
+struct _GstRtpBurst
+{
+  GstElement parent_instance;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+  GstPad *rtcp_sinkpad;
+  GstPad *rtcp_srcpad;
+
+  guint bitrate;
+  guint max_bursts;
+  guint cooldown;
+
+  /* protects everything below */
+  GSocket *socket;
+  gint rtp_port;
+  gint rtcp_port;
+  GMutex lock;
+  GCond cond;
+  GstBarcoGopCache cache;
+  gchar *encoding_name;
+  gboolean flushing;
+  guint active;
+  guint64 bursts;
+  guint64 refused;
+  /* SSRC of the media, requests have to name it */
+  gboolean have_ssrc;
+  guint32 ssrc;
+  /* address string -> monotonic time until which it gets no burst */
+  GHashTable *recent;
+};
+
+/* a burst to one receiver, sent from its own thread */
+typedef struct
+{
+  GstRtpBurst *self;
+  GSocket *socket;
+  GSocketAddress *addr;
+  gchar *host;
+  GstBufferList *list;
+} GstRtpBurstJob;
+
+enum
+{
+  PROP_0,
+  PROP_BITRATE,
+  PROP_BURSTS,
+  PROP_COOLDOWN,
+  PROP_MAX_BURSTS,
+  PROP_REFUSED,
+  PROP_RTCP_PORT,
+  PROP_RTP_PORT,
+  PROP_SOCKET,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_BITRATE          (20000)
+#define DEFAULT_PROP_MAX_BURSTS       (4)
+#define DEFAULT_PROP_COOLDOWN         (10000)
+#define DEFAULT_PROP_RTP_PORT         (5004)
+#define DEFAULT_PROP_RTCP_PORT        (5005)
+#define DEFAULT_CACHE_SIZE            (4 * 1024 * 1024)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate rtcp_sink_template =
+GST_STATIC_PAD_TEMPLATE ("rtcp_sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtcp"));
+
+static GstStaticPadTemplate rtcp_src_template =
+GST_STATIC_PAD_TEMPLATE ("rtcp_src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtcp"));
+
+#define gst_rtp_burst_parent_class parent_class
+G_DEFINE_TYPE (GstRtpBurst, gst_rtp_burst, GST_TYPE_ELEMENT);
+
+/**
+ * gst_rtp_burst_thread:
+ * @data: the #GstRtpBurstJob to send
+ *
+ * Send the cached packets to one receiver, paced at the configured
+ * bitrate so the burst does not overrun the access link of the receiver.
+ *
+ * Returns: NULL
+ */
+static gpointer
+gst_rtp_burst_thread (gpointer data)
+{
+  GstRtpBurstJob *job = data;
+  GstRtpBurst *self = job->self;
+  GError *err = NULL;
+  gint64 start = g_get_monotonic_time ();
+  guint64 sent = 0;
+  gint64 *until;
+  guint bitrate;
+  guint i, len = gst_buffer_list_length (job->list);
+
+  GST_OBJECT_LOCK (self);
+  bitrate = MAX (self->bitrate, 1);
+  GST_OBJECT_UNLOCK (self);
+
+  for (i = 0; i < len && !g_atomic_int_get (&self->flushing); i++) {
+    GstBuffer *buffer = gst_buffer_list_get (job->list, i);
+    GstMapInfo map;
+    gint64 due;
+
+    if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+      continue;
+    if (g_socket_send_to (job->socket, job->addr, (const gchar *) map.data,
+            map.size, NULL, &err) < 0) {
+      GST_DEBUG_OBJECT (self, "Burst send failed: %s", err->message);
+      g_clear_error (&err);
+    }
+    sent += map.size;
+    gst_buffer_unmap (buffer, &map);
+
+    /* bitrate is in kbit/s, so bits / bitrate is in ms */
+    due = start + (gint64) (sent * 8 * 1000 / bitrate);
+    if (due > g_get_monotonic_time ())
+      g_usleep (due - g_get_monotonic_time ());
+  }
+
+  GST_DEBUG_OBJECT (self, "Sent burst of %" G_GUINT64_FORMAT " bytes in %"
+      G_GINT64_FORMAT " us", sent, g_get_monotonic_time () - start);
+
+  g_object_unref (job->socket);
+  gst_buffer_list_unref (job->list);
+  g_object_unref (job->addr);
+
+  g_mutex_lock (&self->lock);
+  self->active--;
+  self->bursts++;
+  /* the cooldown starts when the burst is over */
+  until = g_hash_table_lookup (self->recent, job->host);
+  if (until)
+    *until = g_get_monotonic_time () +
+        (gint64) self->cooldown * G_TIME_SPAN_MILLISECOND;
+  g_cond_broadcast (&self->cond);
+  g_mutex_unlock (&self->lock);
+
+  g_free (job->host);
+  g_slice_free (GstRtpBurstJob, job);
+
+  gst_object_unref (self);
+
+  return NULL;
+}
+
+static gboolean
+gst_rtp_burst_expired (gpointer key, gpointer value, gpointer user_data)
+{
+  return *(gint64 *) value <= *(gint64 *) user_data;
+}
+
+/**
+ * gst_rtp_burst_start:
+ * @self: The current #GstRtpBurst object
+ * @from: the RTCP address of the receiver
+ * @ssrc: the media source SSRC of the request
+ *
+ * Start a burst to the RTP port of the receiver. Must be called with the
+ * lock held.
+ *
+ * Returns: FALSE if the request was refused
+ */
+static gboolean
+gst_rtp_burst_start (GstRtpBurst * self, GSocketAddress * from, guint32 ssrc)
+{
+  GInetSocketAddress *inet;
+  GstRtpBurstJob *job;
+  GstBufferList *list;
+  GThread *thread;
+  gint64 now, *until;
+  gchar *host;
+  gint port;
+
+  if (!G_IS_INET_SOCKET_ADDRESS (from))
+    return FALSE;
+  inet = G_INET_SOCKET_ADDRESS (from);
+  port = g_inet_socket_address_get_port (inet) - self->rtcp_port +
+      self->rtp_port;
+  if (port < 1 || port > G_MAXUINT16)
+    return FALSE;
+
+  if (!self->have_ssrc || ssrc != self->ssrc) {
+    GST_DEBUG_OBJECT (self, "Not bursting, request for SSRC %08x", ssrc);
+    return FALSE;
+  }
+  if (self->flushing || self->active >= self->max_bursts) {
+    GST_DEBUG_OBJECT (self, "Not bursting, %u bursts active", self->active);
+    return FALSE;
+  }
+
+  /* the port is not part of the key, it is as easy to spoof as the rest */
+  now = g_get_monotonic_time ();
+  host = g_inet_address_to_string (g_inet_socket_address_get_address (inet));
+  until = g_hash_table_lookup (self->recent, host);
+  if (until && *until > now) {
+    GST_DEBUG_OBJECT (self, "Not bursting, %s had a burst recently", host);
+    g_free (host);
+    return FALSE;
+  }
+
+  if (self->socket == NULL) {
+    GST_DEBUG_OBJECT (self, "Not bursting, the stream has no socket yet");
+    g_free (host);
+    return TRUE;
+  }
+  list = gst_barco_gop_cache_get (&self->cache);
+  if (list == NULL) {
+    GST_DEBUG_OBJECT (self, "Not bursting, no keyframe cached yet");
+    g_free (host);
+    /* not the fault of the receiver */
+    return TRUE;
+  }
+  self->active++;
+
+  g_hash_table_foreach_remove (self->recent, gst_rtp_burst_expired, &now);
+  until = g_new (gint64, 1);
+  *until = G_MAXINT64;
+  g_hash_table_insert (self->recent, g_strdup (host), until);
+
+  job = g_slice_new0 (GstRtpBurstJob);
+  job->self = gst_object_ref (self);
+  job->socket = g_object_ref (self->socket);
+  job->host = host;
+  job->list = list;
+  job->addr = g_inet_socket_address_new (g_inet_socket_address_get_address
+      (inet), port);
+
+  GST_INFO_OBJECT (self, "Bursting %u packets to port %d",
+      gst_buffer_list_length (list), port);
+
+  thread = g_thread_new ("rtpburst", gst_rtp_burst_thread, job);
+  g_thread_unref (thread);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_burst_rtcp_chain:
+ * @pad: the rtcp_sink pad
+ * @parent: The current #GstRtpBurst object
+ * @buffer: a compound RTCP packet
+ *
+ * Look for RAMS-R requests, the packet itself goes on to rtpbin.
+ *
+ * Returns: the #GstFlowReturn of the push on rtcp_src
+ */
+static GstFlowReturn
+gst_rtp_burst_rtcp_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpBurst *self = GST_RTP_BURST (parent);
+  GstNetAddressMeta *meta = gst_buffer_get_net_address_meta (buffer);
+  gboolean request = FALSE;
+  guint32 ssrc = 0;
+  GstMapInfo map;
+  gsize offset, len;
+
+  if (meta && gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    for (offset = 0; offset + 4 <= map.size; offset += len) {
+      const guint8 *p = map.data + offset;
+
+      len = (GST_READ_UINT16_BE (p + 2) + 1) * 4;
+      if ((p[0] >> 6) != 2 || offset + len > map.size)
+        break;
+      /* header, sender SSRC and media source SSRC come before the FCI */
+      if (p[1] == GST_RTCP_TYPE_RTPFB &&
+          (p[0] & 0x1f) == GST_RTCP_RTPFB_TYPE_RAMS && len >= 16 &&
+          p[12] == GST_RAMS_SFMT_RAMS_R) {
+        ssrc = GST_READ_UINT32_BE (p + 8);
+        request = TRUE;
+      }
+    }
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  if (request) {
+    g_mutex_lock (&self->lock);
+    if (!gst_rtp_burst_start (self, meta->addr, ssrc))
+      self->refused++;
+    g_mutex_unlock (&self->lock);
+  }
+
+  return gst_pad_push (self->rtcp_srcpad, buffer);
+}
+
+static GstFlowReturn
+gst_rtp_burst_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpBurst *self = GST_RTP_BURST (parent);
+
+  guint8 header[12];
+
+  g_mutex_lock (&self->lock);
+  if (gst_buffer_extract (buffer, 0, header, 12) == 12) {
+    self->ssrc = GST_READ_UINT32_BE (header + 8);
+    self->have_ssrc = TRUE;
+  }
+  gst_barco_gop_cache_push (&self->cache, buffer, self->encoding_name);
+  g_mutex_unlock (&self->lock);
+
+  return gst_pad_push (self->srcpad, buffer);
+}
+
+static gboolean
+gst_rtp_burst_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpBurst *self = GST_RTP_BURST (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+    GstStructure *s;
+
+    gst_event_parse_caps (event, &caps);
+    s = gst_caps_get_structure (caps, 0);
+
+    g_mutex_lock (&self->lock);
+    g_free (self->encoding_name);
+    self->encoding_name =
+        g_strdup (gst_structure_get_string (s, "encoding-name"));
+    g_mutex_unlock (&self->lock);
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+/**
+ * gst_rtp_burst_iterate_internal_links:
+ * @pad: a pad of the #GstRtpBurst
+ * @parent: The current #GstRtpBurst object
+ *
+ * Keep RTP and RTCP apart for the default event and query handling.
+ *
+ * Returns: (transfer full): an iterator over the pad linked to @pad
+ */
+static GstIterator *
+gst_rtp_burst_iterate_internal_links (GstPad * pad, GstObject * parent)
+{
+  GstRtpBurst *self = GST_RTP_BURST (parent);
+  GValue val = G_VALUE_INIT;
+  GstIterator *it;
+  GstPad *other;
+
+  if (pad == self->sinkpad)
+    other = self->srcpad;
+  else if (pad == self->srcpad)
+    other = self->sinkpad;
+  else if (pad == self->rtcp_sinkpad)
+    other = self->rtcp_srcpad;
+  else
+    other = self->rtcp_sinkpad;
+
+  g_value_init (&val, GST_TYPE_PAD);
+  g_value_set_object (&val, other);
+  it = gst_iterator_new_single (GST_TYPE_PAD, &val);
+  g_value_unset (&val);
+
+  return it;
+}
+
+static GstStateChangeReturn
+gst_rtp_burst_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpBurst *self = GST_RTP_BURST (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      g_mutex_lock (&self->lock);
+      g_atomic_int_set (&self->flushing, FALSE);
+      g_mutex_unlock (&self->lock);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* running bursts hold a ref to the element, wait for them */
+      g_mutex_lock (&self->lock);
+      g_atomic_int_set (&self->flushing, TRUE);
+      while (self->active > 0)
+        g_cond_wait (&self->cond, &self->lock);
+      gst_barco_gop_cache_clear (&self->cache);
+      g_hash_table_remove_all (self->recent);
+      self->have_ssrc = FALSE;
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  return ret;
+}
+
+static void
+gst_rtp_burst_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpBurst *self = GST_RTP_BURST (object);
+
+  switch (prop_id) {
+    case PROP_BITRATE:
+      GST_OBJECT_LOCK (self);
+      self->bitrate = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_COOLDOWN:
+      g_mutex_lock (&self->lock);
+      self->cooldown = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_BURSTS:
+      g_mutex_lock (&self->lock);
+      self->max_bursts = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_RTCP_PORT:
+      g_mutex_lock (&self->lock);
+      self->rtcp_port = g_value_get_int (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_RTP_PORT:
+      g_mutex_lock (&self->lock);
+      self->rtp_port = g_value_get_int (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_SOCKET:
+      g_mutex_lock (&self->lock);
+      if (self->socket)
+        g_object_unref (self->socket);
+      self->socket = g_value_dup_object (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_burst_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpBurst *self = GST_RTP_BURST (object);
+
+  switch (prop_id) {
+    case PROP_BITRATE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->bitrate);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BURSTS:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint64 (value, self->bursts);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_COOLDOWN:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->cooldown);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_MAX_BURSTS:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->max_bursts);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_REFUSED:
+      g_mutex_lock (&self->lock);
+      g_value_set_uint64 (value, self->refused);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_RTCP_PORT:
+      g_mutex_lock (&self->lock);
+      g_value_set_int (value, self->rtcp_port);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_RTP_PORT:
+      g_mutex_lock (&self->lock);
+      g_value_set_int (value, self->rtp_port);
+      g_mutex_unlock (&self->lock);
+      break;
+    case PROP_SOCKET:
+      g_mutex_lock (&self->lock);
+      g_value_set_object (value, self->socket);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_burst_finalize (GObject * gobject)
+{
+  GstRtpBurst *self = GST_RTP_BURST (gobject);
+
+  gst_barco_gop_cache_clear (&self->cache);
+  g_free (self->encoding_name);
+  if (self->socket)
+    g_object_unref (self->socket);
+  g_hash_table_unref (self->recent);
+  g_cond_clear (&self->cond);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_burst_class_init (GstRtpBurstClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  oclass->set_property = gst_rtp_burst_set_property;
+  oclass->get_property = gst_rtp_burst_get_property;
+  oclass->finalize = gst_rtp_burst_finalize;
+
+  /**
+   * GstRtpBurst::bitrate
+   *
+   * Rate in kbit/s of a burst, should be above the stream bitrate so the
+   * receiver catches up with the live stream, and below its link rate.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_BITRATE,
+      g_param_spec_uint ("bitrate", "Bitrate",
+          "Rate of a burst in kbit/s", 1, G_MAXUINT, DEFAULT_PROP_BITRATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::max-bursts
+   *
+   * Maximum number of receivers served at the same time, further
+   * requests are ignored and those receivers join the normal way.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MAX_BURSTS,
+      g_param_spec_uint ("max-bursts", "Maximum bursts",
+          "Maximum number of bursts sent at the same time", 0, G_MAXUINT,
+          DEFAULT_PROP_MAX_BURSTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::bursts
+   *
+   * Number of bursts that were sent.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_BURSTS,
+      g_param_spec_uint64 ("bursts", "Bursts", "Number of bursts sent",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::cooldown
+   *
+   * Time in ms after a burst during which its receiver gets no new one.
+   * Bounds what a spoofed request can make the sender send to an address.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_COOLDOWN,
+      g_param_spec_uint ("cooldown", "Cooldown",
+          "Time in ms after a burst before its receiver gets a new one",
+          0, G_MAXUINT, DEFAULT_PROP_COOLDOWN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::refused
+   *
+   * Number of requests that were ignored: for another SSRC, during the
+   * cooldown of their address or with max-bursts bursts active.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_REFUSED,
+      g_param_spec_uint64 ("refused", "Refused", "Number of requests ignored",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::rtp-port
+   *
+   * Port the stream is sent to. A receiver gets its burst on its RTCP port
+   * shifted by the difference between rtp-port and rtcp-port.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RTP_PORT,
+      g_param_spec_int ("rtp-port", "RTP port",
+          "Port the stream is sent to", 0, G_MAXUINT16,
+          DEFAULT_PROP_RTP_PORT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::rtcp-port
+   *
+   * Port the RTCP of the stream is sent to, the same as rtp-port with
+   * rtcp-mux.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RTCP_PORT,
+      g_param_spec_int ("rtcp-port", "RTCP port",
+          "Port the RTCP of the stream is sent to", 0, G_MAXUINT16,
+          DEFAULT_PROP_RTCP_PORT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBurst::socket
+   *
+   * Socket the stream is sent on, the bursts are sent on it too. Requests
+   * are not answered without one.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_SOCKET,
+      g_param_spec_object ("socket", "Socket",
+          "Socket the stream is sent on", G_TYPE_SOCKET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&rtcp_sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&rtcp_src_template));
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_burst_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpburst",
+      "Network/RTP",
+      "Barco RTP rapid acquisition (burst-on-join) server",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_burst_debug,
+      "barcortpburst", 0, "Barco RTP burst-on-join server");
+}
+
+static void
+gst_rtp_burst_init (GstRtpBurst * self)
+{
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_burst_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_burst_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  GST_PAD_SET_PROXY_CAPS (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->rtcp_sinkpad = gst_pad_new_from_static_template (&rtcp_sink_template,
+      "rtcp_sink");
+  gst_pad_set_chain_function (self->rtcp_sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_burst_rtcp_chain));
+  GST_PAD_SET_PROXY_CAPS (self->rtcp_sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->rtcp_sinkpad);
+
+  self->rtcp_srcpad = gst_pad_new_from_static_template (&rtcp_src_template,
+      "rtcp_src");
+  GST_PAD_SET_PROXY_CAPS (self->rtcp_srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->rtcp_srcpad);
+
+  gst_pad_set_iterate_internal_links_function (self->sinkpad,
+      gst_rtp_burst_iterate_internal_links);
+  gst_pad_set_iterate_internal_links_function (self->srcpad,
+      gst_rtp_burst_iterate_internal_links);
+  gst_pad_set_iterate_internal_links_function (self->rtcp_sinkpad,
+      gst_rtp_burst_iterate_internal_links);
+  gst_pad_set_iterate_internal_links_function (self->rtcp_srcpad,
+      gst_rtp_burst_iterate_internal_links);
+
+  self->bitrate = DEFAULT_PROP_BITRATE;
+  self->max_bursts = DEFAULT_PROP_MAX_BURSTS;
+  self->cooldown = DEFAULT_PROP_COOLDOWN;
+  self->rtp_port = DEFAULT_PROP_RTP_PORT;
+  self->rtcp_port = DEFAULT_PROP_RTCP_PORT;
+  self->recent = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      g_free);
+  self->flushing = TRUE;
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  gst_barco_gop_cache_init (&self->cache, DEFAULT_CACHE_SIZE);
+}
+
+gboolean
+rtp_burst_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpburst", GST_RANK_NONE, GST_TYPE_RTP_BURST);
+}
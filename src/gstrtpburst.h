@@ -0,0 +1,15 @@
+#ifndef _GST_RTP_BURST_H_
+#define _GST_RTP_BURST_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_BURST (gst_rtp_burst_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpBurst, gst_rtp_burst, GST, RTP_BURST,
+    GstElement);
+
+gboolean rtp_burst_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_BURST_H_ */
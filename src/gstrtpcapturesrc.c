@@ -0,0 +1,876 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * UDP receiver on a shared AF_PACKET TPACKET_V3 ring, used by rtpsrc
+ * instead of udpsrc in capture mode.
+ *
+ * All elements capturing on the same interface share one memory mapped
+ * ring, read by a single thread without a system call per packet. A BPF
+ * filter built from the address and port of every element only lets
+ * their packets into the ring; the thread hands each packet to the
+ * elements of its group. Sockets are only opened to join the multicast
+ * groups. IPv4 only.
+ *
+ * The ring carries the receive time of the kernel with every packet; with
+ * kernel-timestamps it is used as the arrival time instead of the time
+ * create() pops the packet.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <gio/gio.h>
+#include <gst/net/gstnet.h>
+
+#include "gstrtpcapturesrc.h"
+#include "gstbarcomgs_common.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_capture_src_debug);
+#define GST_CAT_DEFAULT rtp_capture_src_debug
+
+/* 32 blocks of 1 MiB, retired by the kernel after 10 ms at the latest */
+#define GST_RTP_CAPTURE_BLOCK_SIZE    (1 << 20)
+#define GST_RTP_CAPTURE_BLOCKS        (32)
+#define GST_RTP_CAPTURE_FRAME_SIZE    (2048)
+#define GST_RTP_CAPTURE_BLOCK_TIMEOUT (10)
+/* Wakeup interval of the ring thread and of create() in ms */
+#define GST_RTP_CAPTURE_WAIT_MS       (100)
+/* Packets queued per element before dropping */
+#define GST_RTP_CAPTURE_MAX_QUEUED    (4096)
+
+typedef struct
+{
+  gint refcount;
+  gchar *iface;
+  gint fd;
+  guint8 *map;
+  GThread *thread;
+  gint running;
+
+  /* protects members and the filter */
+  GMutex lock;
+  /* (address << 16 | port) -> GSList of GstRtpCaptureSrc */
+  GHashTable *members;
+} GstRtpCaptureRing;
+
+struct _GstRtpCaptureSrc
+{
+  GstPushSrc parent_instance;
+
+  gchar *iface;
+  gchar *address;
+  gint port;
+  gchar *multicast_iface;
+  GstCaps *caps;
+  gboolean kernel_timestamps;
+
+  GSocket *socket;
+  GstRtpCaptureRing *ring;
+  guint64 key;
+  GAsyncQueue *queue;
+  gint flushing;
+};
+
+enum
+{
+  PROP_0,
+  PROP_ADDRESS,
+  PROP_CAPS,
+  PROP_IFACE,
+  PROP_KERNEL_TIMESTAMPS,
+  PROP_MULTICAST_IFACE,
+  PROP_PORT,
+  PROP_URI,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_ADDRESS          "0.0.0.0"
+#define DEFAULT_PROP_PORT             (5004)
+#define DEFAULT_PROP_IFACE            "lo"
+#define DEFAULT_PROP_MULTICAST_IFACE  (NULL)
+#define DEFAULT_PROP_KERNEL_TIMESTAMPS (FALSE)
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_rtp_capture_src_parent_class parent_class
+G_DEFINE_TYPE (GstRtpCaptureSrc, gst_rtp_capture_src, GST_TYPE_PUSH_SRC);
+
+/* the rings by interface */
+static GMutex rings_lock;
+static GHashTable *rings;
+
+#define GST_RTP_CAPTURE_KEY(addr, port) (((guint64) (addr) << 16) | (port))
+
+/**
+ * gst_rtp_capture_ring_set_filter:
+ * @ring: a #GstRtpCaptureRing, locked
+ *
+ * Only accept unfragmented IPv4 UDP to the address and port of a member;
+ * members on 0.0.0.0 accept the port on any address. Every member ends
+ * in its own return so all jumps stay short.
+ */
+static void
+gst_rtp_capture_ring_set_filter (GstRtpCaptureRing * ring)
+{
+  static const struct sock_filter head[] = {
+    BPF_STMT (BPF_LD | BPF_B | BPF_ABS, 0),
+    BPF_STMT (BPF_ALU | BPF_AND | BPF_K, 0xf0),
+    BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, 0x40, 1, 0),
+    BPF_STMT (BPF_RET | BPF_K, 0),
+    BPF_STMT (BPF_LD | BPF_B | BPF_ABS, 9),
+    BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 1, 0),
+    BPF_STMT (BPF_RET | BPF_K, 0),
+    BPF_STMT (BPF_LD | BPF_H | BPF_ABS, 6),
+    BPF_JUMP (BPF_JMP | BPF_JSET | BPF_K, 0x1fff, 0, 1),
+    BPF_STMT (BPF_RET | BPF_K, 0),
+    BPF_STMT (BPF_LDX | BPF_B | BPF_MSH, 0),
+  };
+  GArray *prog = g_array_new (FALSE, FALSE, sizeof (struct sock_filter));
+  struct sock_filter ins;
+  struct sock_fprog fprog;
+  GHashTableIter iter;
+  gpointer key;
+
+  g_array_append_vals (prog, head, G_N_ELEMENTS (head));
+
+  g_hash_table_iter_init (&iter, ring->members);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    guint32 addr = *(guint64 *) key >> 16;
+    guint16 port = *(guint64 *) key & 0xffff;
+
+    ins = (struct sock_filter) BPF_STMT (BPF_LD | BPF_H | BPF_IND, 2);
+    g_array_append_val (prog, ins);
+    ins = (struct sock_filter) BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, port, 0,
+        addr ? 3 : 1);
+    g_array_append_val (prog, ins);
+    if (addr) {
+      ins = (struct sock_filter) BPF_STMT (BPF_LD | BPF_W | BPF_ABS, 16);
+      g_array_append_val (prog, ins);
+      ins = (struct sock_filter) BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, addr,
+          0, 1);
+      g_array_append_val (prog, ins);
+    }
+    ins = (struct sock_filter) BPF_STMT (BPF_RET | BPF_K, 0xffffffff);
+    g_array_append_val (prog, ins);
+  }
+
+  ins = (struct sock_filter) BPF_STMT (BPF_RET | BPF_K, 0);
+  g_array_append_val (prog, ins);
+
+  fprog.len = prog->len;
+  fprog.filter = (struct sock_filter *) prog->data;
+  if (setsockopt (ring->fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog,
+          sizeof (fprog)) < 0)
+    GST_WARNING ("Could not set the capture filter on %s: %s", ring->iface,
+        g_strerror (errno));
+
+  g_array_free (prog, TRUE);
+}
+
+/**
+ * gst_rtp_capture_ring_dispatch:
+ * @ring: a #GstRtpCaptureRing, locked
+ * @ppd: a packet in a block of the ring
+ *
+ * Copy the UDP payload of a packet out of the ring and queue it on every
+ * member of its group, with the receive time of the kernel.
+ */
+static void
+gst_rtp_capture_ring_dispatch (GstRtpCaptureRing * ring,
+    struct tpacket3_hdr *ppd)
+{
+  struct sockaddr_ll *sll = (struct sockaddr_ll *) ((guint8 *) ppd +
+      TPACKET_ALIGN (sizeof (struct tpacket3_hdr)));
+  const guint8 *ip = (guint8 *) ppd + ppd->tp_net;
+  guint len = ppd->tp_snaplen, ihl, ulen;
+  guint32 dst;
+  guint16 dport;
+  GSList *members, *l;
+  GInetAddress *addr;
+  GSocketAddress *saddr;
+  GstBuffer *buffer;
+
+  /* on loopback every packet is seen going out and coming in */
+  if (sll->sll_pkttype == PACKET_OUTGOING || len < 20)
+    return;
+
+  ihl = (ip[0] & 0x0f) * 4;
+  if (len < ihl + 8)
+    return;
+  ulen = GST_READ_UINT16_BE (ip + ihl + 4);
+  if (ulen < 8 || ihl + ulen > len)
+    return;
+
+  dst = GST_READ_UINT32_BE (ip + 16);
+  dport = GST_READ_UINT16_BE (ip + ihl + 2);
+  members = g_hash_table_lookup (ring->members,
+      &(guint64) { GST_RTP_CAPTURE_KEY (dst, dport) });
+  if (members == NULL)
+    members = g_hash_table_lookup (ring->members,
+        &(guint64) { GST_RTP_CAPTURE_KEY (0, dport) });
+  if (members == NULL)
+    return;
+
+  buffer = gst_buffer_new_allocate (NULL, ulen - 8, NULL);
+  gst_buffer_fill (buffer, 0, ip + ihl + 8, ulen - 8);
+  gst_barco_buffer_add_arrival (buffer,
+      (GstClockTime) ppd->tp_sec * GST_SECOND + ppd->tp_nsec);
+
+  addr = g_inet_address_new_from_bytes (ip + 12, G_SOCKET_FAMILY_IPV4);
+  saddr = g_inet_socket_address_new (addr,
+      GST_READ_UINT16_BE (ip + ihl));
+  gst_buffer_add_net_address_meta (buffer, saddr);
+  g_object_unref (saddr);
+  g_object_unref (addr);
+
+  for (l = members; l; l = l->next) {
+    GstRtpCaptureSrc *self = l->data;
+
+    if (g_async_queue_length (self->queue) >= GST_RTP_CAPTURE_MAX_QUEUED)
+      GST_LOG_OBJECT (self, "Queue full, dropping packet");
+    else
+      g_async_queue_push (self->queue, gst_buffer_ref (buffer));
+  }
+  gst_buffer_unref (buffer);
+}
+
+static gpointer
+gst_rtp_capture_ring_thread (gpointer data)
+{
+  GstRtpCaptureRing *ring = data;
+  struct pollfd pfd = { ring->fd, POLLIN | POLLERR, 0 };
+  struct tpacket_block_desc *desc;
+  struct tpacket3_hdr *ppd;
+  guint block = 0, i;
+
+  while (g_atomic_int_get (&ring->running)) {
+    desc = (struct tpacket_block_desc *) (ring->map +
+        (gsize) block * GST_RTP_CAPTURE_BLOCK_SIZE);
+
+    if (!(desc->hdr.bh1.block_status & TP_STATUS_USER)) {
+      poll (&pfd, 1, GST_RTP_CAPTURE_WAIT_MS);
+      continue;
+    }
+
+    ppd = (struct tpacket3_hdr *) ((guint8 *) desc +
+        desc->hdr.bh1.offset_to_first_pkt);
+    g_mutex_lock (&ring->lock);
+    for (i = 0; i < desc->hdr.bh1.num_pkts; i++) {
+      gst_rtp_capture_ring_dispatch (ring, ppd);
+      ppd = (struct tpacket3_hdr *) ((guint8 *) ppd + ppd->tp_next_offset);
+    }
+    g_mutex_unlock (&ring->lock);
+
+    /* hand the block back to the kernel */
+    __sync_synchronize ();
+    desc->hdr.bh1.block_status = TP_STATUS_KERNEL;
+    block = (block + 1) % GST_RTP_CAPTURE_BLOCKS;
+  }
+
+  return NULL;
+}
+
+static void
+gst_rtp_capture_ring_free (GstRtpCaptureRing * ring)
+{
+  if (ring->thread) {
+    g_atomic_int_set (&ring->running, FALSE);
+    g_thread_join (ring->thread);
+  }
+  if (ring->map)
+    munmap (ring->map,
+        (gsize) GST_RTP_CAPTURE_BLOCKS * GST_RTP_CAPTURE_BLOCK_SIZE);
+  if (ring->fd >= 0)
+    close (ring->fd);
+  g_hash_table_unref (ring->members);
+  g_mutex_clear (&ring->lock);
+  g_free (ring->iface);
+  g_slice_free (GstRtpCaptureRing, ring);
+}
+
+/**
+ * gst_rtp_capture_ring_new:
+ * @iface: the interface to capture on
+ * @err: return location for an error
+ *
+ * Returns: (nullable): a running ring on @iface
+ */
+static GstRtpCaptureRing *
+gst_rtp_capture_ring_new (const gchar * iface, GError ** err)
+{
+  GstRtpCaptureRing *ring = g_slice_new0 (GstRtpCaptureRing);
+  struct tpacket_req3 req;
+  struct sockaddr_ll sll;
+  gint version = TPACKET_V3;
+  const gchar *what;
+
+  ring->refcount = 1;
+  ring->iface = g_strdup (iface);
+  g_mutex_init (&ring->lock);
+  ring->members = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free,
+      NULL);
+
+  /* cooked packets start at the IP header, whatever the link */
+  what = "socket";
+  ring->fd = socket (AF_PACKET, SOCK_DGRAM, htons (ETH_P_IP));
+  if (ring->fd < 0)
+    goto error;
+
+  /* nothing gets in before the first member */
+  gst_rtp_capture_ring_set_filter (ring);
+
+  what = "PACKET_VERSION";
+  if (setsockopt (ring->fd, SOL_PACKET, PACKET_VERSION, &version,
+          sizeof (version)) < 0)
+    goto error;
+
+  memset (&req, 0, sizeof (req));
+  req.tp_block_size = GST_RTP_CAPTURE_BLOCK_SIZE;
+  req.tp_block_nr = GST_RTP_CAPTURE_BLOCKS;
+  req.tp_frame_size = GST_RTP_CAPTURE_FRAME_SIZE;
+  req.tp_frame_nr = GST_RTP_CAPTURE_BLOCK_SIZE / GST_RTP_CAPTURE_FRAME_SIZE *
+      GST_RTP_CAPTURE_BLOCKS;
+  req.tp_retire_blk_tov = GST_RTP_CAPTURE_BLOCK_TIMEOUT;
+  what = "PACKET_RX_RING";
+  if (setsockopt (ring->fd, SOL_PACKET, PACKET_RX_RING, &req,
+          sizeof (req)) < 0)
+    goto error;
+
+  what = "mmap";
+  ring->map = mmap (NULL,
+      (gsize) GST_RTP_CAPTURE_BLOCKS * GST_RTP_CAPTURE_BLOCK_SIZE,
+      PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+  if (ring->map == MAP_FAILED) {
+    ring->map = NULL;
+    goto error;
+  }
+
+  memset (&sll, 0, sizeof (sll));
+  sll.sll_family = AF_PACKET;
+  sll.sll_protocol = htons (ETH_P_IP);
+  sll.sll_ifindex = if_nametoindex (iface);
+  what = "bind";
+  if (sll.sll_ifindex == 0 ||
+      bind (ring->fd, (struct sockaddr *) &sll, sizeof (sll)) < 0)
+    goto error;
+
+  ring->running = TRUE;
+  ring->thread = g_thread_new ("rtpcapture", gst_rtp_capture_ring_thread,
+      ring);
+
+  GST_INFO ("Capturing on %s", iface);
+  return ring;
+
+error:
+  g_set_error (err, G_IO_ERROR, g_io_error_from_errno (errno),
+      "%s on %s: %s", what, iface, g_strerror (errno));
+  gst_rtp_capture_ring_free (ring);
+  return NULL;
+}
+
+static GstRtpCaptureRing *
+gst_rtp_capture_ring_get (const gchar * iface, GError ** err)
+{
+  GstRtpCaptureRing *ring;
+
+  g_mutex_lock (&rings_lock);
+  if (rings == NULL)
+    rings = g_hash_table_new (g_str_hash, g_str_equal);
+
+  ring = g_hash_table_lookup (rings, iface);
+  if (ring) {
+    ring->refcount++;
+  } else {
+    ring = gst_rtp_capture_ring_new (iface, err);
+    if (ring)
+      g_hash_table_insert (rings, ring->iface, ring);
+  }
+  g_mutex_unlock (&rings_lock);
+
+  return ring;
+}
+
+static void
+gst_rtp_capture_ring_unref (GstRtpCaptureRing * ring)
+{
+  g_mutex_lock (&rings_lock);
+  if (--ring->refcount == 0) {
+    g_hash_table_remove (rings, ring->iface);
+    gst_rtp_capture_ring_free (ring);
+  }
+  g_mutex_unlock (&rings_lock);
+}
+
+static void
+gst_rtp_capture_ring_add (GstRtpCaptureRing * ring, GstRtpCaptureSrc * self)
+{
+  GSList *members;
+
+  g_mutex_lock (&ring->lock);
+  members = g_hash_table_lookup (ring->members, &self->key);
+  if (members) {
+    /* the list head stays the same */
+    members = g_slist_append (members, self);
+  } else {
+    g_hash_table_insert (ring->members, g_memdup (&self->key,
+            sizeof (self->key)), g_slist_append (NULL, self));
+    gst_rtp_capture_ring_set_filter (ring);
+  }
+  g_mutex_unlock (&ring->lock);
+}
+
+static void
+gst_rtp_capture_ring_remove (GstRtpCaptureRing * ring,
+    GstRtpCaptureSrc * self)
+{
+  GSList *members;
+
+  g_mutex_lock (&ring->lock);
+  members = g_hash_table_lookup (ring->members, &self->key);
+  members = g_slist_remove (members, self);
+  if (members) {
+    g_hash_table_insert (ring->members, g_memdup (&self->key,
+            sizeof (self->key)), members);
+  } else {
+    g_hash_table_remove (ring->members, &self->key);
+    gst_rtp_capture_ring_set_filter (ring);
+  }
+  g_mutex_unlock (&ring->lock);
+}
+
+/**
+ * gst_rtp_capture_src_join:
+ * @self: the #GstRtpCaptureSrc
+ * @addr: the address to receive
+ *
+ * The ring sees the packets but does not join groups. A socket bound to
+ * the group and port takes care of the membership and keeps the kernel
+ * from answering unicast with port unreachable; it is never read, so its
+ * receive buffer is kept as small as possible.
+ */
+static gboolean
+gst_rtp_capture_src_join (GstRtpCaptureSrc * self, GInetAddress * addr)
+{
+  GSocketAddress *bind_addr;
+  GError *err = NULL;
+
+  self->socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+  if (self->socket == NULL)
+    goto error;
+
+  g_socket_set_option (self->socket, SOL_SOCKET, SO_RCVBUF, 0, NULL);
+
+  bind_addr = g_inet_socket_address_new (addr, self->port);
+  if (!g_socket_bind (self->socket, bind_addr, TRUE, &err)) {
+    g_object_unref (bind_addr);
+    goto error;
+  }
+  g_object_unref (bind_addr);
+
+  if (g_inet_address_get_is_multicast (addr) &&
+      !g_socket_join_multicast_group (self->socket, addr, FALSE,
+          self->multicast_iface ? self->multicast_iface : self->iface, &err))
+    goto error;
+
+  return TRUE;
+
+error:
+  GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+      ("Could not join %s:%d: %s", self->address, self->port, err->message));
+  g_clear_error (&err);
+  g_clear_object (&self->socket);
+  return FALSE;
+}
+
+static gboolean
+gst_rtp_capture_src_start (GstBaseSrc * src)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (src);
+  GInetAddress *addr;
+  GError *err = NULL;
+  gboolean ret;
+
+  addr = g_inet_address_new_from_string (self->address);
+  if (addr == NULL ||
+      g_inet_address_get_family (addr) != G_SOCKET_FAMILY_IPV4) {
+    GST_ELEMENT_ERROR (self, RESOURCE, SETTINGS, (NULL),
+        ("Can only capture IPv4, not %s", self->address));
+    if (addr)
+      g_object_unref (addr);
+    return FALSE;
+  }
+
+  self->key = GST_RTP_CAPTURE_KEY (GST_READ_UINT32_BE
+      (g_inet_address_to_bytes (addr)), self->port);
+  ret = gst_rtp_capture_src_join (self, addr);
+  g_object_unref (addr);
+  if (!ret)
+    return FALSE;
+
+  self->ring = gst_rtp_capture_ring_get (self->iface, &err);
+  if (self->ring == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+        ("Could not capture: %s", err->message));
+    g_clear_error (&err);
+    g_clear_object (&self->socket);
+    return FALSE;
+  }
+  gst_rtp_capture_ring_add (self->ring, self);
+
+  GST_INFO_OBJECT (self, "Capturing %s:%d on %s", self->address, self->port,
+      self->iface);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_capture_src_stop (GstBaseSrc * src)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (src);
+  GstBuffer *buffer;
+
+  if (self->ring) {
+    gst_rtp_capture_ring_remove (self->ring, self);
+    gst_rtp_capture_ring_unref (self->ring);
+    self->ring = NULL;
+  }
+
+  while ((buffer = g_async_queue_try_pop (self->queue)))
+    gst_buffer_unref (buffer);
+
+  if (self->socket) {
+    g_socket_close (self->socket, NULL);
+    g_clear_object (&self->socket);
+  }
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_rtp_capture_src_create (GstPushSrc * src, GstBuffer ** outbuf)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (src);
+
+  *outbuf = NULL;
+  while (*outbuf == NULL) {
+    if (g_atomic_int_get (&self->flushing))
+      return GST_FLOW_FLUSHING;
+
+    *outbuf = g_async_queue_timeout_pop (self->queue,
+        GST_RTP_CAPTURE_WAIT_MS * 1000);
+  }
+
+  /* the buffer is shared with the other members of the group, it is
+   * only copied when it gets timestamps */
+  if (self->kernel_timestamps)
+    *outbuf = gst_barco_buffer_stamp_arrival (GST_ELEMENT (self), *outbuf);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_rtp_capture_src_unlock (GstBaseSrc * src)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (src);
+
+  g_atomic_int_set (&self->flushing, TRUE);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_capture_src_unlock_stop (GstBaseSrc * src)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (src);
+
+  g_atomic_int_set (&self->flushing, FALSE);
+
+  return TRUE;
+}
+
+static GstCaps *
+gst_rtp_capture_src_get_caps (GstBaseSrc * src, GstCaps * filter)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (src);
+  GstCaps *caps;
+
+  GST_OBJECT_LOCK (self);
+  caps = self->caps ? gst_caps_ref (self->caps) : gst_caps_new_any ();
+  GST_OBJECT_UNLOCK (self);
+
+  if (filter) {
+    GstCaps *tmp = gst_caps_intersect_full (filter, caps,
+        GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  return caps;
+}
+
+static void
+gst_rtp_capture_src_set_uri (GstRtpCaptureSrc * self, const gchar * str)
+{
+  GstUri *uri = gst_uri_from_string (str);
+
+  if (uri == NULL) {
+    GST_WARNING_OBJECT (self, "Invalid URI %s", str);
+    return;
+  }
+
+  g_free (self->address);
+  self->address = g_strdup (gst_uri_get_host (uri));
+  if (gst_uri_get_port (uri) != GST_URI_NO_PORT)
+    self->port = gst_uri_get_port (uri);
+  gst_uri_unref (uri);
+}
+
+static void
+gst_rtp_capture_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_ADDRESS:
+      g_free (self->address);
+      self->address = g_value_dup_string (value);
+      break;
+    case PROP_CAPS:
+      GST_OBJECT_LOCK (self);
+      gst_caps_replace (&self->caps, (GstCaps *) gst_value_get_caps (value));
+      GST_OBJECT_UNLOCK (self);
+      gst_pad_mark_reconfigure (GST_BASE_SRC_PAD (self));
+      break;
+    case PROP_IFACE:
+      g_free (self->iface);
+      self->iface = g_value_dup_string (value);
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      self->kernel_timestamps = g_value_get_boolean (value);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_free (self->multicast_iface);
+      self->multicast_iface = g_value_dup_string (value);
+      break;
+    case PROP_PORT:
+      self->port = g_value_get_int (value);
+      break;
+    case PROP_URI:
+      gst_rtp_capture_src_set_uri (self, g_value_get_string (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_capture_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_ADDRESS:
+      g_value_set_string (value, self->address);
+      break;
+    case PROP_CAPS:
+      GST_OBJECT_LOCK (self);
+      gst_value_set_caps (value, self->caps);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_IFACE:
+      g_value_set_string (value, self->iface);
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      g_value_set_boolean (value, self->kernel_timestamps);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_value_set_string (value, self->multicast_iface);
+      break;
+    case PROP_PORT:
+      g_value_set_int (value, self->port);
+      break;
+    case PROP_URI:
+      g_value_take_string (value, g_strdup_printf ("udp://%s:%d",
+              self->address, self->port));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_capture_src_finalize (GObject * gobject)
+{
+  GstRtpCaptureSrc *self = GST_RTP_CAPTURE_SRC (gobject);
+
+  g_free (self->iface);
+  g_free (self->address);
+  g_free (self->multicast_iface);
+  gst_caps_replace (&self->caps, NULL);
+  g_async_queue_unref (self->queue);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_capture_src_class_init (GstRtpCaptureSrcClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstBaseSrcClass *gstbasesrc_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *gstpushsrc_class = GST_PUSH_SRC_CLASS (klass);
+
+  oclass->set_property = gst_rtp_capture_src_set_property;
+  oclass->get_property = gst_rtp_capture_src_get_property;
+  oclass->finalize = gst_rtp_capture_src_finalize;
+
+  /**
+   * GstRtpCaptureSrc::iface
+   *
+   * Interface to capture on, shared with all elements capturing on it.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_IFACE,
+      g_param_spec_string ("iface", "Interface", "Interface to capture on",
+          DEFAULT_PROP_IFACE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpCaptureSrc::address
+   *
+   * IPv4 address to receive packets on, a multicast group is joined.
+   * 0.0.0.0 receives the port on any address.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_ADDRESS,
+      g_param_spec_string ("address", "Address",
+          "Address to receive packets on", DEFAULT_PROP_ADDRESS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpCaptureSrc::port
+   *
+   * Port to receive packets on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_PORT,
+      g_param_spec_int ("port", "Port", "Port to receive packets on",
+          0, G_MAXUINT16, DEFAULT_PROP_PORT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpCaptureSrc::uri
+   *
+   * udp://address:port to receive packets on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_URI,
+      g_param_spec_string ("uri", "URI", "udp:// URI to receive packets on",
+          NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpCaptureSrc::multicast-iface
+   *
+   * Network interface to join the multicast group on, the capture
+   * interface when not set.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MULTICAST_IFACE,
+      g_param_spec_string ("multicast-iface", "Multicast Interface",
+          "Network interface to join the multicast group on",
+          DEFAULT_PROP_MULTICAST_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpCaptureSrc::caps
+   *
+   * Caps of the received packets.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_CAPS,
+      g_param_spec_boxed ("caps", "Caps", "Caps of the received packets",
+          GST_TYPE_CAPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpCaptureSrc::kernel-timestamps
+   *
+   * Time the packets on the receive time the kernel stored in the ring
+   * instead of the time they are read.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KERNEL_TIMESTAMPS,
+      g_param_spec_boolean ("kernel-timestamps", "Kernel Timestamps",
+          "Time the packets on the receive time of the kernel",
+          DEFAULT_PROP_KERNEL_TIMESTAMPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+
+  gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_rtp_capture_src_start);
+  gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_rtp_capture_src_stop);
+  gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR (gst_rtp_capture_src_unlock);
+  gstbasesrc_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_rtp_capture_src_unlock_stop);
+  gstbasesrc_class->get_caps =
+      GST_DEBUG_FUNCPTR (gst_rtp_capture_src_get_caps);
+  gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_rtp_capture_src_create);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpcapturesrc",
+      "Source/Network",
+      "Barco UDP receiver on a shared packet capture ring",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_capture_src_debug,
+      "barcortpcapturesrc", 0, "Barco UDP receiver on a packet ring");
+}
+
+static void
+gst_rtp_capture_src_init (GstRtpCaptureSrc * self)
+{
+  self->iface = g_strdup (DEFAULT_PROP_IFACE);
+  self->address = g_strdup (DEFAULT_PROP_ADDRESS);
+  self->port = DEFAULT_PROP_PORT;
+  self->multicast_iface = g_strdup (DEFAULT_PROP_MULTICAST_IFACE);
+  self->kernel_timestamps = DEFAULT_PROP_KERNEL_TIMESTAMPS;
+  self->queue = g_async_queue_new ();
+
+  gst_base_src_set_live (GST_BASE_SRC (self), TRUE);
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+  gst_base_src_set_do_timestamp (GST_BASE_SRC (self), TRUE);
+}
+
+gboolean
+rtp_capture_src_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpcapturesrc", GST_RANK_NONE, GST_TYPE_RTP_CAPTURE_SRC);
+}
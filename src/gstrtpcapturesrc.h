@@ -0,0 +1,16 @@
+#ifndef _GST_RTP_CAPTURE_SRC_H_
+#define _GST_RTP_CAPTURE_SRC_H_
+
+#include <gst/gst.h>
+#include <gst/base/gstpushsrc.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_CAPTURE_SRC (gst_rtp_capture_src_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpCaptureSrc, gst_rtp_capture_src, GST,
+    RTP_CAPTURE_SRC, GstPushSrc);
+
+gboolean rtp_capture_src_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_CAPTURE_SRC_H_ */
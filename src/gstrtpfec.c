@@ -0,0 +1,446 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpfec
+ *
+ * \brief XOR parity FEC shared by the FEC encoder and decoder
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gstrtpfec.h"
+
+#if defined(__GNUC__)
+/* Let the compiler pick the vector unit: SSE2/AVX2 on x86, NEON on ARM */
+#if defined(__AVX2__)
+typedef guint8 GstRtpFecVec __attribute__ ((vector_size (32)));
+#else
+typedef guint8 GstRtpFecVec __attribute__ ((vector_size (16)));
+#endif
+#endif
+
+GType
+gst_rtp_fec_mode_get_type (void)
+{
+  static gsize id = 0;
+  static const GEnumValue values[] = {
+    {GST_RTP_FEC_MODE_NONE, "No FEC", "none"},
+    {GST_RTP_FEC_MODE_AUTO, "SMPTE 2022-1 for MP2T, FlexFEC otherwise", "auto"},
+    {GST_RTP_FEC_MODE_ULPFEC, "ULPFEC (RFC 5109), row FEC only", "ulpfec"},
+    {GST_RTP_FEC_MODE_FLEXFEC, "FlexFEC (RFC 8627)", "flexfec"},
+    {GST_RTP_FEC_MODE_SMPTE_2022_1, "SMPTE 2022-1", "smpte-2022-1"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_enum_register_static ("GstRtpFecMode", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
+/**
+ * gst_rtp_fec_xor:
+ * @dst: destination, XORed in place
+ * @src: source
+ * @len: number of bytes
+ *
+ * XOR @src into @dst. This is the hot loop of both FEC generation and
+ * recovery; it works on vector registers four at a time and does not
+ * require any alignment.
+ */
+void
+gst_rtp_fec_xor (guint8 * dst, const guint8 * src, gsize len)
+{
+#if defined(__GNUC__)
+  while (len >= 4 * sizeof (GstRtpFecVec)) {
+    GstRtpFecVec d[4], s[4];
+
+    memcpy (d, dst, sizeof (d));
+    memcpy (s, src, sizeof (s));
+    d[0] ^= s[0];
+    d[1] ^= s[1];
+    d[2] ^= s[2];
+    d[3] ^= s[3];
+    memcpy (dst, d, sizeof (d));
+
+    dst += sizeof (d);
+    src += sizeof (s);
+    len -= sizeof (d);
+  }
+
+  while (len >= sizeof (GstRtpFecVec)) {
+    GstRtpFecVec d, s;
+
+    memcpy (&d, dst, sizeof (d));
+    memcpy (&s, src, sizeof (s));
+    d ^= s;
+    memcpy (dst, &d, sizeof (d));
+
+    dst += sizeof (d);
+    src += sizeof (s);
+    len -= sizeof (d);
+  }
+#endif
+
+  while (len >= sizeof (guint64)) {
+    guint64 d, s;
+
+    memcpy (&d, dst, sizeof (d));
+    memcpy (&s, src, sizeof (s));
+    d ^= s;
+    memcpy (dst, &d, sizeof (d));
+
+    dst += sizeof (d);
+    src += sizeof (s);
+    len -= sizeof (d);
+  }
+
+  while (len--)
+    *dst++ ^= *src++;
+}
+
+void
+gst_rtp_fec_group_init (GstRtpFecGroup * group)
+{
+  memset (group, 0, sizeof (GstRtpFecGroup));
+}
+
+void
+gst_rtp_fec_group_clear (GstRtpFecGroup * group)
+{
+  g_free (group->payload);
+  memset (group, 0, sizeof (GstRtpFecGroup));
+}
+
+/**
+ * gst_rtp_fec_group_reset:
+ * @group: the #GstRtpFecGroup
+ *
+ * Start a new row or column; the payload buffer is kept for reuse.
+ */
+void
+gst_rtp_fec_group_reset (GstRtpFecGroup * group)
+{
+  if (group->payload_len)
+    memset (group->payload, 0, group->payload_len);
+
+  group->sn_base = 0;
+  group->count = 0;
+  group->hdr_rec[0] = group->hdr_rec[1] = 0;
+  group->ts_rec = 0;
+  group->len_rec = 0;
+  group->last_ts = 0;
+  group->payload_len = 0;
+}
+
+/**
+ * gst_rtp_fec_group_add:
+ * @group: the #GstRtpFecGroup
+ * @data: a complete RTP packet
+ * @size: the size of @data
+ *
+ * Add an RTP packet to the parity of @group.
+ *
+ * Returns: %FALSE if @data is not an RTP packet
+ */
+gboolean
+gst_rtp_fec_group_add (GstRtpFecGroup * group, const guint8 * data, gsize size)
+{
+  gsize len;
+
+  if (G_UNLIKELY (size < GST_RTP_FEC_RTP_HEADER_LEN || (data[0] >> 6) != 2))
+    return FALSE;
+
+  len = size - GST_RTP_FEC_RTP_HEADER_LEN;
+
+  if (G_UNLIKELY (len > group->payload_size)) {
+    group->payload = g_realloc (group->payload, len);
+    memset (group->payload + group->payload_size, 0,
+        len - group->payload_size);
+    group->payload_size = len;
+  }
+
+  if (group->count == 0)
+    group->sn_base = GST_READ_UINT16_BE (data + 2);
+
+  group->hdr_rec[0] ^= data[0];
+  group->hdr_rec[1] ^= data[1];
+  group->last_ts = GST_READ_UINT32_BE (data + 4);
+  group->ts_rec ^= group->last_ts;
+  group->len_rec ^= (guint16) len;
+
+  gst_rtp_fec_xor (group->payload, data + GST_RTP_FEC_RTP_HEADER_LEN, len);
+  group->payload_len = MAX (group->payload_len, len);
+  group->count++;
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_fec_build:
+ * @mode: the FEC flavour to generate, not none or auto
+ * @group: the completed row or column
+ * @row: %TRUE for row FEC, %FALSE for column FEC
+ * @L: number of columns in the matrix
+ * @D: number of rows in the matrix
+ * @pt: payload type of the FEC stream
+ * @seq: sequence number of the FEC stream
+ * @ssrc: SSRC of the FEC stream
+ * @out: memory to write the FEC packet in
+ * @out_size: size of @out
+ *
+ * Serialise the parity of @group as an RTP FEC packet.
+ *
+ * Returns: the size of the FEC packet or 0 if @out is too small
+ */
+gsize
+gst_rtp_fec_build (GstRtpFecMode mode, const GstRtpFecGroup * group,
+    gboolean row, guint L, guint D, guint8 pt, guint16 seq, guint32 ssrc,
+    guint8 * out, gsize out_size)
+{
+  guint8 *h = out + GST_RTP_FEC_RTP_HEADER_LEN;
+  gsize hlen = 0;
+
+  if (out_size < GST_RTP_FEC_RTP_HEADER_LEN + GST_RTP_FEC_MAX_HEADER_LEN +
+      group->payload_len)
+    return 0;
+
+  out[0] = 0x80;
+  out[1] = pt & 0x7f;
+  GST_WRITE_UINT16_BE (out + 2, seq);
+  GST_WRITE_UINT32_BE (out + 4, group->last_ts);
+  GST_WRITE_UINT32_BE (out + 8, ssrc);
+
+  switch (mode) {
+    case GST_RTP_FEC_MODE_SMPTE_2022_1:
+      GST_WRITE_UINT16_BE (h, group->sn_base);
+      GST_WRITE_UINT16_BE (h + 2, group->len_rec);
+      h[4] = 0x80 | (group->hdr_rec[1] & 0x7f);
+      h[5] = h[6] = h[7] = 0;
+      GST_WRITE_UINT32_BE (h + 8, group->ts_rec);
+      h[12] = row ? 0x40 : 0x00;
+      h[13] = row ? 1 : L;
+      h[14] = row ? L : D;
+      h[15] = 0;
+      hlen = 16;
+      break;
+    case GST_RTP_FEC_MODE_ULPFEC:
+    {
+      gboolean long_mask = group->count > 16;
+      guint64 mask = ((G_GUINT64_CONSTANT (1) << group->count) - 1) <<
+          ((long_mask ? 48 : 16) - group->count);
+
+      h[0] = (long_mask ? 0x40 : 0x00) | (group->hdr_rec[0] & 0x3f);
+      h[1] = group->hdr_rec[1];
+      GST_WRITE_UINT16_BE (h + 2, group->sn_base);
+      GST_WRITE_UINT32_BE (h + 4, group->ts_rec);
+      GST_WRITE_UINT16_BE (h + 8, group->len_rec);
+      GST_WRITE_UINT16_BE (h + 10, (guint16) group->payload_len);
+      if (long_mask) {
+        GST_WRITE_UINT16_BE (h + 12, (guint16) (mask >> 32));
+        GST_WRITE_UINT32_BE (h + 14, (guint32) mask);
+        hlen = 18;
+      } else {
+        GST_WRITE_UINT16_BE (h + 12, (guint16) mask);
+        hlen = 14;
+      }
+    }
+      break;
+    case GST_RTP_FEC_MODE_FLEXFEC:
+      h[0] = 0x40 | (group->hdr_rec[0] & 0x3f);
+      h[1] = group->hdr_rec[1];
+      GST_WRITE_UINT16_BE (h + 2, group->len_rec);
+      GST_WRITE_UINT32_BE (h + 4, group->ts_rec);
+      GST_WRITE_UINT16_BE (h + 8, group->sn_base);
+      h[10] = L;
+      h[11] = row ? 0 : D;
+      hlen = 12;
+      break;
+    default:
+      g_return_val_if_reached (0);
+  }
+
+  memcpy (h + hlen, group->payload, group->payload_len);
+
+  return GST_RTP_FEC_RTP_HEADER_LEN + hlen + group->payload_len;
+}
+
+/**
+ * gst_rtp_fec_parse:
+ * @mode: the FEC flavour to parse, not none or auto
+ * @data: a complete FEC RTP packet
+ * @size: the size of @data
+ * @fec: the #GstRtpFecPacket to fill in
+ *
+ * Returns: %FALSE if @data is not a valid FEC packet
+ */
+gboolean
+gst_rtp_fec_parse (GstRtpFecMode mode, const guint8 * data, gsize size,
+    GstRtpFecPacket * fec)
+{
+  const guint8 *h;
+  gsize offset, hlen;
+
+  if (size < GST_RTP_FEC_RTP_HEADER_LEN || (data[0] >> 6) != 2)
+    return FALSE;
+
+  offset = GST_RTP_FEC_RTP_HEADER_LEN + (data[0] & 0x0f) * 4;
+  if (offset >= size)
+    return FALSE;
+
+  h = data + offset;
+  size -= offset;
+  memset (fec, 0, sizeof (GstRtpFecPacket));
+
+  switch (mode) {
+    case GST_RTP_FEC_MODE_SMPTE_2022_1:
+      hlen = 16;
+      if (size < hlen)
+        return FALSE;
+      fec->sn_base = GST_READ_UINT16_BE (h);
+      fec->len_rec = GST_READ_UINT16_BE (h + 2);
+      fec->hdr_rec[0] = 0;
+      fec->hdr_rec[1] = h[4] & 0x7f;
+      fec->ts_rec = GST_READ_UINT32_BE (h + 8);
+      fec->row = (h[12] & 0x40) != 0;
+      fec->L = fec->row ? h[14] : h[13];
+      fec->D = fec->row ? 1 : h[14];
+      break;
+    case GST_RTP_FEC_MODE_ULPFEC:
+      hlen = (h[0] & 0x40) ? 18 : 14;
+      if (size < hlen)
+        return FALSE;
+      fec->hdr_rec[0] = h[0] & 0x3f;
+      fec->hdr_rec[1] = h[1];
+      fec->sn_base = GST_READ_UINT16_BE (h + 2);
+      fec->ts_rec = GST_READ_UINT32_BE (h + 4);
+      fec->len_rec = GST_READ_UINT16_BE (h + 8);
+      if (hlen == 18)
+        fec->mask = ((guint64) GST_READ_UINT16_BE (h + 12) << 32) |
+            GST_READ_UINT32_BE (h + 14);
+      else
+        fec->mask = ((guint64) GST_READ_UINT16_BE (h + 12)) << 32;
+      fec->row = TRUE;
+      fec->D = 1;
+      break;
+    case GST_RTP_FEC_MODE_FLEXFEC:
+      hlen = 12;
+      if (size < hlen || (h[0] & 0xc0) != 0x40)
+        return FALSE;
+      fec->hdr_rec[0] = h[0] & 0x3f;
+      fec->hdr_rec[1] = h[1];
+      fec->len_rec = GST_READ_UINT16_BE (h + 2);
+      fec->ts_rec = GST_READ_UINT32_BE (h + 4);
+      fec->sn_base = GST_READ_UINT16_BE (h + 8);
+      fec->L = h[10];
+      fec->D = h[11];
+      fec->row = (fec->D == 0);
+      break;
+    default:
+      return FALSE;
+  }
+
+  if (mode != GST_RTP_FEC_MODE_ULPFEC &&
+      (fec->L == 0 || fec->L > GST_RTP_FEC_MAX_COLUMNS ||
+          fec->D > GST_RTP_FEC_MAX_ROWS))
+    return FALSE;
+
+  fec->payload = h + hlen;
+  fec->payload_len = size - hlen;
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_fec_packet_get_seqnums:
+ * @fec: a parsed #GstRtpFecPacket
+ * @seqnums: array of at least 48 entries
+ *
+ * Returns: the number of media sequence numbers protected by @fec
+ */
+guint
+gst_rtp_fec_packet_get_seqnums (const GstRtpFecPacket * fec, guint16 * seqnums)
+{
+  guint i, n = 0;
+
+  if (fec->mask) {
+    /* ULPFEC: the MSB of the (left aligned) 48 bit mask is sn_base */
+    for (i = 0; i < 48; i++)
+      if (fec->mask & (G_GUINT64_CONSTANT (1) << (47 - i)))
+        seqnums[n++] = fec->sn_base + i;
+  } else if (fec->row) {
+    for (i = 0; i < fec->L; i++)
+      seqnums[n++] = fec->sn_base + i;
+  } else {
+    for (i = 0; i < fec->D; i++)
+      seqnums[n++] = fec->sn_base + i * fec->L;
+  }
+
+  return n;
+}
+
+/**
+ * gst_rtp_fec_group_set_packet:
+ * @group: the #GstRtpFecGroup
+ * @fec: a parsed #GstRtpFecPacket
+ *
+ * Seed @group with the parity of @fec. Adding all received packets of
+ * the row or column with gst_rtp_fec_group_add() then leaves the missing
+ * packet in @group.
+ */
+void
+gst_rtp_fec_group_set_packet (GstRtpFecGroup * group,
+    const GstRtpFecPacket * fec)
+{
+  gst_rtp_fec_group_reset (group);
+
+  if (fec->payload_len > group->payload_size) {
+    group->payload = g_realloc (group->payload, fec->payload_len);
+    group->payload_size = fec->payload_len;
+  }
+  memcpy (group->payload, fec->payload, fec->payload_len);
+  group->payload_len = fec->payload_len;
+
+  group->hdr_rec[0] = fec->hdr_rec[0];
+  group->hdr_rec[1] = fec->hdr_rec[1];
+  group->ts_rec = fec->ts_rec;
+  group->len_rec = fec->len_rec;
+  /* not a media packet, keeps sn_base from being overwritten */
+  group->count = 1;
+}
+
+/**
+ * gst_rtp_fec_group_restore:
+ * @group: a #GstRtpFecGroup seeded with gst_rtp_fec_group_set_packet()
+ *   to which all but one protected packets were added
+ * @seq: the sequence number of the missing packet
+ * @ssrc: the SSRC of the media stream
+ * @out: memory to write the recovered packet in
+ * @out_size: size of @out
+ *
+ * Returns: the size of the recovered RTP packet, 0 if it is inconsistent
+ */
+gsize
+gst_rtp_fec_group_restore (const GstRtpFecGroup * group, guint16 seq,
+    guint32 ssrc, guint8 * out, gsize out_size)
+{
+  gsize len = group->len_rec;
+
+  if (len > group->payload_len ||
+      out_size < GST_RTP_FEC_RTP_HEADER_LEN + len)
+    return 0;
+
+  out[0] = 0x80 | (group->hdr_rec[0] & 0x3f);
+  out[1] = group->hdr_rec[1];
+  GST_WRITE_UINT16_BE (out + 2, seq);
+  GST_WRITE_UINT32_BE (out + 4, group->ts_rec);
+  GST_WRITE_UINT32_BE (out + 8, ssrc);
+  memcpy (out + GST_RTP_FEC_RTP_HEADER_LEN, group->payload, len);
+
+  return GST_RTP_FEC_RTP_HEADER_LEN + len;
+}
@@ -0,0 +1,113 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpfec
+ *
+ * \brief XOR parity FEC shared by the FEC encoder and decoder
+ *
+ * Row/column (L x D) XOR parity as used by SMPTE 2022-1, FlexFEC
+ * (RFC 8627, fixed L/D mask) and ULPFEC (RFC 5109, as a separate stream).
+ * The three only differ in the layout of the FEC header.
+ *
+ */
+
+#ifndef _GST_RTP_FEC_H_
+#define _GST_RTP_FEC_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GST_RTP_FEC_MODE_NONE,
+  GST_RTP_FEC_MODE_AUTO,
+  GST_RTP_FEC_MODE_ULPFEC,
+  GST_RTP_FEC_MODE_FLEXFEC,
+  GST_RTP_FEC_MODE_SMPTE_2022_1
+} GstRtpFecMode;
+
+#define GST_TYPE_RTP_FEC_MODE (gst_rtp_fec_mode_get_type ())
+GType gst_rtp_fec_mode_get_type (void);
+
+/* Size of the fixed RTP header; the FEC protects everything after it */
+#define GST_RTP_FEC_RTP_HEADER_LEN   (12)
+/* Largest FEC header: ULPFEC with a 48 bit mask */
+#define GST_RTP_FEC_MAX_HEADER_LEN   (18)
+
+/* The FEC matrix is limited so that the decoder window stays small */
+#define GST_RTP_FEC_MAX_COLUMNS      (48)
+#define GST_RTP_FEC_MAX_ROWS         (48)
+
+/* Seqnums the decoder keeps around, covers two full matrices */
+#define GST_RTP_FEC_WINDOW           (8192)
+
+/* FEC streams are sent next to RTP/RTCP: column FEC on port + 2,
+ * row FEC on port + 4 (SMPTE 2022-1 convention) */
+#define GST_RTP_FEC_COLUMN_PORT_OFFSET (2)
+#define GST_RTP_FEC_ROW_PORT_OFFSET    (4)
+
+typedef struct _GstRtpFecGroup GstRtpFecGroup;
+
+/**
+ * GstRtpFecGroup:
+ *
+ * Running XOR over the packets of one row or one column.
+ */
+struct _GstRtpFecGroup
+{
+  guint16 sn_base;
+  guint count;
+
+  guint8 hdr_rec[2];            /* P, X, CC, M, PT */
+  guint32 ts_rec;
+  guint16 len_rec;
+  guint32 last_ts;
+
+  guint8 *payload;
+  gsize payload_len;            /* longest protected payload */
+  gsize payload_size;           /* allocated */
+};
+
+/**
+ * GstRtpFecPacket:
+ *
+ * Parsed FEC packet; @payload points into the mapped FEC packet.
+ */
+typedef struct
+{
+  gboolean row;
+  guint16 sn_base;
+  guint L;
+  guint D;
+  guint64 mask;                 /* ULPFEC only */
+
+  guint8 hdr_rec[2];
+  guint32 ts_rec;
+  guint16 len_rec;
+
+  const guint8 *payload;
+  gsize payload_len;
+} GstRtpFecPacket;
+
+void gst_rtp_fec_xor (guint8 * dst, const guint8 * src, gsize len);
+
+void gst_rtp_fec_group_init (GstRtpFecGroup * group);
+void gst_rtp_fec_group_clear (GstRtpFecGroup * group);
+void gst_rtp_fec_group_reset (GstRtpFecGroup * group);
+gboolean gst_rtp_fec_group_add (GstRtpFecGroup * group, const guint8 * data,
+    gsize size);
+
+gsize gst_rtp_fec_build (GstRtpFecMode mode, const GstRtpFecGroup * group,
+    gboolean row, guint L, guint D, guint8 pt, guint16 seq, guint32 ssrc,
+    guint8 * out, gsize out_size);
+gboolean gst_rtp_fec_parse (GstRtpFecMode mode, const guint8 * data,
+    gsize size, GstRtpFecPacket * fec);
+guint gst_rtp_fec_packet_get_seqnums (const GstRtpFecPacket * fec,
+    guint16 * seqnums);
+
+void gst_rtp_fec_group_set_packet (GstRtpFecGroup * group,
+    const GstRtpFecPacket * fec);
+gsize gst_rtp_fec_group_restore (const GstRtpFecGroup * group, guint16 seq,
+    guint32 ssrc, guint8 * out, gsize out_size);
+
+G_END_DECLS
+#endif /* _GST_RTP_FEC_H_ */
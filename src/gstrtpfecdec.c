@@ -0,0 +1,662 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * Row/column XOR FEC recovery used by rtpsrc.
+ *
+ * RTP packets received on the sink pad are passed through unmodified and
+ * kept in a window indexed by seqnum. FEC packets arrive on fec_0 (column)
+ * and fec_1 (row); when exactly one packet protected by a FEC packet is
+ * missing, it is rebuilt and pushed on the src pad. The jitterbuffer
+ * downstream puts recovered packets back in order.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gstrtpfecdec.h"
+#include "gstrtpfec.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_fec_dec_debug);
+#define GST_CAT_DEFAULT rtp_fec_dec_debug
+
+/* Packets are given up on once they are this far behind the newest one,
+ * raised to two matrices when larger matrices are received */
+#define GST_RTP_FEC_DEC_MIN_SPAN      (1024)
+/* FEC packets waiting for more than one missing packet */
+#define GST_RTP_FEC_DEC_MAX_PENDING   (256)
+
+typedef struct
+{
+  GstBuffer *buffer;
+  guint16 seq;
+} GstRtpFecDecSlot;
+
+struct _GstRtpFecDec
+{
+  GstElement parent_instance;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+  GstPad *fecpad[2];
+
+  GstRtpFecMode mode;
+
+  /* serializes the media and FEC streaming threads, also held while
+   * pushing so the src pad only sees one thread at a time */
+  GMutex lock;
+
+  GstRtpFecMode active_mode;
+  gboolean have_seq;
+  guint16 max_seq;
+  guint16 expire_seq;
+  guint span;
+  guint32 ssrc;
+  GstRtpFecDecSlot window[GST_RTP_FEC_WINDOW];
+  GQueue pending;
+  GstRtpFecGroup work;
+
+  /* protected by the object lock */
+  guint64 recovered;
+  guint64 unrecoverable;
+};
+
+enum
+{
+  PROP_0,
+  PROP_MODE,
+  PROP_RECOVERED,
+  PROP_UNRECOVERABLE,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_MODE             GST_RTP_FEC_MODE_AUTO
+
+typedef enum
+{
+  GST_RTP_FEC_DEC_DONE,         /* nothing left to do with this FEC packet */
+  GST_RTP_FEC_DEC_RECOVERED,    /* recovered a packet */
+  GST_RTP_FEC_DEC_WAIT          /* more than one packet missing */
+} GstRtpFecDecResult;
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate fec_0_template = GST_STATIC_PAD_TEMPLATE ("fec_0",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate fec_1_template = GST_STATIC_PAD_TEMPLATE ("fec_1",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+#define gst_rtp_fec_dec_parent_class parent_class
+G_DEFINE_TYPE (GstRtpFecDec, gst_rtp_fec_dec, GST_TYPE_ELEMENT);
+
+static inline gint
+gst_rtp_fec_dec_seq_diff (guint16 a, guint16 b)
+{
+  return (gint16) (a - b);
+}
+
+static void
+gst_rtp_fec_dec_reset (GstRtpFecDec * self)
+{
+  guint i;
+
+  for (i = 0; i < GST_RTP_FEC_WINDOW; i++)
+    gst_buffer_replace (&self->window[i].buffer, NULL);
+  g_queue_clear_full (&self->pending, (GDestroyNotify) gst_buffer_unref);
+
+  self->have_seq = FALSE;
+  self->span = GST_RTP_FEC_DEC_MIN_SPAN;
+}
+
+static inline GstBuffer *
+gst_rtp_fec_dec_lookup (GstRtpFecDec * self, guint16 seq)
+{
+  GstRtpFecDecSlot *slot = &self->window[seq % GST_RTP_FEC_WINDOW];
+
+  return (slot->buffer && slot->seq == seq) ? slot->buffer : NULL;
+}
+
+/**
+ * gst_rtp_fec_dec_store:
+ * @self: The current #GstRtpFecDec object
+ * @seq: seqnum of @buffer
+ * @buffer: (transfer none): media or recovered packet
+ *
+ * Keep @buffer in the window and give up on packets that fell out of it.
+ *
+ * Returns: FALSE if @buffer is too old or a duplicate
+ */
+static gboolean
+gst_rtp_fec_dec_store (GstRtpFecDec * self, guint16 seq, GstBuffer * buffer)
+{
+  GstRtpFecDecSlot *slot;
+  guint64 lost = 0;
+
+  if (G_UNLIKELY (!self->have_seq)) {
+    self->max_seq = self->expire_seq = seq;
+    self->have_seq = TRUE;
+  } else if (ABS (gst_rtp_fec_dec_seq_diff (seq,
+              self->max_seq)) >= GST_RTP_FEC_WINDOW) {
+    GST_DEBUG_OBJECT (self, "Seqnum jump %u -> %u, resetting", self->max_seq,
+        seq);
+    gst_rtp_fec_dec_reset (self);
+    self->max_seq = self->expire_seq = seq;
+    self->have_seq = TRUE;
+  } else if (gst_rtp_fec_dec_seq_diff (seq, self->expire_seq) < 0) {
+    return FALSE;
+  } else if (gst_rtp_fec_dec_seq_diff (seq, self->max_seq) > 0) {
+    self->max_seq = seq;
+  }
+
+  if (gst_rtp_fec_dec_lookup (self, seq))
+    return FALSE;
+
+  slot = &self->window[seq % GST_RTP_FEC_WINDOW];
+  gst_buffer_replace (&slot->buffer, buffer);
+  slot->seq = seq;
+
+  while ((guint16) (self->max_seq - self->expire_seq) >= self->span) {
+    slot = &self->window[self->expire_seq % GST_RTP_FEC_WINDOW];
+    if (slot->buffer && slot->seq == self->expire_seq)
+      gst_buffer_replace (&slot->buffer, NULL);
+    else
+      lost++;
+    self->expire_seq++;
+  }
+
+  if (lost) {
+    GST_OBJECT_LOCK (self);
+    self->unrecoverable += lost;
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_fec_dec_try:
+ * @self: The current #GstRtpFecDec object
+ * @fec_buffer: the FEC packet
+ * @ref: buffer whose timestamps are given to a recovered packet
+ * @recovered: (out): recovered packet, if any
+ *
+ * Returns: what to do with @fec_buffer
+ */
+static GstRtpFecDecResult
+gst_rtp_fec_dec_try (GstRtpFecDec * self, GstBuffer * fec_buffer,
+    GstBuffer * ref, GstBuffer ** recovered)
+{
+  GstRtpFecDecResult res = GST_RTP_FEC_DEC_DONE;
+  guint16 seqnums[GST_RTP_FEC_MAX_ROWS];
+  GstRtpFecPacket fec;
+  GstMapInfo map, pmap;
+  guint n, i, missing = 0;
+  guint16 missing_seq = 0;
+  GstBuffer *out;
+  gsize size;
+
+  if (!gst_buffer_map (fec_buffer, &map, GST_MAP_READ))
+    return GST_RTP_FEC_DEC_DONE;
+
+  if (!gst_rtp_fec_parse (self->active_mode, map.data, map.size, &fec))
+    goto done;
+
+  if (G_UNLIKELY (fec.L * MAX (fec.D, 1) * 2 > self->span))
+    self->span = MIN (fec.L * MAX (fec.D, 1) * 2, GST_RTP_FEC_WINDOW / 2);
+
+  n = gst_rtp_fec_packet_get_seqnums (&fec, seqnums);
+  for (i = 0; i < n; i++) {
+    /* a protected packet is no longer in the window */
+    if (gst_rtp_fec_dec_seq_diff (seqnums[i], self->expire_seq) < 0)
+      goto done;
+    if (!gst_rtp_fec_dec_lookup (self, seqnums[i])) {
+      missing++;
+      missing_seq = seqnums[i];
+    }
+  }
+
+  /* nothing lost, or the last packet might still be on its way */
+  if (missing == 0)
+    goto done;
+  if (missing > 1 ||
+      gst_rtp_fec_dec_seq_diff (missing_seq, self->max_seq) > 0) {
+    res = GST_RTP_FEC_DEC_WAIT;
+    goto done;
+  }
+
+  gst_rtp_fec_group_set_packet (&self->work, &fec);
+  for (i = 0; i < n; i++) {
+    GstBuffer *b;
+
+    if (seqnums[i] == missing_seq)
+      continue;
+    b = gst_rtp_fec_dec_lookup (self, seqnums[i]);
+    if (gst_buffer_map (b, &pmap, GST_MAP_READ)) {
+      gst_rtp_fec_group_add (&self->work, pmap.data, pmap.size);
+      gst_buffer_unmap (b, &pmap);
+    }
+  }
+
+  out = gst_buffer_new_allocate (NULL, GST_RTP_FEC_RTP_HEADER_LEN +
+      self->work.payload_len, NULL);
+  gst_buffer_map (out, &pmap, GST_MAP_WRITE);
+  size = gst_rtp_fec_group_restore (&self->work, missing_seq, self->ssrc,
+      pmap.data, pmap.size);
+  if (size && self->active_mode == GST_RTP_FEC_MODE_SMPTE_2022_1) {
+    /* the 2022-1 header only recovers the payload type */
+    pmap.data[0] = 0x80;
+    pmap.data[1] &= 0x7f;
+  }
+  gst_buffer_unmap (out, &pmap);
+
+  if (size == 0) {
+    GST_DEBUG_OBJECT (self, "Inconsistent FEC for seqnum %u", missing_seq);
+    gst_buffer_unref (out);
+    goto done;
+  }
+
+  gst_buffer_set_size (out, size);
+  GST_BUFFER_PTS (out) = GST_BUFFER_PTS (ref);
+  GST_BUFFER_DTS (out) = GST_BUFFER_DTS (ref);
+  gst_rtp_fec_dec_store (self, missing_seq, out);
+  *recovered = out;
+  res = GST_RTP_FEC_DEC_RECOVERED;
+
+  GST_LOG_OBJECT (self, "Recovered seqnum %u", missing_seq);
+  GST_OBJECT_LOCK (self);
+  self->recovered++;
+  GST_OBJECT_UNLOCK (self);
+
+done:
+  gst_buffer_unmap (fec_buffer, &map);
+  return res;
+}
+
+/**
+ * gst_rtp_fec_dec_retry_pending:
+ * @self: The current #GstRtpFecDec object
+ * @ref: buffer whose timestamps are given to recovered packets
+ * @out: list receiving the recovered packets
+ *
+ * Every recovery can make a waiting FEC packet of the other dimension
+ * usable, go over the waiting ones until nothing changes.
+ */
+static void
+gst_rtp_fec_dec_retry_pending (GstRtpFecDec * self, GstBuffer * ref,
+    GQueue * out)
+{
+  gboolean progress = TRUE;
+
+  while (progress) {
+    GList *l, *next;
+
+    progress = FALSE;
+    for (l = self->pending.head; l; l = next) {
+      GstBuffer *recovered = NULL;
+
+      next = l->next;
+      switch (gst_rtp_fec_dec_try (self, l->data, ref, &recovered)) {
+        case GST_RTP_FEC_DEC_RECOVERED:
+          g_queue_push_tail (out, recovered);
+          progress = TRUE;
+          /* fall through */
+        case GST_RTP_FEC_DEC_DONE:
+          gst_buffer_unref (l->data);
+          g_queue_delete_link (&self->pending, l);
+          break;
+        case GST_RTP_FEC_DEC_WAIT:
+          break;
+      }
+    }
+  }
+}
+
+static GstFlowReturn
+gst_rtp_fec_dec_push_recovered (GstRtpFecDec * self, GQueue * out)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (out))) {
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (self->srcpad, buffer);
+    else
+      gst_buffer_unref (buffer);
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_rtp_fec_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (parent);
+  GQueue out = G_QUEUE_INIT;
+  GstFlowReturn ret;
+  GstMapInfo map;
+  gboolean stored = FALSE;
+  guint16 seq = 0;
+
+  g_mutex_lock (&self->lock);
+
+  if (G_UNLIKELY (self->active_mode == GST_RTP_FEC_MODE_NONE))
+    goto push;
+
+  if (gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    if (G_LIKELY (map.size >= GST_RTP_FEC_RTP_HEADER_LEN)) {
+      if (G_UNLIKELY (self->active_mode == GST_RTP_FEC_MODE_AUTO)) {
+        self->active_mode = ((map.data[1] & 0x7f) == 33) ?
+            GST_RTP_FEC_MODE_SMPTE_2022_1 : GST_RTP_FEC_MODE_FLEXFEC;
+        GST_INFO_OBJECT (self, "Expecting %s FEC",
+            self->active_mode == GST_RTP_FEC_MODE_FLEXFEC ?
+            "FlexFEC" : "SMPTE 2022-1");
+      }
+      seq = GST_READ_UINT16_BE (map.data + 2);
+      self->ssrc = GST_READ_UINT32_BE (map.data + 8);
+      stored = TRUE;
+    }
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  if (stored && gst_rtp_fec_dec_store (self, seq, buffer))
+    gst_rtp_fec_dec_retry_pending (self, buffer, &out);
+
+push:
+  ret = gst_pad_push (self->srcpad, buffer);
+  if (ret == GST_FLOW_OK)
+    ret = gst_rtp_fec_dec_push_recovered (self, &out);
+  else
+    g_queue_clear_full (&out, (GDestroyNotify) gst_buffer_unref);
+
+  g_mutex_unlock (&self->lock);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_rtp_fec_dec_fec_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (parent);
+  GQueue out = G_QUEUE_INIT;
+  GstBuffer *recovered = NULL;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&self->lock);
+
+  /* the FEC flavour is only known once media was seen */
+  if (self->active_mode == GST_RTP_FEC_MODE_NONE ||
+      self->active_mode == GST_RTP_FEC_MODE_AUTO || !self->have_seq) {
+    gst_buffer_unref (buffer);
+    goto done;
+  }
+
+  switch (gst_rtp_fec_dec_try (self, buffer, buffer, &recovered)) {
+    case GST_RTP_FEC_DEC_RECOVERED:
+      g_queue_push_tail (&out, recovered);
+      gst_buffer_unref (buffer);
+      gst_rtp_fec_dec_retry_pending (self, recovered, &out);
+      break;
+    case GST_RTP_FEC_DEC_WAIT:
+      g_queue_push_tail (&self->pending, buffer);
+      if (self->pending.length > GST_RTP_FEC_DEC_MAX_PENDING)
+        gst_buffer_unref (g_queue_pop_head (&self->pending));
+      break;
+    case GST_RTP_FEC_DEC_DONE:
+      gst_buffer_unref (buffer);
+      break;
+  }
+
+  ret = gst_rtp_fec_dec_push_recovered (self, &out);
+
+done:
+  g_mutex_unlock (&self->lock);
+
+  /* a FEC stream must never take down the media stream */
+  if (ret != GST_FLOW_OK && ret != GST_FLOW_FLUSHING)
+    GST_DEBUG_OBJECT (self, "Recovered push returned %s",
+        gst_flow_get_name (ret));
+
+  return ret == GST_FLOW_FLUSHING ? ret : GST_FLOW_OK;
+}
+
+static gboolean
+gst_rtp_fec_dec_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    g_mutex_lock (&self->lock);
+    gst_rtp_fec_dec_reset (self);
+    g_mutex_unlock (&self->lock);
+  }
+
+  return gst_pad_push_event (self->srcpad, event);
+}
+
+static gboolean
+gst_rtp_fec_dec_fec_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  /* the FEC streams have their own caps and segment; only the media
+   * stream decides what goes downstream */
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static GstStateChangeReturn
+gst_rtp_fec_dec_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      g_mutex_lock (&self->lock);
+      GST_OBJECT_LOCK (self);
+      self->active_mode = self->mode;
+      self->recovered = 0;
+      self->unrecoverable = 0;
+      GST_OBJECT_UNLOCK (self);
+      gst_rtp_fec_dec_reset (self);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      g_mutex_lock (&self->lock);
+      gst_rtp_fec_dec_reset (self);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_fec_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_MODE:
+      self->mode = g_value_get_enum (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_fec_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_MODE:
+      g_value_set_enum (value, self->mode);
+      break;
+    case PROP_RECOVERED:
+      g_value_set_uint64 (value, self->recovered);
+      break;
+    case PROP_UNRECOVERABLE:
+      g_value_set_uint64 (value, self->unrecoverable);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_fec_dec_finalize (GObject * gobject)
+{
+  GstRtpFecDec *self = GST_RTP_FEC_DEC (gobject);
+
+  gst_rtp_fec_dec_reset (self);
+  gst_rtp_fec_group_clear (&self->work);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_fec_dec_class_init (GstRtpFecDecClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  oclass->set_property = gst_rtp_fec_dec_set_property;
+  oclass->get_property = gst_rtp_fec_dec_get_property;
+  oclass->finalize = gst_rtp_fec_dec_finalize;
+
+  /**
+   * GstRtpFecDec::mode
+   *
+   * FEC flavour to expect, auto uses SMPTE 2022-1 for MP2T (pt 33)
+   * and FlexFEC for everything else.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MODE,
+      g_param_spec_enum ("mode", "FEC mode", "FEC flavour to expect",
+          GST_TYPE_RTP_FEC_MODE, DEFAULT_PROP_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpFecDec::recovered
+   *
+   * Number of packets rebuilt from FEC.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RECOVERED,
+      g_param_spec_uint64 ("recovered", "Recovered",
+          "Number of packets recovered with FEC", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpFecDec::unrecoverable
+   *
+   * Number of packets that were neither received nor recovered before
+   * they left the recovery window.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_UNRECOVERABLE,
+      g_param_spec_uint64 ("unrecoverable", "Unrecoverable",
+          "Number of lost packets FEC could not recover", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&fec_0_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&fec_1_template));
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpfecdec",
+      "Codec/Decoder/Network/RTP",
+      "Barco RTP row/column XOR FEC recovery",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_fec_dec_debug,
+      "barcortpfecdec", 0, "Barco RTP FEC recovery");
+}
+
+static void
+gst_rtp_fec_dec_init (GstRtpFecDec * self)
+{
+  guint i;
+
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  GST_PAD_SET_PROXY_CAPS (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  for (i = 0; i < 2; i++) {
+    self->fecpad[i] = gst_pad_new_from_static_template (i == 0 ?
+        &fec_0_template : &fec_1_template, i == 0 ? "fec_0" : "fec_1");
+    gst_pad_set_chain_function (self->fecpad[i],
+        GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_fec_chain));
+    gst_pad_set_event_function (self->fecpad[i],
+        GST_DEBUG_FUNCPTR (gst_rtp_fec_dec_fec_event));
+    gst_element_add_pad (GST_ELEMENT (self), self->fecpad[i]);
+  }
+
+  self->mode = DEFAULT_PROP_MODE;
+  self->span = GST_RTP_FEC_DEC_MIN_SPAN;
+
+  g_mutex_init (&self->lock);
+  g_queue_init (&self->pending);
+  gst_rtp_fec_group_init (&self->work);
+}
+
+gboolean
+rtp_fec_dec_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpfecdec", GST_RANK_NONE, GST_TYPE_RTP_FEC_DEC);
+}
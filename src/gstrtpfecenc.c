@@ -0,0 +1,578 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * Row/column XOR FEC generator used by rtpsink.
+ *
+ * RTP packets are passed through unmodified on the src pad; the column
+ * FEC packets are pushed on fec_0 and the row FEC packets on fec_1.
+ *
+ * A row FEC packet follows its row. The column FEC packets of a matrix
+ * are spread over the next one, one every D media packets, as SMPTE
+ * 2022-1 sends them: a loss on the network does not hit a column and its
+ * FEC packet at once, and the FEC does not add a burst at the end of every
+ * matrix.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gstrtpfecenc.h"
+#include "gstrtpfec.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_fec_enc_debug);
+#define GST_CAT_DEFAULT rtp_fec_enc_debug
+
+struct _GstRtpFecEnc
+{
+  GstElement parent_instance;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+  GstPad *fecpad[2];
+
+  GstRtpFecMode mode;
+  guint columns;
+  guint rows;
+  gboolean row;
+  guint pt;
+
+  /* current matrix, only touched from the streaming thread */
+  GstRtpFecMode active_mode;
+  guint L;
+  guint D;
+  gboolean row_fec;
+  guint index;
+  GstRtpFecGroup column_groups[GST_RTP_FEC_MAX_COLUMNS];
+  GstRtpFecGroup row_group;
+  /* column FEC packets waiting for their turn in the next matrix, the
+   * first columns_due of them are of earlier matrices */
+  GQueue columns_pending;
+  guint columns_due;
+
+  guint32 ssrc;
+  guint16 seq[2];
+  gboolean fec_started[2];
+  GstSegment segment;
+};
+
+enum
+{
+  PROP_0,
+  PROP_COLUMNS,
+  PROP_MODE,
+  PROP_PT,
+  PROP_ROW,
+  PROP_ROWS,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_MODE             GST_RTP_FEC_MODE_AUTO
+#define DEFAULT_PROP_COLUMNS          (10)
+#define DEFAULT_PROP_ROWS             (10)
+#define DEFAULT_PROP_ROW              (TRUE)
+/* the last dynamic payload type, payloaders start at 96 */
+#define DEFAULT_PROP_PT               (127)
+
+#define GST_RTP_FEC_COLUMN            (0)
+#define GST_RTP_FEC_ROW               (1)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate fec_0_template = GST_STATIC_PAD_TEMPLATE ("fec_0",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate fec_1_template = GST_STATIC_PAD_TEMPLATE ("fec_1",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+#define gst_rtp_fec_enc_parent_class parent_class
+G_DEFINE_TYPE (GstRtpFecEnc, gst_rtp_fec_enc, GST_TYPE_ELEMENT);
+
+/**
+ * gst_rtp_fec_enc_start_fec_pad:
+ * @self: The current #GstRtpFecEnc object
+ * @idx: the FEC pad to start
+ *
+ * The FEC pads do not follow the events of the media stream, send the
+ * sticky events they need before the first FEC packet.
+ */
+static void
+gst_rtp_fec_enc_start_fec_pad (GstRtpFecEnc * self, guint idx)
+{
+  GstPad *pad = self->fecpad[idx];
+  gchar *stream_id;
+  GstCaps *caps;
+
+  stream_id = gst_pad_create_stream_id (pad, GST_ELEMENT_CAST (self),
+      GST_PAD_NAME (pad));
+  gst_pad_push_event (pad, gst_event_new_stream_start (stream_id));
+  g_free (stream_id);
+
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, "application",
+      "clock-rate", G_TYPE_INT, 90000,
+      "payload", G_TYPE_INT, self->pt, NULL);
+  gst_pad_push_event (pad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+
+  gst_pad_push_event (pad, gst_event_new_segment (&self->segment));
+
+  self->fec_started[idx] = TRUE;
+}
+
+/**
+ * gst_rtp_fec_enc_finish_group:
+ * @self: The current #GstRtpFecEnc object
+ * @group: the completed row or column
+ * @idx: GST_RTP_FEC_COLUMN or GST_RTP_FEC_ROW
+ *
+ * Returns: (transfer full): the FEC packet protecting @group
+ */
+static GstBuffer *
+gst_rtp_fec_enc_finish_group (GstRtpFecEnc * self, GstRtpFecGroup * group,
+    guint idx)
+{
+  GstBuffer *fec;
+  GstMapInfo map;
+  gsize size;
+
+  fec = gst_buffer_new_allocate (NULL, GST_RTP_FEC_RTP_HEADER_LEN +
+      GST_RTP_FEC_MAX_HEADER_LEN + group->payload_len, NULL);
+  gst_buffer_map (fec, &map, GST_MAP_WRITE);
+  size = gst_rtp_fec_build (self->active_mode, group,
+      idx == GST_RTP_FEC_ROW, self->L, self->D, self->pt, self->seq[idx]++,
+      self->ssrc, map.data, map.size);
+  gst_buffer_unmap (fec, &map);
+  gst_buffer_set_size (fec, size);
+
+  gst_rtp_fec_group_reset (group);
+
+  return fec;
+}
+
+/**
+ * gst_rtp_fec_enc_process:
+ * @self: The current #GstRtpFecEnc object
+ * @data: the RTP packet
+ * @size: the size of @data
+ * @out: array of two, receives the column and row FEC packets if any
+ *
+ * Packets fill an L x D matrix row by row; every column is protected by
+ * a column FEC packet and, if enabled, every row by a row FEC packet.
+ * Every D packets, a column FEC packet of the previous matrix is due.
+ */
+static void
+gst_rtp_fec_enc_process (GstRtpFecEnc * self, const guint8 * data,
+    gsize size, GstBuffer ** out)
+{
+  guint c, r, i;
+
+  if (self->index == 0) {
+    GST_OBJECT_LOCK (self);
+    self->L = self->columns;
+    self->D = self->rows;
+    self->row_fec = self->row;
+    GST_OBJECT_UNLOCK (self);
+
+    if (self->active_mode == GST_RTP_FEC_MODE_ULPFEC) {
+      /* the ULPFEC mask only describes consecutive packets here */
+      self->D = 0;
+      self->row_fec = TRUE;
+    }
+
+    for (i = 0; i < self->L; i++)
+      gst_rtp_fec_group_reset (&self->column_groups[i]);
+    gst_rtp_fec_group_reset (&self->row_group);
+    self->columns_due = self->columns_pending.length;
+  }
+
+  c = self->index % self->L;
+  r = self->index / self->L;
+
+  if (self->D > 0) {
+    gst_rtp_fec_group_add (&self->column_groups[c], data, size);
+    if (r == self->D - 1)
+      g_queue_push_tail (&self->columns_pending,
+          gst_rtp_fec_enc_finish_group (self, &self->column_groups[c],
+              GST_RTP_FEC_COLUMN));
+  }
+
+  if (self->row_fec) {
+    gst_rtp_fec_group_add (&self->row_group, data, size);
+    if (c == self->L - 1)
+      out[GST_RTP_FEC_ROW] = gst_rtp_fec_enc_finish_group (self,
+          &self->row_group, GST_RTP_FEC_ROW);
+  }
+
+  self->index++;
+  if (self->columns_due > 0 && self->index % MAX (self->D, 1) == 0) {
+    out[GST_RTP_FEC_COLUMN] = g_queue_pop_head (&self->columns_pending);
+    self->columns_due--;
+  }
+  if (self->index == self->L * MAX (self->D, 1))
+    self->index = 0;
+}
+
+/**
+ * gst_rtp_fec_enc_push_fec:
+ * @self: The current #GstRtpFecEnc object
+ * @idx: GST_RTP_FEC_COLUMN or GST_RTP_FEC_ROW
+ * @fec: (transfer full): the FEC packet
+ *
+ * FEC is best effort, a failing push does not stop the media.
+ */
+static void
+gst_rtp_fec_enc_push_fec (GstRtpFecEnc * self, guint idx, GstBuffer * fec)
+{
+  GstFlowReturn ret;
+
+  if (G_UNLIKELY (!self->fec_started[idx]))
+    gst_rtp_fec_enc_start_fec_pad (self, idx);
+
+  ret = gst_pad_push (self->fecpad[idx], fec);
+  if (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED)
+    GST_DEBUG_OBJECT (self, "FEC push returned %s", gst_flow_get_name (ret));
+}
+
+static GstFlowReturn
+gst_rtp_fec_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpFecEnc *self = GST_RTP_FEC_ENC (parent);
+  GstBuffer *out[2] = { NULL, NULL };
+  GstFlowReturn ret;
+  GstMapInfo map;
+  guint i;
+
+  if (G_UNLIKELY (self->active_mode == GST_RTP_FEC_MODE_NONE))
+    return gst_pad_push (self->srcpad, buffer);
+
+  if (gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    if (G_LIKELY (map.size >= GST_RTP_FEC_RTP_HEADER_LEN)) {
+      if (G_UNLIKELY (self->active_mode == GST_RTP_FEC_MODE_AUTO)) {
+        self->active_mode = ((map.data[1] & 0x7f) == 33) ?
+            GST_RTP_FEC_MODE_SMPTE_2022_1 : GST_RTP_FEC_MODE_FLEXFEC;
+        GST_INFO_OBJECT (self, "Generating %s FEC",
+            self->active_mode == GST_RTP_FEC_MODE_FLEXFEC ?
+            "FlexFEC" : "SMPTE 2022-1");
+      }
+      gst_rtp_fec_enc_process (self, map.data, map.size, out);
+    }
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  /* FEC packets go out after the media packets they protect */
+  ret = gst_pad_push (self->srcpad, buffer);
+
+  for (i = 0; i < 2; i++)
+    if (out[i])
+      gst_rtp_fec_enc_push_fec (self, i, out[i]);
+
+  return ret;
+}
+
+static gboolean
+gst_rtp_fec_enc_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpFecEnc *self = GST_RTP_FEC_ENC (parent);
+  GstStructure *s;
+  GstCaps *caps;
+  GstBuffer *fec;
+  gint pt;
+  guint i;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+      gst_event_parse_caps (event, &caps);
+      s = gst_caps_get_structure (caps, 0);
+      /* a receiver could not tell the FEC from the media */
+      if (self->active_mode != GST_RTP_FEC_MODE_NONE &&
+          gst_structure_get_int (s, "payload", &pt) && pt == self->pt) {
+        GST_ELEMENT_WARNING (self, STREAM, FORMAT, (NULL),
+            ("FEC payload type %d is the payload type of the media, "
+                "sending without FEC", pt));
+        self->active_mode = GST_RTP_FEC_MODE_NONE;
+      }
+      break;
+    case GST_EVENT_SEGMENT:
+      gst_event_copy_segment (event, &self->segment);
+      break;
+    case GST_EVENT_EOS:
+      /* the last matrix is protected too */
+      while ((fec = g_queue_pop_head (&self->columns_pending)))
+        gst_rtp_fec_enc_push_fec (self, GST_RTP_FEC_COLUMN, fec);
+      for (i = 0; i < 2; i++)
+        if (self->fec_started[i])
+          gst_pad_push_event (self->fecpad[i], gst_event_new_eos ());
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      self->index = 0;
+      self->columns_due = 0;
+      g_queue_clear_full (&self->columns_pending,
+          (GDestroyNotify) gst_buffer_unref);
+      break;
+    default:
+      break;
+  }
+
+  /* the media caps and segment only apply to the src pad */
+  return gst_pad_push_event (self->srcpad, event);
+}
+
+static GstStateChangeReturn
+gst_rtp_fec_enc_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpFecEnc *self = GST_RTP_FEC_ENC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      self->active_mode = self->mode;
+      self->index = 0;
+      self->columns_due = 0;
+      g_queue_clear_full (&self->columns_pending,
+          (GDestroyNotify) gst_buffer_unref);
+      self->ssrc = g_random_int ();
+      self->seq[0] = g_random_int_range (0, G_MAXUINT16);
+      self->seq[1] = g_random_int_range (0, G_MAXUINT16);
+      self->fec_started[0] = self->fec_started[1] = FALSE;
+      gst_segment_init (&self->segment, GST_FORMAT_TIME);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  return ret;
+}
+
+static void
+gst_rtp_fec_enc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecEnc *self = GST_RTP_FEC_ENC (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_MODE:
+      self->mode = g_value_get_enum (value);
+      break;
+    case PROP_COLUMNS:
+      self->columns = g_value_get_uint (value);
+      break;
+    case PROP_ROWS:
+      self->rows = g_value_get_uint (value);
+      break;
+    case PROP_ROW:
+      self->row = g_value_get_boolean (value);
+      break;
+    case PROP_PT:
+      self->pt = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_fec_enc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpFecEnc *self = GST_RTP_FEC_ENC (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_MODE:
+      g_value_set_enum (value, self->mode);
+      break;
+    case PROP_COLUMNS:
+      g_value_set_uint (value, self->columns);
+      break;
+    case PROP_ROWS:
+      g_value_set_uint (value, self->rows);
+      break;
+    case PROP_ROW:
+      g_value_set_boolean (value, self->row);
+      break;
+    case PROP_PT:
+      g_value_set_uint (value, self->pt);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_fec_enc_finalize (GObject * gobject)
+{
+  GstRtpFecEnc *self = GST_RTP_FEC_ENC (gobject);
+  guint i;
+
+  for (i = 0; i < GST_RTP_FEC_MAX_COLUMNS; i++)
+    gst_rtp_fec_group_clear (&self->column_groups[i]);
+  gst_rtp_fec_group_clear (&self->row_group);
+  g_queue_clear_full (&self->columns_pending,
+      (GDestroyNotify) gst_buffer_unref);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_fec_enc_class_init (GstRtpFecEncClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  oclass->set_property = gst_rtp_fec_enc_set_property;
+  oclass->get_property = gst_rtp_fec_enc_get_property;
+  oclass->finalize = gst_rtp_fec_enc_finalize;
+
+  /**
+   * GstRtpFecEnc::mode
+   *
+   * FEC flavour to generate, auto uses SMPTE 2022-1 for MP2T (pt 33)
+   * and FlexFEC for everything else.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MODE,
+      g_param_spec_enum ("mode", "FEC mode", "FEC flavour to generate",
+          GST_TYPE_RTP_FEC_MODE, DEFAULT_PROP_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpFecEnc::columns
+   *
+   * Number of columns (L) in the FEC matrix, also the row length.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_COLUMNS,
+      g_param_spec_uint ("columns", "Columns",
+          "Number of columns (L) in the FEC matrix", 1,
+          GST_RTP_FEC_MAX_COLUMNS, DEFAULT_PROP_COLUMNS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpFecEnc::rows
+   *
+   * Number of rows (D) in the FEC matrix, also the column length.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_ROWS,
+      g_param_spec_uint ("rows", "Rows",
+          "Number of rows (D) in the FEC matrix (0 = no column FEC)", 0,
+          GST_RTP_FEC_MAX_ROWS, DEFAULT_PROP_ROWS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpFecEnc::row
+   *
+   * Also protect every row of the matrix (2D FEC).
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_ROW,
+      g_param_spec_boolean ("row", "Row FEC", "Generate row FEC packets",
+          DEFAULT_PROP_ROW, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpFecEnc::pt
+   *
+   * Payload type of the FEC packets. It has to differ from the payload type
+   * of the media, the element sends without FEC otherwise.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_PT,
+      g_param_spec_uint ("pt", "Payload type", "Payload type of FEC packets",
+          0, G_MAXINT8, DEFAULT_PROP_PT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&fec_0_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&fec_1_template));
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_enc_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpfecenc",
+      "Codec/Encoder/Network/RTP",
+      "Barco RTP row/column XOR FEC generator",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_fec_enc_debug,
+      "barcortpfecenc", 0, "Barco RTP FEC generator");
+}
+
+static void
+gst_rtp_fec_enc_init (GstRtpFecEnc * self)
+{
+  guint i;
+
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_enc_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fec_enc_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  GST_PAD_SET_PROXY_CAPS (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->fecpad[0] = gst_pad_new_from_static_template (&fec_0_template,
+      "fec_0");
+  gst_pad_use_fixed_caps (self->fecpad[0]);
+  gst_element_add_pad (GST_ELEMENT (self), self->fecpad[0]);
+
+  self->fecpad[1] = gst_pad_new_from_static_template (&fec_1_template,
+      "fec_1");
+  gst_pad_use_fixed_caps (self->fecpad[1]);
+  gst_element_add_pad (GST_ELEMENT (self), self->fecpad[1]);
+
+  self->mode = DEFAULT_PROP_MODE;
+  self->columns = DEFAULT_PROP_COLUMNS;
+  self->rows = DEFAULT_PROP_ROWS;
+  self->row = DEFAULT_PROP_ROW;
+  self->pt = DEFAULT_PROP_PT;
+
+  for (i = 0; i < GST_RTP_FEC_MAX_COLUMNS; i++)
+    gst_rtp_fec_group_init (&self->column_groups[i]);
+  gst_rtp_fec_group_init (&self->row_group);
+  g_queue_init (&self->columns_pending);
+  gst_segment_init (&self->segment, GST_FORMAT_TIME);
+}
+
+gboolean
+rtp_fec_enc_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpfecenc", GST_RANK_NONE, GST_TYPE_RTP_FEC_ENC);
+}
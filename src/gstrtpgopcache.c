@@ -0,0 +1,104 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpgopcache
+ *
+ * \brief Cache of the last GOP of an RTP stream, for fast channel change
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "gstrtpgopcache.h"
+#include "gstrtppacket.h"
+
+void
+gst_barco_gop_cache_init (GstBarcoGopCache * cache, gsize max_bytes)
+{
+  g_queue_init (&cache->packets);
+  cache->bytes = 0;
+  cache->max_bytes = max_bytes;
+  cache->have_keyframe = FALSE;
+  cache->keyframe_ts = 0;
+}
+
+void
+gst_barco_gop_cache_clear (GstBarcoGopCache * cache)
+{
+  g_queue_clear_full (&cache->packets, (GDestroyNotify) gst_buffer_unref);
+  cache->bytes = 0;
+  cache->have_keyframe = FALSE;
+}
+
+/**
+ * gst_barco_gop_cache_push:
+ * @cache: a #GstBarcoGopCache
+ * @buffer: (transfer none): an RTP packet
+ * @encoding_name: (nullable): encoding name of the stream
+ *
+ * Restart the cache at every new keyframe and keep a ref to @buffer when
+ * the cache holds a keyframe. A GOP that does not fit in max_bytes is
+ * dropped as a whole; a partial GOP is of no use to a decoder.
+ */
+void
+gst_barco_gop_cache_push (GstBarcoGopCache * cache, GstBuffer * buffer,
+    const gchar * encoding_name)
+{
+  GstMapInfo map;
+  gboolean keyframe;
+  guint32 ts;
+  gsize size;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+  if (map.size < 12) {
+    gst_buffer_unmap (buffer, &map);
+    return;
+  }
+  keyframe = gst_barco_rtp_is_keyframe (map.data, map.size,
+      gst_barco_rtp_guess_encoding_name (map.data[1] & 0x7f, encoding_name));
+  ts = GST_READ_UINT32_BE (map.data + 4);
+  size = map.size;
+  gst_buffer_unmap (buffer, &map);
+
+  /* parameter sets and all slices of a keyframe share the timestamp */
+  if (keyframe && (!cache->have_keyframe || ts != cache->keyframe_ts)) {
+    gst_barco_gop_cache_clear (cache);
+    cache->have_keyframe = TRUE;
+    cache->keyframe_ts = ts;
+  }
+
+  if (!cache->have_keyframe)
+    return;
+
+  if (cache->bytes + size > cache->max_bytes) {
+    gst_barco_gop_cache_clear (cache);
+    return;
+  }
+
+  g_queue_push_tail (&cache->packets, gst_buffer_ref (buffer));
+  cache->bytes += size;
+}
+
+/**
+ * gst_barco_gop_cache_get:
+ * @cache: a #GstBarcoGopCache
+ *
+ * Returns: (transfer full) (nullable): refs to the cached packets, NULL
+ * when no keyframe was cached
+ */
+GstBufferList *
+gst_barco_gop_cache_get (GstBarcoGopCache * cache)
+{
+  GstBufferList *list;
+  GList *l;
+
+  if (!cache->have_keyframe || cache->packets.length == 0)
+    return NULL;
+
+  list = gst_buffer_list_new_sized (cache->packets.length);
+  for (l = cache->packets.head; l; l = l->next)
+    gst_buffer_list_add (list, gst_buffer_ref (l->data));
+
+  return list;
+}
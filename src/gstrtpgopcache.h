@@ -0,0 +1,37 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpgopcache
+ *
+ * \brief Cache of the last GOP of an RTP stream, for fast channel change
+ *
+ */
+
+#ifndef _GST_RTP_GOP_CACHE_H_
+#define _GST_RTP_GOP_CACHE_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstBarcoGopCache:
+ *
+ * RTP packets from the last keyframe onward, as refs to the received
+ * buffers. Not thread safe, callers lock.
+ */
+typedef struct
+{
+  GQueue packets;
+  gsize bytes;
+  gsize max_bytes;
+  gboolean have_keyframe;
+  guint32 keyframe_ts;
+} GstBarcoGopCache;
+
+void gst_barco_gop_cache_init (GstBarcoGopCache * cache, gsize max_bytes);
+void gst_barco_gop_cache_clear (GstBarcoGopCache * cache);
+void gst_barco_gop_cache_push (GstBarcoGopCache * cache, GstBuffer * buffer,
+    const gchar * encoding_name);
+GstBufferList *gst_barco_gop_cache_get (GstBarcoGopCache * cache);
+
+G_END_DECLS
+#endif /* _GST_RTP_GOP_CACHE_H_ */
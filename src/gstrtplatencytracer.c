@@ -0,0 +1,511 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * Latency of the hot path of rtpsrc and rtpsink, per stage.
+ *
+ * rtpsrc and rtpsink mark the pads their RTP packets pass (see
+ * GstBarcoLatencyStage). This tracer times every packet on those pads
+ * and keeps, per bin and per stage, a histogram of the time since the
+ * previous stage the packet passed. The histograms are log-linear, with
+ * 16 buckets per power of two, so the percentiles are within 6.25% from
+ * 1 ns up to half an hour.
+ *
+ * The packets are told apart by their SSRC and sequence number in a ring
+ * of recent packets. Other pads only cost a lookup of their qdata per
+ * push.
+ *
+ * The percentiles of every stage are logged as a barcortp-latency record
+ * when the bin goes back to READY and when it is freed:
+ *
+ *   GST_TRACERS=barcortplatency GST_DEBUG=GST_TRACER:7 gst-launch-1.0 ...
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gstrtplatencytracer.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_latency_tracer_debug);
+#define GST_CAT_DEFAULT rtp_latency_tracer_debug
+
+/* Packets in flight told apart, a power of two */
+#define GST_RTP_LATENCY_ENTRIES       (1024)
+/* Longest latency kept apart, in bits of ns */
+#define GST_RTP_LATENCY_MAX_BITS      (41)
+/* 32 exact buckets, then 16 per power of two */
+#define GST_RTP_LATENCY_BUCKETS       ((GST_RTP_LATENCY_MAX_BITS - 3) * 16)
+/* The histogram of the time from the first to the last stage */
+#define GST_RTP_LATENCY_TOTAL         (GST_BARCO_LATENCY_N_STAGES)
+
+typedef struct
+{
+  guint64 count;
+  guint64 max;
+  guint64 buckets[GST_RTP_LATENCY_BUCKETS];
+} GstRtpLatencyHistogram;
+
+typedef struct
+{
+  /* 1 while a stage reads or writes the entry */
+  gint busy;
+  /* 0, or 1 << 48 | SSRC << 16 | sequence number */
+  guint64 key;
+  GstClockTime time[GST_BARCO_LATENCY_N_STAGES];
+} GstRtpLatencyEntry;
+
+/* The packets and histograms of an rtpsrc or rtpsink. Every stage is
+ * recorded from the streaming thread of its pad, without waiting: a stage
+ * that finds the entry of its packet busy skips it, so a packet raced for
+ * by two threads is at worst counted once too few. last_key is only a
+ * hint, a torn read of it matches no entry. */
+typedef struct
+{
+  gchar *name;
+  guint64 last_key;
+  GstRtpLatencyEntry entries[GST_RTP_LATENCY_ENTRIES];
+  GstRtpLatencyHistogram hist[GST_BARCO_LATENCY_N_STAGES + 1];
+} GstRtpLatencyFlow;
+
+struct _GstRtpLatencyTracer
+{
+  GstTracer parent_instance;
+};
+
+static const gchar *stage_names[GST_BARCO_LATENCY_N_STAGES + 1] = {
+  "receive", "queue", "jitterbuffer", "push", "entry", "rtpbin", "send",
+  "total"
+};
+
+static GstTracerRecord *tr_latency;
+static GMutex flows_lock;
+static GQuark flow_quark;
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (rtp_latency_tracer_debug, "barcortplatency", 0, \
+        "Barco RTP hot path latency tracer");
+G_DEFINE_TYPE_WITH_CODE (GstRtpLatencyTracer, gst_rtp_latency_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+G_DEFINE_QUARK (barcortp-latency-mark, gst_barco_latency_mark);
+
+static void
+gst_barco_latency_mark_free (gpointer data)
+{
+  GstBarcoLatencyMark *mark = data;
+
+  if (mark->pending)
+    g_array_unref (mark->pending);
+  g_slice_free (GstBarcoLatencyMark, mark);
+}
+
+/**
+ * gst_barco_latency_mark_pad:
+ * @pad: a pad the RTP packets are pushed on
+ * @bin: the rtpsrc or rtpsink @pad belongs to
+ * @stage: the stage the pushes on @pad time
+ *
+ * Mark @pad for the barcortplatency tracer. This costs nothing when the
+ * tracer is not loaded. A pad can be the point of more than one stage.
+ */
+void
+gst_barco_latency_mark_pad (GstPad * pad, GstElement * bin,
+    GstBarcoLatencyStage stage)
+{
+  GstBarcoLatencyMark *mark;
+
+  mark = g_object_get_qdata (G_OBJECT (pad), gst_barco_latency_mark_quark ());
+  if (mark == NULL) {
+    mark = g_slice_new0 (GstBarcoLatencyMark);
+    mark->bin = bin;
+    mark->stages = 1 << stage;
+    if (stage == GST_BARCO_LATENCY_SEND)
+      mark->pending = g_array_new (FALSE, FALSE, sizeof (guint64));
+    g_object_set_qdata_full (G_OBJECT (pad), gst_barco_latency_mark_quark (),
+        mark, gst_barco_latency_mark_free);
+  } else {
+    if (stage == GST_BARCO_LATENCY_SEND && mark->pending == NULL)
+      mark->pending = g_array_new (FALSE, FALSE, sizeof (guint64));
+    mark->stages |= 1 << stage;
+  }
+}
+
+static guint
+gst_rtp_latency_bucket (guint64 value)
+{
+  guint shift;
+
+  value = MIN (value, (G_GUINT64_CONSTANT (1) << GST_RTP_LATENCY_MAX_BITS) - 1);
+  if (value < 32)
+    return value;
+
+  /* keep the 5 highest bits, the top one is implied by the shift */
+  shift = g_bit_storage (value) - 5;
+  return ((shift + 1) << 4) + (value >> shift) - 16;
+}
+
+/* Returns: the highest value of @bucket */
+static guint64
+gst_rtp_latency_bucket_value (guint bucket)
+{
+  guint shift;
+
+  if (bucket < 32)
+    return bucket;
+
+  shift = (bucket >> 4) - 1;
+  return (((guint64) (bucket & 15) + 17) << shift) - 1;
+}
+
+static void
+gst_rtp_latency_histogram_add (GstRtpLatencyHistogram * hist, guint64 value)
+{
+  hist->buckets[gst_rtp_latency_bucket (value)]++;
+  hist->count++;
+  if (value > hist->max)
+    hist->max = value;
+}
+
+/**
+ * gst_rtp_latency_histogram_percentiles:
+ * @hist: a histogram with values
+ * @q: the percentiles to find, in increasing order between 0 and 1
+ * @values: (out): the highest value of the bucket of each percentile
+ * @n: the number of percentiles
+ */
+static void
+gst_rtp_latency_histogram_percentiles (GstRtpLatencyHistogram * hist,
+    const gdouble * q, guint64 * values, guint n)
+{
+  guint64 seen = 0;
+  guint i, j = 0;
+
+  for (i = 0; i < GST_RTP_LATENCY_BUCKETS && j < n; i++) {
+    seen += hist->buckets[i];
+    while (j < n && seen > 0 && seen >= q[j] * hist->count)
+      values[j++] = MIN (gst_rtp_latency_bucket_value (i), hist->max);
+  }
+  for (; j < n; j++)
+    values[j] = hist->max;
+}
+
+static void
+gst_rtp_latency_flow_log (GstRtpLatencyFlow * flow)
+{
+  static const gdouble q[] = { 0.5, 0.9, 0.99, 0.999 };
+  guint64 values[G_N_ELEMENTS (q)];
+  GstRtpLatencyHistogram *hist;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (flow->hist); i++) {
+    hist = &flow->hist[i];
+    if (hist->count == 0)
+      continue;
+
+    gst_rtp_latency_histogram_percentiles (hist, q, values, G_N_ELEMENTS (q));
+    gst_tracer_record_log (tr_latency, flow->name, stage_names[i],
+        hist->count, values[0], values[1], values[2], values[3], hist->max);
+  }
+}
+
+static void
+gst_rtp_latency_flow_reset (GstRtpLatencyFlow * flow)
+{
+  flow->last_key = 0;
+  memset (flow->entries, 0, sizeof (flow->entries));
+  memset (flow->hist, 0, sizeof (flow->hist));
+}
+
+static void
+gst_rtp_latency_flow_free (gpointer data)
+{
+  GstRtpLatencyFlow *flow = data;
+
+  gst_rtp_latency_flow_log (flow);
+  g_free (flow->name);
+  g_free (flow);
+}
+
+/**
+ * gst_rtp_latency_flow_get:
+ * @mark: the mark of a pad
+ *
+ * Returns: the flow of the bin of @mark, kept as its qdata
+ */
+static GstRtpLatencyFlow *
+gst_rtp_latency_flow_get (GstBarcoLatencyMark * mark)
+{
+  GObject *bin = G_OBJECT (mark->bin);
+  GstRtpLatencyFlow *flow;
+
+  flow = g_object_get_qdata (bin, flow_quark);
+  if (G_LIKELY (flow))
+    return flow;
+
+  g_mutex_lock (&flows_lock);
+  flow = g_object_get_qdata (bin, flow_quark);
+  if (flow == NULL) {
+    flow = g_new0 (GstRtpLatencyFlow, 1);
+    flow->name = gst_object_get_name (GST_OBJECT (bin));
+    g_object_set_qdata_full (bin, flow_quark, flow,
+        gst_rtp_latency_flow_free);
+    GST_DEBUG ("Timing the packets of %s", flow->name);
+  }
+  g_mutex_unlock (&flows_lock);
+
+  return flow;
+}
+
+/**
+ * gst_rtp_latency_flow_record:
+ * @flow: the flow of the bin
+ * @stage: the stage the packet passed
+ * @key: the packet
+ * @ts: the time it passed
+ *
+ * The first stage of rtpsrc or rtpsink starts timing the packet, the
+ * next ones add the time since the last stage it passed to their
+ * histogram.
+ */
+static void
+gst_rtp_latency_flow_record (GstRtpLatencyFlow * flow,
+    GstBarcoLatencyStage stage, guint64 key, GstClockTime ts)
+{
+  GstBarcoLatencyStage first, last, prev;
+  GstRtpLatencyEntry *entry;
+  guint i;
+
+  if (stage < GST_BARCO_LATENCY_ENTRY) {
+    first = GST_BARCO_LATENCY_RECEIVE;
+    last = GST_BARCO_LATENCY_PUSH;
+  } else {
+    first = GST_BARCO_LATENCY_ENTRY;
+    last = GST_BARCO_LATENCY_SEND;
+  }
+
+  entry = &flow->entries[(key ^ (key >> 16)) & (GST_RTP_LATENCY_ENTRIES - 1)];
+  if (!g_atomic_int_compare_and_exchange (&entry->busy, 0, 1))
+    return;
+
+  if (stage == first) {
+    /* the second copy of a packet over a redundant path */
+    if (entry->key == key && ts - entry->time[first] < GST_SECOND)
+      goto done;
+
+    entry->key = key;
+    for (i = 0; i < G_N_ELEMENTS (entry->time); i++)
+      entry->time[i] = GST_CLOCK_TIME_NONE;
+    entry->time[first] = ts;
+    flow->last_key = key;
+    goto done;
+  }
+
+  if (entry->key != key || GST_CLOCK_TIME_IS_VALID (entry->time[stage]))
+    goto done;
+
+  /* stages without an element in this bin are skipped */
+  for (prev = stage - 1; prev > first; prev--)
+    if (GST_CLOCK_TIME_IS_VALID (entry->time[prev]))
+      break;
+  if (!GST_CLOCK_TIME_IS_VALID (entry->time[prev]) || ts < entry->time[prev])
+    goto done;
+
+  entry->time[stage] = ts;
+  gst_rtp_latency_histogram_add (&flow->hist[stage], ts - entry->time[prev]);
+  if (stage == last)
+    gst_rtp_latency_histogram_add (&flow->hist[GST_RTP_LATENCY_TOTAL],
+        ts - entry->time[first]);
+  flow->last_key = key;
+
+done:
+  g_atomic_int_set (&entry->busy, 0);
+}
+
+/**
+ * gst_rtp_latency_tracer_buffer:
+ * @mark: the mark of the pad @buffer is pushed on
+ * @ts: the time of the push
+ * @buffer: the pushed buffer
+ *
+ * Buffers that are no RTP packets, the TS packets out of barcortpmp2t,
+ * are timed as the last RTP packet of the bin.
+ */
+static void
+gst_rtp_latency_tracer_buffer (GstBarcoLatencyMark * mark, GstClockTime ts,
+    GstBuffer * buffer)
+{
+  GstRtpLatencyFlow *flow = gst_rtp_latency_flow_get (mark);
+  GstReferenceTimestampMeta *meta;
+  guint8 header[12];
+  guint64 key, now;
+  guint stage;
+
+  if (gst_buffer_extract (buffer, 0, header, sizeof (header)) ==
+      sizeof (header) && (header[0] >> 6) == 2) {
+    key = G_GUINT64_CONSTANT (1) << 48 |
+        (guint64) GST_READ_UINT32_BE (header + 8) << 16 |
+        GST_READ_UINT16_BE (header + 2);
+  } else if (mark->stages & (1 << GST_BARCO_LATENCY_RECEIVE |
+          1 << GST_BARCO_LATENCY_ENTRY) || flow->last_key == 0) {
+    return;
+  } else {
+    key = flow->last_key;
+  }
+
+  for (stage = 0; stage < GST_BARCO_LATENCY_N_STAGES; stage++) {
+    if (stage == GST_BARCO_LATENCY_SEND || !(mark->stages & (1 << stage)))
+      continue;
+    gst_rtp_latency_flow_record (flow, stage, key, ts);
+  }
+
+  /* the socket is only done with the packet when the push returns, the
+   * packets of a push from another thread at the same time are not sent
+   * timed */
+  if (mark->stages & (1 << GST_BARCO_LATENCY_SEND) &&
+      (g_atomic_pointer_get (&mark->pending_owner) == g_thread_self () ||
+          g_atomic_pointer_compare_and_exchange (&mark->pending_owner, NULL,
+              g_thread_self ())))
+    g_array_append_val (mark->pending, key);
+
+  /* with kernel-timestamps, the receive stage is the time from the
+   * kernel to the receiver pushing the packet */
+  if (mark->stages & (1 << GST_BARCO_LATENCY_RECEIVE) &&
+      (meta = gst_buffer_get_reference_timestamp_meta (buffer, NULL))) {
+    now = g_get_real_time () * 1000;
+    if (now > meta->timestamp)
+      gst_rtp_latency_histogram_add (&flow->hist[GST_BARCO_LATENCY_RECEIVE],
+          now - meta->timestamp);
+  }
+}
+
+static void
+do_push_buffer_pre (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  GstBarcoLatencyMark *mark =
+      g_object_get_qdata (G_OBJECT (pad), gst_barco_latency_mark_quark ());
+
+  if (G_LIKELY (mark == NULL))
+    return;
+
+  gst_rtp_latency_tracer_buffer (mark, ts, buffer);
+}
+
+static void
+do_push_buffer_list_pre (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  GstBarcoLatencyMark *mark =
+      g_object_get_qdata (G_OBJECT (pad), gst_barco_latency_mark_quark ());
+  guint i, n;
+
+  if (G_LIKELY (mark == NULL))
+    return;
+
+  n = gst_buffer_list_length (list);
+  for (i = 0; i < n; i++)
+    gst_rtp_latency_tracer_buffer (mark, ts, gst_buffer_list_get (list, i));
+}
+
+static void
+do_push_buffer_post (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  GstBarcoLatencyMark *mark =
+      g_object_get_qdata (G_OBJECT (pad), gst_barco_latency_mark_quark ());
+  GstRtpLatencyFlow *flow;
+  guint i;
+
+  if (G_LIKELY (mark == NULL || mark->pending == NULL ||
+          g_atomic_pointer_get (&mark->pending_owner) != g_thread_self ()))
+    return;
+
+  flow = gst_rtp_latency_flow_get (mark);
+  if (res == GST_FLOW_OK)
+    for (i = 0; i < mark->pending->len; i++)
+      gst_rtp_latency_flow_record (flow, GST_BARCO_LATENCY_SEND,
+          g_array_index (mark->pending, guint64, i), ts);
+  g_array_set_size (mark->pending, 0);
+  g_atomic_pointer_set (&mark->pending_owner, NULL);
+}
+
+static void
+do_element_change_state_post (GstTracer * self, GstClockTime ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  GstRtpLatencyFlow *flow;
+
+  if (transition != GST_STATE_CHANGE_PAUSED_TO_READY)
+    return;
+
+  flow = g_object_get_qdata (G_OBJECT (element), flow_quark);
+  if (flow == NULL)
+    return;
+
+  gst_rtp_latency_flow_log (flow);
+  gst_rtp_latency_flow_reset (flow);
+}
+
+static GstStructure *
+gst_rtp_latency_tracer_value (GType type, GstTracerValueScope scope,
+    const gchar * description)
+{
+  return gst_structure_new ("value",
+      "type", G_TYPE_GTYPE, type,
+      "related-to", GST_TYPE_TRACER_VALUE_SCOPE, scope,
+      "description", G_TYPE_STRING, description, NULL);
+}
+
+static void
+gst_rtp_latency_tracer_class_init (GstRtpLatencyTracerClass * klass)
+{
+  tr_latency = gst_tracer_record_new ("barcortp-latency.class",
+      "element", gst_rtp_latency_tracer_value (G_TYPE_STRING,
+          GST_TRACER_VALUE_SCOPE_ELEMENT, "the rtpsrc or rtpsink"),
+      "stage", gst_rtp_latency_tracer_value (G_TYPE_STRING,
+          GST_TRACER_VALUE_SCOPE_PROCESS,
+          "the stage timed since the previous one"),
+      "count", gst_rtp_latency_tracer_value (G_TYPE_UINT64,
+          GST_TRACER_VALUE_SCOPE_PROCESS, "packets timed"),
+      "p50", gst_rtp_latency_tracer_value (G_TYPE_UINT64,
+          GST_TRACER_VALUE_SCOPE_PROCESS, "median latency in ns"),
+      "p90", gst_rtp_latency_tracer_value (G_TYPE_UINT64,
+          GST_TRACER_VALUE_SCOPE_PROCESS, "90th percentile in ns"),
+      "p99", gst_rtp_latency_tracer_value (G_TYPE_UINT64,
+          GST_TRACER_VALUE_SCOPE_PROCESS, "99th percentile in ns"),
+      "p999", gst_rtp_latency_tracer_value (G_TYPE_UINT64,
+          GST_TRACER_VALUE_SCOPE_PROCESS, "99.9th percentile in ns"),
+      "max", gst_rtp_latency_tracer_value (G_TYPE_UINT64,
+          GST_TRACER_VALUE_SCOPE_PROCESS, "maximum latency in ns"), NULL);
+  GST_OBJECT_FLAG_SET (tr_latency, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+
+  flow_quark = g_quark_from_static_string ("barcortp-latency-flow");
+}
+
+static void
+gst_rtp_latency_tracer_init (GstRtpLatencyTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
+
+gboolean
+rtp_latency_tracer_init (GstPlugin * plugin)
+{
+  return gst_tracer_register (plugin, "barcortplatency",
+      GST_TYPE_RTP_LATENCY_TRACER);
+}
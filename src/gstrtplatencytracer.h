@@ -0,0 +1,53 @@
+#ifndef _GST_RTP_LATENCY_TRACER_H_
+#define _GST_RTP_LATENCY_TRACER_H_
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_LATENCY_TRACER (gst_rtp_latency_tracer_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpLatencyTracer, gst_rtp_latency_tracer, GST,
+    RTP_LATENCY_TRACER, GstTracer);
+
+/**
+ * GstBarcoLatencyStage:
+ *
+ * The points of the hot path of rtpsrc and rtpsink the barcortplatency
+ * tracer times the RTP packets on.
+ */
+typedef enum
+{
+  GST_BARCO_LATENCY_RECEIVE,    /* pushed by the socket receiver */
+  GST_BARCO_LATENCY_QUEUE,      /* out of the queue in front of rtpbin */
+  GST_BARCO_LATENCY_JITTERBUFFER,       /* out of rtpbin */
+  GST_BARCO_LATENCY_PUSH,       /* pushed on the src pad of rtpsrc */
+  GST_BARCO_LATENCY_ENTRY,      /* into the sink pad of rtpsink */
+  GST_BARCO_LATENCY_RTPBIN,     /* out of rtpbin */
+  GST_BARCO_LATENCY_SEND,       /* handed to the socket */
+  GST_BARCO_LATENCY_N_STAGES
+} GstBarcoLatencyStage;
+
+/**
+ * GstBarcoLatencyMark:
+ *
+ * The stages a pad is a point of, the bin it belongs to, and the packets
+ * of the push in progress for the stages timed when the push returns,
+ * with the thread pushing them.
+ */
+typedef struct
+{
+  GstElement *bin;
+  guint stages;
+  GArray *pending;
+  gpointer pending_owner;
+} GstBarcoLatencyMark;
+
+GQuark gst_barco_latency_mark_quark (void);
+void gst_barco_latency_mark_pad (GstPad * pad, GstElement * bin,
+    GstBarcoLatencyStage stage);
+
+gboolean rtp_latency_tracer_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_LATENCY_TRACER_H_ */
@@ -0,0 +1,137 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpmdi
+ *
+ * \brief RFC 4445 Media Delivery Index of a received RTP stream
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gstrtpmdi.h"
+
+/**
+ * gst_barco_mdi_init:
+ * @mdi: a #GstBarcoMdi
+ * @clock_rate: RTP clock rate of the stream, for the jitter
+ */
+void
+gst_barco_mdi_init (GstBarcoMdi * mdi, guint clock_rate)
+{
+  memset (mdi, 0, sizeof (*mdi));
+  mdi->clock_rate = clock_rate;
+  mdi->start = GST_CLOCK_TIME_NONE;
+}
+
+/**
+ * gst_barco_mdi_add:
+ * @mdi: a #GstBarcoMdi
+ * @data: an RTP packet
+ * @size: the size of @data
+ * @arrival: arrival time of the packet
+ *
+ * Account one packet: sequence gaps, interarrival jitter and the level of
+ * the virtual buffer before and after it arrived. Reordered and duplicate
+ * packets are not counted as lost.
+ */
+void
+gst_barco_mdi_add (GstBarcoMdi * mdi, const guint8 * data, gsize size,
+    GstClockTime arrival)
+{
+  guint16 seq, gap;
+  guint32 transit;
+  gint32 d;
+  gdouble vb;
+
+  if (size < 12 || (data[0] & 0xc0) != 0x80)
+    return;
+
+  if (!GST_CLOCK_TIME_IS_VALID (mdi->start))
+    mdi->start = arrival;
+
+  seq = GST_READ_UINT16_BE (data + 2);
+  gap = seq - mdi->seq - 1;
+  if (!mdi->have_seq || gap < 0x8000) {
+    if (mdi->have_seq && gap) {
+      mdi->lost += gap;
+      mdi->gaps++;
+    }
+    mdi->seq = seq;
+    mdi->have_seq = TRUE;
+  }
+
+  /* RFC 3550 A.8, in RTP clock units */
+  transit = (guint32) gst_util_uint64_scale_int (arrival, mdi->clock_rate,
+      GST_SECOND) - GST_READ_UINT32_BE (data + 4);
+  if (mdi->have_transit) {
+    d = transit - mdi->transit;
+    mdi->jitter += (ABS (d) - mdi->jitter) / 16.0;
+  }
+  mdi->transit = transit;
+  mdi->have_transit = TRUE;
+
+  /* RFC 4445 DF: the virtual buffer fills with every packet and drains
+   * at the media rate */
+  vb = mdi->bytes - mdi->rate * (arrival - mdi->start);
+  mdi->vb_min = MIN (mdi->vb_min, vb);
+  mdi->vb_max = MAX (mdi->vb_max, vb + size);
+  mdi->bytes += size;
+  mdi->packets++;
+}
+
+/**
+ * gst_barco_mdi_take:
+ * @mdi: a #GstBarcoMdi
+ * @now: end of the interval, on the clock of the arrival times
+ *
+ * Close the current interval and start the next one. The media rate of
+ * the Delay Factor is the rate of the previous interval, so the first
+ * interval reports no Delay Factor.
+ *
+ * Returns: (transfer full): a GstRtpSrcMdi structure with the
+ * delay-factor and jitter in ms, the media-loss-rate in packets per
+ * second, the bitrate and the packets, lost packets and gaps of the
+ * interval
+ */
+GstStructure *
+gst_barco_mdi_take (GstBarcoMdi * mdi, GstClockTime now)
+{
+  GstStructure *s;
+  GstClockTime duration = 0;
+  gdouble df = 0.0, mlr = 0.0;
+
+  if (GST_CLOCK_TIME_IS_VALID (mdi->start) && now > mdi->start)
+    duration = now - mdi->start;
+
+  if (mdi->rate > 0.0)
+    df = (mdi->vb_max - mdi->vb_min) / mdi->rate / GST_MSECOND;
+  if (duration)
+    mlr = (gdouble) mdi->lost * GST_SECOND / duration;
+
+  s = gst_structure_new ("GstRtpSrcMdi",
+      "delay-factor", G_TYPE_DOUBLE, df,
+      "media-loss-rate", G_TYPE_DOUBLE, mlr,
+      "jitter", G_TYPE_DOUBLE,
+      mdi->clock_rate ? mdi->jitter * 1000.0 / mdi->clock_rate : 0.0,
+      "bitrate", G_TYPE_UINT64,
+      duration ? gst_util_uint64_scale (mdi->bytes * 8, GST_SECOND,
+          duration) : G_GUINT64_CONSTANT (0),
+      "packets", G_TYPE_UINT64, mdi->packets,
+      "lost", G_TYPE_UINT64, mdi->lost,
+      "gaps", G_TYPE_UINT, mdi->gaps, NULL);
+
+  mdi->rate = duration ? (gdouble) mdi->bytes / duration : 0.0;
+  mdi->start = GST_CLOCK_TIME_IS_VALID (mdi->start) ? now :
+      GST_CLOCK_TIME_NONE;
+  mdi->bytes = 0;
+  mdi->packets = 0;
+  mdi->lost = 0;
+  mdi->gaps = 0;
+  mdi->vb_min = 0.0;
+  mdi->vb_max = 0.0;
+
+  return s;
+}
@@ -0,0 +1,50 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpmdi
+ *
+ * \brief RFC 4445 Media Delivery Index of a received RTP stream
+ *
+ */
+
+#ifndef _GST_RTP_MDI_H_
+#define _GST_RTP_MDI_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstBarcoMdi:
+ *
+ * RFC 4445 Media Delivery Index of an RTP stream over an interval, with
+ * the RFC 3550 interarrival jitter. Not thread safe, callers lock.
+ */
+typedef struct
+{
+  guint clock_rate;
+
+  /* current interval */
+  GstClockTime start;
+  guint64 bytes;
+  guint64 packets;
+  guint64 lost;
+  guint gaps;
+  gdouble vb_min;
+  gdouble vb_max;
+  /* drain rate of the virtual buffer in bytes per ns, measured over the
+   * previous interval */
+  gdouble rate;
+
+  gboolean have_seq;
+  guint16 seq;
+  gboolean have_transit;
+  guint32 transit;
+  gdouble jitter;
+} GstBarcoMdi;
+
+void gst_barco_mdi_init (GstBarcoMdi * mdi, guint clock_rate);
+void gst_barco_mdi_add (GstBarcoMdi * mdi, const guint8 * data, gsize size,
+    GstClockTime arrival);
+GstStructure *gst_barco_mdi_take (GstBarcoMdi * mdi, GstClockTime now);
+
+G_END_DECLS
+#endif /* _GST_RTP_MDI_H_ */
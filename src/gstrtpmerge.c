@@ -0,0 +1,671 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * SMPTE 2022-7 seamless protection switching used by rtpsrc.
+ *
+ * The same RTP stream is received on sink_0 and sink_1 over two paths and
+ * merged into one stream ordered by seqnum. Every seqnum is forwarded
+ * once, whichever path delivers it first. A packet that is missing on
+ * both paths holds back the packets after it for at most max-skew, so a
+ * dead path adds no latency: the other one still delivers in order. A
+ * timer on the system clock ends the wait when nothing arrives anymore.
+ *
+ * The first stream-start, caps and segment of either path are forwarded.
+ * Later ones are forwarded when they differ from the last forwarded one,
+ * so the other path repeating a change does not send it twice.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gstrtpmerge.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_merge_debug);
+#define GST_CAT_DEFAULT rtp_merge_debug
+
+/* Seqnums tracked for reordering and duplicate detection */
+#define GST_RTP_MERGE_WINDOW          (4096)
+
+typedef enum
+{
+  GST_RTP_MERGE_SLOT_EMPTY,
+  GST_RTP_MERGE_SLOT_HELD,      /* waiting for an earlier seqnum */
+  GST_RTP_MERGE_SLOT_DONE       /* forwarded */
+} GstRtpMergeSlotState;
+
+typedef struct
+{
+  GstBuffer *buffer;
+  guint16 seq;
+  GstRtpMergeSlotState state;
+} GstRtpMergeSlot;
+
+/* the sticky events of the paths */
+typedef enum
+{
+  GST_RTP_MERGE_STICKY_STREAM_START,
+  GST_RTP_MERGE_STICKY_CAPS,
+  GST_RTP_MERGE_STICKY_SEGMENT,
+  GST_RTP_MERGE_STICKY_N
+} GstRtpMergeSticky;
+
+struct _GstRtpMerge
+{
+  GstElement parent_instance;
+
+  GstPad *sinkpad[2];
+  GstPad *srcpad;
+
+  /* serializes both paths and the timer, also held while pushing */
+  GMutex lock;
+
+  guint max_skew;
+  gboolean started;
+  guint16 next_seq;
+  guint held;
+  gint64 gap_since;
+  GstRtpMergeSlot slots[GST_RTP_MERGE_WINDOW];
+  /* fires max-skew after gap_since */
+  GstClockID timer;
+  gint64 timer_deadline;
+
+  /* the last forwarded sticky events, and which path sent one already */
+  GstEvent *sticky[GST_RTP_MERGE_STICKY_N];
+  gboolean seen[2][GST_RTP_MERGE_STICKY_N];
+  gboolean eos[2];
+
+  /* protected by the object lock */
+  guint64 duplicates;
+  guint64 lost;
+};
+
+enum
+{
+  PROP_0,
+  PROP_DUPLICATES,
+  PROP_LOST,
+  PROP_MAX_SKEW,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_MAX_SKEW         (50)
+
+static GstStaticPadTemplate sink_0_template =
+GST_STATIC_PAD_TEMPLATE ("sink_0",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate sink_1_template =
+GST_STATIC_PAD_TEMPLATE ("sink_1",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+#define gst_rtp_merge_parent_class parent_class
+G_DEFINE_TYPE (GstRtpMerge, gst_rtp_merge, GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_merge_cancel_timer (GstRtpMerge * self)
+{
+  if (self->timer) {
+    gst_clock_id_unschedule (self->timer);
+    gst_clock_id_unref (self->timer);
+    self->timer = NULL;
+  }
+}
+
+static void
+gst_rtp_merge_reset (GstRtpMerge * self)
+{
+  guint i;
+
+  for (i = 0; i < GST_RTP_MERGE_WINDOW; i++) {
+    gst_buffer_replace (&self->slots[i].buffer, NULL);
+    self->slots[i].state = GST_RTP_MERGE_SLOT_EMPTY;
+  }
+
+  self->started = FALSE;
+  self->held = 0;
+  self->gap_since = -1;
+  gst_rtp_merge_cancel_timer (self);
+}
+
+/**
+ * gst_rtp_merge_drain:
+ * @self: The current #GstRtpMerge object
+ * @ret: (inout): flow return of the pushes so far
+ *
+ * Push the held packets that are in order now.
+ *
+ * Returns: TRUE if next_seq moved
+ */
+static gboolean
+gst_rtp_merge_drain (GstRtpMerge * self, GstFlowReturn * ret)
+{
+  gboolean advanced = FALSE;
+
+  while (self->held > 0) {
+    GstRtpMergeSlot *slot = &self->slots[self->next_seq % GST_RTP_MERGE_WINDOW];
+    GstBuffer *buffer;
+
+    if (slot->state != GST_RTP_MERGE_SLOT_HELD || slot->seq != self->next_seq)
+      break;
+
+    buffer = slot->buffer;
+    slot->buffer = NULL;
+    slot->state = GST_RTP_MERGE_SLOT_DONE;
+    self->held--;
+    self->next_seq++;
+    advanced = TRUE;
+
+    if (*ret == GST_FLOW_OK)
+      *ret = gst_pad_push (self->srcpad, buffer);
+    else
+      gst_buffer_unref (buffer);
+  }
+
+  return advanced;
+}
+
+/**
+ * gst_rtp_merge_skip:
+ * @self: The current #GstRtpMerge object
+ *
+ * The packet at next_seq did not arrive on either path within max-skew,
+ * give up on it and on every other missing one up to the next held packet.
+ */
+static void
+gst_rtp_merge_skip (GstRtpMerge * self)
+{
+  guint64 lost = 0;
+
+  while (lost < GST_RTP_MERGE_WINDOW) {
+    GstRtpMergeSlot *slot = &self->slots[self->next_seq % GST_RTP_MERGE_WINDOW];
+
+    if (slot->state == GST_RTP_MERGE_SLOT_HELD && slot->seq == self->next_seq)
+      break;
+    self->next_seq++;
+    lost++;
+  }
+
+  GST_LOG_OBJECT (self, "Skipped %" G_GUINT64_FORMAT " packets", lost);
+
+  GST_OBJECT_LOCK (self);
+  self->lost += lost;
+  GST_OBJECT_UNLOCK (self);
+}
+
+/**
+ * gst_rtp_merge_expire:
+ * @self: The current #GstRtpMerge object
+ * @now: the monotonic time
+ * @ret: (inout): flow return of the pushes so far
+ *
+ * Give up on the packets that are missing on both paths for max-skew.
+ */
+static void
+gst_rtp_merge_expire (GstRtpMerge * self, gint64 now, GstFlowReturn * ret)
+{
+  while (self->held > 0 && now - self->gap_since >=
+      (gint64) self->max_skew * G_TIME_SPAN_MILLISECOND) {
+    gst_rtp_merge_skip (self);
+    gst_rtp_merge_drain (self, ret);
+    self->gap_since = self->held > 0 ? now : -1;
+  }
+}
+
+static gboolean gst_rtp_merge_timeout (GstClock * clock, GstClockTime time,
+    GstClockID id, gpointer user_data);
+
+/**
+ * gst_rtp_merge_update_timer:
+ * @self: The current #GstRtpMerge object
+ * @now: the monotonic time
+ *
+ * Wake up when the current gap reaches max-skew, also when no packet
+ * arrives on either path anymore.
+ */
+static void
+gst_rtp_merge_update_timer (GstRtpMerge * self, gint64 now)
+{
+  GstClock *clock;
+  gint64 deadline;
+
+  if (self->held == 0) {
+    gst_rtp_merge_cancel_timer (self);
+    return;
+  }
+
+  deadline = self->gap_since +
+      (gint64) self->max_skew * G_TIME_SPAN_MILLISECOND;
+  if (self->timer && self->timer_deadline == deadline)
+    return;
+
+  gst_rtp_merge_cancel_timer (self);
+  clock = gst_system_clock_obtain ();
+  self->timer = gst_clock_new_single_shot_id (clock,
+      gst_clock_get_time (clock) + (MAX (deadline, now) - now) * GST_USECOND);
+  self->timer_deadline = deadline;
+  gst_clock_id_wait_async (self->timer, gst_rtp_merge_timeout,
+      gst_object_ref (self), gst_object_unref);
+  gst_object_unref (clock);
+}
+
+/**
+ * gst_rtp_merge_timeout:
+ *
+ * Push the packets held back by a gap that reached max-skew, from the
+ * thread of the system clock.
+ */
+static gboolean
+gst_rtp_merge_timeout (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (user_data);
+  GstFlowReturn ret = GST_FLOW_OK;
+  gint64 now = g_get_monotonic_time ();
+
+  g_mutex_lock (&self->lock);
+  /* a packet closed the gap or moved the deadline meanwhile */
+  if (id == self->timer) {
+    gst_clock_id_unref (self->timer);
+    self->timer = NULL;
+    gst_rtp_merge_expire (self, now, &ret);
+    gst_rtp_merge_update_timer (self, now);
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (ret != GST_FLOW_OK)
+    GST_DEBUG_OBJECT (self, "Push after timeout returned %s",
+        gst_flow_get_name (ret));
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_rtp_merge_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (parent);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstRtpMergeSlot *slot;
+  GstMapInfo map;
+  gint64 now;
+  guint16 seq;
+  gint diff;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return gst_pad_push (self->srcpad, buffer);
+  if (G_UNLIKELY (map.size < 12)) {
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+  seq = GST_READ_UINT16_BE (map.data + 2);
+  gst_buffer_unmap (buffer, &map);
+
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&self->lock);
+
+  if (G_UNLIKELY (!self->started)) {
+    self->next_seq = seq;
+    self->started = TRUE;
+  }
+
+  diff = (gint16) (seq - self->next_seq);
+  if (G_UNLIKELY (ABS (diff) >= GST_RTP_MERGE_WINDOW)) {
+    GST_DEBUG_OBJECT (self, "Seqnum jump %u -> %u, resynchronising",
+        self->next_seq, seq);
+    while (self->held > 0) {
+      gst_rtp_merge_skip (self);
+      gst_rtp_merge_drain (self, &ret);
+    }
+    gst_rtp_merge_reset (self);
+    self->next_seq = seq;
+    self->started = TRUE;
+    diff = 0;
+  }
+
+  slot = &self->slots[seq % GST_RTP_MERGE_WINDOW];
+  if (slot->state != GST_RTP_MERGE_SLOT_EMPTY && slot->seq == seq) {
+    /* the other path was first */
+    gst_buffer_unref (buffer);
+    GST_OBJECT_LOCK (self);
+    self->duplicates++;
+    GST_OBJECT_UNLOCK (self);
+    goto done;
+  }
+
+  slot->seq = seq;
+  if (diff < 0) {
+    /* already skipped, let the jitterbuffer decide if it is still useful */
+    slot->state = GST_RTP_MERGE_SLOT_DONE;
+    ret = gst_pad_push (self->srcpad, buffer);
+    goto done;
+  }
+
+  gst_buffer_replace (&slot->buffer, NULL);
+  slot->buffer = buffer;
+  slot->state = GST_RTP_MERGE_SLOT_HELD;
+  self->held++;
+
+  if (gst_rtp_merge_drain (self, &ret) || self->gap_since < 0)
+    self->gap_since = self->held > 0 ? now : -1;
+
+  gst_rtp_merge_expire (self, now, &ret);
+  gst_rtp_merge_update_timer (self, now);
+
+done:
+  g_mutex_unlock (&self->lock);
+
+  return ret;
+}
+
+/**
+ * gst_rtp_merge_event_equal:
+ * @a: a sticky event
+ * @b: a sticky event of the same type
+ *
+ * Returns: TRUE if forwarding @b after @a changes nothing downstream
+ */
+static gboolean
+gst_rtp_merge_event_equal (GstEvent * a, GstEvent * b)
+{
+  const gchar *id_a, *id_b;
+  GstCaps *caps_a, *caps_b;
+  const GstSegment *seg_a, *seg_b;
+
+  switch (GST_EVENT_TYPE (a)) {
+    case GST_EVENT_STREAM_START:
+      gst_event_parse_stream_start (a, &id_a);
+      gst_event_parse_stream_start (b, &id_b);
+      return g_strcmp0 (id_a, id_b) == 0;
+    case GST_EVENT_CAPS:
+      gst_event_parse_caps (a, &caps_a);
+      gst_event_parse_caps (b, &caps_b);
+      return gst_caps_is_equal (caps_a, caps_b);
+    case GST_EVENT_SEGMENT:
+      gst_event_parse_segment (a, &seg_a);
+      gst_event_parse_segment (b, &seg_b);
+      return gst_segment_is_equal (seg_a, seg_b);
+    default:
+      return FALSE;
+  }
+}
+
+/**
+ * gst_rtp_merge_clear_sticky:
+ * @self: The current #GstRtpMerge object
+ */
+static void
+gst_rtp_merge_clear_sticky (GstRtpMerge * self)
+{
+  guint i;
+
+  for (i = 0; i < GST_RTP_MERGE_STICKY_N; i++) {
+    gst_event_replace (&self->sticky[i], NULL);
+    self->seen[0][i] = self->seen[1][i] = FALSE;
+  }
+}
+
+static gboolean
+gst_rtp_merge_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (parent);
+  gboolean primary = (pad == self->sinkpad[0]);
+  gboolean forward = primary;
+  gint sticky = -1;
+  guint path = primary ? 0 : 1;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_STREAM_START:
+      sticky = GST_RTP_MERGE_STICKY_STREAM_START;
+      break;
+    case GST_EVENT_CAPS:
+      sticky = GST_RTP_MERGE_STICKY_CAPS;
+      break;
+    case GST_EVENT_SEGMENT:
+      sticky = GST_RTP_MERGE_STICKY_SEGMENT;
+      break;
+    case GST_EVENT_EOS:
+      /* the stream only ends when both paths ended */
+      g_mutex_lock (&self->lock);
+      self->eos[primary ? 0 : 1] = TRUE;
+      forward = self->eos[0] && self->eos[1];
+      g_mutex_unlock (&self->lock);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      if (primary) {
+        g_mutex_lock (&self->lock);
+        gst_rtp_merge_reset (self);
+        /* the flush took the segment off the src pad */
+        gst_event_replace (&self->sticky[GST_RTP_MERGE_STICKY_SEGMENT], NULL);
+        g_mutex_unlock (&self->lock);
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (sticky >= 0) {
+    /* the first event of a path only starts that path, a later one is a
+     * change on it */
+    g_mutex_lock (&self->lock);
+    forward = self->sticky[sticky] == NULL || (self->seen[path][sticky] &&
+        !gst_rtp_merge_event_equal (self->sticky[sticky], event));
+    self->seen[path][sticky] = TRUE;
+    if (forward)
+      gst_event_replace (&self->sticky[sticky], event);
+    g_mutex_unlock (&self->lock);
+  }
+
+  if (!forward) {
+    gst_event_unref (event);
+    return TRUE;
+  }
+
+  return gst_pad_push_event (self->srcpad, event);
+}
+
+static GstStateChangeReturn
+gst_rtp_merge_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      g_mutex_lock (&self->lock);
+      gst_rtp_merge_reset (self);
+      gst_rtp_merge_clear_sticky (self);
+      self->eos[0] = self->eos[1] = FALSE;
+      g_mutex_unlock (&self->lock);
+      GST_OBJECT_LOCK (self);
+      self->duplicates = 0;
+      self->lost = 0;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      g_mutex_lock (&self->lock);
+      gst_rtp_merge_reset (self);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_merge_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (object);
+
+  switch (prop_id) {
+    case PROP_MAX_SKEW:
+      g_mutex_lock (&self->lock);
+      self->max_skew = g_value_get_uint (value);
+      g_mutex_unlock (&self->lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_merge_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (object);
+
+  if (prop_id == PROP_MAX_SKEW) {
+    g_mutex_lock (&self->lock);
+    g_value_set_uint (value, self->max_skew);
+    g_mutex_unlock (&self->lock);
+    return;
+  }
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_DUPLICATES:
+      g_value_set_uint64 (value, self->duplicates);
+      break;
+    case PROP_LOST:
+      g_value_set_uint64 (value, self->lost);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_merge_finalize (GObject * gobject)
+{
+  GstRtpMerge *self = GST_RTP_MERGE (gobject);
+
+  gst_rtp_merge_reset (self);
+  gst_rtp_merge_clear_sticky (self);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_merge_class_init (GstRtpMergeClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  oclass->set_property = gst_rtp_merge_set_property;
+  oclass->get_property = gst_rtp_merge_get_property;
+  oclass->finalize = gst_rtp_merge_finalize;
+
+  /**
+   * GstRtpMerge::max-skew
+   *
+   * Longest time in ms a packet missing on both paths holds back the
+   * packets after it (the SMPTE 2022-7 path skew).
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MAX_SKEW,
+      g_param_spec_uint ("max-skew", "Maximum path skew",
+          "Maximum time in ms to wait for a packet missing on both paths",
+          0, G_MAXUINT, DEFAULT_PROP_MAX_SKEW,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpMerge::duplicates
+   *
+   * Number of packets dropped because the other path delivered them first.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_DUPLICATES,
+      g_param_spec_uint64 ("duplicates", "Duplicates",
+          "Number of packets already received on the other path",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpMerge::lost
+   *
+   * Number of packets missing on both paths.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_LOST,
+      g_param_spec_uint64 ("lost", "Lost",
+          "Number of packets missing on both paths",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_0_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_1_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_merge_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpmerge",
+      "Filter/Network/RTP",
+      "Barco SMPTE 2022-7 RTP stream merger",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_merge_debug,
+      "barcortpmerge", 0, "Barco SMPTE 2022-7 merger");
+}
+
+static void
+gst_rtp_merge_init (GstRtpMerge * self)
+{
+  guint i;
+
+  for (i = 0; i < 2; i++) {
+    self->sinkpad[i] = gst_pad_new_from_static_template (i == 0 ?
+        &sink_0_template : &sink_1_template, i == 0 ? "sink_0" : "sink_1");
+    gst_pad_set_chain_function (self->sinkpad[i],
+        GST_DEBUG_FUNCPTR (gst_rtp_merge_chain));
+    gst_pad_set_event_function (self->sinkpad[i],
+        GST_DEBUG_FUNCPTR (gst_rtp_merge_sink_event));
+    GST_PAD_SET_PROXY_CAPS (self->sinkpad[i]);
+    gst_element_add_pad (GST_ELEMENT (self), self->sinkpad[i]);
+  }
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_use_fixed_caps (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->max_skew = DEFAULT_PROP_MAX_SKEW;
+  g_mutex_init (&self->lock);
+  gst_rtp_merge_reset (self);
+}
+
+gboolean
+rtp_merge_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpmerge", GST_RANK_NONE, GST_TYPE_RTP_MERGE);
+}
@@ -0,0 +1,15 @@
+#ifndef _GST_RTP_MERGE_H_
+#define _GST_RTP_MERGE_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_MERGE (gst_rtp_merge_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpMerge, gst_rtp_merge, GST, RTP_MERGE,
+    GstElement);
+
+gboolean rtp_merge_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_MERGE_H_ */
@@ -0,0 +1,557 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * MPEG-TS receive path used by rtpsrc for MP2T (pt 33) streams.
+ *
+ * Takes the place of rtpbin: the TS packets in every RTP packet are pushed
+ * as a list of 188 byte sub-buffers of the received buffer, without
+ * copies. The continuity counters are checked per PID. The packets are
+ * timestamped on the PCR: the clock of the sender is recovered from the
+ * lowest delay between PCR and arrival over the last seconds, so the
+ * output follows the sender clock with a fixed latency instead of the
+ * network jitter.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gstrtpmp2t.h"
+#include "gstrtppacket.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_mp2t_debug);
+#define GST_CAT_DEFAULT rtp_mp2t_debug
+
+#define GST_RTP_MP2T_PACKET_SIZE      (188)
+#define GST_RTP_MP2T_PIDS             (8192)
+#define GST_RTP_MP2T_NULL_PID         (0x1fff)
+#define GST_RTP_MP2T_CC_UNKNOWN       (0xff)
+/* PCR wraps after 2^33 ticks of the 90 kHz base */
+#define GST_RTP_MP2T_PCR_WRAP         (G_GUINT64_CONSTANT (1) << 33)
+/* The lowest PCR delay is taken over two windows of this length */
+#define GST_RTP_MP2T_WINDOW           (2 * GST_SECOND)
+/* A PCR this far from the extrapolated one is a discontinuity */
+#define GST_RTP_MP2T_MAX_PCR_JUMP     (GST_SECOND)
+/* A seqnum further back than this is a restarted sender, not a late
+ * packet */
+#define GST_RTP_MP2T_MAX_MISORDER     (100)
+
+struct _GstRtpMp2t
+{
+  GstElement parent_instance;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* streaming thread only */
+  gboolean have_seq;
+  guint16 next_seq;
+  guint32 ssrc;
+  guint8 cc[GST_RTP_MP2T_PIDS];
+  gint pcr_pid;
+
+  gboolean have_pcr;
+  guint64 last_pcr;             /* 90 kHz base as received */
+  guint64 pcr_wraps;
+  GstClockTime pcr_time;        /* unwrapped last PCR */
+  guint64 pcr_bytes;            /* TS bytes since the last PCR */
+  gdouble ns_per_byte;
+  GstClockTimeDiff delay_min[2];
+  GstClockTime window_start;
+  GstClockTime jitter_max;
+  GstClockTime last_out;
+
+  /* protected by the object lock */
+  guint latency;
+  guint64 cc_errors;
+  GstClockTime pcr_jitter;
+};
+
+enum
+{
+  PROP_0,
+  PROP_CC_ERRORS,
+  PROP_LATENCY,
+  PROP_PCR_JITTER,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_LATENCY          (40)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/mpegts, systemstream = (boolean) true, "
+        "packetsize = (int) 188"));
+
+#define gst_rtp_mp2t_parent_class parent_class
+G_DEFINE_TYPE (GstRtpMp2t, gst_rtp_mp2t, GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_mp2t_reset_clock (GstRtpMp2t * self)
+{
+  self->have_pcr = FALSE;
+  self->pcr_wraps = 0;
+  self->pcr_bytes = 0;
+  self->ns_per_byte = 0.0;
+  self->delay_min[0] = self->delay_min[1] = G_MAXINT64;
+  self->window_start = GST_CLOCK_TIME_NONE;
+  self->jitter_max = 0;
+}
+
+/* a new stream, the output timestamps keep going up */
+static void
+gst_rtp_mp2t_resync (GstRtpMp2t * self)
+{
+  memset (self->cc, GST_RTP_MP2T_CC_UNKNOWN, sizeof (self->cc));
+  self->pcr_pid = -1;
+  gst_rtp_mp2t_reset_clock (self);
+}
+
+static void
+gst_rtp_mp2t_reset (GstRtpMp2t * self)
+{
+  gst_rtp_mp2t_resync (self);
+  self->have_seq = FALSE;
+  self->last_out = 0;
+}
+
+/**
+ * gst_rtp_mp2t_check_cc:
+ * @self: The current #GstRtpMp2t object
+ * @ts: a TS packet
+ *
+ * The continuity counter goes up with every packet with payload of a PID,
+ * a repeated packet keeps it. The discontinuity indicator restarts it.
+ */
+static void
+gst_rtp_mp2t_check_cc (GstRtpMp2t * self, const guint8 * ts)
+{
+  guint pid = GST_READ_UINT16_BE (ts + 1) & 0x1fff;
+  guint8 cc = ts[3] & 0x0f;
+  guint8 last;
+
+  if (pid == GST_RTP_MP2T_NULL_PID)
+    return;
+
+  if ((ts[3] & 0x20) && ts[4] > 0 && (ts[5] & 0x80))
+    self->cc[pid] = GST_RTP_MP2T_CC_UNKNOWN;
+
+  last = self->cc[pid];
+  self->cc[pid] = cc;
+  if (last == GST_RTP_MP2T_CC_UNKNOWN || cc == last)
+    return;
+
+  if (!(ts[3] & 0x10) || cc != ((last + 1) & 0x0f)) {
+    GST_LOG_OBJECT (self, "PID %u continuity %u -> %u", pid, last, cc);
+    GST_OBJECT_LOCK (self);
+    self->cc_errors++;
+    GST_OBJECT_UNLOCK (self);
+  }
+}
+
+/**
+ * gst_rtp_mp2t_pcr:
+ * @self: The current #GstRtpMp2t object
+ * @ts: a TS packet
+ * @pcr: (out): the 90 kHz base of its PCR
+ *
+ * Returns: TRUE if @ts carries the PCR of the stream, the first PID
+ * seen with one.
+ */
+static gboolean
+gst_rtp_mp2t_pcr (GstRtpMp2t * self, const guint8 * ts, guint64 * pcr)
+{
+  gint pid = GST_READ_UINT16_BE (ts + 1) & 0x1fff;
+
+  if (!(ts[3] & 0x20) || ts[4] < 7 || !(ts[5] & 0x10))
+    return FALSE;
+  if (self->pcr_pid < 0) {
+    GST_DEBUG_OBJECT (self, "PCR on PID %d", pid);
+    self->pcr_pid = pid;
+  }
+  if (pid != self->pcr_pid)
+    return FALSE;
+
+  /* the 27 MHz extension is below the resolution of the jitter */
+  *pcr = ((guint64) GST_READ_UINT32_BE (ts + 6) << 1) | (ts[10] >> 7);
+  return TRUE;
+}
+
+/**
+ * gst_rtp_mp2t_update_clock:
+ * @self: The current #GstRtpMp2t object
+ * @pcr: the 90 kHz base of a PCR
+ * @arrival: running time the packet with @pcr arrived
+ *
+ * Track the byte rate between PCRs and the lowest delay of a PCR in the
+ * last two windows, the packets with the least network delay. The rest
+ * of the delays are the PCR jitter.
+ */
+static void
+gst_rtp_mp2t_update_clock (GstRtpMp2t * self, guint64 pcr,
+    GstClockTime arrival)
+{
+  GstClockTime pcr_time;
+  GstClockTimeDiff delay;
+
+  if (self->have_pcr && pcr < self->last_pcr &&
+      self->last_pcr - pcr > GST_RTP_MP2T_PCR_WRAP / 2)
+    self->pcr_wraps++;
+
+  pcr_time = gst_util_uint64_scale_int (pcr +
+      self->pcr_wraps * GST_RTP_MP2T_PCR_WRAP, GST_SECOND, 90000);
+
+  if (self->have_pcr) {
+    GstClockTimeDiff diff = GST_CLOCK_DIFF (self->pcr_time, pcr_time);
+
+    if (diff <= 0 || diff > GST_RTP_MP2T_MAX_PCR_JUMP) {
+      GST_DEBUG_OBJECT (self, "PCR discontinuity of %" GST_STIME_FORMAT,
+          GST_STIME_ARGS (diff));
+      gst_rtp_mp2t_reset_clock (self);
+    } else if (self->pcr_bytes) {
+      self->ns_per_byte = (gdouble) diff / self->pcr_bytes;
+    }
+  }
+
+  self->have_pcr = TRUE;
+  self->last_pcr = pcr;
+  self->pcr_time = pcr_time;
+  self->pcr_bytes = 0;
+
+  if (!GST_CLOCK_TIME_IS_VALID (arrival))
+    return;
+
+  if (!GST_CLOCK_TIME_IS_VALID (self->window_start))
+    self->window_start = pcr_time;
+  if (pcr_time - self->window_start >= GST_RTP_MP2T_WINDOW) {
+    /* the older window goes, so the sender clock drift is followed */
+    self->delay_min[0] = self->delay_min[1];
+    self->delay_min[1] = G_MAXINT64;
+    self->window_start = pcr_time;
+
+    GST_OBJECT_LOCK (self);
+    self->pcr_jitter = self->jitter_max;
+    GST_OBJECT_UNLOCK (self);
+    self->jitter_max = 0;
+  }
+
+  delay = GST_CLOCK_DIFF (pcr_time, arrival);
+  self->delay_min[1] = MIN (self->delay_min[1], delay);
+  self->jitter_max = MAX (self->jitter_max,
+      delay - MIN (self->delay_min[0], self->delay_min[1]));
+}
+
+static GstFlowReturn
+gst_rtp_mp2t_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpMp2t *self = GST_RTP_MP2T (parent);
+  GstClockTime arrival = GST_BUFFER_DTS_OR_PTS (buffer);
+  GstClockTime out;
+  GstClockTimeDiff delay;
+  GstBufferList *list;
+  const guint8 *payload;
+  gsize len, offset, i, n;
+  GstMapInfo map;
+  guint64 pcr;
+  guint32 ssrc;
+  guint16 seq;
+  gint diff;
+  guint latency;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    goto drop;
+  if (!gst_barco_rtp_get_payload (map.data, map.size, &payload, &len))
+    goto drop_unmap;
+
+  /* without a jitterbuffer, late and repeated packets go here */
+  seq = GST_READ_UINT16_BE (map.data + 2);
+  ssrc = GST_READ_UINT32_BE (map.data + 8);
+  diff = (gint16) (seq - self->next_seq);
+  if (self->have_seq && (ssrc != self->ssrc ||
+          diff < -GST_RTP_MP2T_MAX_MISORDER)) {
+    GST_DEBUG_OBJECT (self, "New stream %08x seqnum %u, expected %08x %u",
+        ssrc, seq, self->ssrc, self->next_seq);
+    gst_rtp_mp2t_resync (self);
+  } else if (self->have_seq && diff < 0) {
+    GST_LOG_OBJECT (self, "Late packet %u, expected %u", seq, self->next_seq);
+    goto drop_unmap;
+  }
+  self->next_seq = seq + 1;
+  self->ssrc = ssrc;
+  self->have_seq = TRUE;
+
+  offset = payload - map.data;
+  n = len / GST_RTP_MP2T_PACKET_SIZE;
+
+  GST_OBJECT_LOCK (self);
+  latency = self->latency;
+  GST_OBJECT_UNLOCK (self);
+
+  /* the time of the first TS packet, extrapolated from the last PCR */
+  delay = MIN (self->delay_min[0], self->delay_min[1]);
+  if (self->have_pcr && delay != G_MAXINT64)
+    out = self->pcr_time + (GstClockTime) (self->pcr_bytes *
+        self->ns_per_byte) + delay;
+  else
+    out = arrival;
+
+  for (i = 0; i < n; i++) {
+    const guint8 *ts = payload + i * GST_RTP_MP2T_PACKET_SIZE;
+
+    if (ts[0] != 0x47) {
+      GST_LOG_OBJECT (self, "Lost TS sync");
+      n = i;
+      break;
+    }
+    gst_rtp_mp2t_check_cc (self, ts);
+    if (gst_rtp_mp2t_pcr (self, ts, &pcr))
+      gst_rtp_mp2t_update_clock (self, pcr, arrival);
+    self->pcr_bytes += GST_RTP_MP2T_PACKET_SIZE;
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  if (GST_CLOCK_TIME_IS_VALID (out)) {
+    out += latency * GST_MSECOND;
+    out = MAX (out, self->last_out);
+    self->last_out = out;
+  }
+
+  list = gst_buffer_list_new_sized (n);
+  for (i = 0; i < n; i++) {
+    GstBuffer *packet = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY,
+        offset + i * GST_RTP_MP2T_PACKET_SIZE, GST_RTP_MP2T_PACKET_SIZE);
+
+    GST_BUFFER_PTS (packet) = GST_BUFFER_DTS (packet) = out;
+    gst_buffer_list_add (list, packet);
+  }
+  gst_buffer_unref (buffer);
+
+  if (n == 0) {
+    gst_buffer_list_unref (list);
+    return GST_FLOW_OK;
+  }
+
+  return gst_pad_push_list (self->srcpad, list);
+
+drop_unmap:
+  gst_buffer_unmap (buffer, &map);
+drop:
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_rtp_mp2t_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpMp2t *self = GST_RTP_MP2T (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps = gst_pad_get_pad_template_caps (self->srcpad);
+
+      gst_event_unref (event);
+      event = gst_event_new_caps (caps);
+      gst_caps_unref (caps);
+      break;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      gst_rtp_mp2t_reset (self);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_push_event (self->srcpad, event);
+}
+
+static gboolean
+gst_rtp_mp2t_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstRtpMp2t *self = GST_RTP_MP2T (parent);
+  GstClockTime min, max, latency;
+  gboolean live;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_LATENCY)
+    return gst_pad_query_default (pad, parent, query);
+
+  if (!gst_pad_peer_query (self->sinkpad, query))
+    return FALSE;
+
+  GST_OBJECT_LOCK (self);
+  latency = self->latency * GST_MSECOND;
+  GST_OBJECT_UNLOCK (self);
+
+  gst_query_parse_latency (query, &live, &min, &max);
+  min += latency;
+  if (GST_CLOCK_TIME_IS_VALID (max))
+    max += latency;
+  gst_query_set_latency (query, live, min, max);
+
+  return TRUE;
+}
+
+static GstStateChangeReturn
+gst_rtp_mp2t_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpMp2t *self = GST_RTP_MP2T (element);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      gst_rtp_mp2t_reset (self);
+      GST_OBJECT_LOCK (self);
+      self->cc_errors = 0;
+      self->pcr_jitter = 0;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      break;
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+}
+
+static void
+gst_rtp_mp2t_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpMp2t *self = GST_RTP_MP2T (object);
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (self);
+      self->latency = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      gst_element_post_message (GST_ELEMENT (self),
+          gst_message_new_latency (GST_OBJECT (self)));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_mp2t_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpMp2t *self = GST_RTP_MP2T (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_LATENCY:
+      g_value_set_uint (value, self->latency);
+      break;
+    case PROP_CC_ERRORS:
+      g_value_set_uint64 (value, self->cc_errors);
+      break;
+    case PROP_PCR_JITTER:
+      g_value_set_uint64 (value, self->pcr_jitter);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_mp2t_class_init (GstRtpMp2tClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  oclass->set_property = gst_rtp_mp2t_set_property;
+  oclass->get_property = gst_rtp_mp2t_get_property;
+
+  /**
+   * GstRtpMp2t::latency
+   *
+   * Time in ms the TS packets are delayed behind the recovered sender
+   * clock, it has to cover the network jitter.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_LATENCY,
+      g_param_spec_uint ("latency", "Latency",
+          "Delay in ms behind the PCR of the sender", 0, G_MAXUINT,
+          DEFAULT_PROP_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpMp2t::cc-errors
+   *
+   * Number of continuity counter errors over all PIDs.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_CC_ERRORS,
+      g_param_spec_uint64 ("cc-errors", "CC errors",
+          "Number of continuity counter errors", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpMp2t::pcr-jitter
+   *
+   * Largest delay of a PCR above the lowest one, in ns, over the last
+   * window of 2 s.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_PCR_JITTER,
+      g_param_spec_uint64 ("pcr-jitter", "PCR jitter",
+          "Arrival jitter of the PCR in ns", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpmp2t",
+      "Codec/Depayloader/Network/RTP",
+      "Barco MPEG-TS receiver with PCR de-jittering",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_mp2t_debug,
+      "barcortpmp2t", 0, "Barco MPEG-TS receiver");
+}
+
+static void
+gst_rtp_mp2t_init (GstRtpMp2t * self)
+{
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_sink_event));
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_query_function (self->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_src_query));
+  gst_pad_use_fixed_caps (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->latency = DEFAULT_PROP_LATENCY;
+  gst_rtp_mp2t_reset (self);
+}
+
+gboolean
+rtp_mp2t_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpmp2t", GST_RANK_NONE, GST_TYPE_RTP_MP2T);
+}
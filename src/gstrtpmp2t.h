@@ -0,0 +1,14 @@
+#ifndef _GST_RTP_MP2T_H_
+#define _GST_RTP_MP2T_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_MP2T (gst_rtp_mp2t_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpMp2t, gst_rtp_mp2t, GST, RTP_MP2T, GstElement);
+
+gboolean rtp_mp2t_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_MP2T_H_ */
@@ -0,0 +1,520 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * PCR locked pacing of MP2T (pt 33) streams used by rtpsink.
+ *
+ * A muxer pushes its output in bursts, the PCRs in the stream say when
+ * every byte should leave. The TS packets are held until the next PCR,
+ * then repacketized in RTP packets of 7 TS packets, each timestamped at
+ * the time of its first byte, interpolated between the two PCRs. The sink
+ * syncing on these timestamps sends the stream at the rate of the mux.
+ *
+ * The RTP header of the stream is kept, the sequence numbers are
+ * renumbered and the RTP timestamp is the send time (RFC 2250). Other
+ * streams pass through untouched.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <gst/base/gstadapter.h>
+
+#include "gstrtpmp2tpace.h"
+#include "gstrtppacket.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_mp2t_pace_debug);
+#define GST_CAT_DEFAULT rtp_mp2t_pace_debug
+
+#define GST_RTP_MP2T_PACE_PACKET_SIZE (188)
+#define GST_RTP_MP2T_PACE_PACKETS     (7)
+#define GST_RTP_MP2T_PACE_PAYLOAD_SIZE \
+    (GST_RTP_MP2T_PACE_PACKETS * GST_RTP_MP2T_PACE_PACKET_SIZE)
+#define GST_RTP_MP2T_PACE_PCR_WRAP    (G_GUINT64_CONSTANT (1) << 33)
+/* A PCR this far from the previous one is a discontinuity */
+#define GST_RTP_MP2T_PACE_MAX_PCR_JUMP (GST_SECOND)
+/* Bytes held without a new PCR before sending them anyway */
+#define GST_RTP_MP2T_PACE_MAX_HELD    (2 * 1024 * 1024)
+
+struct _GstRtpMp2tPace
+{
+  GstElement parent_instance;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* streaming thread only */
+  gboolean active;
+  GstAdapter *adapter;
+  guint64 head_pos;             /* TS byte position of the adapter head */
+  guint64 in_pos;               /* TS byte position after the adapter */
+  GstClockTime in_pts;
+
+  gint pcr_pid;
+  gboolean have_pcr;
+  guint64 last_pcr;
+  guint64 pcr_wraps;
+  guint64 pcr_pos;
+  GstClockTime pcr_time;
+  GstClockTimeDiff offset;      /* PCR time to buffer time */
+  gdouble ns_per_byte;
+
+  gboolean have_header;
+  guint8 header[12];
+  guint16 seq;
+  GstClockTime first_pts;
+  GstClockTime last_out;
+
+  /* protected by the object lock */
+  guint latency;
+};
+
+enum
+{
+  PROP_0,
+  PROP_LATENCY,
+  PROP_LAST
+};
+
+/* longest PCR interval of ISO/IEC 13818-1 */
+#define DEFAULT_PROP_LATENCY          (100)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+#define gst_rtp_mp2t_pace_parent_class parent_class
+G_DEFINE_TYPE (GstRtpMp2tPace, gst_rtp_mp2t_pace, GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_mp2t_pace_reset (GstRtpMp2tPace * self)
+{
+  gst_adapter_clear (self->adapter);
+  self->head_pos = self->in_pos = 0;
+  self->in_pts = GST_CLOCK_TIME_NONE;
+  self->pcr_pid = -1;
+  self->have_pcr = FALSE;
+  self->pcr_wraps = 0;
+  self->ns_per_byte = 0.0;
+  self->have_header = FALSE;
+  self->first_pts = GST_CLOCK_TIME_NONE;
+  self->last_out = 0;
+}
+
+/**
+ * gst_rtp_mp2t_pace_time:
+ * @self: The current #GstRtpMp2tPace object
+ * @pos: a TS byte position
+ *
+ * Returns: the time the byte at @pos has to be sent, interpolated from the
+ * last PCR and the byte rate up to it
+ */
+static GstClockTime
+gst_rtp_mp2t_pace_time (GstRtpMp2tPace * self, guint64 pos)
+{
+  GstClockTime latency, out;
+
+  GST_OBJECT_LOCK (self);
+  latency = self->latency * GST_MSECOND;
+  GST_OBJECT_UNLOCK (self);
+
+  if (self->have_pcr && self->ns_per_byte > 0.0)
+    out = self->pcr_time + self->offset + latency +
+        (GstClockTimeDiff) (((gint64) pos - (gint64) self->pcr_pos) *
+        self->ns_per_byte);
+  else if (GST_CLOCK_TIME_IS_VALID (self->in_pts))
+    out = self->in_pts + latency;
+  else
+    return GST_CLOCK_TIME_NONE;
+
+  out = MAX (out, self->last_out);
+  self->last_out = out;
+
+  return out;
+}
+
+/**
+ * gst_rtp_mp2t_pace_push:
+ * @self: The current #GstRtpMp2tPace object
+ * @limit: push the packets starting before this TS byte position
+ * @drain: also push a last packet of less than 7 TS packets
+ *
+ * Returns: the flow return of the pushes
+ */
+static GstFlowReturn
+gst_rtp_mp2t_pace_push (GstRtpMp2tPace * self, guint64 limit, gboolean drain)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  while (ret == GST_FLOW_OK && self->head_pos < limit) {
+    gsize avail = gst_adapter_available (self->adapter);
+    gsize size = MIN (avail, GST_RTP_MP2T_PACE_PAYLOAD_SIZE);
+    GstClockTime pts;
+    GstBuffer *header, *packet;
+    guint32 rtptime = GST_READ_UINT32_BE (self->header + 4);
+
+    size -= size % GST_RTP_MP2T_PACE_PACKET_SIZE;
+    if (size == 0 || (size < GST_RTP_MP2T_PACE_PAYLOAD_SIZE && !drain))
+      break;
+
+    pts = gst_rtp_mp2t_pace_time (self, self->head_pos);
+    if (GST_CLOCK_TIME_IS_VALID (pts)) {
+      if (!GST_CLOCK_TIME_IS_VALID (self->first_pts))
+        self->first_pts = pts;
+      rtptime += (guint32) gst_util_uint64_scale_int (pts - self->first_pts, 90000,
+          GST_SECOND);
+    }
+
+    header = gst_buffer_new_allocate (NULL, sizeof (self->header), NULL);
+    gst_buffer_fill (header, 0, self->header, sizeof (self->header));
+    {
+      GstMapInfo map;
+
+      gst_buffer_map (header, &map, GST_MAP_WRITE);
+      GST_WRITE_UINT16_BE (map.data + 2, self->seq);
+      GST_WRITE_UINT32_BE (map.data + 4, rtptime);
+      gst_buffer_unmap (header, &map);
+    }
+    self->seq++;
+
+    packet = gst_buffer_append (header,
+        gst_adapter_take_buffer_fast (self->adapter, size));
+    GST_BUFFER_PTS (packet) = GST_BUFFER_DTS (packet) = pts;
+    self->head_pos += size;
+
+    ret = gst_pad_push (self->srcpad, packet);
+  }
+
+  return ret;
+}
+
+/**
+ * gst_rtp_mp2t_pace_pcr:
+ * @self: The current #GstRtpMp2tPace object
+ * @pcr: the 90 kHz base of a PCR
+ * @pos: TS byte position of the packet with @pcr
+ *
+ * Send everything before @pos interpolated between the previous PCR and
+ * this one, then move on to the next PCR interval.
+ */
+static GstFlowReturn
+gst_rtp_mp2t_pace_pcr (GstRtpMp2tPace * self, guint64 pcr, guint64 pos)
+{
+  GstClockTime pcr_time;
+  GstClockTimeDiff diff = 0;
+  GstFlowReturn ret;
+
+  if (self->have_pcr && pcr < self->last_pcr &&
+      self->last_pcr - pcr > GST_RTP_MP2T_PACE_PCR_WRAP / 2)
+    self->pcr_wraps++;
+  pcr_time = gst_util_uint64_scale_int (pcr +
+      self->pcr_wraps * GST_RTP_MP2T_PACE_PCR_WRAP, GST_SECOND, 90000);
+
+  if (self->have_pcr)
+    diff = GST_CLOCK_DIFF (self->pcr_time, pcr_time);
+
+  if (self->have_pcr && diff > 0 && diff <= GST_RTP_MP2T_PACE_MAX_PCR_JUMP &&
+      pos > self->pcr_pos) {
+    self->ns_per_byte = (gdouble) diff / (pos - self->pcr_pos);
+    ret = gst_rtp_mp2t_pace_push (self, pos, FALSE);
+  } else {
+    /* first PCR or a discontinuity: send what is held as it came in and
+     * lock onto the new PCR */
+    if (self->have_pcr)
+      GST_DEBUG_OBJECT (self, "PCR discontinuity of %" GST_STIME_FORMAT,
+          GST_STIME_ARGS (diff));
+    self->have_pcr = FALSE;
+    ret = gst_rtp_mp2t_pace_push (self, pos, FALSE);
+    self->ns_per_byte = 0.0;
+    self->pcr_wraps = 0;
+    pcr_time = gst_util_uint64_scale_int (pcr, GST_SECOND, 90000);
+    if (GST_CLOCK_TIME_IS_VALID (self->in_pts))
+      self->offset = GST_CLOCK_DIFF (pcr_time, self->in_pts);
+    self->have_pcr = GST_CLOCK_TIME_IS_VALID (self->in_pts);
+  }
+
+  self->last_pcr = pcr;
+  self->pcr_time = pcr_time;
+  self->pcr_pos = pos;
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_rtp_mp2t_pace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (parent);
+  GstFlowReturn ret = GST_FLOW_OK;
+  const guint8 *payload, *ts;
+  gsize len, offset, i, n;
+  GstMapInfo map;
+  gint pid;
+
+  if (!self->active)
+    return gst_pad_push (self->srcpad, buffer);
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+  if (!gst_barco_rtp_get_payload (map.data, map.size, &payload, &len)) {
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+
+  if (!self->have_header) {
+    /* no CSRCs, extension, padding or marker on the paced packets */
+    memcpy (self->header, map.data, sizeof (self->header));
+    self->header[0] = 0x80;
+    self->header[1] &= 0x7f;
+    self->seq = GST_READ_UINT16_BE (map.data + 2);
+    self->have_header = TRUE;
+  }
+
+  offset = payload - map.data;
+  n = len / GST_RTP_MP2T_PACE_PACKET_SIZE;
+  if (GST_BUFFER_PTS_IS_VALID (buffer))
+    self->in_pts = GST_BUFFER_PTS (buffer);
+
+  /* the TS packets go in the adapter as they are, the PCRs are looked up
+   * in the mapped packet */
+  if (n > 0)
+    gst_adapter_push (self->adapter, gst_buffer_copy_region (buffer,
+            GST_BUFFER_COPY_MEMORY, offset,
+            n * GST_RTP_MP2T_PACE_PACKET_SIZE));
+
+  for (i = 0; i < n && ret == GST_FLOW_OK; i++) {
+    ts = payload + i * GST_RTP_MP2T_PACE_PACKET_SIZE;
+    pid = GST_READ_UINT16_BE (ts + 1) & 0x1fff;
+
+    if (ts[0] == 0x47 && (ts[3] & 0x20) && ts[4] >= 7 && (ts[5] & 0x10)) {
+      if (self->pcr_pid < 0)
+        self->pcr_pid = pid;
+      if (pid == self->pcr_pid)
+        ret = gst_rtp_mp2t_pace_pcr (self, ((guint64) GST_READ_UINT32_BE
+                (ts + 6) << 1) | (ts[10] >> 7),
+            self->in_pos + i * GST_RTP_MP2T_PACE_PACKET_SIZE);
+    }
+  }
+  self->in_pos += n * GST_RTP_MP2T_PACE_PACKET_SIZE;
+
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  /* a stream without PCRs is sent as it comes in */
+  if (ret == GST_FLOW_OK && (self->pcr_pid < 0 ||
+          self->in_pos - self->head_pos > GST_RTP_MP2T_PACE_MAX_HELD))
+    ret = gst_rtp_mp2t_pace_push (self, self->in_pos, FALSE);
+
+  return ret;
+}
+
+static gboolean
+gst_rtp_mp2t_pace_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      GstStructure *s;
+      const gchar *encoding_name;
+      gint pt = -1;
+
+      gst_event_parse_caps (event, &caps);
+      s = gst_caps_get_structure (caps, 0);
+      encoding_name = gst_structure_get_string (s, "encoding-name");
+      gst_structure_get_int (s, "payload", &pt);
+      self->active = encoding_name ?
+          g_ascii_strcasecmp (encoding_name, "MP2T") == 0 : pt == 33;
+      GST_INFO_OBJECT (self, "%s pacing", self->active ? "MP2T" : "No");
+      break;
+    }
+    case GST_EVENT_EOS:
+      if (self->active)
+        gst_rtp_mp2t_pace_push (self, self->in_pos, TRUE);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_rtp_mp2t_pace_reset (self);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_rtp_mp2t_pace_src_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (parent);
+  GstClockTime min, max, latency;
+  gboolean live;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_LATENCY || !self->active)
+    return gst_pad_query_default (pad, parent, query);
+
+  if (!gst_pad_peer_query (self->sinkpad, query))
+    return FALSE;
+
+  GST_OBJECT_LOCK (self);
+  latency = self->latency * GST_MSECOND;
+  GST_OBJECT_UNLOCK (self);
+
+  gst_query_parse_latency (query, &live, &min, &max);
+  min += latency;
+  if (GST_CLOCK_TIME_IS_VALID (max))
+    max += latency;
+  gst_query_set_latency (query, live, min, max);
+
+  return TRUE;
+}
+
+static GstStateChangeReturn
+gst_rtp_mp2t_pace_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtp_mp2t_pace_reset (self);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_mp2t_pace_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (object);
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (self);
+      self->latency = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_mp2t_pace_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (object);
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->latency);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_mp2t_pace_finalize (GObject * gobject)
+{
+  GstRtpMp2tPace *self = GST_RTP_MP2T_PACE (gobject);
+
+  g_object_unref (self->adapter);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_mp2t_pace_class_init (GstRtpMp2tPaceClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  oclass->set_property = gst_rtp_mp2t_pace_set_property;
+  oclass->get_property = gst_rtp_mp2t_pace_get_property;
+  oclass->finalize = gst_rtp_mp2t_pace_finalize;
+
+  /**
+   * GstRtpMp2tPace::latency
+   *
+   * Time in ms the packets are sent after their PCR time, it has to cover
+   * the PCR interval of the mux the packets are held for.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_LATENCY,
+      g_param_spec_uint ("latency", "Latency",
+          "Delay in ms behind the PCR to hold the packets of a PCR interval",
+          0, G_MAXUINT, DEFAULT_PROP_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_pace_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpmp2tpace",
+      "Filter/Network/RTP",
+      "Barco PCR locked pacing of MPEG-TS over RTP",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_mp2t_pace_debug,
+      "barcortpmp2tpace", 0, "Barco MPEG-TS pacing");
+}
+
+static void
+gst_rtp_mp2t_pace_init (GstRtpMp2tPace * self)
+{
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_pace_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_pace_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_query_function (self->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_mp2t_pace_src_query));
+  GST_PAD_SET_PROXY_CAPS (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->latency = DEFAULT_PROP_LATENCY;
+  self->adapter = gst_adapter_new ();
+  gst_rtp_mp2t_pace_reset (self);
+}
+
+gboolean
+rtp_mp2t_pace_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpmp2tpace", GST_RANK_NONE, GST_TYPE_RTP_MP2T_PACE);
+}
@@ -0,0 +1,15 @@
+#ifndef _GST_RTP_MP2T_PACE_H_
+#define _GST_RTP_MP2T_PACE_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_MP2T_PACE (gst_rtp_mp2t_pace_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpMp2tPace, gst_rtp_mp2t_pace, GST, RTP_MP2T_PACE,
+    GstElement);
+
+gboolean rtp_mp2t_pace_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_MP2T_PACE_H_ */
@@ -0,0 +1,224 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtppacket
+ *
+ * \brief Minimal parsing of the RTP packets looked into before rtpbin
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "gstrtppacket.h"
+
+/**
+ * gst_barco_rtp_get_payload:
+ * @data: an RTP packet
+ * @size: the size of @data
+ * @payload: (out): start of the payload
+ * @payload_len: (out): size of the payload, without padding
+ *
+ * Minimal RTP header parsing for the places that look into packets before
+ * they reach rtpbin.
+ *
+ * Returns: FALSE if @data is not a valid RTP packet
+ */
+gboolean
+gst_barco_rtp_get_payload (const guint8 * data, gsize size,
+    const guint8 ** payload, gsize * payload_len)
+{
+  gsize offset, len;
+
+  if (size < 12 || (data[0] >> 6) != 2)
+    return FALSE;
+
+  offset = 12 + (data[0] & 0x0f) * 4;
+  if (data[0] & 0x10) {
+    if (size < offset + 4)
+      return FALSE;
+    offset += 4 + GST_READ_UINT16_BE (data + offset + 2) * 4;
+  }
+  if (size <= offset)
+    return FALSE;
+
+  len = size - offset;
+  if (data[0] & 0x20) {
+    if (data[size - 1] >= len)
+      return FALSE;
+    len -= data[size - 1];
+  }
+
+  *payload = data + offset;
+  *payload_len = len;
+
+  return TRUE;
+}
+
+/**
+ * gst_barco_rtp_guess_encoding_name:
+ * @pt: payload type of the stream
+ * @encoding_name: (nullable): configured encoding name
+ *
+ * Returns: @encoding_name, or the encoding of a static payload type
+ */
+const gchar *
+gst_barco_rtp_guess_encoding_name (guint pt, const gchar * encoding_name)
+{
+  if (encoding_name)
+    return encoding_name;
+
+  switch (pt) {
+    case 32:
+      return "MPV";
+    case 33:
+      return "MP2T";
+    default:
+      return NULL;
+  }
+}
+
+static gboolean
+gst_barco_h264_nal_is_keyframe (guint8 header)
+{
+  guint8 type = header & 0x1f;
+
+  /* IDR slice or SPS */
+  return type == 5 || type == 7;
+}
+
+static gboolean
+gst_barco_h264_is_keyframe (const guint8 * p, gsize len)
+{
+  gsize offset;
+
+  switch (p[0] & 0x1f) {
+    case 24:                   /* STAP-A */
+      for (offset = 1; offset + 2 < len;
+          offset += 2 + GST_READ_UINT16_BE (p + offset)) {
+        if (gst_barco_h264_nal_is_keyframe (p[offset + 2]))
+          return TRUE;
+      }
+      return FALSE;
+    case 28:                   /* FU-A, start fragment */
+      return len >= 2 && (p[1] & 0x80) && gst_barco_h264_nal_is_keyframe (p[1]);
+    default:
+      return gst_barco_h264_nal_is_keyframe (p[0]);
+  }
+}
+
+static gboolean
+gst_barco_h265_nal_is_keyframe (guint8 type)
+{
+  /* IRAP pictures or VPS/SPS/PPS */
+  return (type >= 16 && type <= 21) || (type >= 32 && type <= 34);
+}
+
+static gboolean
+gst_barco_h265_is_keyframe (const guint8 * p, gsize len)
+{
+  gsize offset;
+
+  if (len < 3)
+    return FALSE;
+
+  switch ((p[0] >> 1) & 0x3f) {
+    case 48:                   /* aggregation packet */
+      for (offset = 2; offset + 2 < len;
+          offset += 2 + GST_READ_UINT16_BE (p + offset)) {
+        if (gst_barco_h265_nal_is_keyframe ((p[offset + 2] >> 1) & 0x3f))
+          return TRUE;
+      }
+      return FALSE;
+    case 49:                   /* fragmentation unit, start fragment */
+      return (p[2] & 0x80) && gst_barco_h265_nal_is_keyframe (p[2] & 0x3f);
+    default:
+      return gst_barco_h265_nal_is_keyframe ((p[0] >> 1) & 0x3f);
+  }
+}
+
+static gboolean
+gst_barco_mpeg4_is_keyframe (const guint8 * p, gsize len)
+{
+  gsize i;
+
+  for (i = 0; i + 4 < len; i++) {
+    if (p[i] != 0 || p[i + 1] != 0 || p[i + 2] != 1)
+      continue;
+    /* visual object sequence, group of VOP or an I-VOP */
+    if (p[i + 3] == 0xb0 || p[i + 3] == 0xb3)
+      return TRUE;
+    if (p[i + 3] == 0xb6)
+      return (p[i + 4] >> 6) == 0;
+  }
+
+  return FALSE;
+}
+
+static gboolean
+gst_barco_mp2t_is_keyframe (const guint8 * p, gsize len)
+{
+  gsize i;
+
+  /* random_access_indicator in the adaptation field */
+  for (i = 0; i + 188 <= len; i += 188) {
+    if (p[i] == 0x47 && (p[i + 3] & 0x20) && p[i + 4] > 0 &&
+        (p[i + 5] & 0x40))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+/**
+ * gst_barco_rtp_has_keyframes:
+ * @encoding_name: (nullable): encoding name of the stream
+ *
+ * Returns: TRUE if gst_barco_rtp_is_keyframe() can find the keyframes of
+ * @encoding_name
+ */
+gboolean
+gst_barco_rtp_has_keyframes (const gchar * encoding_name)
+{
+  static const gchar *names[] = { "H264", "H265", "MP4V-ES", "MP2T" };
+  guint i;
+
+  for (i = 0; encoding_name && i < G_N_ELEMENTS (names); i++)
+    if (g_ascii_strcasecmp (encoding_name, names[i]) == 0)
+      return TRUE;
+
+  return FALSE;
+}
+
+/**
+ * gst_barco_rtp_is_keyframe:
+ * @data: an RTP packet
+ * @size: the size of @data
+ * @encoding_name: (nullable): encoding name of the stream
+ *
+ * Look for the start of a keyframe (or the parameter sets preceding it)
+ * in H264, H265, MP4V-ES and MP2T payloads.
+ *
+ * Returns: TRUE if @data starts or contains a keyframe
+ */
+gboolean
+gst_barco_rtp_is_keyframe (const guint8 * data, gsize size,
+    const gchar * encoding_name)
+{
+  const guint8 *p;
+  gsize len;
+
+  if (encoding_name == NULL ||
+      !gst_barco_rtp_get_payload (data, size, &p, &len))
+    return FALSE;
+
+  if (g_ascii_strcasecmp (encoding_name, "H264") == 0)
+    return gst_barco_h264_is_keyframe (p, len);
+  if (g_ascii_strcasecmp (encoding_name, "H265") == 0)
+    return gst_barco_h265_is_keyframe (p, len);
+  if (g_ascii_strcasecmp (encoding_name, "MP4V-ES") == 0)
+    return gst_barco_mpeg4_is_keyframe (p, len);
+  if (g_ascii_strcasecmp (encoding_name, "MP2T") == 0)
+    return gst_barco_mp2t_is_keyframe (p, len);
+
+  return FALSE;
+}
@@ -0,0 +1,24 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtppacket
+ *
+ * \brief Minimal parsing of the RTP packets looked into before rtpbin
+ *
+ */
+
+#ifndef _GST_RTP_PACKET_H_
+#define _GST_RTP_PACKET_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+gboolean gst_barco_rtp_get_payload (const guint8 * data, gsize size,
+    const guint8 ** payload, gsize * payload_len);
+const gchar *gst_barco_rtp_guess_encoding_name (guint pt,
+    const gchar * encoding_name);
+gboolean gst_barco_rtp_is_keyframe (const guint8 * data, gsize size,
+    const gchar * encoding_name);
+gboolean gst_barco_rtp_has_keyframes (const gchar * encoding_name);
+
+G_END_DECLS
+#endif /* _GST_RTP_PACKET_H_ */
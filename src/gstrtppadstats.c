@@ -0,0 +1,178 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtppadstats
+ *
+ * \brief Counters of the RTP packets through the pads of rtpsrc and rtpsink
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gstrtppadstats.h"
+
+/**
+ * gst_barco_pad_stats_init:
+ * @stats: a #GstBarcoPadStats
+ * @clock_rate: RTP clock rate of the stream for the jitter, 0 for none
+ */
+void
+gst_barco_pad_stats_init (GstBarcoPadStats * stats, guint clock_rate)
+{
+  memset (stats, 0, sizeof (GstBarcoPadStats));
+  stats->clock_rate = clock_rate;
+  stats->entry_time = GST_CLOCK_TIME_NONE;
+}
+
+/**
+ * gst_barco_pad_stats_add:
+ * @stats: a #GstBarcoPadStats
+ * @data: an RTP packet
+ * @size: the size of @data
+ * @arrival: arrival time of the packet, or #GST_CLOCK_TIME_NONE
+ *
+ * Count a packet entering the pad. A sequence number more than one ahead
+ * counts the ones in between as lost. A packet behind counts as
+ * reordered, and no longer as lost when it is one of those, or as a
+ * duplicate when it already arrived. Over 64 packets behind, it is too
+ * late to tell. The arrival is used for the jitter and is remembered, so
+ * gst_barco_pad_stats_sent() can time the packet.
+ */
+void
+gst_barco_pad_stats_add (GstBarcoPadStats * stats, const guint8 * data,
+    gsize size, GstClockTime arrival)
+{
+  guint16 seq, gap, back;
+  guint32 transit;
+  gint32 d;
+
+  if (size < 12 || (data[0] & 0xc0) != 0x80)
+    return;
+
+  g_atomic_int_inc (&stats->generation);
+  seq = GST_READ_UINT16_BE (data + 2);
+  gap = seq - stats->seq - 1;
+  if (!stats->have_seq) {
+    stats->first_seq = seq;
+    stats->missing = 0;
+    stats->seq = seq;
+    stats->have_seq = TRUE;
+  } else if (gap < 0x8000) {
+    stats->lost += gap;
+    if (gap >= 63)
+      stats->missing = G_MAXUINT64 << 1;
+    else
+      stats->missing = (stats->missing << (gap + 1)) |
+          (((G_GUINT64_CONSTANT (1) << gap) - 1) << 1);
+    stats->seq = seq;
+  } else {
+    back = stats->seq - seq;
+    if (back < 64 && (stats->missing & (G_GUINT64_CONSTANT (1) << back))) {
+      /* a late packet fills a gap that was counted as lost */
+      stats->missing &= ~(G_GUINT64_CONSTANT (1) << back);
+      stats->reordered++;
+      stats->lost--;
+    } else if (back < 64 && (guint16) (seq - stats->first_seq) < 0x8000) {
+      stats->duplicates++;
+    } else {
+      stats->reordered++;
+    }
+  }
+
+  /* RFC 3550 A.8, in RTP clock units */
+  if (stats->clock_rate && GST_CLOCK_TIME_IS_VALID (arrival)) {
+    transit = (guint32) gst_util_uint64_scale_int (arrival,
+        stats->clock_rate, GST_SECOND) - GST_READ_UINT32_BE (data + 4);
+    if (stats->have_transit) {
+      d = transit - stats->transit;
+      stats->jitter += (ABS (d) - stats->jitter) / 16.0;
+    }
+    stats->transit = transit;
+    stats->have_transit = TRUE;
+  }
+
+  stats->entry_seq = seq;
+  stats->entry_time = arrival;
+  stats->bytes += size;
+  stats->packets++;
+  g_atomic_int_inc (&stats->generation);
+}
+
+/**
+ * gst_barco_pad_stats_sent:
+ * @stats: a #GstBarcoPadStats
+ * @data: an RTP packet
+ * @size: the size of @data
+ * @now: the time, on the clock of the arrival times
+ *
+ * Count a packet handed to the socket, and the time it took since it
+ * arrived when it is the packet that last entered.
+ */
+void
+gst_barco_pad_stats_sent (GstBarcoPadStats * stats, const guint8 * data,
+    gsize size, GstClockTime now)
+{
+  GstClockTime latency;
+
+  if (size < 12 || (data[0] & 0xc0) != 0x80)
+    return;
+
+  g_atomic_int_inc (&stats->generation);
+  stats->sent++;
+  if (GST_CLOCK_TIME_IS_VALID (stats->entry_time) &&
+      GST_READ_UINT16_BE (data + 2) == stats->entry_seq) {
+    latency = now - stats->entry_time;
+    stats->entry_time = GST_CLOCK_TIME_NONE;
+    stats->latency = stats->latency ?
+        stats->latency - stats->latency / 16 + latency / 16 : latency;
+    stats->latency_max = MAX (stats->latency_max, latency);
+  }
+  g_atomic_int_inc (&stats->generation);
+}
+
+/**
+ * gst_barco_pad_stats_to_structure:
+ * @stats: a #GstBarcoPadStats
+ * @name: name of the structure
+ * @pad: (nullable): name of the pad the stream leaves on
+ *
+ * Take a consistent snapshot of the counters, while the writer goes on.
+ *
+ * Returns: (transfer full): a structure with the counters, the jitter in
+ * ns and the average and maximum send latency in ns
+ */
+GstStructure *
+gst_barco_pad_stats_to_structure (GstBarcoPadStats * stats,
+    const gchar * name, const gchar * pad)
+{
+  GstBarcoPadStats copy;
+  gint generation;
+
+  /* retry while the writer was busy, it never waits for us */
+  do {
+    generation = g_atomic_int_get (&stats->generation);
+    if (generation & 1)
+      continue;
+    memcpy (&copy, stats, sizeof (GstBarcoPadStats));
+  } while ((generation & 1) ||
+      g_atomic_int_add (&stats->generation, 0) != generation);
+  stats = &copy;
+
+  return gst_structure_new (name,
+      "pad", G_TYPE_STRING, pad,
+      "ssrc", G_TYPE_UINT, stats->ssrc,
+      "pt", G_TYPE_UINT, stats->pt,
+      "packets", G_TYPE_UINT64, stats->packets,
+      "bytes", G_TYPE_UINT64, stats->bytes,
+      "lost", G_TYPE_UINT64, stats->lost,
+      "reordered", G_TYPE_UINT64, stats->reordered,
+      "duplicates", G_TYPE_UINT64, stats->duplicates,
+      "jitter", G_TYPE_UINT64, stats->clock_rate ?
+      (guint64) (stats->jitter * GST_SECOND / stats->clock_rate) :
+      G_GUINT64_CONSTANT (0),
+      "sent", G_TYPE_UINT64, stats->sent,
+      "send-latency", G_TYPE_UINT64, stats->latency,
+      "send-latency-max", G_TYPE_UINT64, stats->latency_max, NULL);
+}
@@ -0,0 +1,65 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtppadstats
+ *
+ * \brief Counters of the RTP packets through the pads of rtpsrc and rtpsink
+ *
+ */
+
+#ifndef _GST_RTP_PAD_STATS_H_
+#define _GST_RTP_PAD_STATS_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstBarcoPadStats:
+ *
+ * Counters of the RTP packets through a pad. There is one writer at a
+ * time, a sink pad probe or a caller that locks. Readers take a snapshot
+ * with gst_barco_pad_stats_to_structure() from any thread without
+ * stopping the writer.
+ */
+typedef struct
+{
+  /* odd while the writer updates the counters */
+  gint generation;
+
+  guint ssrc;
+  guint pt;
+  guint clock_rate;
+
+  guint64 packets;
+  guint64 bytes;
+  guint64 lost;
+  guint64 reordered;
+  guint64 duplicates;
+  /* RFC 3550 interarrival jitter, in RTP clock units */
+  gdouble jitter;
+  guint64 sent;
+  /* time from the arrival to the socket, in ns */
+  guint64 latency;
+  guint64 latency_max;
+
+  /* private to the writer */
+  gboolean have_seq;
+  guint16 seq;
+  guint16 first_seq;
+  /* bit n: seq - n was counted as lost and did not arrive yet */
+  guint64 missing;
+  gboolean have_transit;
+  guint32 transit;
+  guint16 entry_seq;
+  GstClockTime entry_time;
+} GstBarcoPadStats;
+
+void gst_barco_pad_stats_init (GstBarcoPadStats * stats, guint clock_rate);
+void gst_barco_pad_stats_add (GstBarcoPadStats * stats, const guint8 * data,
+    gsize size, GstClockTime arrival);
+void gst_barco_pad_stats_sent (GstBarcoPadStats * stats,
+    const guint8 * data, gsize size, GstClockTime now);
+GstStructure *gst_barco_pad_stats_to_structure (GstBarcoPadStats * stats,
+    const gchar * name, const gchar * pad);
+
+G_END_DECLS
+#endif /* _GST_RTP_PAD_STATS_H_ */
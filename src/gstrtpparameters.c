@@ -0,0 +1,368 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * Registry of the RTP parameters (encoding name, media, clock rate) that
+ * rtpsrc maps payload types on.
+ *
+ * The built in tables are indexed once per process by static payload type
+ * and by encoding name. Entries can be added or replaced from the key file
+ * named by GST_BARCO_RTP_PARAMETERS, read on the first lookup, so a new
+ * codec does not need a rebuild. That key file is the interface for
+ * applications, no header of this plugin is installed:
+ *
+ *   [AV1]
+ *   media=video
+ *   clock-rate=90000
+ *
+ *   [JPEG-XS]
+ *   media=video
+ *   clock-rate=90000
+ *
+ * A group can also set payload= to map a static payload type. Entries and
+ * replaced indexes are never freed, the pointers handed out stay valid and
+ * lookups read the index without a lock.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gst/gst.h>
+#include <string.h>
+
+#include "gstrtpparameters.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_parameters_debug);
+#define GST_CAT_DEFAULT rtp_parameters_debug
+
+static const RtpParameters RTP_STATIC_PARAMETERS[] = {
+  {0, "PCMU", "audio", 8000},
+  {3, "GSM", "audio", 8000},
+  {4, "G723", "audio", 8000},
+  {5, "DVI4", "audio", 8000},
+  {6, "DVI4", "audio", 16000},
+  {7, "LPC", "audio", 8000},
+  {8, "PCMA", "audio", 8000},
+  {9, "G722", "audio", 8000},
+  {10, "L16", "audio", 48000},
+  {11, "L16", "audio", 48000},
+  {12, "QCELP", "audio", 8000},
+  {13, "CN", "audio", 8000},
+  {14, "MPA", "audio", 90000},
+  {15, "G728", "audio", 8000},
+  {16, "DVI4", "audio", 11025},
+  {17, "DVI4", "audio", 22050},
+  {18, "G729", "audio", 8000},
+  {25, "CelB", "video", 90000},
+  {26, "JPEG", "video", 90000},
+  {28, "nv", "video", 90000},
+  {31, "H261", "video", 90000},
+  {32, "MPV", "video", 90000},
+  {33, "MP2T", "video", 90000},
+  {34, "H263", "video", 90000},
+  {-1, NULL, NULL, 0}
+};
+
+static const RtpParameters RTP_DYNAMIC_PARAMETERS[] = {
+  {0, "MP4V-ES", "video", 90000},
+  {0, "H264", "video", 90000},
+  {0, "H265", "video", 90000},
+  {0, "MP2P", "video", 90000},
+  {0, "H263-1998", "video", 90000},
+  {0, "H263-2000", "video", 90000},
+  {0, "MP1S", "video", 90000},
+  {0, "AMR", "audio", 8000},
+  {0, "AMR-WB", "audio", 16000},
+  {0, "DAT12", "audio", 0},
+  {0, "dsr-es201108", "audio", 0},
+  {0, "EVRC", "audio", 8000},
+  {0, "EVRC0", "audio", 8000},
+  {0, "EVRC1", "audio", 8000},
+  {0, "EVRCB", "audio", 8000},
+  {0, "EVRCB0", "audio", 8000},
+  {0, "EVRCB1", "audio", 8000},
+  {0, "EVRCWB", "audio", 0},
+  {0, "EVRCWB0", "audio", 0},
+  {0, "EVRCWB1", "audio", 0},
+  {0, "G7221", "audio", 16000},
+  {0, "G726-16", "audio", 8000},
+  {0, "G726-24", "audio", 8000},
+  {0, "G726-32", "audio", 8000},
+  {0, "G726-40", "audio", 8000},
+  {0, "G729D", "audio", 8000},
+  {0, "G729E", "audio", 8000},
+  {0, "GSM-EFR", "audio", 8000},
+  {0, "L8", "audio", 0},
+  {0, "RED", "audio", 0},
+  {0, "rtx", "audio", 0},
+  {0, "VDVI", "audio", 0},
+  {0, "L20", "audio", 0},
+  {0, "L24", "audio", 0},
+  {0, "MP4A-LATM", "audio", 48000},
+  {0, "mpa-robust", "audio", 90000},
+  {0, "parityfec", "audio", 0},
+  {0, "SMV", "audio", 8000},
+  {0, "SMV0", "audio", 8000},
+  {0, "t140c", "audio", 0},
+  {0, "t38", "audio", 0},
+  {0, "telephone-event", "audio", 0},
+  {0, "tone", "audio", 0},
+  {0, "DVI4", "audio", 0},
+  {0, "G722", "audio", 0},
+  {0, "G723", "audio", 0},
+  {0, "G728", "audio", 0},
+  {0, "G729", "audio", 0},
+  {0, "GSM", "audio", 0},
+  {0, "L16", "audio", 48000},
+  {0, "LPC", "audio", 0},
+  {0, "PCMA", "audio", 0},
+  {0, "PCMU", "audio", 0},
+  {0, "OPUS", "audio", 48000},
+  {0, "BMPEG", "video", 90000},
+  {0, "BT656", "video", 90000},
+  {0, "DV", "video", 90000},
+  {0, "parityfec", "video", 0},
+  {0, "pointer", "video", 90000},
+  {0, "raw", "video", 90000},
+  {0, "rtx", "video", 0},
+  {0, "SMPTE292M", "video", 0},
+  {0, "vc1", "video", 90000},
+  /* custom encoding name */
+  {0, "MPEG4-GENERIC-AUDIO", "audio", 0},
+  {0, "BLC3", "video", 90000},
+  {0, "THEORA", "video", 90000},
+  /*application/x-rtp, media=(string)video, clock-rate=(int)90000, encoding-name=(string)RAW, sampling=(string)RGB, depth=(string)24, width=(string)800, height=(string)600, colorimetry=(string)SMPTE240M, payload=(int)127 */
+  {0, "RAW-RGB24", "video", 90000},
+  {0, "VP8", "video", 90000},
+  {0, "VP8-DRAFT-IETF-01", "video", 90000},
+  {0, "VP9", "video", 90000},
+  {0, "VP9-DRAFT-IETF-01", "video", 90000},
+  /* application/x-rtp, media=(string)video, clock-rate=(int)90000, encoding-name=(string)V2D, width=(int)1920, original-width=(int)1920, height=(int)1200, original-height=(int)1200, slice-size=(int)36, format=(int)0, max-slice-number=(int)1000, stereo-mode=(int)0, comp-mode=(int)0, motion-comp-mode=(int)0, ssrc=(uint)2621274064, payload=(int)96, timestamp-offset=(uint)1572929903, seqnum-offset=(uint)29225 */
+  {0, "V2D", "video", 90000 },
+  /*application/x-rtp, media=(string)application, clock-rate=(int)9000, encoding-name=(string)X-GST */
+  {0, "X-GST", "media", 9000},
+  {-1, NULL, NULL, 0}
+};
+
+/* An immutable index of the parameters. Lookups read the current one
+ * without a lock; a registration publishes a new one. */
+typedef struct
+{
+  const RtpParameters *by_pt[128];
+  GHashTable *by_name;
+} RtpParametersTable;
+
+/* serializes the registrations */
+static GMutex registry_lock;
+static RtpParametersTable *registry;
+/* replaced tables, a lookup may still be reading them */
+static GSList *retired;
+
+static void
+gst_rtp_parameters_index (RtpParametersTable * table,
+    const RtpParameters * p, gboolean replace)
+{
+  if (p->encoding_name == NULL)
+    return;
+  if (replace || !g_hash_table_contains (table->by_name, p->encoding_name))
+    g_hash_table_insert (table->by_name, (gpointer) p->encoding_name,
+        (gpointer) p);
+}
+
+/**
+ * gst_rtp_parameters_init:
+ *
+ * Index the built in tables, the first entry of a name wins and the
+ * dynamic ones go first. Then add the key file of the environment.
+ */
+static void
+gst_rtp_parameters_init (void)
+{
+  static gsize initialized = 0;
+  RtpParametersTable *table;
+  const RtpParameters *p;
+  const gchar *path;
+  GError *error = NULL;
+
+  if (!g_once_init_enter (&initialized))
+    return;
+
+  GST_DEBUG_CATEGORY_INIT (rtp_parameters_debug, "barcortpparameters", 0,
+      "Barco RTP parameters");
+
+  table = g_new0 (RtpParametersTable, 1);
+  table->by_name = g_hash_table_new (g_str_hash, g_str_equal);
+  for (p = RTP_DYNAMIC_PARAMETERS; p->pt >= 0; p++)
+    gst_rtp_parameters_index (table, p, FALSE);
+  for (p = RTP_STATIC_PARAMETERS; p->pt >= 0; p++) {
+    if (table->by_pt[p->pt] == NULL)
+      table->by_pt[p->pt] = p;
+    gst_rtp_parameters_index (table, p, FALSE);
+  }
+  g_atomic_pointer_set (&registry, table);
+
+  g_once_init_leave (&initialized, 1);
+
+  path = g_getenv ("GST_BARCO_RTP_PARAMETERS");
+  if (path && !gst_rtp_parameters_load (path, &error)) {
+    GST_WARNING ("Could not load RTP parameters from %s: %s", path,
+        error->message);
+    g_clear_error (&error);
+  }
+}
+
+/**
+ * gst_rtp_parameters_lookup_pt:
+ * @pt: a payload type
+ *
+ * Returns: (nullable): the parameters of the static payload type @pt
+ */
+const RtpParameters *
+gst_rtp_parameters_lookup_pt (guint pt)
+{
+  RtpParametersTable *table;
+
+  gst_rtp_parameters_init ();
+
+  if (pt >= G_N_ELEMENTS (table->by_pt))
+    return NULL;
+
+  table = g_atomic_pointer_get (&registry);
+
+  return table->by_pt[pt];
+}
+
+/**
+ * gst_rtp_parameters_lookup_name:
+ * @encoding_name: an encoding name
+ *
+ * Returns: (nullable): the parameters of @encoding_name
+ */
+const RtpParameters *
+gst_rtp_parameters_lookup_name (const gchar * encoding_name)
+{
+  RtpParametersTable *table;
+
+  gst_rtp_parameters_init ();
+
+  if (encoding_name == NULL)
+    return NULL;
+
+  table = g_atomic_pointer_get (&registry);
+
+  return g_hash_table_lookup (table->by_name, encoding_name);
+}
+
+/**
+ * gst_rtp_parameters_register:
+ * @pt: the static payload type, or -1 for a dynamic one
+ * @encoding_name: the encoding name
+ * @media: "audio", "video" or "application"
+ * @clock_rate: the RTP clock rate, 0 when it is not fixed
+ *
+ * Add @encoding_name or replace the parameters it had. The change is
+ * made on a copy of the index that then replaces it, so lookups never
+ * wait. Only called through gst_rtp_parameters_load().
+ */
+void
+gst_rtp_parameters_register (gint pt, const gchar * encoding_name,
+    const gchar * media, gint clock_rate)
+{
+  RtpParametersTable *table, *old;
+  GHashTableIter iter;
+  gpointer key, value;
+  RtpParameters *p;
+
+  g_return_if_fail (encoding_name != NULL);
+  g_return_if_fail (pt < (gint) G_N_ELEMENTS (table->by_pt));
+
+  gst_rtp_parameters_init ();
+
+  p = g_new0 (RtpParameters, 1);
+  p->pt = MAX (pt, 0);
+  p->encoding_name = g_intern_string (encoding_name);
+  p->media = g_intern_string (media ? media : "video");
+  p->clock_rate = clock_rate;
+
+  GST_INFO ("Registering %s, %s, clock-rate %d, pt %d", p->encoding_name,
+      p->media, p->clock_rate, pt);
+
+  g_mutex_lock (&registry_lock);
+  old = g_atomic_pointer_get (&registry);
+  table = g_new0 (RtpParametersTable, 1);
+  memcpy (table->by_pt, old->by_pt, sizeof (table->by_pt));
+  table->by_name = g_hash_table_new (g_str_hash, g_str_equal);
+  g_hash_table_iter_init (&iter, old->by_name);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    g_hash_table_insert (table->by_name, key, value);
+
+  gst_rtp_parameters_index (table, p, TRUE);
+  if (pt >= 0)
+    table->by_pt[pt] = p;
+  g_atomic_pointer_set (&registry, table);
+  retired = g_slist_prepend (retired, old);
+  g_mutex_unlock (&registry_lock);
+}
+
+/**
+ * gst_rtp_parameters_load:
+ * @path: a key file with a group per encoding name
+ * @error: return location for a #GError
+ *
+ * Register the encoding names of @path, see the top of this file.
+ *
+ * Returns: FALSE if @path could not be read
+ */
+gboolean
+gst_rtp_parameters_load (const gchar * path, GError ** error)
+{
+  GKeyFile *file;
+  gchar **groups, **group;
+
+  gst_rtp_parameters_init ();
+
+  file = g_key_file_new ();
+  if (!g_key_file_load_from_file (file, path, G_KEY_FILE_NONE, error)) {
+    g_key_file_free (file);
+    return FALSE;
+  }
+
+  groups = g_key_file_get_groups (file, NULL);
+  for (group = groups; *group; group++) {
+    gchar *media = g_key_file_get_string (file, *group, "media", NULL);
+    gint clock_rate = g_key_file_get_integer (file, *group, "clock-rate",
+        NULL);
+    gint pt = g_key_file_has_key (file, *group, "payload", NULL) ?
+        g_key_file_get_integer (file, *group, "payload", NULL) : -1;
+
+    if (pt < 128)
+      gst_rtp_parameters_register (pt, *group, media, clock_rate);
+    else
+      GST_WARNING ("Ignoring %s, payload %d out of range", *group, pt);
+    g_free (media);
+  }
+  g_strfreev (groups);
+  g_key_file_free (file);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_parameters_rtx_pt:
+ * @rtx_pt: the rtx-pt of rtpsink and rtpsrc
+ * @pt: a media payload type
+ *
+ * Both ends derive the RFC 4588 payload type of each media payload type
+ * from rtx-pt: it is rtx-pt for 96 and for the static payload types, and
+ * rtx-pt + n for 96 + n.
+ *
+ * Returns: the retransmission payload type of @pt, 0 if out of range
+ */
+guint
+gst_rtp_parameters_rtx_pt (guint rtx_pt, guint pt)
+{
+  guint rtx = pt >= 96 ? rtx_pt + pt - 96 : rtx_pt;
+
+  return rtx_pt > 0 && rtx <= G_MAXINT8 && rtx != pt ? rtx : 0;
+}
@@ -19,7 +19,12 @@
 #include <stdio.h>
 
 #include "gstrtpsink.h"
+#include "gstrtpfec.h"
+#include "gstrtpmp2tpace.h"
 #include "gstbarcomgs_common.h"
+#include "gstrtplatencytracer.h"
+#include "gstrtppadstats.h"
+#include "gstrtpparameters.h"
 
 /* See:  https://bugzilla.gnome.org/show_bug.cgi?id=779765 */
 #ifndef HAVE_GST_OBJECT_SET_PROPERTIES_FROM_URI_QUERY_PARAMETERS
@@ -43,6 +48,34 @@ struct _GstRtpSink
   gint pt;
   gint src_port;
 
+  guint rtx_pt;
+  guint rtx_time;
+  guint rtx_max_packets;
+
+  GstRtpFecMode fec;
+  guint fec_columns;
+  guint fec_rows;
+  gboolean fec_row;
+  guint fec_pt;
+
+  gboolean burst;
+  guint burst_bitrate;
+
+  gboolean io_uring;
+
+  guint keyframe_request_interval;
+  guint64 keyframe_requests_received;
+  guint64 keyframe_requests_forwarded;
+
+  gboolean mp2t_pacing;
+
+  gchar *multicast_iface;
+  GstUri *redundant_uri;
+  gchar *redundant_multicast_iface;
+
+  guint stats_interval;
+  GstClockID stats_clock_id;
+
   GstElement *rtpbin;
 
   GMutex lock;
@@ -51,9 +84,29 @@ struct _GstRtpSink
 enum
 {
   PROP_0,
+  PROP_BURST,
+  PROP_BURST_BITRATE,
   PROP_CIDR,
+  PROP_FEC,
+  PROP_FEC_COLUMNS,
+  PROP_FEC_PT,
+  PROP_FEC_ROW,
+  PROP_FEC_ROWS,
+  PROP_IO_URING,
+  PROP_KEYFRAME_REQUEST_INTERVAL,
+  PROP_KEYFRAME_REQUESTS_FORWARDED,
+  PROP_KEYFRAME_REQUESTS_RECEIVED,
+  PROP_MP2T_PACING,
+  PROP_MULTICAST_IFACE,
   PROP_NPADS,
+  PROP_REDUNDANT_MULTICAST_IFACE,
+  PROP_REDUNDANT_URI,
+  PROP_RTX_MAX_PACKETS,
+  PROP_RTX_PT,
+  PROP_RTX_TIME,
   PROP_SRC_PORT,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
   PROP_TTL,
   PROP_TTL_MC,
   PROP_URI,
@@ -66,6 +119,32 @@ enum
 #define DEFAULT_PROP_TTL              (64)
 #define DEFAULT_PROP_TTL_MC           (8)
 #define DEFAULT_SRC_PORT              (0)
+#define DEFAULT_PROP_RTX_PT           (0)
+#define DEFAULT_PROP_RTX_TIME         (500)
+#define DEFAULT_PROP_RTX_MAX_PACKETS  (512)
+#define DEFAULT_PROP_FEC              GST_RTP_FEC_MODE_NONE
+#define DEFAULT_PROP_FEC_COLUMNS      (10)
+#define DEFAULT_PROP_FEC_ROWS         (10)
+#define DEFAULT_PROP_FEC_ROW          (TRUE)
+#define DEFAULT_PROP_FEC_PT           (127)
+#define DEFAULT_PROP_MULTICAST_IFACE  (NULL)
+#define DEFAULT_PROP_REDUNDANT_URI    (NULL)
+#define DEFAULT_PROP_BURST            (FALSE)
+#define DEFAULT_PROP_BURST_BITRATE    (20000)
+#define DEFAULT_PROP_KEYFRAME_REQUEST_INTERVAL (1000)
+#define DEFAULT_PROP_IO_URING         (FALSE)
+#define DEFAULT_PROP_MP2T_PACING      (FALSE)
+#define DEFAULT_PROP_STATS_INTERVAL   (0)
+
+/* Statistics of a sink pad, shared by the ghost pad and the probes that
+ * update them. The probes run in different threads when a pacer sits in
+ * between, so the counters are protected by lock */
+typedef struct
+{
+  gint refcount;
+  GMutex lock;
+  GstBarcoPadStats stats;
+} GstRtpSinkStats;
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink_%u",
     GST_PAD_SINK,
@@ -84,6 +163,20 @@ G_DEFINE_TYPE_WITH_CODE (GstRtpSink, gst_rtp_sink, GST_TYPE_BIN,
 #define GST_RTP_SINK_LOCK(obj) (g_mutex_lock (GST_RTP_SINK_GET_LOCK(obj)))
 #define GST_RTP_SINK_UNLOCK(obj) (g_mutex_unlock (GST_RTP_SINK_GET_LOCK(obj)))
 
+/* Elements of a send chain, stored on the rtpbin send pad */
+static const gchar *send_chain_keys[] = {
+  "rtpsink.rtp_sink",
+  "rtpsink.rtcp_sink",
+  "rtpsink.rtcp_src",
+  "rtpsink.fec_enc",
+  "rtpsink.fec_sink_0",
+  "rtpsink.fec_sink_1",
+  "rtpsink.redundant_tee",
+  "rtpsink.redundant_sink",
+  "rtpsink.burst",
+  "rtpsink.mp2t_pace",
+};
+
 static gboolean gst_rtp_sink_is_multicast (const gchar * ip_addr);
 static GstPad* gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name);
 
@@ -140,6 +233,20 @@ gst_rtp_sink_cleanup_send_chain(GstElement *self, GstPad* sinkpad)
   g_return_if_fail(sinkpad != NULL);
 
   parent = GST_ELEMENT(gst_pad_get_parent(sinkpad));
+
+  /* The MP2T pacer sits in front of the rtpbin send pad */
+  if (GST_IS_RTP_MP2T_PACE (parent)) {
+    GstPad *srcpad = gst_element_get_static_pad (parent, "src");
+    GstPad *peer = gst_pad_get_peer (srcpad);
+
+    gst_object_unref (srcpad);
+    gst_object_unref (parent);
+    if (peer == NULL)
+      return;
+    parent = GST_ELEMENT (gst_pad_get_parent (peer));
+    sinkpad = peer;
+    gst_object_unref (peer);
+  }
   GST_DEBUG_OBJECT(self, "Cleaning up element %" GST_PTR_FORMAT, parent);
 
   gst_element_release_request_pad (parent, sinkpad);
@@ -281,6 +388,7 @@ gst_rtp_sink_rtpbin_pad_removed_cb (GstElement * element,
   GstElement *sink = NULL;
   GstPad *peer = NULL;
   GstElement *parent = NULL;
+  guint i;
 
   GST_INFO_OBJECT(self, "Pad %" GST_PTR_FORMAT " was removed on %" GST_PTR_FORMAT, pad, element);
 
@@ -289,31 +397,15 @@ gst_rtp_sink_rtpbin_pad_removed_cb (GstElement * element,
 
   GST_INFO_OBJECT(self, "Pad %" GST_PTR_FORMAT ", linked to %" GST_PTR_FORMAT " was removed on %" GST_PTR_FORMAT, pad, peer, parent);
 
-  sink = g_object_get_data (G_OBJECT (pad), "rtpsink.rtp_sink");
-  if (GST_IS_ELEMENT(sink)){
-    gst_element_set_locked_state (sink, TRUE);
-    gst_element_set_state (sink, GST_STATE_NULL);
-    gst_bin_remove_many (GST_BIN_CAST (self), sink, NULL);
-
-    GST_INFO_OBJECT(self, "Removed element %" GST_PTR_FORMAT, sink);
-  }
-
-  sink = g_object_get_data (G_OBJECT (pad), "rtpsink.rtcp_sink");
-  if (GST_IS_ELEMENT(sink)){
-    gst_element_set_locked_state (sink, TRUE);
-    gst_element_set_state (sink, GST_STATE_NULL);
-    gst_bin_remove_many (GST_BIN_CAST (self), sink, NULL);
-
-    GST_INFO_OBJECT(self, "Removed element %" GST_PTR_FORMAT, sink);
-  }
-
-  sink = g_object_get_data (G_OBJECT (pad), "rtpsink.rtcp_src");
-  if (GST_IS_ELEMENT(sink)){
-    gst_element_set_locked_state (sink, TRUE);
-    gst_element_set_state (sink, GST_STATE_NULL);
-    gst_bin_remove_many (GST_BIN_CAST (self), sink, NULL);
+  for (i = 0; i < G_N_ELEMENTS (send_chain_keys); i++) {
+    sink = g_object_get_data (G_OBJECT (pad), send_chain_keys[i]);
+    if (GST_IS_ELEMENT(sink)){
+      gst_element_set_locked_state (sink, TRUE);
+      gst_element_set_state (sink, GST_STATE_NULL);
+      gst_bin_remove_many (GST_BIN_CAST (self), sink, NULL);
 
-    GST_INFO_OBJECT(self, "Removed element %" GST_PTR_FORMAT, sink);
+      GST_INFO_OBJECT(self, "Removed element %" GST_PTR_FORMAT, sink);
+    }
   }
 
   if (peer) gst_object_unref(peer);
@@ -422,6 +514,54 @@ gst_rtp_sink_rtp_bin_event (GstPad * pad, GstObject * parent, GstEvent * event)
 }
 
 
+/**
+ * gst_rtp_sink_keyframe_request_probe:
+ * @pad: the sink #GstGhostPad of a stream
+ * @info: the #GstPadProbeInfo with the upstream event
+ * @user_data: the current #GstRtpSink
+ *
+ * Every FIR/PLI of every receiver ends up as a force-key-unit event going
+ * upstream. After a glitch on a multicast stream all receivers ask at
+ * once; forward the first request to the encoder and drop the others for
+ * keyframe-request-interval, the keyframe answers them all.
+ *
+ * Returns: GST_PAD_PROBE_DROP for a request within the interval
+ */
+static GstPadProbeReturn
+gst_rtp_sink_keyframe_request_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSink *self = GST_RTP_SINK (user_data);
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+  const GstStructure *s;
+  gint64 now, *last;
+  gboolean forward;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CUSTOM_UPSTREAM)
+    return GST_PAD_PROBE_OK;
+  s = gst_event_get_structure (event);
+  if (!gst_structure_has_name (s, "GstForceKeyUnit"))
+    return GST_PAD_PROBE_OK;
+
+  now = g_get_monotonic_time ();
+  last = g_object_get_data (G_OBJECT (pad), "rtpsink.keyframe_request");
+
+  GST_OBJECT_LOCK (self);
+  self->keyframe_requests_received++;
+  forward = (*last == 0 ||
+      now - *last >= (gint64) self->keyframe_request_interval * 1000);
+  if (forward) {
+    *last = now;
+    self->keyframe_requests_forwarded++;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  GST_LOG_OBJECT (self, "Keyframe request on %" GST_PTR_FORMAT ", %s", pad,
+      forward ? "forwarding" : "dropping");
+
+  return forward ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+}
+
 /**
  * gst_rtp_sink_rtpbin_element_added:
  * @rtpbin: the #GstBin where the element was added in (#GstRtpBin)
@@ -445,42 +585,210 @@ gst_rtp_sink_rtpbin_element_added (GstBin* rtpbin,
 }
 
 /**
- * gst_rtp_sink_create_udp:
- * @self: The current #GstRtpSink objecta
- * @name: The name of the pad requested
+ * gst_rtp_sink_rtx_caps_probe:
+ * @pad: The sink pad of the rtprtxsend of a session
+ * @info: The #GstPadProbeInfo with the event
+ * @user_data: The current #GstRtpSink object
  *
- * When a pad is requested, the proper udpsink and udpsrc elements are
- * created on the same session.
- *
- * In order for RTP to work by passing the data through the same bin;
- * a number of udpsrc/udpsinks need to be created per media that is sent
- * out. While media can be fed through the same rtpbin in order to keep them
- * in the same session; each media sent should be sent on a different socket
- * (See RFC 3550).
+ * Add the payload type of new caps to the payload type map of the
+ * rtprtxsend, on the retransmission payload type
+ * gst_rtp_parameters_rtx_pt() gives it.
  *
- * Returns: (transfer full): The created #GstGhostPad on the current element
+ * Returns: GST_PAD_PROBE_OK
  */
-static GstPad*
-gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
+static GstPadProbeReturn
+gst_rtp_sink_rtx_caps_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
 {
-  GstElement *rtp_sink, *rtcp_sink, *rtcp_src;
+  GstRtpSink *self = GST_RTP_SINK (user_data);
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+  GstStructure *pt_map = NULL;
+  GstElement *rtx;
   GstCaps *caps;
-  GstUri *uri = gst_uri_copy(self->uri);
-  guint v=0;
+  gchar pt_str[4];
+  guint rtx_pt;
+  gint pt;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS)
+    return GST_PAD_PROBE_OK;
+
+  gst_event_parse_caps (event, &caps);
+  if (gst_caps_is_empty (caps) ||
+      !gst_structure_get_int (gst_caps_get_structure (caps, 0), "payload",
+          &pt))
+    return GST_PAD_PROBE_OK;
+
+  rtx_pt = gst_rtp_parameters_rtx_pt (self->rtx_pt, pt);
+  if (rtx_pt == 0) {
+    GST_WARNING_OBJECT (self, "No retransmission payload type for pt %d", pt);
+    return GST_PAD_PROBE_OK;
+  }
+
+  rtx = gst_pad_get_parent_element (pad);
+  if (rtx == NULL)
+    return GST_PAD_PROBE_OK;
+
+  g_object_get (G_OBJECT (rtx), "payload-type-map", &pt_map, NULL);
+  if (pt_map == NULL)
+    pt_map = gst_structure_new_empty ("application/x-rtp-pt-map");
+  g_snprintf (pt_str, sizeof (pt_str), "%d", pt);
+  if (!gst_structure_has_field (pt_map, pt_str)) {
+    GST_INFO_OBJECT (self, "Retransmitting pt %d on pt %u", pt, rtx_pt);
+    gst_structure_set (pt_map, pt_str, G_TYPE_UINT, rtx_pt, NULL);
+    g_object_set (G_OBJECT (rtx), "payload-type-map", pt_map, NULL);
+  }
+  gst_structure_free (pt_map);
+  gst_object_unref (rtx);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_rtp_sink_rtpbin_request_aux_sender_cb:
+ * @rtpbin: the #GstRtpBin requesting the auxiliary sender
+ * @sess_id: the session-id of the session
+ * @data: gpointer to the current #GstRtpSink object
+ *
+ * Wrap an rtprtxsend in a bin so that NACKed packets are retransmitted
+ * (RFC 4588). The history kept per SSRC is bounded both in time (rtx-time)
+ * and in packets (rtx-max-packets).
+ *
+ * The payload type map starts empty, each payload type negotiated on the
+ * session gets its own retransmission payload type when its caps come by.
+ *
+ * Returns: (transfer full): the auxiliary sender or %NULL when disabled
+ */
+static GstElement *
+gst_rtp_sink_rtpbin_request_aux_sender_cb (GstElement * rtpbin,
+    guint sess_id, gpointer data)
+{
+  GstRtpSink *self = GST_RTP_SINK (data);
+  GstElement *bin, *rtx;
+  GstStructure *pt_map;
   GstPad *pad;
-  const gchar* host = NULL;
+  gchar *name;
 
-  GST_DEBUG_OBJECT(self, "Hooking up UDP elements.");
+  if (self->rtx_pt == 0)
+    return NULL;
 
-  g_return_val_if_fail(self->uri, NULL);
+  GST_INFO_OBJECT (self, "Enabling retransmission on session %u (pt %u)",
+      sess_id, self->rtx_pt);
+
+  rtx = gst_element_factory_make ("rtprtxsend", NULL);
+  if (rtx == NULL) {
+    GST_WARNING_OBJECT (self, "rtprtxsend not available, no retransmission");
+    return NULL;
+  }
+
+  pt_map = gst_structure_new_empty ("application/x-rtp-pt-map");
+  g_object_set (G_OBJECT (rtx),
+      "payload-type-map", pt_map,
+      "max-size-time", self->rtx_time,
+      "max-size-packets", self->rtx_max_packets,
+      NULL);
+  gst_structure_free (pt_map);
+
+  bin = gst_bin_new (NULL);
+  gst_bin_add (GST_BIN (bin), rtx);
+
+  pad = gst_element_get_static_pad (rtx, "src");
+  name = g_strdup_printf ("src_%u", sess_id);
+  gst_element_add_pad (bin, gst_ghost_pad_new (name, pad));
+  g_free (name);
+  gst_object_unref (pad);
+
+  pad = gst_element_get_static_pad (rtx, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      gst_rtp_sink_rtx_caps_probe, self, NULL);
+  name = g_strdup_printf ("sink_%u", sess_id);
+  gst_element_add_pad (bin, gst_ghost_pad_new (name, pad));
+  g_free (name);
+  gst_object_unref (pad);
+
+  return bin;
+}
+
+/**
+ * gst_rtp_sink_create_fec:
+ * @self: The current #GstRtpSink object
+ * @host: the destination host of the stream
+ * @port: the destination RTP port of the stream
+ * @fec_sinks: (out): the column and row FEC udpsinks
+ *
+ * Create the FEC generator and the udpsinks for the column and row FEC
+ * streams. They are sent on the ports next to RTP and RTCP; as every pad
+ * uses a different host, ports do not collide between pads.
+ *
+ * Returns: (transfer none): the FEC generator, added to the bin
+ */
+static GstElement *
+gst_rtp_sink_create_fec (GstRtpSink *self, const gchar *host, gint port,
+    GstElement **fec_sinks)
+{
+  GstElement *fec_enc;
+  guint i;
+
+  fec_enc = gst_element_factory_make ("barcortpfecenc", NULL);
+  g_return_val_if_fail (fec_enc != NULL, NULL);
+
+  g_object_set (G_OBJECT (fec_enc),
+      "mode", self->fec,
+      "columns", self->fec_columns,
+      "rows", self->fec_rows,
+      "row", self->fec_row,
+      "pt", self->fec_pt,
+      NULL);
+  gst_bin_add (GST_BIN (self), fec_enc);
+
+  for (i = 0; i < 2; i++) {
+    gchar *fec_name = g_strdup_printf ("fec_%u", i);
+
+    fec_sinks[i] = gst_element_factory_make ("udpsink", NULL);
+    g_object_set (G_OBJECT (fec_sinks[i]),
+        "sync", FALSE,
+        "async", FALSE,
+        "ttl", self->ttl,
+        "ttl-mc", self->ttl_mc,
+        "host", host,
+        "port", port + (i == 0 ? GST_RTP_FEC_COLUMN_PORT_OFFSET :
+            GST_RTP_FEC_ROW_PORT_OFFSET),
+        "auto-multicast", FALSE,
+        NULL);
+    gst_bin_add (GST_BIN (self), fec_sinks[i]);
+
+    if (!gst_element_link_pads (fec_enc, fec_name, fec_sinks[i], "sink"))
+      GST_ERROR_OBJECT(self, "Problem linking up FEC data (%s).", fec_name);
+    g_free (fec_name);
+  }
+
+  GST_INFO_OBJECT (self, "Sending %ux%u FEC on ports %d and %d",
+      self->fec_columns, self->fec_rows,
+      port + GST_RTP_FEC_COLUMN_PORT_OFFSET, port + GST_RTP_FEC_ROW_PORT_OFFSET);
+
+  return fec_enc;
+}
+
+/**
+ * gst_rtp_sink_adjust_host:
+ * @self: The current #GstRtpSink object
+ * @uri: the destination of the pad being created
+ *
+ * Every pad sends to the next address: adjust the host of @uri to match
+ * with the CIDR notation.
+ *
+ * Returns: FALSE if @uri has no valid host
+ */
+static gboolean
+gst_rtp_sink_adjust_host (GstRtpSink *self, GstUri *uri)
+{
+  const gchar *host = gst_uri_get_host(uri);
+  guint v=0;
 
-  host = gst_uri_get_host(uri);
   if( host == NULL) {
     GST_ERROR_OBJECT(self, "Could not get a valid host.");
-    return NULL;
+    return FALSE;
   }
 
-  /* Adjust the URI to match with the CIDR notation */
   if (gst_barco_is_ipv4(uri)) {
     guint u[4];
 
@@ -501,7 +809,370 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
     }
   }
 
-  rtp_sink = gst_element_factory_make ("udpsink", NULL);
+  return TRUE;
+}
+
+/**
+ * gst_rtp_sink_create_redundant:
+ * @self: The current #GstRtpSink object
+ * @uri: the destination of the first path
+ * @rtp_sink: the udpsink of the first path
+ * @redundant_sink: (out): the udpsink of the second path
+ *
+ * Send the RTP data of a pad twice for SMPTE 2022-7: a tee hands the same
+ * buffers to the udpsink of each path, so the stream is only packetized
+ * once and nothing is copied. The second path goes to redundant-uri, or
+ * to the same destination over redundant-multicast-iface.
+ *
+ * Returns: (transfer none): the tee, added to the bin
+ */
+static GstElement *
+gst_rtp_sink_create_redundant (GstRtpSink *self, GstUri *uri,
+    GstElement *rtp_sink, GstElement **redundant_sink)
+{
+  GstUri *ruri;
+  GstElement *tee;
+  gint port;
+
+  if (self->redundant_uri) {
+    ruri = gst_uri_copy (self->redundant_uri);
+    if (!gst_rtp_sink_adjust_host (self, ruri)) {
+      gst_uri_unref (ruri);
+      return NULL;
+    }
+  } else {
+    ruri = gst_uri_ref (uri);
+  }
+
+  port = gst_uri_get_port (ruri);
+  if (port == GST_URI_NO_PORT)
+    port = gst_uri_get_port (uri);
+
+  tee = gst_element_factory_make ("tee", NULL);
+  *redundant_sink = gst_element_factory_make ("udpsink", NULL);
+  if (tee == NULL || *redundant_sink == NULL) {
+    gst_uri_unref (ruri);
+    g_return_val_if_reached (NULL);
+  }
+
+  /* one dead path must not stop the other */
+  g_object_set (G_OBJECT (tee), "allow-not-linked", TRUE, NULL);
+
+  g_object_set (G_OBJECT (*redundant_sink),
+      "async", FALSE,
+      "ttl", self->ttl,
+      "ttl-mc", self->ttl_mc,
+      "host", gst_uri_get_host (ruri),
+      "port", port,
+      "multicast-iface", self->redundant_multicast_iface ?
+          self->redundant_multicast_iface : self->multicast_iface,
+      "auto-multicast", TRUE,
+      NULL);
+
+  gst_bin_add_many (GST_BIN (self), tee, *redundant_sink, NULL);
+
+  if (!gst_element_link_pads (tee, "src_%u", rtp_sink, "sink") ||
+      !gst_element_link_pads (tee, "src_%u", *redundant_sink, "sink"))
+    GST_ERROR_OBJECT(self, "Problem linking up the redundant path.");
+
+  GST_INFO_OBJECT (self, "Sending redundant path to %s:%d",
+      gst_uri_get_host (ruri), port);
+  gst_uri_unref (ruri);
+
+  return tee;
+}
+
+static GstRtpSinkStats *
+gst_rtp_sink_stats_ref (GstRtpSinkStats * stats)
+{
+  g_atomic_int_inc (&stats->refcount);
+  return stats;
+}
+
+static void
+gst_rtp_sink_stats_unref (gpointer data)
+{
+  GstRtpSinkStats *stats = data;
+
+  if (g_atomic_int_dec_and_test (&stats->refcount)) {
+    g_mutex_clear (&stats->lock);
+    g_slice_free (GstRtpSinkStats, stats);
+  }
+}
+
+/**
+ * gst_rtp_sink_stats_foreach:
+ * @info: the packets through a pad
+ * @func: called for every packet
+ * @stats: the #GstBarcoPadStats of the pad
+ */
+static void
+gst_rtp_sink_stats_foreach (GstPadProbeInfo * info,
+    void (*func) (GstBarcoPadStats *, GstBuffer *), GstBarcoPadStats * stats)
+{
+  guint i, n;
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+    n = gst_buffer_list_length (list);
+    for (i = 0; i < n; i++)
+      func (stats, gst_buffer_list_get (list, i));
+  } else {
+    func (stats, GST_PAD_PROBE_INFO_BUFFER (info));
+  }
+}
+
+static void
+gst_rtp_sink_stats_add (GstBarcoPadStats * stats, GstBuffer * buffer)
+{
+  GstMapInfo map;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+  if (map.size >= 12) {
+    stats->ssrc = GST_READ_UINT32_BE (map.data + 8);
+    stats->pt = map.data[1] & 0x7f;
+  }
+  gst_barco_pad_stats_add (stats, map.data, map.size,
+      gst_util_get_timestamp ());
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+gst_rtp_sink_stats_sent (GstBarcoPadStats * stats, GstBuffer * buffer)
+{
+  GstMapInfo map;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+  gst_barco_pad_stats_sent (stats, map.data, map.size,
+      gst_util_get_timestamp ());
+  gst_buffer_unmap (buffer, &map);
+}
+
+/**
+ * gst_rtp_sink_stats_in_probe:
+ * @pad: The send pad of rtpbin
+ * @info: The packets to send
+ * @user_data: The #GstRtpSinkStats of the stream
+ */
+static GstPadProbeReturn
+gst_rtp_sink_stats_in_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSinkStats *stats = user_data;
+
+  g_mutex_lock (&stats->lock);
+  gst_rtp_sink_stats_foreach (info, gst_rtp_sink_stats_add, &stats->stats);
+  g_mutex_unlock (&stats->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_rtp_sink_stats_out_probe:
+ * @pad: The sink pad of the RTP sink
+ * @info: The packets handed to the socket
+ * @user_data: The #GstRtpSinkStats of the stream
+ */
+static GstPadProbeReturn
+gst_rtp_sink_stats_out_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSinkStats *stats = user_data;
+
+  g_mutex_lock (&stats->lock);
+  gst_rtp_sink_stats_foreach (info, gst_rtp_sink_stats_sent, &stats->stats);
+  g_mutex_unlock (&stats->lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_rtp_sink_get_stats:
+ * @self: The current #GstRtpSink object
+ *
+ * Returns: (transfer full): a GstRtpSinkStats structure with a
+ * GstRtpSinkStreamStats per sink pad
+ */
+static GstStructure *
+gst_rtp_sink_get_stats (GstRtpSink * self)
+{
+  GValue streams = G_VALUE_INIT;
+  GValue v = G_VALUE_INIT;
+  GstRtpSinkStats *stats;
+  GstStructure *s;
+  GList *l;
+
+  g_value_init (&streams, GST_TYPE_ARRAY);
+  GST_OBJECT_LOCK (self);
+  for (l = GST_ELEMENT (self)->sinkpads; l; l = l->next) {
+    stats = g_object_get_data (G_OBJECT (l->data), "rtpsink.stats");
+    if (stats == NULL)
+      continue;
+    g_value_init (&v, GST_TYPE_STRUCTURE);
+    g_mutex_lock (&stats->lock);
+    g_value_take_boxed (&v, gst_barco_pad_stats_to_structure (&stats->stats,
+            "GstRtpSinkStreamStats", GST_OBJECT_NAME (l->data)));
+    g_mutex_unlock (&stats->lock);
+    gst_value_array_append_and_take_value (&streams, &v);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  s = gst_structure_new_empty ("GstRtpSinkStats");
+  gst_structure_take_value (s, "streams", &streams);
+
+  return s;
+}
+
+/**
+ * gst_rtp_sink_stats_timeout:
+ *
+ * Post the statistics on the bus.
+ */
+static gboolean
+gst_rtp_sink_stats_timeout (GstClock * clock, GstClockTime time,
+    GstClockID id, gpointer user_data)
+{
+  GstRtpSink *self = GST_RTP_SINK (user_data);
+
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_rtp_sink_get_stats (self)));
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_sink_share_burst_socket:
+ * @rtpbin: the rtpbin
+ * @pad: a send_rtp_sink pad of @rtpbin
+ * @user_data: unused
+ *
+ * Hand the socket of the RTP sink to the burst server of the stream, so
+ * bursts come from the address of the stream. Shared memory has no RTP
+ * socket, the RTCP one is used. The sinks create their sockets when they
+ * start.
+ *
+ * Returns: TRUE to continue with the next pad
+ */
+static gboolean
+gst_rtp_sink_share_burst_socket (GstElement * rtpbin, GstPad * pad,
+    gpointer user_data)
+{
+  GstElement *burst = g_object_get_data (G_OBJECT (pad), "rtpsink.burst");
+  GstElement *rtp_sink;
+  GSocket *socket = NULL;
+
+  if (burst == NULL)
+    return TRUE;
+
+  rtp_sink = g_object_get_data (G_OBJECT (pad), "rtpsink.rtp_sink");
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (rtp_sink),
+          "used-socket"))
+    g_object_get (G_OBJECT (rtp_sink), "used-socket", &socket, NULL);
+  if (socket == NULL)
+    g_object_get (g_object_get_data (G_OBJECT (pad), "rtpsink.rtcp_src"),
+        "used-socket", &socket, NULL);
+
+  g_object_set (G_OBJECT (burst), "socket", socket, NULL);
+  if (socket)
+    g_object_unref (socket);
+
+  return TRUE;
+}
+
+static GstStateChangeReturn
+gst_rtp_sink_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpSink *self = GST_RTP_SINK (element);
+  GstStateChangeReturn ret;
+  GstClock *clock;
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY &&
+      self->stats_clock_id) {
+    gst_clock_id_unschedule (self->stats_clock_id);
+    gst_clock_id_unref (self->stats_clock_id);
+    self->stats_clock_id = NULL;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED)
+    gst_element_foreach_sink_pad (self->rtpbin,
+        gst_rtp_sink_share_burst_socket, NULL);
+
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED &&
+      self->stats_interval > 0) {
+    clock = gst_system_clock_obtain ();
+    self->stats_clock_id = gst_clock_new_periodic_id (clock,
+        gst_clock_get_time (clock) + self->stats_interval * GST_MSECOND,
+        self->stats_interval * GST_MSECOND);
+    gst_clock_id_wait_async (self->stats_clock_id,
+        gst_rtp_sink_stats_timeout, self, NULL);
+    gst_object_unref (clock);
+  }
+
+  return ret;
+}
+
+/**
+ * gst_rtp_sink_create_udp:
+ * @self: The current #GstRtpSink objecta
+ * @name: The name of the pad requested
+ *
+ * When a pad is requested, the proper udpsink and udpsrc elements are
+ * created on the same session.
+ *
+ * In order for RTP to work by passing the data through the same bin;
+ * a number of udpsrc/udpsinks need to be created per media that is sent
+ * out. While media can be fed through the same rtpbin in order to keep them
+ * in the same session; each media sent should be sent on a different socket
+ * (See RFC 3550).
+ *
+ * Returns: (transfer full): The created #GstGhostPad on the current element
+ */
+static GstPad*
+gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
+{
+  GstElement *rtp_sink, *rtcp_sink, *rtcp_src;
+  GstElement *rtp_head, *fec_enc = NULL;
+  GstElement *fec_sinks[2] = { NULL, NULL };
+  GstCaps *caps;
+  GstElement *redundant_tee = NULL, *redundant_sink = NULL;
+  GstElement *burst = NULL, *rtcp_head;
+  GstElement *mp2t_pace = NULL;
+  GstRtpSinkStats *stats;
+  GstUri *uri = gst_uri_copy(self->uri);
+  GstPad *pad, *target;
+  const gchar* host = NULL;
+  gboolean uring = FALSE;
+
+  GST_DEBUG_OBJECT(self, "Hooking up UDP elements.");
+
+  g_return_val_if_fail(self->uri, NULL);
+
+  if (!gst_rtp_sink_adjust_host (self, uri)) {
+    gst_uri_unref (uri);
+    return NULL;
+  }
+  host = gst_uri_get_host(uri);
+
+  /* rtp+shm:// hands the RTP packets to a receiver on the same host
+   * through shared memory; RTCP, FEC and bursts stay on UDP */
+  if (gst_barco_is_shm (uri))
+    rtp_sink = gst_element_factory_make ("shmsink", NULL);
+  else if (self->io_uring && gst_barco_uring_supported () &&
+      (rtp_sink = gst_element_factory_make ("barcortpuringsink", NULL)))
+    uring = TRUE;
+  else {
+    if (self->io_uring)
+      GST_WARNING_OBJECT(self, "No io_uring support, sending with udpsink.");
+    rtp_sink = gst_element_factory_make ("udpsink", NULL);
+  }
   rtcp_sink = gst_element_factory_make ("udpsink", NULL);
   rtcp_src = gst_element_factory_make ("udpsrc", NULL);
 
@@ -513,14 +1184,42 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
 
   /* Set properties */
   GST_DEBUG_OBJECT(self, "Configuring the RTP/RTCP sink elements.");
-  g_object_set (G_OBJECT (rtp_sink),
-      "async", FALSE,
-      "ttl", self->ttl,
-      "ttl-mc", self->ttl_mc,
-      "host", host,
-      "port", gst_uri_get_port(uri),
-      "auto-multicast", TRUE,
-      NULL);
+  if (gst_barco_is_shm (uri)) {
+    gchar *path = gst_barco_shm_socket_path (uri, self->npads);
+
+    /* the payloader allocates from the shared memory, so the packets are
+     * not copied on the way to the receiver */
+    GST_DEBUG_OBJECT(self, "Sending RTP through shared memory on %s.", path);
+    g_object_set (G_OBJECT (rtp_sink),
+        "async", FALSE,
+        "socket-path", path,
+        "wait-for-connection", FALSE,
+        NULL);
+    g_free (path);
+  } else if (uring) {
+    g_object_set (G_OBJECT (rtp_sink),
+        "async", FALSE,
+        "ttl", self->ttl,
+        "ttl-mc", self->ttl_mc,
+        "host", host,
+        "port", gst_uri_get_port(uri),
+        "bind-port", self->src_port,
+        "multicast-iface", self->multicast_iface,
+        NULL);
+  } else {
+    g_object_set (G_OBJECT (rtp_sink),
+        "async", FALSE,
+        "ttl", self->ttl,
+        "ttl-mc", self->ttl_mc,
+        "host", host,
+        "port", gst_uri_get_port(uri),
+        "multicast-iface", self->multicast_iface,
+        "auto-multicast", TRUE,
+        NULL);
+    if (self->src_port > 0)
+      xgst_barco_set_supported_parameter (rtp_sink, "bind-port",
+          self->src_port);
+  }
 
   /* auto-multicast should be set to false as rtcp_src will already
    * join the multicast group */
@@ -553,6 +1252,55 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
       "caps", caps, "auto-multicast", TRUE, NULL);
   gst_caps_unref (caps);
 
+  /* The RTP data from rtpbin goes to the head of the send chain */
+  rtp_head = rtp_sink;
+  if (gst_barco_is_shm (uri) &&
+      (self->redundant_uri || self->redundant_multicast_iface)) {
+    GST_WARNING_OBJECT(self, "No redundant path for shared memory.");
+  } else if (self->redundant_uri || self->redundant_multicast_iface) {
+    redundant_tee = gst_rtp_sink_create_redundant (self, uri, rtp_sink,
+        &redundant_sink);
+    if (redundant_tee)
+      rtp_head = redundant_tee;
+    else
+      GST_ERROR_OBJECT(self, "Problem setting up redundancy, sending without.");
+  }
+
+  if (self->fec != GST_RTP_FEC_MODE_NONE) {
+    fec_enc = gst_rtp_sink_create_fec (self, host, gst_uri_get_port(uri),
+        fec_sinks);
+    if (fec_enc && gst_element_link_pads (fec_enc, "src", rtp_head, "sink"))
+      rtp_head = fec_enc;
+    else
+      GST_ERROR_OBJECT(self, "Problem setting up FEC, sending without.");
+  }
+
+  /* The burst server caches the media packets before FEC and taps the
+   * RTCP of the receivers for their requests */
+  rtcp_head = rtcp_src;
+  if (self->burst) {
+    burst = gst_element_factory_make ("barcortpburst", NULL);
+    if (burst) {
+      gint rtcp_port;
+
+      /* receivers listen on the ports the stream is sent to */
+      g_object_get (G_OBJECT (rtcp_sink), "port", &rtcp_port, NULL);
+      g_object_set (G_OBJECT (burst),
+          "bitrate", self->burst_bitrate,
+          "rtp-port", gst_uri_get_port(uri),
+          "rtcp-port", rtcp_port,
+          NULL);
+      gst_bin_add (GST_BIN (self), burst);
+    }
+    if (burst && gst_element_link_pads (burst, "src", rtp_head, "sink") &&
+        gst_element_link_pads (rtcp_src, "src", burst, "rtcp_sink")) {
+      rtp_head = burst;
+      rtcp_head = burst;
+    } else {
+      GST_ERROR_OBJECT(self, "Problem setting up burst-on-join, sending without.");
+    }
+  }
+
   {
     /* Link the UDP sources and sinks to the RTP bin element. This should
        be done for each stream that is added while only using one single
@@ -574,7 +1322,7 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
      * It looks as if that this link can only be used when a pad is
      * spawned; the link up will be a bit later as a result. */
     lname = g_strdup_printf ("send_rtp_src_%d", self->npads);
-    if (!gst_element_link_pads (self->rtpbin, lname, rtp_sink, "sink"))
+    if (!gst_element_link_pads (self->rtpbin, lname, rtp_head, "sink"))
       GST_ERROR_OBJECT(self, "Problem linking up outgoing RTP data (%s).", lname);
     g_free(lname);
 
@@ -592,7 +1340,8 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
 
     /* Link up the udpsrc incoming RTCP data to the RTCP control sink bin */
     lname = g_strdup_printf ("recv_rtcp_sink_%d", self->npads);
-    if (!gst_element_link_pads (rtcp_src, "src", self->rtpbin, lname))
+    if (!gst_element_link_pads (rtcp_head,
+            rtcp_head == burst ? "rtcp_src" : "src", self->rtpbin, lname))
       GST_ERROR_OBJECT(self, "Problem linking up incoming RTCP data (%s).", lname);
     g_free(lname);
   }
@@ -603,6 +1352,45 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
   if(!gst_element_sync_state_with_parent (rtp_sink))
     GST_ERROR_OBJECT (self, "Could not set RTP sink to playing.");
 
+  if (redundant_tee) {
+    if (!gst_element_sync_state_with_parent (redundant_sink) ||
+        !gst_element_sync_state_with_parent (redundant_tee))
+      GST_ERROR_OBJECT (self, "Could not set redundant path to playing.");
+  }
+
+  if (fec_enc) {
+    if (!gst_element_sync_state_with_parent (fec_sinks[0]) ||
+        !gst_element_sync_state_with_parent (fec_sinks[1]) ||
+        !gst_element_sync_state_with_parent (fec_enc))
+      GST_ERROR_OBJECT (self, "Could not set FEC elements to playing.");
+  }
+
+  if (burst && !gst_element_sync_state_with_parent (burst))
+    GST_ERROR_OBJECT (self, "Could not set burst server to playing.");
+
+  /* The MP2T pacer holds the TS packets until their PCR time, the RTP
+   * sink syncing on the clock sends them out at the rate of the mux */
+  target = gst_object_ref (pad);
+  if (self->mp2t_pacing) {
+    mp2t_pace = gst_element_factory_make ("barcortpmp2tpace", NULL);
+    if (mp2t_pace) {
+      GstPad *srcpad;
+
+      gst_bin_add (GST_BIN (self), mp2t_pace);
+      srcpad = gst_element_get_static_pad (mp2t_pace, "src");
+      if (gst_pad_link (srcpad, pad) == GST_PAD_LINK_OK &&
+          gst_element_sync_state_with_parent (mp2t_pace)) {
+        gst_object_unref (target);
+        target = gst_element_get_static_pad (mp2t_pace, "sink");
+      } else {
+        GST_ERROR_OBJECT (self, "Problem setting up MP2T pacing, sending without.");
+        gst_bin_remove (GST_BIN (self), mp2t_pace);
+        mp2t_pace = NULL;
+      }
+      gst_object_unref (srcpad);
+    }
+  }
+
   /* First we update the state of rtcp_src so that it creates a socket and
    * binds on the port gst_uri_get_port(self->uri) + 1 */
   if (!gst_element_sync_state_with_parent (rtcp_src))
@@ -625,25 +1413,98 @@ gst_rtp_sink_create_udp (GstRtpSink *self, const gchar *name)
   g_object_set_data (G_OBJECT (pad), "rtpsink.rtp_sink", rtp_sink);
   g_object_set_data (G_OBJECT (pad), "rtpsink.rtcp_sink", rtcp_sink);
   g_object_set_data (G_OBJECT (pad), "rtpsink.rtcp_src", rtcp_src);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.fec_enc", fec_enc);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.fec_sink_0", fec_sinks[0]);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.fec_sink_1", fec_sinks[1]);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.redundant_tee", redundant_tee);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.redundant_sink", redundant_sink);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.burst", burst);
+  g_object_set_data (G_OBJECT (pad), "rtpsink.mp2t_pace", mp2t_pace);
+
+  /* the sinks only have their sockets when already started */
+  gst_rtp_sink_share_burst_socket (self->rtpbin, pad, NULL);
+
+  /* The packets are counted going into rtpbin, after the pacer, and timed
+   * until they reach the RTP sink */
+  stats = g_slice_new0 (GstRtpSinkStats);
+  stats->refcount = 1;
+  g_mutex_init (&stats->lock);
+  gst_barco_pad_stats_init (&stats->stats, 0);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST, gst_rtp_sink_stats_in_probe,
+      gst_rtp_sink_stats_ref (stats), gst_rtp_sink_stats_unref);
+
+  /* The stages of the barcortplatency tracer */
+  {
+    gchar *lname = g_strdup_printf ("send_rtp_src_%d", self->npads);
+    GstPad *srcpad = gst_element_get_static_pad (self->rtpbin, lname);
+
+    if (srcpad) {
+      gst_barco_latency_mark_pad (srcpad, GST_ELEMENT (self),
+          GST_BARCO_LATENCY_RTPBIN);
+      gst_object_unref (srcpad);
+    }
+    g_free (lname);
+  }
+
+  /* Every path hands the packets to a socket: the latency is that of the
+   * first path to send a packet, and every path counts what it sent */
   {
-    GstPad *ghost;
+    GstElement *path_sinks[2] = { rtp_sink,
+      redundant_tee ? redundant_sink : NULL };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (path_sinks) && path_sinks[i]; i++) {
+      GstPad *sinkpad = gst_element_get_static_pad (path_sinks[i], "sink");
+      GstPad *peer = gst_pad_get_peer (sinkpad);
+
+      gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER |
+          GST_PAD_PROBE_TYPE_BUFFER_LIST, gst_rtp_sink_stats_out_probe,
+          gst_rtp_sink_stats_ref (stats), gst_rtp_sink_stats_unref);
+      if (peer) {
+        gst_barco_latency_mark_pad (peer, GST_ELEMENT (self),
+            GST_BARCO_LATENCY_SEND);
+        gst_object_unref (peer);
+      }
+      gst_object_unref (sinkpad);
+    }
+  }
+
+  {
+    GstPad *ghost, *entry;
     GstPadTemplate *pad_tmpl;
 
     pad_tmpl = gst_static_pad_template_get (&sink_template);
-    ghost = gst_ghost_pad_new_from_template (name, pad, pad_tmpl);
+    ghost = gst_ghost_pad_new_from_template (name, target, pad_tmpl);
     gst_object_unref (pad_tmpl);
+    gst_object_unref(target);
     gst_object_unref(pad);
 
+    g_object_set_data_full (G_OBJECT (ghost), "rtpsink.keyframe_request",
+        g_new0 (gint64, 1), g_free);
+    g_object_set_data_full (G_OBJECT (ghost), "rtpsink.stats", stats,
+        gst_rtp_sink_stats_unref);
+    gst_pad_add_probe (ghost, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+        gst_rtp_sink_keyframe_request_probe, self, NULL);
+
+    /* the pacer renumbers the packets, they are timed from its output */
+    if (mp2t_pace)
+      entry = gst_element_get_static_pad (mp2t_pace, "src");
+    else
+      entry = GST_PAD (gst_proxy_pad_get_internal (GST_PROXY_PAD (ghost)));
+    gst_barco_latency_mark_pad (entry, GST_ELEMENT (self),
+        GST_BARCO_LATENCY_ENTRY);
+    gst_object_unref (entry);
+
     gst_pad_set_active(ghost, TRUE);
     gst_element_add_pad(GST_ELEMENT (self), ghost);
 
     /* Store last references. There are needed further on to link up the
      * new pads. */
-    GST_DEBUG_OBJECT(self, "Storing reference to %" GST_PTR_FORMAT, rtp_sink);
-    g_object_set_data (G_OBJECT (ghost), "rtpsink.rtp_sink", rtp_sink);
-    g_object_set_data (G_OBJECT (ghost), "rtpsink.rtp_uri", uri);
-
-    /*gst_uri_unref(uri);*/
+    GST_DEBUG_OBJECT(self, "Storing reference to %" GST_PTR_FORMAT, rtp_head);
+    g_object_set_data (G_OBJECT (ghost), "rtpsink.rtp_sink", rtp_head);
+    g_object_set_data_full (G_OBJECT (ghost), "rtpsink.rtp_uri", uri,
+        (GDestroyNotify) gst_uri_unref);
 
     return ghost;
   }
@@ -660,7 +1521,9 @@ gst_rtp_sink_uri_get_type (GType type)
 static const gchar *const *
 gst_rtp_sink_uri_get_protocols (GType type)
 {
-  static const gchar *protocols[] = { (char *) "rtp", NULL };
+  static const gchar *protocols[] = { (char *) "rtp", (char *) "rtp+shm",
+    NULL
+  };
 
   return protocols;
 }
@@ -738,6 +1601,37 @@ gst_rtp_sink_set_property (GObject * object, guint prop_id,
     case PROP_CIDR:
       self->cidr = g_value_get_uint (value);
       break;
+    case PROP_BURST:
+      self->burst = g_value_get_boolean (value);
+      break;
+    case PROP_BURST_BITRATE:
+      self->burst_bitrate = g_value_get_uint (value);
+      break;
+    case PROP_IO_URING:
+      self->io_uring = g_value_get_boolean (value);
+      break;
+    case PROP_KEYFRAME_REQUEST_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      self->keyframe_request_interval = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MP2T_PACING:
+      self->mp2t_pacing = g_value_get_boolean (value);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_free (self->multicast_iface);
+      self->multicast_iface = g_value_dup_string (value);
+      break;
+    case PROP_REDUNDANT_URI:
+      if (self->redundant_uri)
+        gst_uri_unref (self->redundant_uri);
+      self->redundant_uri = g_value_get_string (value) ?
+          gst_uri_from_string (g_value_get_string (value)) : NULL;
+      break;
+    case PROP_REDUNDANT_MULTICAST_IFACE:
+      g_free (self->redundant_multicast_iface);
+      self->redundant_multicast_iface = g_value_dup_string (value);
+      break;
     case PROP_TTL:
       self->ttl = g_value_get_int (value);
       break;
@@ -747,6 +1641,35 @@ gst_rtp_sink_set_property (GObject * object, guint prop_id,
     case PROP_SRC_PORT:
       self->src_port = g_value_get_int (value);
       break;
+    case PROP_STATS_INTERVAL:
+      self->stats_interval = g_value_get_uint (value);
+      break;
+    case PROP_RTX_PT:
+      self->rtx_pt = g_value_get_uint (value);
+      GST_DEBUG_OBJECT (self, "set rtx-pt: %u", self->rtx_pt);
+      break;
+    case PROP_RTX_TIME:
+      self->rtx_time = g_value_get_uint (value);
+      break;
+    case PROP_RTX_MAX_PACKETS:
+      self->rtx_max_packets = g_value_get_uint (value);
+      break;
+    case PROP_FEC:
+      self->fec = g_value_get_enum (value);
+      GST_DEBUG_OBJECT (self, "set fec: %d", self->fec);
+      break;
+    case PROP_FEC_COLUMNS:
+      self->fec_columns = g_value_get_uint (value);
+      break;
+    case PROP_FEC_ROWS:
+      self->fec_rows = g_value_get_uint (value);
+      break;
+    case PROP_FEC_ROW:
+      self->fec_row = g_value_get_boolean (value);
+      break;
+    case PROP_FEC_PT:
+      self->fec_pt = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -769,6 +1692,45 @@ gst_rtp_sink_get_property (GObject * object, guint prop_id,
     case PROP_CIDR:
       g_value_set_uint (value, self->cidr);
       break;
+    case PROP_BURST:
+      g_value_set_boolean (value, self->burst);
+      break;
+    case PROP_BURST_BITRATE:
+      g_value_set_uint (value, self->burst_bitrate);
+      break;
+    case PROP_IO_URING:
+      g_value_set_boolean (value, self->io_uring);
+      break;
+    case PROP_KEYFRAME_REQUEST_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->keyframe_request_interval);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_KEYFRAME_REQUESTS_RECEIVED:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->keyframe_requests_received);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_KEYFRAME_REQUESTS_FORWARDED:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->keyframe_requests_forwarded);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MP2T_PACING:
+      g_value_set_boolean (value, self->mp2t_pacing);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_value_set_string (value, self->multicast_iface);
+      break;
+    case PROP_REDUNDANT_URI:
+      if (self->redundant_uri)
+        g_value_take_string (value, gst_uri_to_string (self->redundant_uri));
+      else
+        g_value_set_string (value, NULL);
+      break;
+    case PROP_REDUNDANT_MULTICAST_IFACE:
+      g_value_set_string (value, self->redundant_multicast_iface);
+      break;
     case PROP_TTL:
       g_value_set_int (value, self->ttl);
       break;
@@ -778,9 +1740,39 @@ gst_rtp_sink_get_property (GObject * object, guint prop_id,
     case PROP_SRC_PORT:
       g_value_set_int (value, self->src_port);
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_rtp_sink_get_stats (self));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, self->stats_interval);
+      break;
     case PROP_NPADS:
       g_value_set_uint (value, self->npads);
       break;
+    case PROP_RTX_PT:
+      g_value_set_uint (value, self->rtx_pt);
+      break;
+    case PROP_RTX_TIME:
+      g_value_set_uint (value, self->rtx_time);
+      break;
+    case PROP_RTX_MAX_PACKETS:
+      g_value_set_uint (value, self->rtx_max_packets);
+      break;
+    case PROP_FEC:
+      g_value_set_enum (value, self->fec);
+      break;
+    case PROP_FEC_COLUMNS:
+      g_value_set_uint (value, self->fec_columns);
+      break;
+    case PROP_FEC_ROWS:
+      g_value_set_uint (value, self->fec_rows);
+      break;
+    case PROP_FEC_ROW:
+      g_value_set_boolean (value, self->fec_row);
+      break;
+    case PROP_FEC_PT:
+      g_value_set_uint (value, self->fec_pt);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -794,6 +1786,10 @@ gst_rtp_sink_finalize (GObject * gobject)
 
   if (self->uri)
     gst_uri_unref (self->uri);
+  if (self->redundant_uri)
+    gst_uri_unref (self->redundant_uri);
+  g_free (self->multicast_iface);
+  g_free (self->redundant_multicast_iface);
 
   g_mutex_clear (&self->lock);
   G_OBJECT_CLASS (parent_class)->finalize (gobject);
@@ -809,6 +1805,7 @@ gst_rtp_sink_class_init (GstRtpSinkClass * klass)
   oclass->get_property = gst_rtp_sink_get_property;
   oclass->finalize = gst_rtp_sink_finalize;
 
+  gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_rtp_sink_change_state);
   gstelement_class->request_new_pad = GST_DEBUG_FUNCPTR (gst_rtp_sink_request_new_pad);
   gstelement_class->release_pad = GST_DEBUG_FUNCPTR (gst_rtp_sink_release_pad);
 
@@ -818,6 +1815,9 @@ gst_rtp_sink_class_init (GstRtpSinkClass * klass)
    * uri to establish a stream to. All GStreamer parameters can be
    * encoded in the URI, this URI format is RFC compliant.
    *
+   * With rtp+shm://, the RTP packets go through shared memory to an
+   * rtpsrc on the same host while RTCP stays on UDP.
+   *
    * Since: 0.10.5
    */
   g_object_class_install_property (oclass, PROP_URI,
@@ -862,6 +1862,35 @@ gst_rtp_sink_class_init (GstRtpSinkClass * klass)
           0, 65535, DEFAULT_SRC_PORT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpSink::stats
+   *
+   * Statistics per sink pad: SSRC, payload type, packets, bytes, lost and
+   * reordered packets coming in, packets handed to the sockets, once per
+   * path with a redundant path, and the average and maximum time in ns
+   * from rtpbin to the first socket.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics of the sent streams", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::stats-interval
+   *
+   * Post the stats as a GstRtpSinkStats element message every interval
+   * in ms, 0 to never post them.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_STATS_INTERVAL,
+      g_param_spec_uint ("stats-interval", "Statistics interval",
+          "Interval in ms to post the stats on the bus (0 = never)",
+          0, G_MAXUINT, DEFAULT_PROP_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstRtpSink::cidr
    *
@@ -886,6 +1915,263 @@ gst_rtp_sink_class_init (GstRtpSinkClass * klass)
       g_param_spec_uint ("n-pads", "Number of sink pads",
           "Read the number of sink pads", 0, G_MAXUINT, 0, G_PARAM_READABLE));
 
+  /**
+   * GstRtpSink::rtx-pt
+   *
+   * Payload type used for RFC 4588 retransmission of NACKed packets of
+   * payload type 96 and of the static payload types. The retransmissions
+   * of payload type 96 + n use rtx-pt + n. Needs to be set before
+   * requesting pads.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RTX_PT,
+      g_param_spec_uint ("rtx-pt", "Retransmission payload type",
+          "Payload type for retransmissions (0 = disabled)", 0, G_MAXINT8,
+          DEFAULT_PROP_RTX_PT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::rtx-time
+   *
+   * Amount of ms of sent packets kept per SSRC for retransmission.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RTX_TIME,
+      g_param_spec_uint ("rtx-time", "Retransmission history time",
+          "Amount of ms to keep packets for retransmission (0 = unlimited)",
+          0, G_MAXUINT, DEFAULT_PROP_RTX_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::rtx-max-packets
+   *
+   * Upper bound on the retransmission history per SSRC, this keeps the
+   * memory use bounded for high bitrate streams.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RTX_MAX_PACKETS,
+      g_param_spec_uint ("rtx-max-packets", "Retransmission history size",
+          "Amount of packets to keep for retransmission (0 = unlimited)",
+          0, G_MAXUINT, DEFAULT_PROP_RTX_MAX_PACKETS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::burst
+   *
+   * Answer RFC 6285 rapid acquisition requests (RAMS-R) of receivers with
+   * a unicast burst of the packets since the last keyframe, so they can
+   * start decoding without waiting for the next one. The burst is sent on
+   * the socket of the stream to the RTCP address of the receiver, on its
+   * RTP port. Needs to be set before requesting pads.
+   *
+   * Off by default: a small request with a spoofed source address makes
+   * the sender send a whole GOP to that address. Requests have to name
+   * the SSRC of the stream and an address gets one burst per cooldown,
+   * only enable it where the receivers are trusted.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_BURST,
+      g_param_spec_boolean ("burst", "Burst on join",
+          "Send a burst from the last keyframe to joining receivers",
+          DEFAULT_PROP_BURST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::burst-bitrate
+   *
+   * Rate in kbit/s of a burst, above the stream bitrate so the receiver
+   * catches up with the live stream.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_BURST_BITRATE,
+      g_param_spec_uint ("burst-bitrate", "Burst bitrate",
+          "Rate of a burst in kbit/s", 1, G_MAXUINT,
+          DEFAULT_PROP_BURST_BITRATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::io-uring
+   *
+   * Send the RTP packets as linked sendmsg requests on io_uring instead
+   * of udpsink. Falls back to udpsink when the plugin was built without
+   * liburing or the kernel is older than 6.0. Needs to be set before
+   * requesting pads.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_IO_URING,
+      g_param_spec_boolean ("io-uring", "io_uring",
+          "Send RTP on io_uring when the kernel supports it",
+          DEFAULT_PROP_IO_URING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::keyframe-request-interval
+   *
+   * Keyframe requests (FIR/PLI) of all receivers of a stream are collapsed
+   * into at most one request to the encoder per interval in ms. 0 forwards
+   * every request.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KEYFRAME_REQUEST_INTERVAL,
+      g_param_spec_uint ("keyframe-request-interval",
+          "Keyframe request interval",
+          "Minimum time in ms between keyframe requests sent upstream",
+          0, G_MAXUINT, DEFAULT_PROP_KEYFRAME_REQUEST_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::keyframe-requests-received
+   *
+   * Number of keyframe requests received from the receivers.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KEYFRAME_REQUESTS_RECEIVED,
+      g_param_spec_uint64 ("keyframe-requests-received",
+          "Keyframe requests received",
+          "Number of keyframe requests received from the receivers",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::keyframe-requests-forwarded
+   *
+   * Number of keyframe requests sent upstream to the encoder.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KEYFRAME_REQUESTS_FORWARDED,
+      g_param_spec_uint64 ("keyframe-requests-forwarded",
+          "Keyframe requests forwarded",
+          "Number of keyframe requests sent upstream",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::fec
+   *
+   * Send XOR FEC next to every RTP stream: column FEC on port + 2, row
+   * FEC on port + 4. auto uses SMPTE 2022-1 for MP2T and FlexFEC for
+   * everything else. Needs to be set before requesting pads.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC,
+      g_param_spec_enum ("fec", "FEC", "FEC flavour to send",
+          GST_TYPE_RTP_FEC_MODE, DEFAULT_PROP_FEC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::fec-columns
+   *
+   * Number of columns (L) in the FEC matrix.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC_COLUMNS,
+      g_param_spec_uint ("fec-columns", "FEC columns",
+          "Number of columns (L) in the FEC matrix", 1,
+          GST_RTP_FEC_MAX_COLUMNS, DEFAULT_PROP_FEC_COLUMNS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::fec-rows
+   *
+   * Number of rows (D) in the FEC matrix, 0 disables column FEC.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC_ROWS,
+      g_param_spec_uint ("fec-rows", "FEC rows",
+          "Number of rows (D) in the FEC matrix (0 = no column FEC)", 0,
+          GST_RTP_FEC_MAX_ROWS, DEFAULT_PROP_FEC_ROWS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::fec-row
+   *
+   * Also send row FEC (2D FEC).
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC_ROW,
+      g_param_spec_boolean ("fec-row", "FEC row", "Send row FEC packets",
+          DEFAULT_PROP_FEC_ROW, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::fec-pt
+   *
+   * Payload type of the FEC packets, the last dynamic one by default so it
+   * does not clash with the media. A stream with the same payload type is
+   * sent without FEC.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC_PT,
+      g_param_spec_uint ("fec-pt", "FEC payload type",
+          "Payload type of FEC packets", 0, G_MAXINT8, DEFAULT_PROP_FEC_PT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::mp2t-pacing
+   *
+   * Send MPEG-TS (MP2T) streams at the rate of the PCRs in the mux instead
+   * of in the bursts the muxer pushes them. The TS packets are regrouped in
+   * RTP packets of 7 TS packets and held up to 100 ms. Other streams are
+   * not affected. Needs to be set before requesting pads.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MP2T_PACING,
+      g_param_spec_boolean ("mp2t-pacing", "MP2T pacing",
+          "Pace MPEG-TS streams on their PCR",
+          DEFAULT_PROP_MP2T_PACING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::multicast-iface
+   *
+   * Network interface to send the RTP data on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MULTICAST_IFACE,
+      g_param_spec_string ("multicast-iface", "Multicast interface",
+          "The network interface on which to send multicast",
+          DEFAULT_PROP_MULTICAST_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::redundant-uri
+   *
+   * Also send every pad to this destination (SMPTE 2022-7). The host is
+   * adjusted per pad the same way as for uri. Needs to be set before
+   * requesting pads.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_REDUNDANT_URI,
+      g_param_spec_string ("redundant-uri", "Redundant URI",
+          "URI of the second path of a SMPTE 2022-7 stream",
+          DEFAULT_PROP_REDUNDANT_URI,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink::redundant-multicast-iface
+   *
+   * Network interface to send the second path on. Without redundant-uri
+   * the second path goes to the same destination over this interface.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_REDUNDANT_MULTICAST_IFACE,
+      g_param_spec_string ("redundant-multicast-iface",
+          "Redundant multicast interface",
+          "The network interface on which to send the second path",
+          DEFAULT_PROP_MULTICAST_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&sink_template));
 
@@ -918,6 +2204,25 @@ gst_rtp_sink_init (GstRtpSink * self)
   self->ttl = DEFAULT_PROP_TTL;
   self->ttl_mc = DEFAULT_PROP_TTL_MC;
   self->src_port = DEFAULT_SRC_PORT;
+  self->rtx_pt = DEFAULT_PROP_RTX_PT;
+  self->rtx_time = DEFAULT_PROP_RTX_TIME;
+  self->rtx_max_packets = DEFAULT_PROP_RTX_MAX_PACKETS;
+  self->fec = DEFAULT_PROP_FEC;
+  self->fec_columns = DEFAULT_PROP_FEC_COLUMNS;
+  self->fec_rows = DEFAULT_PROP_FEC_ROWS;
+  self->fec_row = DEFAULT_PROP_FEC_ROW;
+  self->fec_pt = DEFAULT_PROP_FEC_PT;
+  self->burst = DEFAULT_PROP_BURST;
+  self->burst_bitrate = DEFAULT_PROP_BURST_BITRATE;
+  self->io_uring = DEFAULT_PROP_IO_URING;
+  self->keyframe_request_interval = DEFAULT_PROP_KEYFRAME_REQUEST_INTERVAL;
+  self->keyframe_requests_received = 0;
+  self->keyframe_requests_forwarded = 0;
+  self->mp2t_pacing = DEFAULT_PROP_MP2T_PACING;
+  self->stats_interval = DEFAULT_PROP_STATS_INTERVAL;
+  self->multicast_iface = DEFAULT_PROP_MULTICAST_IFACE;
+  self->redundant_uri = NULL;
+  self->redundant_multicast_iface = DEFAULT_PROP_MULTICAST_IFACE;
   g_mutex_init (&self->lock);
 
   {
@@ -941,6 +2246,8 @@ gst_rtp_sink_init (GstRtpSink * self)
         G_CALLBACK (gst_rtp_sink_rtpbin_pad_removed_cb), self);
     g_signal_connect (self->rtpbin, "element-added",
         G_CALLBACK (gst_rtp_sink_rtpbin_element_added), self);
+    g_signal_connect (self->rtpbin, "request-aux-sender",
+        G_CALLBACK (gst_rtp_sink_rtpbin_request_aux_sender_cb), self);
 
     g_object_set (G_OBJECT (self->rtpbin),
         "rtp-profile", 2, /* GST_RTP_PROFILE_AVPF */
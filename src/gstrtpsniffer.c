@@ -0,0 +1,321 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpsniffer
+ *
+ * \brief Guess of the encoding of an RTP stream from its payloads
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include "gstrtpsniffer.h"
+#include "gstrtppacket.h"
+
+/* Candidates of the sniffer, in the order they are tried */
+enum
+{
+  GST_BARCO_SNIFF_MP2T,
+  GST_BARCO_SNIFF_H265,
+  GST_BARCO_SNIFF_H264,
+  GST_BARCO_SNIFF_VP8,
+  GST_BARCO_SNIFF_VP9,
+  GST_BARCO_SNIFF_OPUS,
+  GST_BARCO_SNIFF_MP4V,
+  GST_BARCO_SNIFF_LAST
+};
+
+static const gchar *sniff_names[GST_BARCO_SNIFF_LAST] = {
+  "MP2T", "H265", "H264", "VP8", "VP9", "OPUS", "MP4V-ES"
+};
+
+/* Packets that have to agree on a candidate without a sure sign of it */
+#define GST_BARCO_SNIFF_HITS          (3)
+/* Packets after which the sniffer gives up */
+#define GST_BARCO_SNIFF_PACKETS       (32)
+
+static gboolean
+gst_barco_sniff_mp2t (const guint8 * p, gsize len)
+{
+  gsize i;
+
+  if (len == 0 || len % 188)
+    return FALSE;
+  for (i = 0; i < len; i += 188)
+    if (p[i] != 0x47)
+      return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gst_barco_sniff_h264_nal (guint8 header)
+{
+  guint8 type = header & 0x1f;
+
+  if ((header & 0x80) || type == 0 || type > 23)
+    return FALSE;
+  /* IDR slices and parameter sets are always referenced, SEI, AUD and
+   * the end and filler NALs never */
+  if (type == 5 || type == 7 || type == 8)
+    return (header & 0x60) != 0;
+  if (type == 6 || (type >= 9 && type <= 12))
+    return (header & 0x60) == 0;
+
+  return TRUE;
+}
+
+static gboolean
+gst_barco_sniff_h264 (const guint8 * p, gsize len, gboolean * sure)
+{
+  static const guint8 profiles[] = { 44, 66, 77, 83, 86, 88, 100, 110, 118,
+    122, 128, 134, 135, 138, 139, 244
+  };
+  gsize i, size;
+
+  if (len < 2 || (p[0] & 0x80))
+    return FALSE;
+
+  switch (p[0] & 0x1f) {
+    case 24:                   /* STAP-A */
+      if (len < 4)
+        return FALSE;
+      size = GST_READ_UINT16_BE (p + 1);
+      return size > 0 && 3 + size <= len && gst_barco_sniff_h264_nal (p[3]);
+    case 28:                   /* FU-A */
+      return len > 2 && !(p[1] & 0x20) && (p[1] & 0xc0) != 0xc0 &&
+          gst_barco_sniff_h264_nal ((p[0] & 0x60) | (p[1] & 0x1f));
+    case 7:
+      for (i = 0; i < G_N_ELEMENTS (profiles); i++)
+        if (p[1] == profiles[i])
+          *sure = gst_barco_sniff_h264_nal (p[0]);
+      return *sure;
+    default:
+      return gst_barco_sniff_h264_nal (p[0]);
+  }
+}
+
+static gboolean
+gst_barco_sniff_h265_nal (const guint8 * p)
+{
+  guint8 type = (p[0] >> 1) & 0x3f;
+
+  /* base layer with a temporal id, VCL or non VCL types in use */
+  if ((p[0] & 0x81) || (p[1] & 0xf8) || (p[1] & 0x07) == 0)
+    return FALSE;
+
+  return type <= 9 || (type >= 16 && type <= 21) ||
+      (type >= 32 && type <= 40);
+}
+
+static gboolean
+gst_barco_sniff_h265 (const guint8 * p, gsize len, gboolean * sure)
+{
+  gsize size;
+
+  if (len < 3 || (p[0] & 0x81) || (p[1] & 0xf8) || (p[1] & 0x07) == 0)
+    return FALSE;
+
+  switch ((p[0] >> 1) & 0x3f) {
+    case 48:                   /* aggregation packet */
+      if (len < 6)
+        return FALSE;
+      size = GST_READ_UINT16_BE (p + 2);
+      return size > 1 && 4 + size <= len && gst_barco_sniff_h265_nal (p + 4);
+    case 49:                   /* fragmentation unit */
+      return (p[2] & 0xc0) != 0xc0 && (p[2] & 0x3f) <= 40;
+    case 32:                   /* VPS, SPS, PPS */
+    case 33:
+    case 34:
+      *sure = TRUE;
+      return TRUE;
+    default:
+      return gst_barco_sniff_h265_nal (p);
+  }
+}
+
+static gboolean
+gst_barco_sniff_vp8 (const guint8 * p, gsize len, gboolean * sure)
+{
+  gsize o = 1;
+
+  /* reserved bits of the payload descriptor */
+  if (len < 2 || (p[0] & 0x48))
+    return FALSE;
+
+  if (p[0] & 0x80) {
+    if (p[1] & 0x0f)
+      return FALSE;
+    o = 2;
+    if (p[1] & 0x80)
+      o += (len > o && (p[o] & 0x80)) ? 2 : 1;
+    if (p[1] & 0x40)
+      o++;
+    if (p[1] & 0x30)
+      o++;
+  }
+
+  /* the payload header and start code of the first partition */
+  if ((p[0] & 0x17) == 0x10) {
+    if (len < o + 3 || ((p[o] >> 1) & 0x07) > 3)
+      return FALSE;
+    if ((p[o] & 0x01) == 0) {
+      if (len < o + 6 || p[o + 3] != 0x9d || p[o + 4] != 0x01 ||
+          p[o + 5] != 0x2a)
+        return FALSE;
+      *sure = TRUE;
+    }
+  }
+
+  return len > o;
+}
+
+static gboolean
+gst_barco_sniff_vp9 (const guint8 * p, gsize len, gboolean * sure)
+{
+  gsize o = 1, i;
+
+  /* only keyframes starting without a scalability structure are sure
+   * enough, the descriptor alone says too little */
+  if (len < 2 || (p[0] & 0x0a) != 0x08)
+    return FALSE;
+
+  if (p[0] & 0x80)
+    o += (p[o] & 0x80) ? 2 : 1;
+  if (p[0] & 0x20)
+    o += (p[0] & 0x10) ? 1 : 2;
+  if ((p[0] & 0x50) == 0x50)
+    for (i = 0; i < 3 && o < len && (p[o++] & 0x01); i++);
+
+  /* frame marker, keyframe of profile 0-2 and the sync code */
+  if (len < o + 4 || (p[o] & 0xcc) != 0x80 || (p[o] & 0x30) == 0x30 ||
+      p[o + 1] != 0x49 || p[o + 2] != 0x83 || p[o + 3] != 0x42)
+    return FALSE;
+
+  *sure = TRUE;
+  return TRUE;
+}
+
+/* Duration in 48 kHz samples of an Opus packet from its TOC byte */
+static guint
+gst_barco_sniff_opus_duration (const guint8 * p, gsize len)
+{
+  static const guint silk[] = { 480, 960, 1920, 2880 };
+  static const guint celt[] = { 120, 240, 480, 960 };
+  guint config = p[0] >> 3, frames;
+
+  switch (p[0] & 0x03) {
+    case 0:
+      frames = 1;
+      break;
+    case 3:
+      frames = len > 1 ? p[1] & 0x3f : 0;
+      break;
+    default:
+      frames = 2;
+      break;
+  }
+
+  if (config < 12)
+    return frames * silk[config & 0x03];
+  if (config < 16)
+    return frames * silk[config & 0x01];
+  return frames * celt[config & 0x03];
+}
+
+/**
+ * gst_barco_sniffer_init:
+ * @sniffer: a #GstBarcoSniffer
+ */
+void
+gst_barco_sniffer_init (GstBarcoSniffer * sniffer)
+{
+  memset (sniffer, 0, sizeof (*sniffer));
+}
+
+/**
+ * gst_barco_sniffer_add:
+ * @sniffer: a #GstBarcoSniffer
+ * @data: an RTP packet of the payload type
+ * @size: the size of @data
+ *
+ * Look at the payload of one more packet. A sure sign of an encoding
+ * (MPEG-TS sync bytes, H.264 SPS, H.265 parameter sets, VP8 or VP9
+ * keyframe start codes) decides it at once, otherwise it is decided when
+ * the packets so far all fit one encoding only. Opus is told from the
+ * frame durations of its TOC bytes against the RTP timestamps.
+ *
+ * Returns: TRUE once the sniffer is done, @sniffer->encoding_name is the
+ * guess or NULL when there is none
+ */
+gboolean
+gst_barco_sniffer_add (GstBarcoSniffer * sniffer, const guint8 * data,
+    gsize size)
+{
+  const guint8 *p;
+  gsize len;
+  gboolean fits[GST_BARCO_SNIFF_LAST] = { FALSE, };
+  gboolean sure = FALSE;
+  guint32 ts;
+  gint i, best = -1, n = 0;
+
+  if (sniffer->done)
+    return TRUE;
+  if (!gst_barco_rtp_get_payload (data, size, &p, &len))
+    return FALSE;
+
+  ts = GST_READ_UINT32_BE (data + 4);
+  sniffer->packets++;
+
+  if (gst_barco_sniff_mp2t (p, len)) {
+    best = GST_BARCO_SNIFF_MP2T;
+  } else if (gst_barco_sniff_h265 (p, len, &sure) && sure) {
+    best = GST_BARCO_SNIFF_H265;
+  } else if (gst_barco_sniff_h264 (p, len, &sure) && sure) {
+    best = GST_BARCO_SNIFF_H264;
+  } else if (gst_barco_sniff_vp8 (p, len, &sure) && sure) {
+    best = GST_BARCO_SNIFF_VP8;
+  } else if (gst_barco_sniff_vp9 (p, len, &sure) && sure) {
+    best = GST_BARCO_SNIFF_VP9;
+  } else {
+    fits[GST_BARCO_SNIFF_H265] = gst_barco_sniff_h265 (p, len, &sure);
+    fits[GST_BARCO_SNIFF_H264] = gst_barco_sniff_h264 (p, len, &sure);
+    fits[GST_BARCO_SNIFF_VP8] = gst_barco_sniff_vp8 (p, len, &sure);
+    fits[GST_BARCO_SNIFF_MP4V] = len > 4 && p[0] == 0 && p[1] == 0 &&
+        p[2] == 1;
+  }
+
+  /* the previous packet lasted up to this one */
+  fits[GST_BARCO_SNIFF_OPUS] = sniffer->have_ts && ts != sniffer->ts &&
+      ts - sniffer->ts == sniffer->duration;
+  sniffer->have_ts = TRUE;
+  sniffer->ts = ts;
+  sniffer->duration = gst_barco_sniff_opus_duration (p, len);
+
+  for (i = 0; i < GST_BARCO_SNIFF_LAST; i++)
+    if (fits[i])
+      sniffer->hits[i]++;
+
+  if (best < 0) {
+    /* every packet fits the guess and no other */
+    for (i = 0; i < GST_BARCO_SNIFF_LAST; i++) {
+      if (sniffer->hits[i] >= GST_BARCO_SNIFF_HITS &&
+          sniffer->hits[i] + (i == GST_BARCO_SNIFF_OPUS) >= sniffer->packets) {
+        best = i;
+        n++;
+      }
+    }
+    if (n > 1)
+      best = -1;
+  }
+
+  if (best < 0 && sniffer->packets < GST_BARCO_SNIFF_PACKETS)
+    return FALSE;
+
+  sniffer->done = TRUE;
+  sniffer->encoding_name = best >= 0 ? sniff_names[best] : NULL;
+
+  return TRUE;
+}
@@ -0,0 +1,39 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/** \class gstrtpsniffer
+ *
+ * \brief Guess of the encoding of an RTP stream from its payloads
+ *
+ */
+
+#ifndef _GST_RTP_SNIFFER_H_
+#define _GST_RTP_SNIFFER_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstBarcoSniffer:
+ *
+ * Guess of the encoding of a dynamic payload type from its first packets,
+ * for streams without an encoding-name. Not thread safe, callers lock.
+ */
+typedef struct
+{
+  guint packets;
+  /* packets that fit each candidate encoding */
+  guint hits[8];
+  gboolean have_ts;
+  guint32 ts;
+  guint duration;
+
+  gboolean done;
+  const gchar *encoding_name;
+} GstBarcoSniffer;
+
+void gst_barco_sniffer_init (GstBarcoSniffer * sniffer);
+gboolean gst_barco_sniffer_add (GstBarcoSniffer * sniffer,
+    const guint8 * data, gsize size);
+
+G_END_DECLS
+#endif /* _GST_RTP_SNIFFER_H_ */
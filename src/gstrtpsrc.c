@@ -4,13 +4,24 @@
 #endif
 
 #include <gst/net/gstnet.h>
+#include <gst/sdp/sdp.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "gstrtpsrc.h"
 #include "gstrtpparameters.h"
 #include "gstbarcomgs_common.h"
+#include "gstrtpgopcache.h"
+#include "gstrtplatencytracer.h"
+#include "gstrtpmdi.h"
+#include "gstrtppacket.h"
+#include "gstrtppadstats.h"
+#include "gstrtpsniffer.h"
+#include "gstrtpfec.h"
 
 /* See:  https://bugzilla.gnome.org/show_bug.cgi?id=779765 */
 #ifndef HAVE_GST_OBJECT_SET_PROPERTIES_FROM_URI_QUERY_PARAMETERS
@@ -20,6 +31,8 @@
 GST_DEBUG_CATEGORY_STATIC (rtp_src_debug);
 #define GST_CAT_DEFAULT rtp_src_debug
 
+typedef struct _GstRtpSrcGroup GstRtpSrcGroup;
+
 struct _GstRtpSrc
 {
   GstBin parent_instance;
@@ -39,16 +52,134 @@ struct _GstRtpSrc
   gboolean enable_rtcp;
   guint16 ttl_mc;
 
+  guint rtx_pt;
+  /* the media payload type + 1 of each retransmission payload type */
+  guint8 rtx_apts[128];
+
+  GstRtpFecMode fec;
+  gboolean io_uring;
+  gchar *capture_iface;
+  gboolean kernel_timestamps;
+  guint mdi_interval;
+  guint mp2t_latency;
+
+  guint keyframe_request_interval;
+  guint keyframe_request_retries;
+
+  GstUri *redundant_uri;
+  gchar *redundant_multicast_iface;
+  guint redundant_max_skew;
+
   GstElement *rtp_src;
   GstElement *rtcp_src;
   GstElement *rtcp_sink;
   GstElement *rtpbin;
   GstElement *rtpheaderchange;
+  GstElement *rtx_receive;
+  GstElement *fec_dec;
+  GstElement *fec_src[2];
+  GstElement *redundant_src;
+  GstElement *merge;
+  GstElement *mp2t;
   GstCaps *caps;
+  gchar *sdp;
+  GHashTable *sdp_caps;
+  /* answers of the pt map, protected by the object lock, and their
+   * clock rates for the stats (atomic) */
+  GstCaps *pt_caps[128];
+  gint clock_rates[128];
+
+  gchar **standby_uris;
+  guint standby_cache_size;
+  GPtrArray *groups;
+  GstRtpSrcGroup *active_group;
+  GMutex group_lock;
 
   gint n_ptdemux_pads;
   gint n_rtpbin_pads;
-  GstPad *ghostpad;
+  gint no_more_pads;
+
+  GstBarcoMdi mdi;
+  GMutex mdi_lock;
+  GstClockID mdi_clock_id;
+
+  /* receive buffer tuning: bytes received in the interval (atomic), the
+   * size and the kernel drops last seen (object lock) */
+  guint rcvbuf_bytes;
+  gint rcvbuf_size;
+  gboolean rcvbuf_capped;
+  guint64 drops;
+  gulong rcvbuf_probe_id;
+  GstClockID rcvbuf_clock_id;
+
+  GstElement *rtp_queue;
+  guint stats_interval;
+  GstClockID stats_clock_id;
+
+  /* dynamic payload types 96-127 and their packets held back while
+   * sniffing, protected by the object lock */
+  GstBarcoSniffer sniffers[32];
+  GstBufferList *sniffed[32];
+};
+
+/* Counters of a stream, on the sink pad of its jitterbuffer. Refcounted,
+ * the pad data, the probe and a stats reader each hold a ref */
+typedef struct
+{
+  gint refcount;
+  GstRtpSrc *self;
+  gulong probe_id;
+  GstBarcoPadStats stats;
+} GstRtpSrcStreamStats;
+
+/* Keyframe request state of an rtpbin src pad, only touched from its
+ * streaming thread */
+typedef struct
+{
+  GstRtpSrc *self;
+  gchar *encoding_name;
+  gint64 last_request;
+  guint retries;
+  guint ssrc;
+  gboolean have_keyframe;
+} GstRtpSrcKeyframeRequest;
+
+/* A stream of a new SSRC waiting for a keyframe to take over the ghost
+ * pad of the stream it replaces. Refcounted, the blocking probe, the
+ * async call and the idle probe of the switch each hold a ref */
+typedef struct
+{
+  gint refcount;
+  GstRtpSrc *self;
+  GstPad *ghost;
+  GstPad *target;
+  gchar *encoding_name;
+  guint ssrc;
+  gint64 deadline;
+  /* the blocked rtpbin pad and its probe, set at the keyframe */
+  GstPad *pad;
+  gulong probe_id;
+} GstRtpSrcSwitch;
+
+/* Longest wait in us for a keyframe before switching anyway */
+#define GST_RTP_SRC_SWITCH_TIMEOUT    (2 * G_USEC_PER_SEC)
+
+/* A multicast group joined for fast channel change, only the packets of
+ * the active one are forwarded to rtpbin */
+struct _GstRtpSrcGroup
+{
+  GstRtpSrc *self;
+  GstElement *udpsrc;
+  GstElement *sink;
+
+  /* protected by lock, taken by the streaming thread of the group */
+  GMutex lock;
+  GstUri *uri;
+  GstBarcoGopCache cache;
+  /* the pt map of the group: the encoding-name of its uri, or the
+   * encodings sniffed from its dynamic payload types */
+  gchar *encoding_name;
+  GstBarcoSniffer sniffers[32];
 };
 
 enum
@@ -56,14 +187,36 @@ enum
   PROP_0,
   PROP_BUFFER_SIZE,
   PROP_CAPS,
+  PROP_CAPTURE_IFACE,
+  PROP_CC_ERRORS,
+  PROP_DROPS,
   PROP_ENABLE_RTCP,
   PROP_ENCODING_NAME,
+  PROP_FEC,
+  PROP_FEC_RECOVERED,
+  PROP_FEC_UNRECOVERABLE,
+  PROP_IO_URING,
+  PROP_KERNEL_TIMESTAMPS,
+  PROP_KEYFRAME_REQUEST_INTERVAL,
+  PROP_KEYFRAME_REQUEST_RETRIES,
   PROP_LATENCY,
+  PROP_MDI_INTERVAL,
+  PROP_MP2T_LATENCY,
   PROP_MULTICAST_IFACE,
+  PROP_PCR_JITTER,
   PROP_PT_CHANGE,
   PROP_PT_SELECT,
+  PROP_REDUNDANT_MAX_SKEW,
+  PROP_REDUNDANT_MULTICAST_IFACE,
+  PROP_REDUNDANT_URI,
+  PROP_RTX_PT,
+  PROP_SDP,
   PROP_SSRC_CHANGE,
   PROP_SSRC_SELECT,
+  PROP_STANDBY_CACHE_SIZE,
+  PROP_STANDBY_URIS,
+  PROP_STATS,
+  PROP_STATS_INTERVAL,
   PROP_TIMEOUT,
   PROP_URI,
   PROP_TTL_MC,
@@ -79,6 +232,27 @@ enum
 #define DEFAULT_PROP_MULTICAST_IFACE  (NULL)
 #define DEFAULT_PROP_TIMEOUT          (0)
 #define DEFAULT_PROP_TTL_MC           (1)
+#define DEFAULT_PROP_RTX_PT           (0)
+#define DEFAULT_PROP_FEC              GST_RTP_FEC_MODE_NONE
+#define DEFAULT_PROP_REDUNDANT_URI    (NULL)
+#define DEFAULT_PROP_REDUNDANT_MAX_SKEW (50)
+#define DEFAULT_PROP_KEYFRAME_REQUEST_INTERVAL (500)
+#define DEFAULT_PROP_KEYFRAME_REQUEST_RETRIES (3)
+#define DEFAULT_PROP_STANDBY_URIS     (NULL)
+#define DEFAULT_PROP_SDP              (NULL)
+#define DEFAULT_PROP_STANDBY_CACHE_SIZE (4 * 1024 * 1024)
+#define DEFAULT_PROP_IO_URING         (FALSE)
+#define DEFAULT_PROP_CAPTURE_IFACE    (NULL)
+#define DEFAULT_PROP_KERNEL_TIMESTAMPS (FALSE)
+#define DEFAULT_PROP_MDI_INTERVAL     (0)
+#define DEFAULT_MDI_CLOCK_RATE        (90000)
+#define DEFAULT_PROP_MP2T_LATENCY     (0)
+#define DEFAULT_PROP_STATS_INTERVAL   (0)
+
+/* Interval to check the kernel drops and resize the receive buffer, and
+ * the largest size it is grown to */
+#define GST_RTP_SRC_RCVBUF_INTERVAL   (GST_SECOND)
+#define GST_RTP_SRC_MAX_RCVBUF        (64 * 1024 * 1024)
 
 /* 0 size means just pass the buffer along */
 #define GST_RTPPTCHANGE_DEFAULT_PT_NUMBER (0)
@@ -111,6 +285,10 @@ static GstStateChangeReturn gst_rtp_src_change_state (GstElement * element,
     GstStateChange transition);
 static gboolean gst_rtp_src_is_multicast (const gchar * ip_addr);
 static GSocket *gst_rtp_src_retrieve_rtcpsrc_socket (GstRtpSrc * self);
+static void gst_rtp_src_remove_ssrc (GstRtpSrc * self, guint ssrc);
+static void gst_rtp_src_add_stats (GstRtpSrc * self, GstPad * pad,
+    guint clock_rate);
+static void gst_rtp_src_remove_stats (GstRtpSrc * self, guint ssrc);
 
 /**
  * gst_rtp_src_retrieve_rtcpsrc_socket:
@@ -136,6 +314,454 @@ gst_rtp_src_retrieve_rtcpsrc_socket (GstRtpSrc * self)
   return rtcpfd;
 }
 
+/**
+ * gst_rtp_src_request_keyframe:
+ * @pad: The rtpbin src pad of the stream
+ * @req: The #GstRtpSrcKeyframeRequest of @pad
+ *
+ * Send a force-key-unit event upstream, rtpsession turns it into a FIR
+ * or PLI for the SSRC of @pad. Requests closer together than
+ * keyframe-request-interval are dropped.
+ */
+static void
+gst_rtp_src_request_keyframe (GstPad * pad, GstRtpSrcKeyframeRequest * req)
+{
+  GstRtpSrc *self = req->self;
+  gint64 now = g_get_monotonic_time ();
+  GstEvent *event;
+
+  if (req->last_request != 0 && now - req->last_request <
+      (gint64) self->keyframe_request_interval * 1000)
+    return;
+  req->last_request = now;
+
+  GST_DEBUG_OBJECT (self, "Requesting keyframe on %" GST_PTR_FORMAT, pad);
+
+  event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstForceKeyUnit",
+          "all-headers", G_TYPE_BOOLEAN, TRUE, NULL));
+  gst_pad_send_event (pad, event);
+}
+
+/**
+ * gst_rtp_src_keyframe_probe:
+ * @pad: The rtpbin src pad of the stream
+ * @info: The #GstPadProbeInfo with the packet
+ * @user_data: The #GstRtpSrcKeyframeRequest of @pad
+ *
+ * Retry the keyframe request until a keyframe comes by, start over when
+ * the stream of @pad changes SSRC. The other streams of the session do not
+ * ask again when a source joins.
+ *
+ * Returns: GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn
+gst_rtp_src_keyframe_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrcKeyframeRequest *req = user_data;
+  GstRtpSrc *self = req->self;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstMapInfo map;
+  guint ssrc;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return GST_PAD_PROBE_OK;
+
+  ssrc = map.size >= 12 ? GST_READ_UINT32_BE (map.data + 8) : req->ssrc;
+  if (ssrc != req->ssrc) {
+    GST_DEBUG_OBJECT (self, "SSRC 0x%x took over %" GST_PTR_FORMAT, ssrc,
+        pad);
+    req->ssrc = ssrc;
+    req->have_keyframe = FALSE;
+    req->retries = self->keyframe_request_retries;
+    req->last_request = 0;
+    gst_rtp_src_request_keyframe (pad, req);
+  }
+
+  if (!req->have_keyframe) {
+    req->have_keyframe = gst_barco_rtp_is_keyframe (map.data, map.size,
+        req->encoding_name);
+    if (req->have_keyframe)
+      GST_DEBUG_OBJECT (self, "Got keyframe on %" GST_PTR_FORMAT, pad);
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  if (!req->have_keyframe && req->retries > 0 &&
+      g_get_monotonic_time () - req->last_request >=
+      (gint64) self->keyframe_request_interval * 1000) {
+    req->retries--;
+    gst_rtp_src_request_keyframe (pad, req);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+gst_rtp_src_keyframe_request_free (GstRtpSrcKeyframeRequest * req)
+{
+  g_free (req->encoding_name);
+  g_slice_free (GstRtpSrcKeyframeRequest, req);
+}
+
+/**
+ * gst_rtp_src_start_keyframe_requests:
+ * @self: The current #GstRtpSrc object
+ * @pad: The new rtpbin src pad
+ * @caps: (nullable): The caps of @pad
+ *
+ * Ask for a keyframe as soon as the stream shows up instead of waiting for
+ * the next one of the encoder.
+ */
+static void
+gst_rtp_src_start_keyframe_requests (GstRtpSrc * self, GstPad * pad,
+    GstCaps * caps)
+{
+  GstRtpSrcKeyframeRequest *req;
+  const gchar *encoding_name = self->encoding_name;
+  gulong probe_id;
+  guint ssrc = 0;
+  gint pt = 0;
+
+  if (self->keyframe_request_interval == 0 || !self->enable_rtcp)
+    return;
+
+  if (caps && !gst_caps_is_empty (caps)) {
+    GstStructure *s = gst_caps_get_structure (caps, 0);
+
+    if (gst_structure_get_string (s, "encoding-name"))
+      encoding_name = gst_structure_get_string (s, "encoding-name");
+    gst_structure_get_int (s, "payload", &pt);
+    gst_structure_get_uint (s, "ssrc", &ssrc);
+  }
+
+  req = g_slice_new0 (GstRtpSrcKeyframeRequest);
+  req->self = self;
+  req->encoding_name =
+      g_strdup (gst_barco_rtp_guess_encoding_name (pt, encoding_name));
+  req->retries = self->keyframe_request_retries;
+  req->ssrc = ssrc;
+
+  gst_rtp_src_request_keyframe (pad, req);
+  probe_id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      gst_rtp_src_keyframe_probe, req,
+      (GDestroyNotify) gst_rtp_src_keyframe_request_free);
+  g_object_set_data (G_OBJECT (pad), "rtpsrc.keyframe_probe",
+      GSIZE_TO_POINTER (probe_id));
+}
+
+/**
+ * gst_rtp_src_drop_probe:
+ * @pad: The old target of a ghost pad
+ * @info: The #GstPadProbeInfo with the packet
+ * @user_data: unused
+ *
+ * Keep the replaced stream quiet until it is cleaned up.
+ *
+ * Returns: GST_PAD_PROBE_DROP
+ */
+static GstPadProbeReturn
+gst_rtp_src_drop_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  return GST_PAD_PROBE_DROP;
+}
+
+/**
+ * gst_rtp_src_clear_ssrc:
+ * @element: The current #GstRtpSrc object
+ * @user_data: The old target #GstPad, its "rtpsrc.ssrc" is the stale SSRC
+ *
+ * Drop the jitterbuffer of the replaced SSRC instead of letting it time
+ * out. Runs outside the streaming threads, as it stops one of them.
+ */
+static void
+gst_rtp_src_clear_ssrc (GstElement * element, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (element);
+  GstPad *pad = GST_PAD (user_data);
+  guint ssrc = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (pad),
+          "rtpsrc.ssrc"));
+  GstElement *parent;
+
+  GST_INFO_OBJECT (self, "Clearing stale SSRC 0x%x", ssrc);
+  gst_rtp_src_remove_ssrc (self, ssrc);
+
+  /* with pt-change the old target is the src of a capsfilter */
+  parent = gst_pad_get_parent_element (pad);
+  if (parent && parent != self->rtpbin &&
+      GST_OBJECT_PARENT (parent) == GST_OBJECT (self)) {
+    gst_element_set_locked_state (parent, TRUE);
+    gst_element_set_state (parent, GST_STATE_NULL);
+    gst_bin_remove (GST_BIN (self), parent);
+  }
+  if (parent)
+    gst_object_unref (parent);
+}
+
+/**
+ * gst_rtp_src_remove_ssrc:
+ * @self: The current #GstRtpSrc object
+ * @ssrc: the SSRC to remove
+ *
+ * Free the jitterbuffer and the pads of @ssrc in rtpbin.
+ */
+static void
+gst_rtp_src_remove_ssrc (GstRtpSrc * self, guint ssrc)
+{
+  if (g_signal_lookup ("clear-ssrc", G_OBJECT_TYPE (self->rtpbin))) {
+    g_signal_emit_by_name (self->rtpbin, "clear-ssrc", 0, ssrc);
+  } else {
+    /* older rtpbin, only rtpssrcdemux has the action signal */
+    GstIterator *it = gst_bin_iterate_recurse (GST_BIN (self->rtpbin));
+    GValue data = { 0, };
+
+    while (gst_iterator_next (it, &data) == GST_ITERATOR_OK) {
+      GstElement *elem = g_value_get_object (&data);
+
+      if (g_signal_lookup ("clear-ssrc", G_OBJECT_TYPE (elem)))
+        g_signal_emit_by_name (elem, "clear-ssrc", ssrc);
+      g_value_unset (&data);
+    }
+    gst_iterator_free (it);
+  }
+}
+
+static GstRtpSrcSwitch *
+gst_rtp_src_switch_ref (GstRtpSrcSwitch * sw)
+{
+  g_atomic_int_inc (&sw->refcount);
+
+  return sw;
+}
+
+static void
+gst_rtp_src_switch_unref (GstRtpSrcSwitch * sw)
+{
+  if (!g_atomic_int_dec_and_test (&sw->refcount))
+    return;
+
+  gst_object_unref (sw->ghost);
+  gst_object_unref (sw->target);
+  g_free (sw->encoding_name);
+  g_slice_free (GstRtpSrcSwitch, sw);
+}
+
+/**
+ * gst_rtp_src_switch_retarget:
+ * @sw: The #GstRtpSrcSwitch
+ * @old_target: (nullable): The current target of the ghost pad, idle
+ *
+ * Mute @old_target, retarget the ghost pad and let the blocked keyframe
+ * of the new SSRC through.
+ */
+static void
+gst_rtp_src_switch_retarget (GstRtpSrcSwitch * sw, GstPad * old_target)
+{
+  GstRtpSrc *self = sw->self;
+  GstPad *pad = sw->pad;
+
+  GST_INFO_OBJECT (self, "Switching %" GST_PTR_FORMAT " to SSRC 0x%x",
+      sw->ghost, sw->ssrc);
+
+  if (old_target)
+    gst_pad_add_probe (old_target, GST_PAD_PROBE_TYPE_BUFFER,
+        gst_rtp_src_drop_probe, NULL, NULL);
+
+  gst_ghost_pad_set_target (GST_GHOST_PAD (sw->ghost), sw->target);
+  g_object_set_data (G_OBJECT (sw->target), "rtpsrc.ssrc",
+      GUINT_TO_POINTER (sw->ssrc));
+
+  if (old_target && old_target != sw->target)
+    gst_element_call_async (GST_ELEMENT (self), gst_rtp_src_clear_ssrc,
+        gst_object_ref (old_target), gst_object_unref);
+
+  sw->pad = NULL;
+  gst_pad_remove_probe (pad, sw->probe_id);
+  gst_object_unref (pad);
+}
+
+/**
+ * gst_rtp_src_switch_idle_probe:
+ * @pad: The old target of the ghost pad
+ * @info: The #GstPadProbeInfo
+ * @user_data: The #GstRtpSrcSwitch
+ *
+ * The old stream is between two pushes, it can be replaced without a
+ * packet of it going out after the keyframe of the new one.
+ *
+ * Returns: GST_PAD_PROBE_REMOVE
+ */
+static GstPadProbeReturn
+gst_rtp_src_switch_idle_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  gst_rtp_src_switch_retarget (user_data, pad);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+/**
+ * gst_rtp_src_switch_async:
+ * @element: The current #GstRtpSrc object
+ * @user_data: The #GstRtpSrcSwitch
+ *
+ * Wait for the old target to be idle and switch, off the streaming
+ * threads of both streams.
+ */
+static void
+gst_rtp_src_switch_async (GstElement * element, gpointer user_data)
+{
+  GstRtpSrcSwitch *sw = user_data;
+  GstPad *old_target = gst_ghost_pad_get_target (GST_GHOST_PAD (sw->ghost));
+
+  if (old_target && old_target != sw->target) {
+    gst_pad_add_probe (old_target, GST_PAD_PROBE_TYPE_IDLE,
+        gst_rtp_src_switch_idle_probe, gst_rtp_src_switch_ref (sw),
+        (GDestroyNotify) gst_rtp_src_switch_unref);
+  } else {
+    gst_rtp_src_switch_retarget (sw, NULL);
+  }
+
+  if (old_target)
+    gst_object_unref (old_target);
+}
+
+/**
+ * gst_rtp_src_switch_probe:
+ * @pad: The rtpbin src pad of the new SSRC
+ * @info: The #GstPadProbeInfo with the packet or event
+ * @user_data: The #GstRtpSrcSwitch
+ *
+ * Drop the packets of the new SSRC up to its first keyframe, then block
+ * on it while the ghost pad is retargeted, so downstream sees one
+ * continuous stream starting at a keyframe.
+ *
+ * Returns: GST_PAD_PROBE_OK to block on the keyframe
+ */
+static GstPadProbeReturn
+gst_rtp_src_switch_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrcSwitch *sw = user_data;
+  gboolean keyframe = FALSE;
+  GstMapInfo map;
+
+  /* the stream goes on on the ghost pad, it does not start over */
+  if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
+    return GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+        GST_EVENT_STREAM_START ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_PASS;
+
+  if (sw->pad)
+    return GST_PAD_PROBE_OK;
+
+  if (!gst_barco_rtp_has_keyframes (sw->encoding_name) ||
+      g_get_monotonic_time () >= sw->deadline) {
+    keyframe = TRUE;
+  } else if (gst_buffer_map (GST_PAD_PROBE_INFO_BUFFER (info), &map,
+          GST_MAP_READ)) {
+    keyframe = gst_barco_rtp_is_keyframe (map.data, map.size,
+        sw->encoding_name);
+    gst_buffer_unmap (GST_PAD_PROBE_INFO_BUFFER (info), &map);
+  }
+
+  if (!keyframe)
+    return GST_PAD_PROBE_DROP;
+
+  sw->pad = gst_object_ref (pad);
+  sw->probe_id = info->id;
+  gst_element_call_async (GST_ELEMENT (sw->self), gst_rtp_src_switch_async,
+      gst_rtp_src_switch_ref (sw), (GDestroyNotify) gst_rtp_src_switch_unref);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_rtp_src_switch_ssrc:
+ * @self: The current #GstRtpSrc object
+ * @pad: The rtpbin src pad of the new SSRC
+ * @target: The pad to ghost, @pad or the capsfilter behind it
+ * @caps: (nullable): The caps of @pad
+ *
+ * With ssrc-change, a new SSRC replaces the stream with the same payload
+ * type (or the only stream) on its ghost pad.
+ *
+ * Returns: TRUE if @pad will take over an existing ghost pad
+ */
+static gboolean
+gst_rtp_src_switch_ssrc (GstRtpSrc * self, GstPad * pad, GstPad * target,
+    GstCaps * caps)
+{
+  GstRtpSrcSwitch *sw;
+  GstPad *ghost = NULL;
+  GstIterator *it;
+  GValue data = { 0, };
+  const gchar *encoding_name = self->encoding_name;
+  gint payload = -1;
+  guint ssrc = 0;
+
+  if (caps && !gst_caps_is_empty (caps)) {
+    GstStructure *s = gst_caps_get_structure (caps, 0);
+
+    gst_structure_get_int (s, "payload", &payload);
+    gst_structure_get_uint (s, "ssrc", &ssrc);
+    if (gst_structure_get_string (s, "encoding-name"))
+      encoding_name = gst_structure_get_string (s, "encoding-name");
+  }
+
+  it = gst_element_iterate_src_pads (GST_ELEMENT (self));
+  while (ghost == NULL && gst_iterator_next (it, &data) == GST_ITERATOR_OK) {
+    GstPad *srcpad = g_value_get_object (&data);
+
+    if (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (srcpad),
+                "rtpsrc.payload")) == payload + 1 ||
+        GST_ELEMENT_CAST (self)->numsrcpads == 1)
+      ghost = gst_object_ref (srcpad);
+    g_value_unset (&data);
+  }
+  gst_iterator_free (it);
+
+  if (ghost == NULL)
+    return FALSE;
+
+  GST_INFO_OBJECT (self, "SSRC 0x%x takes over %" GST_PTR_FORMAT
+      " at its first keyframe", ssrc, ghost);
+
+  sw = g_slice_new0 (GstRtpSrcSwitch);
+  sw->refcount = 1;
+  sw->self = self;
+  sw->ghost = ghost;
+  sw->target = gst_object_ref (target);
+  sw->encoding_name =
+      g_strdup (gst_barco_rtp_guess_encoding_name (payload, encoding_name));
+  sw->ssrc = ssrc;
+  sw->deadline = g_get_monotonic_time () + GST_RTP_SRC_SWITCH_TIMEOUT;
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BLOCK |
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      gst_rtp_src_switch_probe, sw, (GDestroyNotify) gst_rtp_src_switch_unref);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_src_mark_latency:
+ * @self: The current #GstRtpSrc object
+ * @element: an element of the bin
+ * @stage: the stage the src pad of @element is the point of
+ *
+ * Mark the src pad of @element for the barcortplatency tracer.
+ */
+static void
+gst_rtp_src_mark_latency (GstRtpSrc * self, GstElement * element,
+    GstBarcoLatencyStage stage)
+{
+  GstPad *pad = gst_element_get_static_pad (element, "src");
+
+  gst_barco_latency_mark_pad (pad, GST_ELEMENT (self), stage);
+  gst_object_unref (pad);
+}
+
 /**
  * gst_rtp_src_rtpbin_pad_added_cb:
  * @element: The #GstElement where the pad was added on
@@ -152,6 +778,10 @@ gst_rtp_src_rtpbin_pad_added_cb (GstElement * element,
   gchar *name;
   GstRtpSrc *self = GST_RTP_SRC (data);
   GstStructure *s = NULL;
+  GstPad *rtpbin_pad;
+  GstPad *ghost;
+  gint payload;
+  guint ssrc;
 
   caps = gst_pad_query_caps (pad, NULL);
 
@@ -224,22 +854,14 @@ gst_rtp_src_rtpbin_pad_added_cb (GstElement * element,
   gst_object_ref (pad);
 
   name = gst_pad_get_name (pad);
-  GST_DEBUG_OBJECT (self, "New pad %s on rtpbin with caps %" GST_PTR_FORMAT,
-      name, caps);
+  GST_DEBUG_OBJECT (self, "New pad %s on rtpbin", name);
   g_free (name);
 
-  if (G_UNLIKELY (self->ssrc_change)) {
-    GST_DEBUG_OBJECT (self, "SSRC ignored, reconnecting on last pad.");
-    if (self->n_rtpbin_pads != 1) {
-      /* which one should be reconnected; cannot determine atm */
-      GST_WARNING ("Ghost pads not equal to 1; can't reconnect");
-    } else {
-      gst_ghost_pad_set_target ((GstGhostPad *) self->ghostpad, pad);
-      gst_object_unref (pad);
-
-      return;
-    }
-  }
+  caps = gst_pad_get_current_caps (pad);
+  gst_rtp_src_start_keyframe_requests (self, pad, caps);
+  rtpbin_pad = pad;
+  gst_barco_latency_mark_pad (rtpbin_pad, GST_ELEMENT (self),
+      GST_BARCO_LATENCY_JITTERBUFFER);
 
   if (G_UNLIKELY (self->pt_change)) {
     GstCaps *caps = gst_rtp_src_request_pt_map_cb (NULL, 0, 96, self);
@@ -261,21 +883,124 @@ gst_rtp_src_rtpbin_pad_added_cb (GstElement * element,
     gst_object_unref (sinkpad);
 
     pad = gst_element_get_static_pad (filter, "src");
+    g_object_set_data (G_OBJECT (pad), "rtpsrc.rtpbin_pad", rtpbin_pad);
+  }
+
+  if (G_UNLIKELY (self->ssrc_change) &&
+      gst_rtp_src_switch_ssrc (self, rtpbin_pad, pad, caps)) {
+    if (caps)
+      gst_caps_unref (caps);
+    gst_object_unref (pad);
+    return;
+  }
+
+  if (caps && !gst_caps_is_empty (caps)) {
+    s = gst_caps_get_structure (caps, 0);
+    if (gst_structure_get_int (s, "payload", &payload))
+      g_object_set_data (G_OBJECT (pad), "rtpsrc.payload",
+          GINT_TO_POINTER (payload + 1));
+    if (gst_structure_get_uint (s, "ssrc", &ssrc))
+      g_object_set_data (G_OBJECT (pad), "rtpsrc.ssrc",
+          GUINT_TO_POINTER (ssrc));
   }
+  if (caps)
+    gst_caps_unref (caps);
 
-  name = g_strdup_printf ("src%d", self->n_rtpbin_pads++);
-  self->ghostpad = gst_ghost_pad_new (name, pad);
+  /* every SSRC gets its own pad, the streams come up from their own
+   * streaming threads */
+  name = g_strdup_printf ("src%d",
+      g_atomic_int_add (&self->n_rtpbin_pads, 1));
+  ghost = gst_ghost_pad_new (name, pad);
   g_free (name);
+  g_object_set_data (G_OBJECT (ghost), "rtpsrc.payload",
+      g_object_get_data (G_OBJECT (pad), "rtpsrc.payload"));
+  gst_barco_latency_mark_pad (ghost, GST_ELEMENT (self),
+      GST_BARCO_LATENCY_PUSH);
 
-  gst_pad_set_active (self->ghostpad, TRUE);
-  gst_element_add_pad (GST_ELEMENT (self), self->ghostpad);
+  gst_pad_set_active (ghost, TRUE);
+  gst_element_add_pad (GST_ELEMENT (self), ghost);
 
-  /* FIXME: check what happens when there are multiple pads added */
-  gst_element_no_more_pads (GST_ELEMENT (self));
+  /* sources can join at any time, signal the first one is there for
+   * the users waiting on the pads of a single stream */
+  if (g_atomic_int_compare_and_exchange (&self->no_more_pads, FALSE, TRUE))
+    gst_element_no_more_pads (GST_ELEMENT (self));
 
   gst_object_unref (pad);
 }
 
+/**
+ * gst_rtp_src_rtpbin_pad_removed_cb:
+ * @element: The #GstElement where the pad was removed from
+ * @pad: The #GstPad that was removed
+ * @data: gpointer to the current #GstRtpSrc object
+ *
+ * rtpbin removes the pads of an SSRC after a BYE or a timeout, remove
+ * the ghost pad with it and free the keyframe requests and the counters
+ * of the SSRC. With ssrc-change the ghost pad stays for the next SSRC.
+ */
+static void
+gst_rtp_src_rtpbin_pad_removed_cb (GstElement * element,
+    GstPad * pad, gpointer data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (data);
+  GstPad *ghost = NULL;
+  GstPad *target = NULL;
+  GstIterator *it;
+  GValue item = { 0, };
+  gulong probe_id;
+  guint sess, ssrc, pt;
+
+  if (GST_PAD_DIRECTION (pad) != GST_PAD_SRC)
+    return;
+
+  probe_id = GPOINTER_TO_SIZE (g_object_steal_data (G_OBJECT (pad),
+          "rtpsrc.keyframe_probe"));
+  if (probe_id)
+    gst_pad_remove_probe (pad, probe_id);
+  if (sscanf (GST_PAD_NAME (pad), "recv_rtp_src_%u_%u_%u", &sess, &ssrc,
+          &pt) == 3)
+    gst_rtp_src_remove_stats (self, ssrc);
+
+  if (self->ssrc_change)
+    return;
+
+  it = gst_element_iterate_src_pads (GST_ELEMENT (self));
+  while (ghost == NULL && gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    GstPad *srcpad = g_value_get_object (&item);
+
+    target = gst_ghost_pad_get_target (GST_GHOST_PAD (srcpad));
+    if (target && (target == pad || g_object_get_data (G_OBJECT (target),
+                "rtpsrc.rtpbin_pad") == pad))
+      ghost = gst_object_ref (srcpad);
+    else if (target)
+      gst_object_unref (target);
+    g_value_unset (&item);
+  }
+  gst_iterator_free (it);
+
+  if (ghost == NULL)
+    return;
+
+  GST_INFO_OBJECT (self, "Removing %" GST_PTR_FORMAT, ghost);
+
+  gst_pad_set_active (ghost, FALSE);
+  gst_element_remove_pad (GST_ELEMENT (self), ghost);
+  gst_object_unref (ghost);
+
+  /* the capsfilter of pt-change */
+  if (target != pad) {
+    GstElement *filter = gst_pad_get_parent_element (target);
+
+    if (filter) {
+      gst_element_set_locked_state (filter, TRUE);
+      gst_element_set_state (filter, GST_STATE_NULL);
+      gst_bin_remove (GST_BIN (self), filter);
+      gst_object_unref (filter);
+    }
+  }
+  gst_object_unref (target);
+}
+
 /**
  * gst_rtp_src_fixup_caps:
  * @ret: The #GstCaps that needs fixup
@@ -364,88 +1089,391 @@ gst_rtp_src_fixup_caps (GstCaps * ret, const gchar * encoding_name)
 }
 
 /**
- * gst_rtp_src_request_pt_map_cb:
- * @sess: The #GstElement that threw the signal
- * @sess_id: the session-id of the session
- * @pt: the payload type
- * @data: gpointer to the current #GstRtpSrc object
- *
- * Request the payload type as #GstCaps for pt in session.
+ * gst_rtp_src_is_rtx_pt:
+ * @self: The current #GstRtpSrc object
+ * @pt: a payload type
  *
- * Returns: (transfer full): the #GstCaps matching the pt
+ * Returns: TRUE if @pt carries retransmissions
  */
-static GstCaps *
-gst_rtp_src_request_pt_map_cb (GstElement * sess, guint sess_id, guint pt,
-    gpointer data)
+static gboolean
+gst_rtp_src_is_rtx_pt (GstRtpSrc * self, guint pt)
 {
-  GstRtpSrc *self = GST_RTP_SRC (data);
-  const RtpParameters *p;
-  GstCaps *ret = NULL;
-  int i = 0;
+  return self->rtx_pt > 0 && (pt == self->rtx_pt ||
+      self->rtx_apts[pt & 0x7f] > 0);
+}
 
-  GST_DEBUG_OBJECT (self, "Requesting caps for pt %u in session %u", pt,
-      sess_id);
+/**
+ * gst_rtp_src_set_rtx_map:
+ * @self: The current #GstRtpSrc object
+ *
+ * Give rtprtxreceive the media payload type of every retransmission
+ * payload type known so far.
+ */
+static void
+gst_rtp_src_set_rtx_map (GstRtpSrc * self)
+{
+  GstStructure *pt_map;
+  GstElement *rtx_receive;
+  gchar pt_str[4];
+  guint i;
+
+  pt_map = gst_structure_new_empty ("application/x-rtp-pt-map");
+  GST_OBJECT_LOCK (self);
+  rtx_receive = self->rtx_receive ? gst_object_ref (self->rtx_receive) : NULL;
+  for (i = 0; i < G_N_ELEMENTS (self->rtx_apts); i++) {
+    if (self->rtx_apts[i] == 0)
+      continue;
+    g_snprintf (pt_str, sizeof (pt_str), "%u", i);
+    gst_structure_set (pt_map, pt_str, G_TYPE_UINT,
+        (guint) self->rtx_apts[i] - 1, NULL);
+  }
+  GST_OBJECT_UNLOCK (self);
 
-  if (self->caps){
-    GST_DEBUG_OBJECT(self, "Full caps were set, no need for lookup %" GST_PTR_FORMAT, self->caps);
-    ret = gst_caps_copy (self->caps);
-    goto full_caps_set;
+  if (rtx_receive) {
+    GST_DEBUG_OBJECT (self, "Retransmission map %" GST_PTR_FORMAT, pt_map);
+    g_object_set (G_OBJECT (rtx_receive), "payload-type-map", pt_map, NULL);
+    gst_object_unref (rtx_receive);
   }
+  gst_structure_free (pt_map);
+}
 
-  if (self->encoding_name)
-    goto dynamic;
+/**
+ * gst_rtp_src_update_rtx_apt:
+ * @self: The current #GstRtpSrc object
+ * @pt: the payload type of a media stream
+ *
+ * RFC 4588 retransmission packets do not carry the original payload type.
+ * Unless the SDP already gave one, map the retransmission payload type
+ * gst_rtp_parameters_rtx_pt() derives from @pt on it, like rtpsink does.
+ */
+static void
+gst_rtp_src_update_rtx_apt (GstRtpSrc * self, guint pt)
+{
+  guint rtx = gst_rtp_parameters_rtx_pt (self->rtx_pt, pt);
+  gboolean changed = FALSE;
+  guint i;
 
-  i = 0;
-  while (RTP_STATIC_PARAMETERS[i].pt >= 0) {
-    p = &(RTP_STATIC_PARAMETERS[i++]);
-    if (p->pt == pt) {
-      GST_DEBUG_OBJECT (self, "found as static param: %s", p->encoding_name);
-      goto beach;
-    }
-  }
-  GST_DEBUG_OBJECT (self, "no static parameters found");
+  if (self->rtx_receive == NULL)
+    return;
 
-  i = 0;
-  if (self->encoding_name == NULL) {
-    GST_INFO_OBJECT (self, "no encoding name set, assuming MP4V-ES");
-    self->encoding_name = g_strdup ("MP4V-ES");
+  GST_OBJECT_LOCK (self);
+  for (i = 0; i < G_N_ELEMENTS (self->rtx_apts); i++)
+    if (self->rtx_apts[i] == pt + 1)
+      break;
+  if (i == G_N_ELEMENTS (self->rtx_apts) && rtx > 0 &&
+      self->rtx_apts[rtx] == 0) {
+    GST_INFO_OBJECT (self, "Mapping retransmission pt %u on pt %u", rtx, pt);
+    self->rtx_apts[rtx] = pt + 1;
+    changed = TRUE;
   }
+  GST_OBJECT_UNLOCK (self);
 
-dynamic:
-  while (RTP_DYNAMIC_PARAMETERS[i].pt >= 0) {
-    p = &(RTP_DYNAMIC_PARAMETERS[i++]);
-    if (g_strcmp0 (p->encoding_name, self->encoding_name) == 0) {
-      GST_DEBUG_OBJECT (self, "found dynamic parameters [%s]",
-          self->encoding_name);
-      goto beach;
+  if (changed)
+    gst_rtp_src_set_rtx_map (self);
+}
+
+/**
+ * gst_rtp_src_request_rtx_pt_map:
+ * @self: The current #GstRtpSrc object
+ * @pt: the retransmission payload type
+ *
+ * The session also asks for the clock-rate of the retransmission payload
+ * type; answer with the parameters of the stream it protects.
+ *
+ * Returns: (transfer full): the #GstCaps for the retransmission stream
+ */
+static GstCaps *
+gst_rtp_src_request_rtx_pt_map (GstRtpSrc * self, guint pt)
+{
+  GstCaps *ret = NULL;
+  GstStructure *s;
+  gint clock_rate = 90000;
+  gchar *media = NULL;
+  gint apt;
+
+  GST_OBJECT_LOCK (self);
+  apt = (gint) self->rtx_apts[pt] - 1;
+  GST_OBJECT_UNLOCK (self);
+
+  if (apt >= 0) {
+    ret = gst_rtp_src_request_pt_map_cb (NULL, 0, apt, self);
+    if (ret) {
+      s = gst_caps_get_structure (ret, 0);
+      gst_structure_get_int (s, "clock-rate", &clock_rate);
+      media = g_strdup (gst_structure_get_string (s, "media"));
+      gst_caps_unref (ret);
     }
   }
 
-  i = 0;
-  /* just in case it was botched; go through the static ones too */
-  while (RTP_STATIC_PARAMETERS[i].pt >= 0) {
-    p = &(RTP_STATIC_PARAMETERS[i++]);
-    if (g_strcmp0 (p->encoding_name, self->encoding_name) == 0) {
-      GST_DEBUG_OBJECT (self, "found static parameters [%s]",
-          self->encoding_name);
-      goto beach;
+  ret = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, media ? media : "video",
+      "clock-rate", G_TYPE_INT, clock_rate,
+      "encoding-name", G_TYPE_STRING, "RTX",
+      "payload", G_TYPE_INT, pt,
+      "apt", G_TYPE_INT, MAX (apt, 0),
+      NULL);
+  g_free (media);
+
+  GST_DEBUG_OBJECT (self, "Decided on retransmission caps %" GST_PTR_FORMAT,
+      ret);
+
+  return ret;
+}
+
+/* marks the lists of held packets pushed by the sniffer */
+static G_DEFINE_QUARK (rtpsrc-sniffed, gst_rtp_src_sniffed);
+
+/**
+ * gst_rtp_src_clear_sniffed:
+ * @self: The current #GstRtpSrc object
+ *
+ * Drop the packets held back by the sniffer.
+ */
+static void
+gst_rtp_src_clear_sniffed (GstRtpSrc * self)
+{
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  for (i = 0; i < G_N_ELEMENTS (self->sniffed); i++)
+    if (self->sniffed[i]) {
+      gst_buffer_list_unref (self->sniffed[i]);
+      self->sniffed[i] = NULL;
+    }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/**
+ * gst_rtp_src_sniff:
+ * @self: The current #GstRtpSrc object
+ * @buffer: an RTP packet on its way to rtpbin
+ * @hold: keep a ref to @buffer while its encoding is not known
+ *
+ * Returns: TRUE when the encoding of the payload type of @buffer is known
+ * or there is no point in waiting for it
+ */
+static gboolean
+gst_rtp_src_sniff (GstRtpSrc * self, GstBuffer * buffer, gboolean hold)
+{
+  GstBarcoSniffer *sniffer;
+  GstMapInfo map;
+  gboolean done = TRUE;
+  guint pt;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return TRUE;
+
+  pt = map.size > 1 ? map.data[1] & 0x7f : 0;
+  if (pt >= 96 && !gst_rtp_src_is_rtx_pt (self, pt)) {
+    sniffer = &self->sniffers[pt - 96];
+    GST_OBJECT_LOCK (self);
+    if (!sniffer->done) {
+      done = gst_barco_sniffer_add (sniffer, map.data, map.size);
+      if (done)
+        GST_INFO_OBJECT (self, "pt %u sniffed as %s after %u packets", pt,
+            GST_STR_NULL (sniffer->encoding_name), sniffer->packets);
+    }
+    /* the sniffer gives up after a few packets, so does the list */
+    if (!done && hold) {
+      if (self->sniffed[pt - 96] == NULL)
+        self->sniffed[pt - 96] = gst_buffer_list_new ();
+      gst_buffer_list_add (self->sniffed[pt - 96], gst_buffer_ref (buffer));
     }
+    GST_OBJECT_UNLOCK (self);
   }
-  i = 0;
-  /* this is really desperate, some encoders claim to be a, while they
-   * are being b (Bosch). */
-  while (RTP_STATIC_PARAMETERS[i].pt >= 0) {
-    p = &(RTP_STATIC_PARAMETERS[i++]);
-    if (p->pt == pt) {
+  gst_buffer_unmap (buffer, &map);
+
+  return done;
+}
+
+/**
+ * gst_rtp_src_sniff_release:
+ * @self: The current #GstRtpSrc object
+ * @pad: The pad feeding rtpbin
+ *
+ * Send the held back packets of the payload types that are known now on
+ * to rtpbin, all of them once the caps are set on the element.
+ *
+ * Returns: TRUE when no payload type seen is being sniffed anymore
+ */
+static gboolean
+gst_rtp_src_sniff_release (GstRtpSrc * self, GstPad * pad)
+{
+  GstBufferList *lists[G_N_ELEMENTS (self->sniffed)] = { NULL, };
+  gboolean configured, finished = TRUE;
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  configured = self->encoding_name || self->caps || self->sdp_caps;
+  for (i = 0; i < G_N_ELEMENTS (self->sniffed); i++) {
+    if (!configured && self->sniffers[i].packets && !self->sniffers[i].done) {
+      finished = FALSE;
+      continue;
+    }
+    lists[i] = self->sniffed[i];
+    self->sniffed[i] = NULL;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  /* through @pad, in front of the packet that settled it, so the tracer
+   * marks on @pad see them. The sniff probe lets them through. */
+  for (i = 0; i < G_N_ELEMENTS (lists); i++) {
+    if (lists[i] == NULL)
+      continue;
+    gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (lists[i]),
+        gst_rtp_src_sniffed_quark (), GINT_TO_POINTER (TRUE), NULL);
+    gst_pad_push_list (pad, lists[i]);
+  }
+
+  return finished;
+}
+
+/**
+ * gst_rtp_src_sniff_probe:
+ * @pad: The pad feeding rtpbin
+ * @info: The #GstPadProbeInfo with the packets
+ * @user_data: The current #GstRtpSrc object
+ *
+ * Without an encoding-name, rtpbin would ask for the caps of a dynamic
+ * payload type on its first packet. Hold the packets back until their
+ * payload tells which encoding it is, then send them on in order.
+ *
+ * Returns: GST_PAD_PROBE_DROP while the encoding is not known yet, the
+ * packet is held; GST_PAD_PROBE_REMOVE once nothing is sniffed anymore
+ */
+static GstPadProbeReturn
+gst_rtp_src_sniff_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  GstBufferList *list;
+  guint i;
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (!gst_rtp_src_sniff (self, GST_PAD_PROBE_INFO_BUFFER (info), TRUE))
+      return GST_PAD_PROBE_DROP;
+  } else {
+    /* cached GOPs start with a keyframe, no need to hold them back */
+    list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+    if (gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST (list),
+            gst_rtp_src_sniffed_quark ()))
+      return GST_PAD_PROBE_OK;
+    for (i = 0; i < gst_buffer_list_length (list); i++)
+      gst_rtp_src_sniff (self, gst_buffer_list_get (list, i), FALSE);
+  }
+
+  if (gst_rtp_src_sniff_release (self, pad)) {
+    GST_DEBUG_OBJECT (self, "Done sniffing");
+    return GST_PAD_PROBE_REMOVE;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_rtp_src_sniffed_encoding_name:
+ * @self: The current #GstRtpSrc object
+ * @pt: a payload type
+ *
+ * Returns: (nullable): the encoding sniffed from the packets of @pt
+ */
+static const gchar *
+gst_rtp_src_sniffed_encoding_name (GstRtpSrc * self, guint pt)
+{
+  const gchar *encoding_name = NULL;
+
+  if (pt < 96 || pt > 127)
+    return NULL;
+
+  GST_OBJECT_LOCK (self);
+  encoding_name = self->sniffers[pt - 96].encoding_name;
+  GST_OBJECT_UNLOCK (self);
+
+  return encoding_name;
+}
+
+/**
+ * gst_rtp_src_clear_pt_caps:
+ * @self: The current #GstRtpSrc object
+ *
+ * Forget the answers of the pt map when what they are based on changed.
+ */
+static void
+gst_rtp_src_clear_pt_caps (GstRtpSrc * self)
+{
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  for (i = 0; i < G_N_ELEMENTS (self->pt_caps); i++) {
+    gst_caps_replace (&self->pt_caps[i], NULL);
+    g_atomic_int_set (&self->clock_rates[i], 0);
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/**
+ * gst_rtp_src_lookup_pt_map:
+ * @self: The current #GstRtpSrc object
+ * @pt: the payload type
+ *
+ * Returns: (transfer full): new #GstCaps for @pt
+ */
+static GstCaps *
+gst_rtp_src_lookup_pt_map (GstRtpSrc * self, guint pt)
+{
+  const RtpParameters *p;
+  const gchar *encoding_name = self->encoding_name;
+  GstCaps *ret = NULL;
+
+  if (self->caps){
+    GST_DEBUG_OBJECT(self, "Full caps were set, no need for lookup %" GST_PTR_FORMAT, self->caps);
+    ret = gst_caps_copy (self->caps);
+    goto full_caps_set;
+  }
+
+  if (self->sdp_caps &&
+      (ret = g_hash_table_lookup (self->sdp_caps, GUINT_TO_POINTER (pt)))) {
+    GST_DEBUG_OBJECT (self, "Caps from the SDP %" GST_PTR_FORMAT, ret);
+    ret = gst_caps_copy (ret);
+    goto full_caps_set;
+  }
+
+  if (encoding_name == NULL) {
+    p = gst_rtp_parameters_lookup_pt (pt);
+    if (p) {
       GST_DEBUG_OBJECT (self, "found as static param: %s", p->encoding_name);
       goto beach;
     }
+    GST_DEBUG_OBJECT (self, "no static parameters found");
+
+    encoding_name = gst_rtp_src_sniffed_encoding_name (self, pt);
+    if (encoding_name) {
+      GST_INFO_OBJECT (self, "no encoding name set, sniffed %s", encoding_name);
+    } else {
+      /* only for this payload type, through its cached caps; the others
+       * are still sniffed */
+      GST_INFO_OBJECT (self, "no encoding name set, assuming MP4V-ES");
+      encoding_name = "MP4V-ES";
+    }
+  }
+
+  p = gst_rtp_parameters_lookup_name (encoding_name);
+  if (p) {
+    GST_DEBUG_OBJECT (self, "found parameters [%s]", encoding_name);
+    goto beach;
+  }
+
+  /* this is really desperate, some encoders claim to be a, while they
+   * are being b (Bosch). */
+  p = gst_rtp_parameters_lookup_pt (pt);
+  if (p) {
+    GST_DEBUG_OBJECT (self, "found as static param: %s", p->encoding_name);
+    goto beach;
   }
 
   GST_WARNING_OBJECT (self,
       "no rtp parameters found for this payload type %s,... :-(",
-      self->encoding_name);
-  p = NULL;
+      encoding_name);
   return NULL;
 
 beach:
@@ -463,8 +1491,12 @@ beach:
        *     a new I-Frame
        * */
       "rtcp-fb-ccm-fir", G_TYPE_BOOLEAN, TRUE,
+      "rtcp-fb-nack-pli", G_TYPE_BOOLEAN, TRUE,
       NULL);
 
+  if (self->rtx_pt > 0)
+    gst_caps_set_simple (ret, "rtcp-fb-nack", G_TYPE_BOOLEAN, TRUE, NULL);
+
   gst_rtp_src_fixup_caps (ret, p->encoding_name);
   GST_DEBUG_OBJECT (self, "Decided on caps %" GST_PTR_FORMAT, ret);
 
@@ -472,6 +1504,59 @@ full_caps_set:
   return ret;
 }
 
+/**
+ * gst_rtp_src_request_pt_map_cb:
+ * @sess: The #GstElement that threw the signal
+ * @sess_id: the session-id of the session
+ * @pt: the payload type
+ * @data: gpointer to the current #GstRtpSrc object
+ *
+ * Request the payload type as #GstCaps for pt in session. The caps are
+ * looked up once per payload type and shared after that; they are never
+ * changed, so holders that want to change them have to copy them.
+ *
+ * Returns: (transfer full): the #GstCaps matching the pt
+ */
+static GstCaps *
+gst_rtp_src_request_pt_map_cb (GstElement * sess, guint sess_id, guint pt,
+    gpointer data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (data);
+  GstCaps *ret = NULL;
+
+  GST_DEBUG_OBJECT (self, "Requesting caps for pt %u in session %u", pt,
+      sess_id);
+
+  g_return_val_if_fail (pt < G_N_ELEMENTS (self->pt_caps), NULL);
+
+  if (G_UNLIKELY (self->rtx_pt > 0)) {
+    if (gst_rtp_src_is_rtx_pt (self, pt))
+      return gst_rtp_src_request_rtx_pt_map (self, pt);
+    gst_rtp_src_update_rtx_apt (self, pt);
+  }
+
+  GST_OBJECT_LOCK (self);
+  if (self->pt_caps[pt])
+    ret = gst_caps_ref (self->pt_caps[pt]);
+  GST_OBJECT_UNLOCK (self);
+  if (ret)
+    return ret;
+
+  ret = gst_rtp_src_lookup_pt_map (self, pt);
+  if (ret) {
+    gint clock_rate = 0;
+
+    gst_structure_get_int (gst_caps_get_structure (ret, 0), "clock-rate",
+        &clock_rate);
+    GST_OBJECT_LOCK (self);
+    gst_caps_replace (&self->pt_caps[pt], ret);
+    g_atomic_int_set (&self->clock_rates[pt], MAX (clock_rate, 0));
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return ret;
+}
+
 /**
  * gst_rtp_src_rtpbin_on_new_ssrc_cb:
  * @object: The #GstElement that threw the signal
@@ -479,37 +1564,1439 @@ full_caps_set:
  * @ssrc: the ssrc of the new stream
  * @user_data: gpointer to the current #GstRtpSrc object
  *
- * Callback thrown when a new SSRC was detected in an RTP session
+ * Callback thrown when a new SSRC was detected in an RTP session
+ */
+static void
+gst_rtp_src_rtpbin_on_new_ssrc_cb (GstElement* object,
+    guint sess_id,
+    guint ssrc,
+    gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC(user_data);
+
+  GST_INFO_OBJECT(self, "Dectected a new SSRC: session 0x%x, ssrc 0x%x.", sess_id, ssrc);
+}
+
+/**
+ * gst_rtp_src_bye_ssrc:
+ * @element: The current #GstRtpSrc object
+ * @user_data: the SSRC that said BYE
+ *
+ * Remove the stream of an SSRC right away instead of after the BYE
+ * timeout of rtpbin, so the pads of departed sources go away quickly.
+ */
+static void
+gst_rtp_src_bye_ssrc (GstElement * element, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (element);
+
+  gst_rtp_src_remove_ssrc (self, GPOINTER_TO_UINT (user_data));
+}
+
+/**
+ * gst_rtp_src_rtpbin_on_bye_ssrc_cb:
+ * @object: The #GstElement that threw the signal
+ * @sess_id: the session-id of the session
+ * @ssrc: the ssrc that sent the BYE
+ * @user_data: gpointer to the current #GstRtpSrc object
+ *
+ * Callback thrown when an SSRC leaves the session
+ */
+static void
+gst_rtp_src_rtpbin_on_bye_ssrc_cb (GstElement * object,
+    guint sess_id, guint ssrc, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+
+  GST_INFO_OBJECT (self, "BYE from SSRC 0x%x in session 0x%x.", ssrc, sess_id);
+
+  /* not from the RTCP thread of the session, removing the stream waits
+   * for its threads */
+  gst_element_call_async (GST_ELEMENT (self), gst_rtp_src_bye_ssrc,
+      GUINT_TO_POINTER (ssrc), NULL);
+}
+
+/**
+ * gst_rtp_src_rtpbin_on_sssrc_collision_cb:
+ * @object: The #GstElement that threw the signal
+ * @sess_id: the session-id of the session
+ * @ssrc: the ssrc of the new stream
+ * @user_data: gpointer to the current #GstRtpSrc object
+ *
+ * Callback thrown when a collision is detected in an RTP session
+ */
+static void
+gst_rtp_src_rtpbin_on_ssrc_collision_cb (GstElement* object,
+    guint sess_id,
+    guint ssrc,
+    gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC(user_data);
+
+  GST_WARNING_OBJECT(self, "Dectected an SSRC collision: session 0x%x, ssrc 0x%x.", sess_id, ssrc);
+}
+
+/**
+ * gst_rtp_src_clear_rtx:
+ * @self: The current #GstRtpSrc object
+ *
+ * Drop the rtprtxreceive of the previous rtpbin and its payload type map.
+ * The retransmission payload types the SDP declares are kept.
+ */
+static void
+gst_rtp_src_clear_rtx (GstRtpSrc * self)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  GstStructure *s;
+  const gchar *apt;
+
+  GST_OBJECT_LOCK (self);
+  if (self->rtx_receive) {
+    gst_object_unref (self->rtx_receive);
+    self->rtx_receive = NULL;
+  }
+  memset (self->rtx_apts, 0, sizeof (self->rtx_apts));
+
+  if (self->sdp_caps) {
+    g_hash_table_iter_init (&iter, self->sdp_caps);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      s = gst_caps_get_structure (value, 0);
+      apt = gst_structure_get_string (s, "apt");
+      if (g_strcmp0 (gst_structure_get_string (s, "encoding-name"),
+              "RTX") == 0 && apt && atoi (apt) >= 0 && atoi (apt) < 128)
+        self->rtx_apts[GPOINTER_TO_UINT (key) & 0x7f] = atoi (apt) + 1;
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/**
+ * gst_rtp_src_rtpbin_request_aux_receiver_cb:
+ * @rtpbin: the #GstRtpBin requesting the auxiliary receiver
+ * @sess_id: the session-id of the session
+ * @user_data: gpointer to the current #GstRtpSrc object
+ *
+ * Wrap an rtprtxreceive in a bin to restore RFC 4588 retransmissions into
+ * the original stream before they reach the jitterbuffer.
+ *
+ * Returns: (transfer full): the auxiliary receiver or %NULL when disabled
+ */
+static GstElement *
+gst_rtp_src_rtpbin_request_aux_receiver_cb (GstElement * rtpbin,
+    guint sess_id, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  GstElement *bin, *rtx_receive;
+  GstPad *pad;
+  gchar *name;
+
+  if (self->rtx_pt == 0)
+    return NULL;
+
+  rtx_receive = gst_element_factory_make ("rtprtxreceive", NULL);
+  if (rtx_receive == NULL) {
+    GST_WARNING_OBJECT (self, "rtprtxreceive not available, no retransmission");
+    return NULL;
+  }
+
+  GST_INFO_OBJECT (self, "Enabling retransmission on session %u (pt %u)",
+      sess_id, self->rtx_pt);
+
+  bin = gst_bin_new (NULL);
+  gst_bin_add (GST_BIN (bin), rtx_receive);
+  gst_rtp_src_clear_rtx (self);
+  GST_OBJECT_LOCK (self);
+  self->rtx_receive = gst_object_ref (rtx_receive);
+  GST_OBJECT_UNLOCK (self);
+  gst_rtp_src_set_rtx_map (self);
+
+  pad = gst_element_get_static_pad (self->rtx_receive, "src");
+  name = g_strdup_printf ("src_%u", sess_id);
+  gst_element_add_pad (bin, gst_ghost_pad_new (name, pad));
+  g_free (name);
+  gst_object_unref (pad);
+
+  pad = gst_element_get_static_pad (self->rtx_receive, "sink");
+  name = g_strdup_printf ("sink_%u", sess_id);
+  gst_element_add_pad (bin, gst_ghost_pad_new (name, pad));
+  g_free (name);
+  gst_object_unref (pad);
+
+  return bin;
+}
+
+/**
+ * gst_rtp_src_rtpbin_new_jitterbuffer_cb:
+ * @rtpbin: The #GstRtpBin that created the jitterbuffer
+ * @jitterbuffer: the new rtpjitterbuffer
+ * @sess_id: the session-id of the session
+ * @ssrc: the ssrc of the stream
+ * @user_data: gpointer to the current #GstRtpSrc object
+ *
+ * Count the packets of the new SSRC. NACKs are only useful while the
+ * retransmission can still make the jitterbuffer deadline; keep
+ * requesting as long as that is the case and send the first request as
+ * soon as a gap is seen.
+ */
+static void
+gst_rtp_src_rtpbin_new_jitterbuffer_cb (GstElement * rtpbin,
+    GstElement * jitterbuffer, guint sess_id, guint ssrc, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  GstPad *pad = gst_element_get_static_pad (jitterbuffer, "sink");
+
+  /* count the packets before the jitterbuffer reorders them */
+  gst_rtp_src_add_stats (self, pad, 0);
+  gst_object_unref (pad);
+
+  if (self->rtx_pt == 0)
+    return;
+
+  GST_DEBUG_OBJECT (self, "Tuning retransmission on jitterbuffer for ssrc 0x%x",
+      ssrc);
+
+  xgst_barco_set_supported_parameter (jitterbuffer, "rtx-deadline",
+      (gint) self->latency);
+  xgst_barco_set_supported_parameter (jitterbuffer, "rtx-retry-period",
+      (gint) self->latency);
+  xgst_barco_set_supported_parameter (jitterbuffer, "rtx-next-seqnum", TRUE);
+}
+
+/**
+ * gst_rtp_src_create_fec:
+ * @self: The current #GstRtpSrc object
+ *
+ * Create the FEC recovery element and the udpsrcs for the column and row
+ * FEC streams, on the ports next to RTP and RTCP.
+ *
+ * Returns: (transfer none): the FEC decoder, added to the bin
+ */
+static GstElement *
+gst_rtp_src_create_fec (GstRtpSrc * self)
+{
+  const gchar *host = gst_uri_get_host (self->uri);
+  gint port = gst_uri_get_port (self->uri);
+  GstElement *fec_dec;
+  GstCaps *caps;
+  guint i;
+
+  fec_dec = gst_element_factory_make ("barcortpfecdec", NULL);
+  g_return_val_if_fail (fec_dec != NULL, NULL);
+
+  g_object_set (G_OBJECT (fec_dec), "mode", self->fec, NULL);
+  gst_bin_add (GST_BIN (self), fec_dec);
+
+  caps = gst_caps_new_empty_simple ("application/x-rtp");
+  for (i = 0; i < 2; i++) {
+    gint fec_port = port + (i == 0 ? GST_RTP_FEC_COLUMN_PORT_OFFSET :
+        GST_RTP_FEC_ROW_PORT_OFFSET);
+    gchar *fec_name = g_strdup_printf ("fec_%u", i);
+
+    self->fec_src[i] = gst_element_factory_make ("udpsrc", NULL);
+    if (gst_rtp_src_is_multicast (host)) {
+      gchar *uri = g_strdup_printf ("udp://%s:%d", host, fec_port);
+      g_object_set (G_OBJECT (self->fec_src[i]), "uri", uri, NULL);
+      g_free (uri);
+    } else {
+      g_object_set (G_OBJECT (self->fec_src[i]), "port", fec_port, NULL);
+    }
+    g_object_set (G_OBJECT (self->fec_src[i]),
+        "reuse", TRUE,
+        "caps", caps,
+        "multicast-iface", self->multicast_iface,
+        "buffer-size", self->buffer_size, "auto-multicast", TRUE, NULL);
+    gst_bin_add (GST_BIN (self), self->fec_src[i]);
+
+    if (!gst_element_link_pads (self->fec_src[i], "src", fec_dec, fec_name))
+      GST_ERROR_OBJECT (self, "Problem linking up FEC data (%s).", fec_name);
+    g_free (fec_name);
+  }
+  gst_caps_unref (caps);
+
+  GST_INFO_OBJECT (self, "Receiving FEC on ports %d and %d",
+      port + GST_RTP_FEC_COLUMN_PORT_OFFSET, port + GST_RTP_FEC_ROW_PORT_OFFSET);
+
+  return fec_dec;
+}
+
+/**
+ * gst_rtp_src_create_redundant:
+ * @self: The current #GstRtpSrc object
+ *
+ * Create the udpsrc for the second path of a SMPTE 2022-7 stream and the
+ * element merging it with the first one.
+ *
+ * Returns: (transfer none): the merger, added to the bin
+ */
+static GstElement *
+gst_rtp_src_create_redundant (GstRtpSrc * self)
+{
+  const gchar *host = gst_uri_get_host (self->redundant_uri);
+  gint port = gst_uri_get_port (self->redundant_uri);
+  GstElement *merge;
+  GstElement *queue;
+
+  merge = gst_element_factory_make ("barcortpmerge", NULL);
+  g_return_val_if_fail (merge != NULL, NULL);
+  g_object_set (G_OBJECT (merge), "max-skew", self->redundant_max_skew, NULL);
+
+  if (port == GST_URI_NO_PORT)
+    port = gst_uri_get_port (self->uri);
+
+  self->redundant_src = gst_element_factory_make ("udpsrc", NULL);
+  if (gst_rtp_src_is_multicast (host)) {
+    gchar *uri = g_strdup_printf ("udp://%s:%d", host, port);
+    g_object_set (G_OBJECT (self->redundant_src), "uri", uri, NULL);
+    g_free (uri);
+  } else {
+    g_object_set (G_OBJECT (self->redundant_src), "port", port, NULL);
+  }
+  g_object_set (G_OBJECT (self->redundant_src),
+      "reuse", TRUE,
+      "multicast-iface", self->redundant_multicast_iface ?
+          self->redundant_multicast_iface : self->multicast_iface,
+      "buffer-size", self->buffer_size, "auto-multicast", TRUE, NULL);
+
+  queue = gst_element_factory_make ("queue", NULL);
+
+  gst_bin_add_many (GST_BIN (self), merge, self->redundant_src, queue, NULL);
+  gst_element_link (self->redundant_src, queue);
+  if (!gst_element_link_pads (queue, "src", merge, "sink_1"))
+    GST_ERROR_OBJECT (self, "Problem linking up the redundant path.");
+  gst_rtp_src_mark_latency (self, self->redundant_src,
+      GST_BARCO_LATENCY_RECEIVE);
+  gst_rtp_src_mark_latency (self, queue, GST_BARCO_LATENCY_QUEUE);
+
+  gst_element_sync_state_with_parent (queue);
+
+  GST_INFO_OBJECT (self, "Receiving redundant path on %s:%d", host, port);
+
+  return merge;
+}
+
+/**
+ * gst_rtp_src_group_encoding_name:
+ * @group: a #GstRtpSrcGroup
+ * @buffer: an RTP packet of @group
+ *
+ * Resolve the encoding of the payload type of @buffer in the pt map of
+ * @group itself: the encoding-name of its URI, or the one sniffed from its
+ * own packets for a dynamic payload type. A standby channel can use
+ * another codec or payload type than the active one. Called with the lock
+ * of @group held.
+ *
+ * Returns: (transfer none) (nullable): the encoding-name, %NULL for a
+ * static payload type or while sniffing
+ */
+static const gchar *
+gst_rtp_src_group_encoding_name (GstRtpSrcGroup * group, GstBuffer * buffer)
+{
+  GstBarcoSniffer *sniffer;
+  GstMapInfo map;
+  guint pt;
+
+  if (group->encoding_name)
+    return group->encoding_name;
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return NULL;
+
+  pt = map.size > 1 ? map.data[1] & 0x7f : 0;
+  sniffer = pt >= 96 ? &group->sniffers[pt - 96] : NULL;
+  if (sniffer && !sniffer->done &&
+      gst_barco_sniffer_add (sniffer, map.data, map.size))
+    GST_INFO_OBJECT (group->self, "pt %u of %s sniffed as %s", pt,
+        gst_uri_get_host (group->uri), GST_STR_NULL (sniffer->encoding_name));
+  gst_buffer_unmap (buffer, &map);
+
+  return sniffer ? sniffer->encoding_name : NULL;
+}
+
+/**
+ * gst_rtp_src_group_probe:
+ * @pad: The src pad of the udpsrc of the group
+ * @info: The #GstPadProbeInfo with the received packet
+ * @user_data: The #GstRtpSrcGroup
+ *
+ * Keep the packets from the last keyframe of a group and forward the
+ * packets of the active group to the appsrc feeding rtpbin.
+ *
+ * Returns: GST_PAD_PROBE_DROP, the fakesink of the group gets nothing
+ */
+static GstPadProbeReturn
+gst_rtp_src_group_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrcGroup *group = user_data;
+  GstRtpSrc *self = group->self;
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstFlowReturn flow;
+
+  /* forwarding under the lock of the group keeps its packets behind the
+   * GOP that was pushed when switching to it */
+  g_mutex_lock (&group->lock);
+  gst_barco_gop_cache_push (&group->cache, buffer,
+      gst_rtp_src_group_encoding_name (group, buffer));
+  if (g_atomic_pointer_get (&self->active_group) == group)
+    g_signal_emit_by_name (self->rtp_src, "push-buffer", buffer, &flow);
+  g_mutex_unlock (&group->lock);
+
+  return GST_PAD_PROBE_DROP;
+}
+
+static void
+gst_rtp_src_group_free (GstRtpSrcGroup * group)
+{
+  gst_barco_gop_cache_clear (&group->cache);
+  gst_uri_unref (group->uri);
+  g_free (group->encoding_name);
+  g_mutex_clear (&group->lock);
+  g_slice_free (GstRtpSrcGroup, group);
+}
+
+/**
+ * gst_rtp_src_clear_groups:
+ * @self: The current #GstRtpSrc object
+ *
+ * Leave the groups and drop their caches, the next start joins them
+ * again.
+ */
+static void
+gst_rtp_src_clear_groups (GstRtpSrc * self)
+{
+  GPtrArray *groups;
+  guint i;
+
+  g_mutex_lock (&self->group_lock);
+  groups = self->groups;
+  self->groups = NULL;
+  g_atomic_pointer_set (&self->active_group, NULL);
+  g_mutex_unlock (&self->group_lock);
+
+  if (groups == NULL)
+    return;
+
+  for (i = 0; i < groups->len; i++) {
+    GstRtpSrcGroup *group = g_ptr_array_index (groups, i);
+
+    gst_element_set_locked_state (group->udpsrc, TRUE);
+    gst_element_set_state (group->udpsrc, GST_STATE_NULL);
+    gst_element_set_locked_state (group->sink, TRUE);
+    gst_element_set_state (group->sink, GST_STATE_NULL);
+    gst_bin_remove_many (GST_BIN (self), group->udpsrc, group->sink, NULL);
+  }
+  g_ptr_array_unref (groups);
+}
+
+/**
+ * gst_rtp_src_make_udpsrc:
+ * @self: The current #GstRtpSrc object
+ * @capture: (out) (optional): set when the packets are captured
+ *
+ * With capture-iface, groups are received from the shared packet ring of
+ * that interface instead of a socket each.
+ *
+ * Returns: (transfer floating): a barcortpcapturesrc or a udpsrc
+ */
+static GstElement *
+gst_rtp_src_make_udpsrc (GstRtpSrc * self, gboolean * capture)
+{
+  GstElement *udpsrc = NULL;
+
+  if (self->capture_iface) {
+    if (gst_barco_capture_supported ())
+      udpsrc = gst_element_factory_make ("barcortpcapturesrc", NULL);
+    if (udpsrc)
+      g_object_set (G_OBJECT (udpsrc), "iface", self->capture_iface,
+          "kernel-timestamps", self->kernel_timestamps, NULL);
+    else
+      GST_WARNING_OBJECT (self, "Cannot capture on %s, receiving with udpsrc.",
+          self->capture_iface);
+  }
+
+  if (capture)
+    *capture = udpsrc != NULL;
+  if (udpsrc == NULL)
+    udpsrc = gst_element_factory_make ("udpsrc", NULL);
+
+  return udpsrc;
+}
+
+/**
+ * gst_rtp_src_set_udpsrc_uri:
+ * @self: The current #GstRtpSrc object
+ * @udpsrc: The udpsrc to configure
+ * @uri: The rtp:// URI to receive
+ *
+ * Join the multicast group of @uri, or listen on its port for unicast.
+ */
+static void
+gst_rtp_src_set_udpsrc_uri (GstRtpSrc * self, GstElement * udpsrc,
+    GstUri * uri)
+{
+  const gchar *host = gst_uri_get_host (uri);
+  gint port = gst_uri_get_port (uri);
+
+  if (port == GST_URI_NO_PORT)
+    port = gst_uri_get_port (self->uri);
+
+  if (gst_rtp_src_is_multicast (host)) {
+    gchar *udp_uri = g_strdup_printf ("udp://%s:%d", host, port);
+    g_object_set (G_OBJECT (udpsrc), "uri", udp_uri, NULL);
+    g_free (udp_uri);
+  } else {
+    g_object_set (G_OBJECT (udpsrc), "port", port, NULL);
+  }
+}
+
+/**
+ * gst_rtp_src_add_group:
+ * @self: The current #GstRtpSrc object
+ * @uri: (transfer full): The rtp:// URI of the group
+ *
+ * Join a group for fast channel change. The group stays joined when it is
+ * not active so a switch to it can start at the cached keyframe.
+ */
+static void
+gst_rtp_src_add_group (GstRtpSrc * self, GstUri * uri)
+{
+  GstRtpSrcGroup *group = g_slice_new0 (GstRtpSrcGroup);
+  const gchar *encoding_name;
+  GstPad *pad;
+  guint i;
+
+  group->self = self;
+  group->uri = uri;
+  g_mutex_init (&group->lock);
+  gst_barco_gop_cache_init (&group->cache, self->standby_cache_size);
+
+  /* the encoding-name of the element is the one of its uri */
+  encoding_name = gst_uri_get_query_value (uri, "encoding-name");
+  if (encoding_name == NULL && self->groups->len == 0)
+    encoding_name = self->encoding_name;
+  group->encoding_name = g_strdup (encoding_name);
+  for (i = 0; i < G_N_ELEMENTS (group->sniffers); i++)
+    gst_barco_sniffer_init (&group->sniffers[i]);
+
+  group->udpsrc = gst_rtp_src_make_udpsrc (self, NULL);
+  group->sink = gst_element_factory_make ("fakesink", NULL);
+  if (group->udpsrc == NULL || group->sink == NULL) {
+    GST_ERROR_OBJECT (self, "Problem creating standby group.");
+    if (group->udpsrc)
+      gst_object_unref (group->udpsrc);
+    if (group->sink)
+      gst_object_unref (group->sink);
+    gst_rtp_src_group_free (group);
+    return;
+  }
+
+  gst_rtp_src_set_udpsrc_uri (self, group->udpsrc, uri);
+  g_object_set (G_OBJECT (group->udpsrc),
+      "multicast-iface", self->multicast_iface, NULL);
+  xgst_barco_set_supported_parameter (group->udpsrc, "reuse", TRUE);
+  xgst_barco_set_supported_parameter (group->udpsrc, "buffer-size",
+      self->buffer_size);
+  xgst_barco_set_supported_parameter (group->udpsrc, "auto-multicast", TRUE);
+  g_object_set (G_OBJECT (group->sink), "sync", FALSE, "async", FALSE, NULL);
+
+  pad = gst_element_get_static_pad (group->udpsrc, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      gst_rtp_src_group_probe, group, NULL);
+  gst_object_unref (pad);
+
+  gst_bin_add_many (GST_BIN (self), group->udpsrc, group->sink, NULL);
+  gst_element_link (group->udpsrc, group->sink);
+  gst_element_sync_state_with_parent (group->sink);
+  gst_element_sync_state_with_parent (group->udpsrc);
+
+  g_ptr_array_add (self->groups, group);
+
+  GST_INFO_OBJECT (self, "Joined standby group %s:%d",
+      gst_uri_get_host (uri), gst_uri_get_port (uri));
+}
+
+/**
+ * gst_rtp_src_create_groups:
+ * @self: The current #GstRtpSrc object
+ *
+ * Join the groups of uri and standby-uris, the first one is active.
+ */
+static void
+gst_rtp_src_create_groups (GstRtpSrc * self)
+{
+  gchar **standby;
+
+  g_object_set (G_OBJECT (self->rtp_src),
+      "is-live", TRUE, "format", GST_FORMAT_TIME,
+      "max-bytes", (guint64) self->standby_cache_size * 2, NULL);
+
+  gst_rtp_src_clear_groups (self);
+  self->groups = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_rtp_src_group_free);
+  gst_rtp_src_add_group (self, gst_uri_ref (self->uri));
+
+  for (standby = self->standby_uris; *standby; standby++) {
+    GstUri *uri = gst_uri_from_string (g_strstrip (*standby));
+
+    if (uri == NULL || gst_uri_get_host (uri) == NULL) {
+      GST_WARNING_OBJECT (self, "Ignoring invalid standby URI %s", *standby);
+      if (uri)
+        gst_uri_unref (uri);
+      continue;
+    }
+    gst_rtp_src_add_group (self, uri);
+  }
+
+  if (self->groups->len > 0)
+    g_atomic_pointer_set (&self->active_group,
+        g_ptr_array_index (self->groups, 0));
+}
+
+/**
+ * gst_rtp_src_switch_group:
+ * @self: The current #GstRtpSrc object
+ *
+ * Make the group of the current uri the active one. When it was joined
+ * as a standby group, its cached GOP is pushed first so decoding starts
+ * without waiting for the next keyframe. Otherwise the active group is
+ * moved to the new uri.
+ */
+static void
+gst_rtp_src_switch_group (GstRtpSrc * self)
+{
+  GstRtpSrcGroup *group = NULL, *old;
+  GstBufferList *list = NULL;
+  GstFlowReturn flow;
+  guint i;
+
+  for (i = 0; i < self->groups->len; i++) {
+    GstRtpSrcGroup *g = g_ptr_array_index (self->groups, i);
+
+    if (g_strcmp0 (gst_uri_get_host (g->uri),
+            gst_uri_get_host (self->uri)) == 0 &&
+        gst_uri_get_port (g->uri) == gst_uri_get_port (self->uri)) {
+      group = g;
+      break;
+    }
+  }
+
+  if (group == NULL) {
+    GST_INFO_OBJECT (self, "%s:%d is not a standby group, rejoining",
+        gst_uri_get_host (self->uri), gst_uri_get_port (self->uri));
+    g_mutex_lock (&self->group_lock);
+    group = self->active_group;
+    g_mutex_lock (&group->lock);
+    gst_barco_gop_cache_clear (&group->cache);
+    gst_uri_unref (group->uri);
+    group->uri = gst_uri_ref (self->uri);
+    g_free (group->encoding_name);
+    group->encoding_name = g_strdup (self->encoding_name);
+    for (i = 0; i < G_N_ELEMENTS (group->sniffers); i++)
+      gst_barco_sniffer_init (&group->sniffers[i]);
+    g_mutex_unlock (&group->lock);
+    g_mutex_unlock (&self->group_lock);
+    gst_rtp_src_set_udpsrc_uri (self, group->udpsrc, self->uri);
+    return;
+  }
+
+  /* group_lock only serializes the switches, the probes of the old and
+   * the new group are held off while the cached GOP goes out */
+  g_mutex_lock (&self->group_lock);
+  old = self->active_group;
+  if (old != group) {
+    g_mutex_lock (&old->lock);
+    g_mutex_lock (&group->lock);
+    g_atomic_pointer_set (&self->active_group, group);
+    list = gst_barco_gop_cache_get (&group->cache);
+    if (list)
+      g_signal_emit_by_name (self->rtp_src, "push-buffer-list", list, &flow);
+    g_mutex_unlock (&group->lock);
+    g_mutex_unlock (&old->lock);
+  }
+  g_mutex_unlock (&self->group_lock);
+
+  GST_INFO_OBJECT (self, "Switched to standby group %s:%d, %u cached packets",
+      gst_uri_get_host (self->uri), gst_uri_get_port (self->uri),
+      list ? gst_buffer_list_length (list) : 0);
+
+  if (list)
+    gst_buffer_list_unref (list);
+}
+
+/**
+ * gst_rtp_src_mdi_probe:
+ * @pad: The src pad of the RTP receiver
+ * @info: The received packet
+ * @user_data: The current #GstRtpSrc object
+ *
+ * Account every packet in the MDI of the interval and drop it.
+ */
+static GstPadProbeReturn
+gst_rtp_src_mdi_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstClockTime now = gst_util_get_timestamp ();
+  GstMapInfo map;
+
+  if (gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    g_mutex_lock (&self->mdi_lock);
+    gst_barco_mdi_add (&self->mdi, map.data, map.size, now);
+    g_mutex_unlock (&self->mdi_lock);
+    /* the packets are dropped here, before the receive buffer probe */
+    g_atomic_int_add (&self->rcvbuf_bytes, map.size);
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  return GST_PAD_PROBE_DROP;
+}
+
+/**
+ * gst_rtp_src_mdi_timeout:
+ *
+ * Post the MDI of the interval that just ended on the bus.
+ */
+static gboolean
+gst_rtp_src_mdi_timeout (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  GstStructure *s;
+
+  g_mutex_lock (&self->mdi_lock);
+  s = gst_barco_mdi_take (&self->mdi, gst_util_get_timestamp ());
+  g_mutex_unlock (&self->mdi_lock);
+
+  GST_LOG_OBJECT (self, "MDI %" GST_PTR_FORMAT, s);
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self), s));
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_src_start_probe:
+ * @self: The current #GstRtpSrc object
+ *
+ * Probe mode: receive the packets into a fakesink, without rtpbin, and
+ * only measure the Media Delivery Index of the stream.
+ *
+ * Returns: true or false
+ */
+static gboolean
+gst_rtp_src_start_probe (GstRtpSrc * self)
+{
+  GstElement *sink;
+  GstClock *clock;
+  GstPad *pad;
+  gint clock_rate = DEFAULT_MDI_CLOCK_RATE;
+
+  self->rtp_src = gst_rtp_src_make_udpsrc (self, NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  if (self->rtp_src == NULL || sink == NULL) {
+    GST_ERROR_OBJECT (self, "Problem creating the MDI probe.");
+    if (self->rtp_src)
+      gst_object_unref (self->rtp_src);
+    if (sink)
+      gst_object_unref (sink);
+    self->rtp_src = NULL;
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Measuring MDI every %u ms", self->mdi_interval);
+
+  gst_rtp_src_set_udpsrc_uri (self, self->rtp_src, self->uri);
+  g_object_set (G_OBJECT (self->rtp_src),
+      "multicast-iface", self->multicast_iface, NULL);
+  xgst_barco_set_supported_parameter (self->rtp_src, "reuse", TRUE);
+  xgst_barco_set_supported_parameter (self->rtp_src, "timeout",
+      self->timeout);
+  xgst_barco_set_supported_parameter (self->rtp_src, "buffer-size",
+      self->buffer_size);
+  xgst_barco_set_supported_parameter (self->rtp_src, "auto-multicast", TRUE);
+  g_object_set (G_OBJECT (sink), "sync", FALSE, "async", FALSE, NULL);
+
+  if (self->caps && gst_caps_get_size (self->caps) > 0)
+    gst_structure_get_int (gst_caps_get_structure (self->caps, 0),
+        "clock-rate", &clock_rate);
+  gst_barco_mdi_init (&self->mdi, clock_rate);
+
+  pad = gst_element_get_static_pad (self->rtp_src, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      gst_rtp_src_mdi_probe, self, NULL);
+  gst_object_unref (pad);
+
+  gst_bin_add_many (GST_BIN (self), self->rtp_src, sink, NULL);
+  gst_element_link (self->rtp_src, sink);
+
+  clock = gst_system_clock_obtain ();
+  self->mdi_clock_id = gst_clock_new_periodic_id (clock,
+      gst_clock_get_time (clock) + self->mdi_interval * GST_MSECOND,
+      self->mdi_interval * GST_MSECOND);
+  gst_clock_id_wait_async (self->mdi_clock_id, gst_rtp_src_mdi_timeout,
+      self, NULL);
+  gst_object_unref (clock);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_src_stop_probe:
+ * @self: The current #GstRtpSrc object
+ */
+static void
+gst_rtp_src_stop_probe (GstRtpSrc * self)
+{
+  if (self->mdi_clock_id) {
+    gst_clock_id_unschedule (self->mdi_clock_id);
+    gst_clock_id_unref (self->mdi_clock_id);
+    self->mdi_clock_id = NULL;
+  }
+}
+
+/**
+ * gst_rtp_src_rcvbuf_probe:
+ * @pad: The src pad of the RTP receiver
+ * @info: The received packets
+ * @user_data: The current #GstRtpSrc object
+ *
+ * Count the received bytes to size the receive buffer on.
+ */
+static GstPadProbeReturn
+gst_rtp_src_rcvbuf_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  gsize size = 0;
+  guint i, n;
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+    n = gst_buffer_list_length (list);
+    for (i = 0; i < n; i++)
+      size += gst_buffer_get_size (gst_buffer_list_get (list, i));
+  } else {
+    size = gst_buffer_get_size (GST_PAD_PROBE_INFO_BUFFER (info));
+  }
+  g_atomic_int_add (&self->rcvbuf_bytes, size);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_rtp_src_rcvbuf_timeout:
+ *
+ * Read the drop counter of the receive socket and, with buffer-size 0,
+ * grow its receive buffer to hold the latency at the measured bitrate,
+ * or double it when the kernel dropped packets.
+ */
+static gboolean
+gst_rtp_src_rcvbuf_timeout (GstClock * clock, GstClockTime time,
+    GstClockID id, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+  GSocket *socket = NULL;
+  guint64 drops = 0, new_drops;
+  gboolean tune;
+  guint bytes, latency;
+  gint size, got;
+
+  bytes = g_atomic_int_and (&self->rcvbuf_bytes, 0);
+  g_object_get (G_OBJECT (self->rtp_src), "used-socket", &socket, NULL);
+  if (socket == NULL)
+    return TRUE;
+
+  /* barcortpuringsrc reads SO_RXQ_OVFL, udpsrc hides the control
+   * messages */
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (self->rtp_src),
+          "drops"))
+    g_object_get (G_OBJECT (self->rtp_src), "drops", &drops, NULL);
+  else
+    gst_barco_socket_get_drops (socket, &drops);
+
+  GST_OBJECT_LOCK (self);
+  new_drops = drops > self->drops ? drops - self->drops : 0;
+  self->drops = MAX (drops, self->drops);
+  latency = self->mp2t ? self->mp2t_latency : self->latency;
+  tune = self->buffer_size == 0;
+  size = gst_util_uint64_scale (bytes, latency * GST_MSECOND,
+      GST_RTP_SRC_RCVBUF_INTERVAL);
+  if (new_drops)
+    size = MAX (size, self->rcvbuf_size * 2);
+  size = MIN (size, GST_RTP_SRC_MAX_RCVBUF);
+  if (size <= self->rcvbuf_size)
+    tune = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  if (new_drops)
+    GST_WARNING_OBJECT (self, "The kernel dropped %" G_GUINT64_FORMAT
+        " packets, the receive buffer was full", new_drops);
+
+  if (tune && (got = gst_barco_socket_grow_rcvbuf (socket, size)) > 0) {
+    GST_OBJECT_LOCK (self);
+    if (got > self->rcvbuf_size)
+      GST_INFO_OBJECT (self, "Receive buffer grown to %d bytes", got);
+    self->rcvbuf_size = got;
+    if (got < size && !self->rcvbuf_capped) {
+      self->rcvbuf_capped = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      GST_ELEMENT_WARNING (self, RESOURCE, SETTINGS, (NULL),
+          ("Receive buffer limited to %d bytes instead of %d, raise "
+              "net.core.rmem_max", got, size));
+    } else {
+      GST_OBJECT_UNLOCK (self);
+    }
+  }
+
+  g_object_unref (socket);
+  return TRUE;
+}
+
+/**
+ * gst_rtp_src_start_rcvbuf:
+ * @self: The current #GstRtpSrc object
+ *
+ * Watch the receive socket once the receiver opened it, for udpsrc and
+ * barcortpuringsrc; shared memory and the capture ring have none.
+ */
+static void
+gst_rtp_src_start_rcvbuf (GstRtpSrc * self)
+{
+  GstClock *clock;
+  GstPad *pad;
+
+  if (self->rtp_src == NULL ||
+      !g_object_class_find_property (G_OBJECT_GET_CLASS (self->rtp_src),
+          "used-socket"))
+    return;
+
+  GST_OBJECT_LOCK (self);
+  self->drops = 0;
+  self->rcvbuf_size = 0;
+  self->rcvbuf_capped = FALSE;
+  GST_OBJECT_UNLOCK (self);
+  g_atomic_int_set (&self->rcvbuf_bytes, 0);
+
+  pad = gst_element_get_static_pad (self->rtp_src, "src");
+  self->rcvbuf_probe_id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST, gst_rtp_src_rcvbuf_probe, self, NULL);
+  gst_object_unref (pad);
+
+  clock = gst_system_clock_obtain ();
+  self->rcvbuf_clock_id = gst_clock_new_periodic_id (clock,
+      gst_clock_get_time (clock) + GST_RTP_SRC_RCVBUF_INTERVAL,
+      GST_RTP_SRC_RCVBUF_INTERVAL);
+  gst_clock_id_wait_async (self->rcvbuf_clock_id, gst_rtp_src_rcvbuf_timeout,
+      self, NULL);
+  gst_object_unref (clock);
+}
+
+/**
+ * gst_rtp_src_stop_rcvbuf:
+ * @self: The current #GstRtpSrc object
+ */
+static void
+gst_rtp_src_stop_rcvbuf (GstRtpSrc * self)
+{
+  GstPad *pad;
+
+  if (self->rcvbuf_clock_id) {
+    gst_clock_id_unschedule (self->rcvbuf_clock_id);
+    gst_clock_id_unref (self->rcvbuf_clock_id);
+    self->rcvbuf_clock_id = NULL;
+  }
+
+  if (self->rcvbuf_probe_id) {
+    pad = gst_element_get_static_pad (self->rtp_src, "src");
+    gst_pad_remove_probe (pad, self->rcvbuf_probe_id);
+    gst_object_unref (pad);
+    self->rcvbuf_probe_id = 0;
+  }
+}
+
+/**
+ * gst_rtp_src_stats_add:
+ * @stream: The #GstRtpSrcStreamStats of the pad
+ * @buffer: a received RTP packet
+ *
+ * Count @buffer in the statistics of its stream. The clock rate for the
+ * jitter is taken from the pt map once rtpbin asked for it.
+ */
+static void
+gst_rtp_src_stats_add (GstRtpSrcStreamStats * stream, GstBuffer * buffer)
+{
+  GstBarcoPadStats *stats = &stream->stats;
+  GstMapInfo map;
+  guint pt;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return;
+  if (map.size < 12) {
+    gst_buffer_unmap (buffer, &map);
+    return;
+  }
+
+  pt = map.data[1] & 0x7f;
+  if (stats->packets == 0) {
+    stats->ssrc = GST_READ_UINT32_BE (map.data + 8);
+    stats->pt = pt;
+  }
+  if (stats->clock_rate == 0)
+    stats->clock_rate = g_atomic_int_get (&stream->self->clock_rates[pt]);
+
+  gst_barco_pad_stats_add (stats, map.data, map.size,
+      GST_BUFFER_DTS (buffer));
+  gst_buffer_unmap (buffer, &map);
+}
+
+/**
+ * gst_rtp_src_stats_probe:
+ * @pad: The sink pad the stream enters on
+ * @info: The received packets
+ * @user_data: The #GstRtpSrcStreamStats of @pad
+ *
+ * Runs with the stream lock of @pad, so there is one writer even when
+ * the merge and the FEC decoder push from their own threads.
+ */
+static GstPadProbeReturn
+gst_rtp_src_stats_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRtpSrcStreamStats *stream = user_data;
+  guint i, n;
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+    n = gst_buffer_list_length (list);
+    for (i = 0; i < n; i++)
+      gst_rtp_src_stats_add (stream, gst_buffer_list_get (list, i));
+  } else {
+    gst_rtp_src_stats_add (stream, GST_PAD_PROBE_INFO_BUFFER (info));
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gpointer
+gst_rtp_src_stream_stats_ref (gpointer data, gpointer user_data)
+{
+  GstRtpSrcStreamStats *stream = data;
+
+  if (stream)
+    g_atomic_int_inc (&stream->refcount);
+
+  return stream;
+}
+
+static void
+gst_rtp_src_stream_stats_unref (gpointer data)
+{
+  GstRtpSrcStreamStats *stream = data;
+
+  if (g_atomic_int_dec_and_test (&stream->refcount))
+    g_slice_free (GstRtpSrcStreamStats, stream);
+}
+
+/**
+ * gst_rtp_src_add_stats:
+ * @self: The current #GstRtpSrc object
+ * @pad: The sink pad of the jitterbuffer of an SSRC, or of the MPEG-TS
+ * receiver
+ * @clock_rate: RTP clock rate of the stream, 0 to take it from the pt map
+ *
+ * Count the packets of a stream on @pad. The counters go away with @pad
+ * when rtpbin frees the stream after a BYE or a timeout.
+ */
+static void
+gst_rtp_src_add_stats (GstRtpSrc * self, GstPad * pad, guint clock_rate)
+{
+  GstRtpSrcStreamStats *stream = g_slice_new0 (GstRtpSrcStreamStats);
+
+  stream->refcount = 2;
+  stream->self = self;
+  gst_barco_pad_stats_init (&stream->stats, clock_rate);
+  stream->probe_id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST, gst_rtp_src_stats_probe, stream,
+      gst_rtp_src_stream_stats_unref);
+  g_object_set_data_full (G_OBJECT (pad), "rtpsrc.stats", stream,
+      gst_rtp_src_stream_stats_unref);
+}
+
+/**
+ * gst_rtp_src_remove_stats:
+ * @self: The current #GstRtpSrc object
+ * @ssrc: an SSRC rtpbin removed the pad of
+ *
+ * Stop counting the packets of @ssrc and free its counters, without
+ * waiting for rtpbin to drop the last ref to its jitterbuffer.
+ */
+static void
+gst_rtp_src_remove_stats (GstRtpSrc * self, guint ssrc)
+{
+  GstRtpSrcStreamStats *stream;
+  GstIterator *it;
+  GValue v = G_VALUE_INIT;
+  GstPad *pad;
+
+  if (self->rtpbin == NULL)
+    return;
+
+  it = gst_bin_iterate_recurse (GST_BIN (self->rtpbin));
+  while (gst_iterator_next (it, &v) == GST_ITERATOR_OK) {
+    pad = gst_element_get_static_pad (g_value_get_object (&v), "sink");
+    g_value_unset (&v);
+    if (pad == NULL)
+      continue;
+
+    stream = g_object_dup_data (G_OBJECT (pad), "rtpsrc.stats",
+        gst_rtp_src_stream_stats_ref, NULL);
+    if (stream && stream->stats.ssrc == ssrc) {
+      GST_DEBUG_OBJECT (self, "Freeing the counters of SSRC 0x%x", ssrc);
+      g_object_set_data (G_OBJECT (pad), "rtpsrc.stats", NULL);
+      gst_pad_remove_probe (pad, stream->probe_id);
+    }
+    if (stream)
+      gst_rtp_src_stream_stats_unref (stream);
+    gst_object_unref (pad);
+  }
+  gst_iterator_free (it);
+}
+
+/**
+ * gst_rtp_src_stream_pad:
+ * @self: The current #GstRtpSrc object
+ * @ssrc: an SSRC
+ * @pt: its payload type
+ *
+ * Returns: (transfer full) (nullable): the name of the src pad the
+ * stream is pushed on
+ */
+static gchar *
+gst_rtp_src_stream_pad (GstRtpSrc * self, guint ssrc, guint pt)
+{
+  gchar *name = NULL;
+  GstPad *target;
+  GList *l;
+  guint sess, pad_ssrc, pad_pt;
+
+  GST_OBJECT_LOCK (self);
+  for (l = GST_ELEMENT (self)->srcpads; l && name == NULL; l = l->next) {
+    /* there is a single stream without rtpbin */
+    if (self->mp2t) {
+      name = gst_pad_get_name (l->data);
+      break;
+    }
+    target = gst_ghost_pad_get_target (GST_GHOST_PAD (l->data));
+    if (target == NULL)
+      continue;
+    if (sscanf (GST_OBJECT_NAME (target), "recv_rtp_src_%u_%u_%u", &sess,
+            &pad_ssrc, &pad_pt) == 3 && pad_ssrc == ssrc && pad_pt == pt)
+      name = gst_pad_get_name (l->data);
+    gst_object_unref (target);
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return name;
+}
+
+/**
+ * gst_rtp_src_append_stats:
+ * @self: The current #GstRtpSrc object
+ * @element: an element of the bin
+ * @streams: the array of GstRtpSrcStreamStats
+ *
+ * Append the counters of the stream entering @element, if any.
+ */
+static void
+gst_rtp_src_append_stats (GstRtpSrc * self, GstElement * element,
+    GValue * streams)
+{
+  GstPad *pad = gst_element_get_static_pad (element, "sink");
+  GstRtpSrcStreamStats *stream;
+  GValue v = G_VALUE_INIT;
+  gchar *name;
+
+  if (pad == NULL)
+    return;
+
+  stream = g_object_dup_data (G_OBJECT (pad), "rtpsrc.stats",
+      gst_rtp_src_stream_stats_ref, NULL);
+  if (stream) {
+    name = gst_rtp_src_stream_pad (self, stream->stats.ssrc,
+        stream->stats.pt);
+    g_value_init (&v, GST_TYPE_STRUCTURE);
+    g_value_take_boxed (&v, gst_barco_pad_stats_to_structure
+        (&stream->stats, "GstRtpSrcStreamStats", name));
+    gst_value_array_append_and_take_value (streams, &v);
+    g_free (name);
+    gst_rtp_src_stream_stats_unref (stream);
+  }
+  gst_object_unref (pad);
+}
+
+/**
+ * gst_rtp_src_get_stats:
+ * @self: The current #GstRtpSrc object
+ *
+ * Returns: (transfer full): a GstRtpSrcStats structure with the kernel
+ * drops, the packets waiting in the queue in front of rtpbin and a
+ * GstRtpSrcStreamStats per SSRC
+ */
+static GstStructure *
+gst_rtp_src_get_stats (GstRtpSrc * self)
+{
+  GValue streams = G_VALUE_INIT;
+  GValue v = G_VALUE_INIT;
+  GstStructure *s;
+  GstIterator *it;
+  gboolean done = FALSE;
+  guint64 drops;
+  guint level = 0;
+
+  g_value_init (&streams, GST_TYPE_ARRAY);
+  if (self->mp2t) {
+    gst_rtp_src_append_stats (self, self->mp2t, &streams);
+  } else if (self->rtpbin) {
+    /* a jitterbuffer per SSRC */
+    it = gst_bin_iterate_recurse (GST_BIN (self->rtpbin));
+    while (!done) {
+      switch (gst_iterator_next (it, &v)) {
+        case GST_ITERATOR_OK:
+          gst_rtp_src_append_stats (self, g_value_get_object (&v), &streams);
+          g_value_unset (&v);
+          break;
+        case GST_ITERATOR_RESYNC:
+          g_value_unset (&streams);
+          g_value_init (&streams, GST_TYPE_ARRAY);
+          gst_iterator_resync (it);
+          break;
+        default:
+          done = TRUE;
+          break;
+      }
+    }
+    gst_iterator_free (it);
+  }
+
+  if (self->rtp_queue)
+    g_object_get (G_OBJECT (self->rtp_queue), "current-level-buffers",
+        &level, NULL);
+
+  GST_OBJECT_LOCK (self);
+  drops = self->drops;
+  GST_OBJECT_UNLOCK (self);
+
+  s = gst_structure_new ("GstRtpSrcStats",
+      "drops", G_TYPE_UINT64, drops,
+      "queue-level", G_TYPE_UINT, level, NULL);
+  gst_structure_take_value (s, "streams", &streams);
+
+  return s;
+}
+
+/**
+ * gst_rtp_src_stats_timeout:
+ *
+ * Post the statistics on the bus.
+ */
+static gboolean
+gst_rtp_src_stats_timeout (GstClock * clock, GstClockTime time,
+    GstClockID id, gpointer user_data)
+{
+  GstRtpSrc *self = GST_RTP_SRC (user_data);
+
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_rtp_src_get_stats (self)));
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_src_start_stats:
+ * @self: The current #GstRtpSrc object
+ */
+static void
+gst_rtp_src_start_stats (GstRtpSrc * self)
+{
+  GstClock *clock;
+
+  if (self->stats_interval == 0)
+    return;
+
+  clock = gst_system_clock_obtain ();
+  self->stats_clock_id = gst_clock_new_periodic_id (clock,
+      gst_clock_get_time (clock) + self->stats_interval * GST_MSECOND,
+      self->stats_interval * GST_MSECOND);
+  gst_clock_id_wait_async (self->stats_clock_id, gst_rtp_src_stats_timeout,
+      self, NULL);
+  gst_object_unref (clock);
+}
+
+/**
+ * gst_rtp_src_stop_stats:
+ * @self: The current #GstRtpSrc object
+ */
+static void
+gst_rtp_src_stop_stats (GstRtpSrc * self)
+{
+  if (self->stats_clock_id) {
+    gst_clock_id_unschedule (self->stats_clock_id);
+    gst_clock_id_unref (self->stats_clock_id);
+    self->stats_clock_id = NULL;
+  }
+}
+
+/**
+ * gst_rtp_src_add_mp2t_pad:
+ * @self: The current #GstRtpSrc object
+ *
+ * The MPEG-TS path has a single stream, exposed right away.
+ */
+static void
+gst_rtp_src_add_mp2t_pad (GstRtpSrc * self)
+{
+  GstPad *pad = gst_element_get_static_pad (self->mp2t, "src");
+  gchar *name = g_strdup_printf ("src%d",
+      g_atomic_int_add (&self->n_rtpbin_pads, 1));
+  GstPad *ghost = gst_ghost_pad_new (name, pad);
+
+  g_free (name);
+  gst_object_unref (pad);
+  gst_barco_latency_mark_pad (ghost, GST_ELEMENT (self),
+      GST_BARCO_LATENCY_PUSH);
+
+  gst_pad_set_active (ghost, TRUE);
+  gst_element_add_pad (GST_ELEMENT (self), ghost);
+
+  if (g_atomic_int_compare_and_exchange (&self->no_more_pads, FALSE, TRUE))
+    gst_element_no_more_pads (GST_ELEMENT (self));
+}
+
+/**
+ * gst_rtp_src_sdp_media_caps:
+ * @self: The current #GstRtpSrc object
+ * @sdp: the parsed SDP
+ * @media: an RTP media of @sdp
+ *
+ * Build the exact caps of every payload type of @media: rtpmap, fmtp
+ * (like sprop-parameter-sets or config) and the other attributes.
  */
 static void
-gst_rtp_src_rtpbin_on_new_ssrc_cb (GstElement* object,
-    guint sess_id,
-    guint ssrc,
-    gpointer user_data)
+gst_rtp_src_sdp_media_caps (GstRtpSrc * self, const GstSDPMessage * sdp,
+    const GstSDPMedia * media)
 {
-  GstRtpSrc *self = GST_RTP_SRC(user_data);
-
-  GST_INFO_OBJECT(self, "Dectected a new SSRC: session 0x%x, ssrc 0x%x.", sess_id, ssrc);
+  guint i;
+
+  for (i = 0; i < gst_sdp_media_formats_len (media); i++) {
+    gint pt = atoi (gst_sdp_media_get_format (media, i));
+    GstCaps *caps;
+
+    if (pt < 0 || pt > 127)
+      continue;
+    caps = gst_sdp_media_get_caps_from_media (media, pt);
+    if (caps == NULL)
+      continue;
+
+    gst_structure_set_name (gst_caps_get_structure (caps, 0),
+        "application/x-rtp");
+    gst_sdp_message_attributes_to_caps (sdp, caps);
+    gst_sdp_media_attributes_to_caps (media, caps);
+    if (self->rtx_pt > 0)
+      gst_caps_set_simple (caps, "rtcp-fb-nack", G_TYPE_BOOLEAN, TRUE, NULL);
+
+    GST_INFO_OBJECT (self, "SDP pt %d: %" GST_PTR_FORMAT, pt, caps);
+    g_hash_table_insert (self->sdp_caps, GUINT_TO_POINTER (pt), caps);
+  }
 }
 
 /**
- * gst_rtp_src_rtpbin_on_sssrc_collision_cb:
- * @object: The #GstElement that threw the signal
- * @sess_id: the session-id of the session
- * @ssrc: the ssrc of the new stream
- * @user_data: gpointer to the current #GstRtpSrc object
+ * gst_rtp_src_load_sdp:
+ * @self: The current #GstRtpSrc object
  *
- * Callback thrown when a collision is detected in an RTP session
+ * Parse the SDP text or file of the sdp property into the caps of its
+ * payload types. When the uri does not name an address, the address and
+ * port of the media are received.
+ *
+ * Returns: FALSE if the SDP cannot be read
  */
-static void
-gst_rtp_src_rtpbin_on_ssrc_collision_cb (GstElement* object,
-    guint sess_id,
-    guint ssrc,
-    gpointer user_data)
+static gboolean
+gst_rtp_src_load_sdp (GstRtpSrc * self)
 {
-  GstRtpSrc *self = GST_RTP_SRC(user_data);
+  GstSDPMessage *sdp = NULL;
+  const GstSDPMedia *media = NULL;
+  const GstSDPConnection *conn = NULL;
+  gchar *text = NULL, *path;
+  gsize len = 0;
+  guint i;
+
+  g_clear_pointer (&self->sdp_caps, g_hash_table_unref);
+  if (self->sdp == NULL)
+    return TRUE;
 
-  GST_WARNING_OBJECT(self, "Dectected an SSRC collision: session 0x%x, ssrc 0x%x.", sess_id, ssrc);
+  if (g_str_has_prefix (self->sdp, "v=")) {
+    text = g_strdup (self->sdp);
+    len = strlen (text);
+  } else {
+    path = g_str_has_prefix (self->sdp, "file:") ?
+        g_filename_from_uri (self->sdp, NULL, NULL) : g_strdup (self->sdp);
+    if (path == NULL || !g_file_get_contents (path, &text, &len, NULL)) {
+      GST_ERROR_OBJECT (self, "Could not read SDP %s", self->sdp);
+      g_free (path);
+      return FALSE;
+    }
+    g_free (path);
+  }
+
+  gst_sdp_message_new (&sdp);
+  if (gst_sdp_message_parse_buffer ((const guint8 *) text, len, sdp) !=
+      GST_SDP_OK) {
+    GST_ERROR_OBJECT (self, "Could not parse SDP %s", self->sdp);
+    gst_sdp_message_free (sdp);
+    g_free (text);
+    return FALSE;
+  }
+  g_free (text);
+
+  /* the RTP media on the port of the uri, or the first one */
+  for (i = 0; i < gst_sdp_message_medias_len (sdp); i++) {
+    const GstSDPMedia *m = gst_sdp_message_get_media (sdp, i);
+
+    if (!g_str_has_prefix (gst_sdp_media_get_proto (m), "RTP/"))
+      continue;
+    if (media == NULL || gst_sdp_media_get_port (m) ==
+        (guint) gst_uri_get_port (self->uri))
+      media = m;
+  }
+  if (media == NULL) {
+    GST_ERROR_OBJECT (self, "No RTP media in SDP %s", self->sdp);
+    gst_sdp_message_free (sdp);
+    return FALSE;
+  }
+
+  self->sdp_caps = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) gst_caps_unref);
+  gst_rtp_src_sdp_media_caps (self, sdp, media);
+
+  if (g_strcmp0 (gst_uri_get_host (self->uri), "0.0.0.0") == 0) {
+    conn = gst_sdp_media_connections_len (media) > 0 ?
+        gst_sdp_media_get_connection (media, 0) :
+        gst_sdp_message_get_connection (sdp);
+    if (conn && conn->address) {
+      self->uri = gst_uri_make_writable (self->uri);
+      gst_uri_set_host (self->uri, conn->address);
+      gst_uri_set_port (self->uri, gst_sdp_media_get_port (media));
+      GST_INFO_OBJECT (self, "Receiving %s:%u from the SDP", conn->address,
+          gst_sdp_media_get_port (media));
+    }
+  }
+
+  gst_sdp_message_free (sdp);
+
+  return TRUE;
 }
 
 /**
@@ -527,18 +3014,56 @@ gst_rtp_src_start (GstRtpSrc * self)
   GstElement *lastelt;
   GstStateChangeReturn ret;
   GstElement *queue;
+  gboolean uring = FALSE;
+  gboolean capture = FALSE;
+  gboolean rtcp = self->enable_rtcp && self->mp2t_latency == 0;
+
+  gst_rtp_src_clear_pt_caps (self);
+  gst_rtp_src_clear_rtx (self);
+  if (!gst_rtp_src_load_sdp (self))
+    GST_ELEMENT_WARNING (self, RESOURCE, READ, (NULL),
+        ("Could not use SDP %s, guessing the caps", self->sdp));
+
+  if (self->mdi_interval > 0)
+    return gst_rtp_src_start_probe (self);
 
   /* Create elements */
   GST_DEBUG_OBJECT (self, "Creating elements");
 
-  self->rtp_src = gst_element_factory_make ("udpsrc", NULL);
+  /* with standby groups, the packets of the active group are pushed into
+   * an appsrc */
+  if (self->standby_uris && *self->standby_uris)
+    self->rtp_src = gst_element_factory_make ("appsrc", NULL);
+  else if (gst_barco_is_shm (self->uri))
+    self->rtp_src = gst_element_factory_make ("shmsrc", NULL);
+  else if (self->capture_iface)
+    self->rtp_src = gst_rtp_src_make_udpsrc (self, &capture);
+  else if ((self->io_uring || self->kernel_timestamps) &&
+      gst_barco_uring_supported () &&
+      (self->rtp_src = gst_element_factory_make ("barcortpuringsrc", NULL)))
+    uring = TRUE;
+  else {
+    if (self->io_uring)
+      GST_WARNING_OBJECT (self, "No io_uring support, receiving with udpsrc.");
+    /* udpsrc does not hand out the control messages of the socket */
+    if (self->kernel_timestamps)
+      GST_WARNING_OBJECT (self, "No kernel timestamps without io_uring or "
+          "capture-iface, timing the packets when they are read.");
+    self->rtp_src = gst_element_factory_make ("udpsrc", NULL);
+  }
   queue = gst_element_factory_make ("queue", NULL);
   g_return_val_if_fail (self->rtp_src != NULL, FALSE);
 
-  self->rtpbin = gst_element_factory_make ("rtpbin", NULL);
-  g_return_val_if_fail (self->rtpbin != NULL, FALSE);
+  /* MPEG-TS is timed on its PCR, not in a jitterbuffer */
+  if (self->mp2t_latency > 0) {
+    self->mp2t = gst_element_factory_make ("barcortpmp2t", NULL);
+    g_return_val_if_fail (self->mp2t != NULL, FALSE);
+  } else {
+    self->rtpbin = gst_element_factory_make ("rtpbin", NULL);
+    g_return_val_if_fail (self->rtpbin != NULL, FALSE);
+  }
 
-  if (self->enable_rtcp) {
+  if (rtcp) {
     GST_DEBUG_OBJECT (self, "Enabling RTCP");
     self->rtcp_src = gst_element_factory_make ("udpsrc", NULL);
     self->rtcp_sink = gst_element_factory_make ("udpsink", NULL);
@@ -565,7 +3090,19 @@ gst_rtp_src_start (GstRtpSrc * self)
   }
 
   /* Set properties */
-  if (gst_rtp_src_is_multicast (gst_uri_get_host(self->uri))) {
+  if (self->standby_uris && *self->standby_uris) {
+    GST_DEBUG_OBJECT(self, "Receiving from standby groups.");
+  } else if (gst_barco_is_shm (self->uri)) {
+    /* the buffers wrap the shared memory of rtpsink, they are not copied */
+    uri = gst_barco_shm_socket_path (self->uri, 0);
+    GST_DEBUG_OBJECT(self, "Receiving RTP through shared memory on %s.", uri);
+    g_object_set (G_OBJECT (self->rtp_src),
+        "socket-path", uri,
+        "is-live", TRUE,
+        "do-timestamp", TRUE,
+        NULL);
+    g_free (uri);
+  } else if (gst_rtp_src_is_multicast (gst_uri_get_host(self->uri))) {
     GST_DEBUG_OBJECT(self, "Setting a multicast URI.");
     uri = g_strdup_printf ("udp://%s:%d", gst_uri_get_host(self->uri), gst_uri_get_port(self->uri));
     g_object_set (G_OBJECT (self->rtp_src), "uri", uri, NULL);
@@ -575,13 +3112,23 @@ gst_rtp_src_start (GstRtpSrc * self)
     g_object_set (G_OBJECT (self->rtp_src), "port", gst_uri_get_port(self->uri), NULL);
   }
 
-  g_object_set (G_OBJECT (self->rtp_src),
-      "reuse", TRUE,
-      "timeout", self->timeout,
-      "multicast-iface", self->multicast_iface,
-      "buffer-size", self->buffer_size, "auto-multicast", TRUE, NULL);
+  if (capture)
+    g_object_set (G_OBJECT (self->rtp_src),
+        "multicast-iface", self->multicast_iface, NULL);
+  else if (uring)
+    g_object_set (G_OBJECT (self->rtp_src),
+        "multicast-iface", self->multicast_iface,
+        "buffer-size", self->buffer_size,
+        "kernel-timestamps", self->kernel_timestamps, NULL);
+  else if (!(self->standby_uris && *self->standby_uris) &&
+      !gst_barco_is_shm (self->uri))
+    g_object_set (G_OBJECT (self->rtp_src),
+        "reuse", TRUE,
+        "timeout", self->timeout,
+        "multicast-iface", self->multicast_iface,
+        "buffer-size", self->buffer_size, "auto-multicast", TRUE, NULL);
 
-  if (self->enable_rtcp) {
+  if (rtcp) {
     if (gst_rtp_src_is_multicast (gst_uri_get_host(self->uri))) {
       uri =
           g_strdup_printf ("udp://%s:%d", gst_uri_get_host(self->uri),
@@ -613,20 +3160,58 @@ gst_rtp_src_start (GstRtpSrc * self)
         NULL);
   }
 
-  g_object_set (G_OBJECT (self->rtpbin),
-      "do-lost", TRUE,
-      "autoremove", TRUE,
-      "rtp-profile", 2, /* GST_RTP_PROFILE_AVPF */
-      "ignore-pt", self->pt_change,
-      "latency", self->latency,
-      NULL);
+  if (self->mp2t)
+    g_object_set (G_OBJECT (self->mp2t), "latency", self->mp2t_latency, NULL);
+  else
+    g_object_set (G_OBJECT (self->rtpbin),
+        "do-lost", TRUE,
+        "autoremove", TRUE,
+        "rtp-profile", 2, /* GST_RTP_PROFILE_AVPF */
+        "ignore-pt", self->pt_change,
+        "latency", self->latency,
+        "do-retransmission", (self->rtx_pt > 0),
+        NULL);
+
+  if (self->rtx_pt > 0 && !rtcp)
+    GST_WARNING_OBJECT (self, "Retransmission needs RTCP to send NACKs");
 
   /* Add elements to the bin and link them */
-  gst_bin_add_many (GST_BIN (self), self->rtp_src, self->rtpbin, NULL);
+  gst_bin_add_many (GST_BIN (self), self->rtp_src,
+      self->mp2t ? self->mp2t : self->rtpbin, NULL);
   gst_bin_add_many (GST_BIN (self), queue, NULL);
   gst_element_link_many(self->rtp_src, queue, NULL);
   /*lastelt = self->rtp_src;*/
   lastelt = queue;
+  self->rtp_queue = queue;
+  gst_rtp_src_mark_latency (self, self->rtp_src, GST_BARCO_LATENCY_RECEIVE);
+  gst_rtp_src_mark_latency (self, queue, GST_BARCO_LATENCY_QUEUE);
+
+  if (self->standby_uris && *self->standby_uris)
+    gst_rtp_src_create_groups (self);
+
+  /* the FEC and the header changes only need to process the merged
+   * stream, so SMPTE 2022-7 goes first */
+  if (self->redundant_uri) {
+    self->merge = gst_rtp_src_create_redundant (self);
+    if (self->merge) {
+      GST_DEBUG_OBJECT (self, "Adding SMPTE 2022-7 merger");
+      gst_element_link_pads (lastelt, "src", self->merge, "sink_0");
+      lastelt = self->merge;
+    } else {
+      GST_ERROR_OBJECT (self, "Problem setting up redundancy, receiving without.");
+    }
+  }
+
+  if (self->fec != GST_RTP_FEC_MODE_NONE) {
+    self->fec_dec = gst_rtp_src_create_fec (self);
+    if (self->fec_dec) {
+      GST_DEBUG_OBJECT (self, "Adding FEC recovery");
+      gst_element_link (lastelt, self->fec_dec);
+      lastelt = self->fec_dec;
+    } else {
+      GST_ERROR_OBJECT (self, "Problem setting up FEC, receiving without.");
+    }
+  }
 
   if (self->rtpheaderchange) {
     GST_DEBUG_OBJECT (self, "Adding RTP Header change");
@@ -634,22 +3219,58 @@ gst_rtp_src_start (GstRtpSrc * self)
     gst_element_link (lastelt, self->rtpheaderchange);
     lastelt = self->rtpheaderchange;
   }
-  gst_element_link_pads (lastelt, "src", self->rtpbin, "recv_rtp_sink_0");
 
-  g_signal_connect (self->rtpbin, "request-pt-map",
-      G_CALLBACK (gst_rtp_src_request_pt_map_cb), self);
+  if (self->mp2t) {
+    GstPad *pad = gst_element_get_static_pad (self->mp2t, "sink");
+
+    gst_rtp_src_add_stats (self, pad, DEFAULT_MDI_CLOCK_RATE);
+    gst_object_unref (pad);
+    gst_element_link (lastelt, self->mp2t);
+    gst_rtp_src_add_mp2t_pad (self);
+  } else {
+    /* without an encoding name, the dynamic payload types are sniffed
+     * before rtpbin asks for their caps */
+    if (self->encoding_name == NULL && self->caps == NULL &&
+        self->sdp_caps == NULL) {
+      GstPad *pad = gst_element_get_static_pad (lastelt, "src");
+      guint i;
+
+      gst_rtp_src_clear_sniffed (self);
+      for (i = 0; i < G_N_ELEMENTS (self->sniffers); i++)
+        gst_barco_sniffer_init (&self->sniffers[i]);
+      gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+          GST_PAD_PROBE_TYPE_BUFFER_LIST, gst_rtp_src_sniff_probe, self,
+          NULL);
+      gst_object_unref (pad);
+    }
+    gst_element_link_pads (lastelt, "src", self->rtpbin, "recv_rtp_sink_0");
+
+    g_signal_connect (self->rtpbin, "request-pt-map",
+        G_CALLBACK (gst_rtp_src_request_pt_map_cb), self);
+
+    g_signal_connect (self->rtpbin, "pad-added",
+        G_CALLBACK (gst_rtp_src_rtpbin_pad_added_cb), self);
+
+    g_signal_connect (self->rtpbin, "pad-removed",
+        G_CALLBACK (gst_rtp_src_rtpbin_pad_removed_cb), self);
 
-  g_signal_connect (self->rtpbin, "pad-added",
-      G_CALLBACK (gst_rtp_src_rtpbin_pad_added_cb), self);
+    g_signal_connect (self->rtpbin, "on-new-ssrc",
+        G_CALLBACK (gst_rtp_src_rtpbin_on_new_ssrc_cb), self);
 
-  g_signal_connect (self->rtpbin, "on-new-ssrc",
-      G_CALLBACK (gst_rtp_src_rtpbin_on_new_ssrc_cb), self);
+    g_signal_connect (self->rtpbin, "on-bye-ssrc",
+        G_CALLBACK (gst_rtp_src_rtpbin_on_bye_ssrc_cb), self);
 
-  g_signal_connect (self->rtpbin, "on-ssrc-collision",
-      G_CALLBACK (gst_rtp_src_rtpbin_on_ssrc_collision_cb), self);
+    g_signal_connect (self->rtpbin, "on-ssrc-collision",
+        G_CALLBACK (gst_rtp_src_rtpbin_on_ssrc_collision_cb), self);
 
+    g_signal_connect (self->rtpbin, "request-aux-receiver",
+        G_CALLBACK (gst_rtp_src_rtpbin_request_aux_receiver_cb), self);
 
-  if (self->enable_rtcp) {
+    g_signal_connect (self->rtpbin, "new-jitterbuffer",
+        G_CALLBACK (gst_rtp_src_rtpbin_new_jitterbuffer_cb), self);
+  }
+
+  if (rtcp) {
     GST_DEBUG_OBJECT (self, "Adding elements and linking up.");
     gst_bin_add_many (GST_BIN (self), self->rtcp_src, self->rtcp_sink,
         NULL);
@@ -661,6 +3282,15 @@ gst_rtp_src_start (GstRtpSrc * self)
   }
 
   gst_element_sync_state_with_parent(queue);
+  if (self->merge) {
+    gst_element_sync_state_with_parent (self->merge);
+    gst_element_sync_state_with_parent (self->redundant_src);
+  }
+  if (self->fec_dec) {
+    gst_element_sync_state_with_parent (self->fec_dec);
+    gst_element_sync_state_with_parent (self->fec_src[0]);
+    gst_element_sync_state_with_parent (self->fec_src[1]);
+  }
 
   /* Sync elements states to the parent bin */
   ret = gst_element_set_state (self->rtp_src, GST_STATE_READY);
@@ -685,12 +3315,13 @@ gst_rtp_src_start (GstRtpSrc * self)
     }
   }
 
-  ret = gst_element_set_state (self->rtpbin, GST_STATE_READY);
+  ret = gst_element_set_state (self->mp2t ? self->mp2t : self->rtpbin,
+      GST_STATE_READY);
   if (ret == GST_STATE_CHANGE_FAILURE){
     GST_ERROR_OBJECT (self, "Could not set RTP bin to READY");
   }
 
-  if (self->enable_rtcp) {
+  if (rtcp) {
     GSocket *rtcpfd = NULL;
 
     /** The order of these lines is really important **/
@@ -749,6 +3380,8 @@ gst_rtp_src_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       {
         GST_DEBUG_OBJECT (self, "Shutting down");
+        gst_rtp_src_stop_rcvbuf (self);
+        gst_rtp_src_stop_stats (self);
       }
       break;
     default:
@@ -759,6 +3392,18 @@ gst_rtp_src_change_state (GstElement * element, GstStateChange transition)
   if (ret == GST_STATE_CHANGE_FAILURE)
     goto done;
 
+  /* the receivers open their sockets going to PAUSED */
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED) {
+    gst_rtp_src_start_rcvbuf (self);
+    gst_rtp_src_start_stats (self);
+  }
+  if (transition == GST_STATE_CHANGE_READY_TO_NULL) {
+    gst_rtp_src_stop_probe (self);
+    gst_rtp_src_clear_groups (self);
+    gst_rtp_src_clear_rtx (self);
+    gst_rtp_src_clear_sniffed (self);
+  }
+
 done:
   return ret;
 
@@ -778,7 +3423,9 @@ gst_rtp_src_uri_get_type (GType type)
 static const gchar *const *
 gst_rtp_src_uri_get_protocols (GType type)
 {
-  static const gchar *protocols[] = { (char *) "rtp", NULL };
+  static const gchar *protocols[] = { (char *) "rtp", (char *) "rtp+shm",
+    NULL
+  };
 
   return protocols;
 }
@@ -839,6 +3486,22 @@ gst_rtp_src_finalize (GObject * gobject)
     gst_uri_unref (src->uri);
   if (src->encoding_name)
     g_free (src->encoding_name);
+  if (src->redundant_uri)
+    gst_uri_unref (src->redundant_uri);
+  g_free (src->redundant_multicast_iface);
+  g_free (src->capture_iface);
+  g_strfreev (src->standby_uris);
+  g_free (src->sdp);
+  if (src->sdp_caps)
+    g_hash_table_unref (src->sdp_caps);
+  gst_rtp_src_clear_pt_caps (src);
+  gst_rtp_src_clear_rtx (src);
+  gst_rtp_src_clear_sniffed (src);
+  if (src->groups)
+    g_ptr_array_unref (src->groups);
+  g_mutex_clear (&src->group_lock);
+  gst_rtp_src_stop_probe (src);
+  g_mutex_clear (&src->mdi_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (gobject);
 }
@@ -853,12 +3516,22 @@ gst_rtp_src_set_property (GObject * object, guint prop_id,
   switch (prop_id) {
     case PROP_URI:{
       gchar *uri = NULL;
+      GstUri *new_uri = gst_uri_from_string (g_value_get_string (value));
+
+      /* keep receiving the current stream on a typo */
+      if (new_uri == NULL) {
+        GST_WARNING_OBJECT (self, "Could not parse uri %s, keeping %"
+            GST_PTR_FORMAT, g_value_get_string (value), self->uri);
+        break;
+      }
       if (self->uri)
         gst_uri_unref (self->uri);
-      self->uri = gst_uri_from_string (g_value_get_string (value));
+      self->uri = new_uri;
 
       gst_object_set_properties_from_uri_query_parameters (G_OBJECT (self), self->uri);
-      if (self->rtp_src) {
+      if (self->groups) {
+        gst_rtp_src_switch_group (self);
+      } else if (self->rtp_src && !gst_barco_is_shm (self->uri)) {
         uri = g_strdup_printf ("udp://%s:%d", gst_uri_get_host(self->uri), gst_uri_get_port(self->uri));
         g_object_set (G_OBJECT (self->rtp_src), "uri", uri, NULL);
         g_free (uri);
@@ -885,10 +3558,11 @@ gst_rtp_src_set_property (GObject * object, guint prop_id,
       GST_INFO_OBJECT (self,
           "Force encoding name (%s), do you know what you are doing?",
           self->encoding_name);
+      gst_rtp_src_clear_pt_caps (self);
       if (self->rtp_src) {
         GST_INFO_OBJECT (self, "Requesting PT map");
         caps = gst_rtp_src_request_pt_map_cb (NULL, 0, 96, self);
-        g_object_set (G_OBJECT (self->rtp_src), "caps", caps, NULL);
+        xgst_barco_set_supported_parameter (self->rtp_src, "caps", caps);
         gst_caps_unref (caps);
       }
       break;
@@ -964,11 +3638,81 @@ gst_rtp_src_set_property (GObject * object, guint prop_id,
       self->caps = new_caps;
       if (old_caps)
         gst_caps_unref (old_caps);
+      gst_rtp_src_clear_pt_caps (self);
       break;
     }
     case PROP_TTL_MC:
       self->ttl_mc = g_value_get_uint (value);
       break;
+    case PROP_RTX_PT:
+      self->rtx_pt = g_value_get_uint (value);
+      GST_DEBUG_OBJECT (self, "set rtx-pt: %u", self->rtx_pt);
+      gst_rtp_src_clear_pt_caps (self);
+      break;
+    case PROP_FEC:
+      self->fec = g_value_get_enum (value);
+      GST_DEBUG_OBJECT (self, "set fec: %d", self->fec);
+      break;
+    case PROP_KEYFRAME_REQUEST_INTERVAL:
+      self->keyframe_request_interval = g_value_get_uint (value);
+      break;
+    case PROP_KEYFRAME_REQUEST_RETRIES:
+      self->keyframe_request_retries = g_value_get_uint (value);
+      break;
+    case PROP_REDUNDANT_URI:
+      if (self->redundant_uri)
+        gst_uri_unref (self->redundant_uri);
+      self->redundant_uri = g_value_get_string (value) ?
+          gst_uri_from_string (g_value_get_string (value)) : NULL;
+      GST_DEBUG_OBJECT (self, "set redundant-uri: %s",
+          g_value_get_string (value));
+      break;
+    case PROP_REDUNDANT_MULTICAST_IFACE:
+      g_free (self->redundant_multicast_iface);
+      self->redundant_multicast_iface = g_value_dup_string (value);
+      break;
+    case PROP_REDUNDANT_MAX_SKEW:
+      self->redundant_max_skew = g_value_get_uint (value);
+      if (self->merge)
+        g_object_set (G_OBJECT (self->merge), "max-skew",
+            self->redundant_max_skew, NULL);
+      break;
+    case PROP_STANDBY_URIS:
+      g_strfreev (self->standby_uris);
+      self->standby_uris = g_value_get_string (value) ?
+          g_strsplit (g_value_get_string (value), ",", -1) : NULL;
+      GST_DEBUG_OBJECT (self, "set standby-uris: %s",
+          g_value_get_string (value));
+      break;
+    case PROP_STANDBY_CACHE_SIZE:
+      self->standby_cache_size = g_value_get_uint (value);
+      break;
+    case PROP_STATS_INTERVAL:
+      self->stats_interval = g_value_get_uint (value);
+      break;
+    case PROP_SDP:
+      g_free (self->sdp);
+      self->sdp = g_value_dup_string (value);
+      break;
+    case PROP_IO_URING:
+      self->io_uring = g_value_get_boolean (value);
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      self->kernel_timestamps = g_value_get_boolean (value);
+      break;
+    case PROP_CAPTURE_IFACE:
+      g_free (self->capture_iface);
+      self->capture_iface = g_value_dup_string (value);
+      break;
+    case PROP_MDI_INTERVAL:
+      self->mdi_interval = g_value_get_uint (value);
+      break;
+    case PROP_MP2T_LATENCY:
+      self->mp2t_latency = g_value_get_uint (value);
+      if (self->mp2t && self->mp2t_latency > 0)
+        g_object_set (G_OBJECT (self->mp2t), "latency", self->mp2t_latency,
+            NULL);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1024,6 +3768,93 @@ gst_rtp_src_get_property (GObject * object, guint prop_id,
     case PROP_TTL_MC:
       g_value_set_uint (value, self->ttl_mc);
       break;
+    case PROP_RTX_PT:
+      g_value_set_uint (value, self->rtx_pt);
+      break;
+    case PROP_FEC:
+      g_value_set_enum (value, self->fec);
+      break;
+    case PROP_KEYFRAME_REQUEST_INTERVAL:
+      g_value_set_uint (value, self->keyframe_request_interval);
+      break;
+    case PROP_KEYFRAME_REQUEST_RETRIES:
+      g_value_set_uint (value, self->keyframe_request_retries);
+      break;
+    case PROP_REDUNDANT_URI:
+      if (self->redundant_uri)
+        g_value_take_string (value, gst_uri_to_string (self->redundant_uri));
+      else
+        g_value_set_string (value, NULL);
+      break;
+    case PROP_REDUNDANT_MULTICAST_IFACE:
+      g_value_set_string (value, self->redundant_multicast_iface);
+      break;
+    case PROP_REDUNDANT_MAX_SKEW:
+      g_value_set_uint (value, self->redundant_max_skew);
+      break;
+    case PROP_STANDBY_URIS:
+      if (self->standby_uris)
+        g_value_take_string (value, g_strjoinv (",", self->standby_uris));
+      else
+        g_value_set_string (value, NULL);
+      break;
+    case PROP_STANDBY_CACHE_SIZE:
+      g_value_set_uint (value, self->standby_cache_size);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_rtp_src_get_stats (self));
+      break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, self->stats_interval);
+      break;
+    case PROP_SDP:
+      g_value_set_string (value, self->sdp);
+      break;
+    case PROP_IO_URING:
+      g_value_set_boolean (value, self->io_uring);
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      g_value_set_boolean (value, self->kernel_timestamps);
+      break;
+    case PROP_CAPTURE_IFACE:
+      g_value_set_string (value, self->capture_iface);
+      break;
+    case PROP_MDI_INTERVAL:
+      g_value_set_uint (value, self->mdi_interval);
+      break;
+    case PROP_MP2T_LATENCY:
+      g_value_set_uint (value, self->mp2t_latency);
+      break;
+    case PROP_CC_ERRORS:
+      if (self->mp2t)
+        g_object_get_property (G_OBJECT (self->mp2t), "cc-errors", value);
+      else
+        g_value_set_uint64 (value, 0);
+      break;
+    case PROP_DROPS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->drops);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PCR_JITTER:
+      if (self->mp2t)
+        g_object_get_property (G_OBJECT (self->mp2t), "pcr-jitter", value);
+      else
+        g_value_set_uint64 (value, 0);
+      break;
+    case PROP_FEC_RECOVERED:
+      if (self->fec_dec)
+        g_object_get_property (G_OBJECT (self->fec_dec), "recovered", value);
+      else
+        g_value_set_uint64 (value, 0);
+      break;
+    case PROP_FEC_UNRECOVERABLE:
+      if (self->fec_dec)
+        g_object_get_property (G_OBJECT (self->fec_dec), "unrecoverable",
+            value);
+      else
+        g_value_set_uint64 (value, 0);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1046,6 +3877,9 @@ gst_rtp_src_class_init (GstRtpSrcClass * klass)
    * uri to establish a stream to. All GStreamer parameters can be
    * encoded in the URI, this URI format is RFC compliant.
    *
+   * With rtp+shm://, the RTP packets of the first stream of an rtpsink on
+   * the same host are read from shared memory while RTCP stays on UDP.
+   *
    * Since: 0.10.5
    */
   g_object_class_install_property (oclass, PROP_URI,
@@ -1106,14 +3940,16 @@ gst_rtp_src_class_init (GstRtpSrcClass * klass)
   /**
    * GstRtpSrc::buffer-size
    *
-   * Size of the kernel receive buffer in bytes
+   * Size of the kernel receive buffer in bytes. With 0, the buffer of the
+   * RTP socket is sized to hold the latency at the measured bitrate and
+   * doubled whenever the kernel drops packets, up to 64 MiB.
    *
    * Since: 1.0.0
    */
   g_object_class_install_property (oclass, PROP_BUFFER_SIZE,
       g_param_spec_uint ("buffer-size", "Kernel receive buffer size",
-          "Size of the kernel receive buffer in bytes, 0=default", 0, G_MAXUINT,
-          DEFAULT_LATENCY_MS, G_PARAM_READWRITE));
+          "Size of the kernel receive buffer in bytes, 0=automatic", 0,
+          G_MAXUINT, DEFAULT_BUFFER_SIZE, G_PARAM_READWRITE));
 
   /**
    * GstRtpSrc::timeout
@@ -1228,6 +4064,344 @@ gst_rtp_src_class_init (GstRtpSrcClass * klass)
           64,
           DEFAULT_PROP_TTL_MC, G_PARAM_READWRITE));
 
+  /**
+   * GstRtpSrc::rtx-pt
+   *
+   * Payload type of RFC 4588 retransmissions sent by the peer. When set,
+   * lost packets are NACKed over RTCP as long as the retransmission can
+   * still arrive within the latency. Like on rtpsink, it carries the
+   * retransmissions of payload type 96 and of the static payload types,
+   * rtx-pt + n those of 96 + n. The apt of the rtx payload types of an SDP
+   * takes precedence.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_RTX_PT,
+      g_param_spec_uint ("rtx-pt", "Retransmission payload type",
+          "Payload type of retransmissions (0 = disabled)", 0, G_MAXINT8,
+          DEFAULT_PROP_RTX_PT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::fec
+   *
+   * Receive the XOR FEC streams sent next to RTP (column FEC on port + 2,
+   * row FEC on port + 4) and rebuild lost packets before the jitterbuffer.
+   * auto expects SMPTE 2022-1 for MP2T and FlexFEC for everything else.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC,
+      g_param_spec_enum ("fec", "FEC", "FEC flavour to receive",
+          GST_TYPE_RTP_FEC_MODE, DEFAULT_PROP_FEC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::fec-recovered
+   *
+   * Number of packets rebuilt from FEC.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC_RECOVERED,
+      g_param_spec_uint64 ("fec-recovered", "FEC recovered",
+          "Number of packets recovered with FEC", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::fec-unrecoverable
+   *
+   * Number of lost packets FEC could not rebuild.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_FEC_UNRECOVERABLE,
+      g_param_spec_uint64 ("fec-unrecoverable", "FEC unrecoverable",
+          "Number of lost packets FEC could not recover", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::keyframe-request-interval
+   *
+   * Ask the sender for a keyframe (FIR/PLI over RTCP) as soon as a stream
+   * or a new SSRC shows up, instead of waiting for the next keyframe of
+   * the encoder. Also the minimum time in ms between two requests.
+   * 0 disables the requests; they need enable-rtcp.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KEYFRAME_REQUEST_INTERVAL,
+      g_param_spec_uint ("keyframe-request-interval",
+          "Keyframe request interval",
+          "Minimum time in ms between keyframe requests (0 = no requests)",
+          0, G_MAXUINT, DEFAULT_PROP_KEYFRAME_REQUEST_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::keyframe-request-retries
+   *
+   * Number of times a keyframe request is repeated when no keyframe
+   * arrives within keyframe-request-interval.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KEYFRAME_REQUEST_RETRIES,
+      g_param_spec_uint ("keyframe-request-retries",
+          "Keyframe request retries",
+          "Number of times an unanswered keyframe request is repeated",
+          0, G_MAXUINT, DEFAULT_PROP_KEYFRAME_REQUEST_RETRIES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::redundant-uri
+   *
+   * Second path of a SMPTE 2022-7 redundant stream. Both paths are merged
+   * by seqnum and every packet is forwarded once, so losing one path is
+   * hitless.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_REDUNDANT_URI,
+      g_param_spec_string ("redundant-uri", "Redundant URI",
+          "URI of the second path of a SMPTE 2022-7 stream",
+          DEFAULT_PROP_REDUNDANT_URI,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::redundant-multicast-iface
+   *
+   * Network interface to receive the second path on, multicast-iface is
+   * used when not set.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_REDUNDANT_MULTICAST_IFACE,
+      g_param_spec_string ("redundant-multicast-iface",
+          "Redundant multicast interface",
+          "The network interface on which to join the second path",
+          DEFAULT_PROP_MULTICAST_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::redundant-max-skew
+   *
+   * Longest time in ms a packet that is missing on both paths holds back
+   * the packets after it. Should cover the delay difference of the paths.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_REDUNDANT_MAX_SKEW,
+      g_param_spec_uint ("redundant-max-skew", "Redundant maximum skew",
+          "Maximum delay difference in ms between the two paths",
+          0, G_MAXUINT, DEFAULT_PROP_REDUNDANT_MAX_SKEW,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::sdp
+   *
+   * SDP of the stream, as text starting with "v=" or as a file name. The
+   * caps of its payload types are taken from it as they are, with their
+   * fmtp parameters like sprop-parameter-sets, instead of guessing them
+   * from encoding-name. When the host of uri is 0.0.0.0, the address and
+   * port of the media are received. Only applied when going to READY.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_SDP,
+      g_param_spec_string ("sdp", "SDP",
+          "SDP text or file describing the stream",
+          DEFAULT_PROP_SDP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::standby-uris
+   *
+   * Comma separated rtp:// URIs of groups to keep joined next to uri.
+   * Setting uri to one of them switches without leaving the old group and
+   * starts at its last keyframe, so there is no wait for a join or a GOP.
+   * A standby URI can carry its own encoding-name, otherwise the encoding
+   * of its dynamic payload types is sniffed from its packets. Only applied
+   * when going to READY.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_STANDBY_URIS,
+      g_param_spec_string ("standby-uris", "Standby URIs",
+          "Comma separated URIs of groups joined for fast channel change",
+          DEFAULT_PROP_STANDBY_URIS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::standby-cache-size
+   *
+   * Bytes kept per standby group from its last keyframe on. A GOP that
+   * does not fit is not cached.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_STANDBY_CACHE_SIZE,
+      g_param_spec_uint ("standby-cache-size", "Standby cache size",
+          "Maximum size in bytes of the GOP cached per standby group",
+          0, G_MAXUINT, DEFAULT_PROP_STANDBY_CACHE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::stats
+   *
+   * Statistics of the received streams: the packets dropped by the
+   * kernel, the packets waiting in the queue in front of rtpbin, and per
+   * SSRC the pad it leaves on, packets, bytes, lost, reordered and
+   * duplicate packets and the interarrival jitter in ns, counted before
+   * the jitterbuffer. The counters of an SSRC go away with its stream
+   * after a BYE or a timeout.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics of the received streams", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::stats-interval
+   *
+   * Post the stats as a GstRtpSrcStats element message every interval in
+   * ms, 0 to never post them.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_STATS_INTERVAL,
+      g_param_spec_uint ("stats-interval", "Statistics interval",
+          "Interval in ms to post the stats on the bus (0 = never)",
+          0, G_MAXUINT, DEFAULT_PROP_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::io-uring
+   *
+   * Receive the RTP packets with a multishot recvmsg on io_uring instead
+   * of udpsrc. Falls back to udpsrc when the plugin was built without
+   * liburing or the kernel is older than 6.0.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_IO_URING,
+      g_param_spec_boolean ("io-uring", "io_uring",
+          "Receive RTP on io_uring when the kernel supports it",
+          DEFAULT_PROP_IO_URING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::kernel-timestamps
+   *
+   * Time the RTP packets on the moment the kernel received them
+   * (SO_TIMESTAMPNS, or the timestamp of the packet ring) instead of the
+   * moment the streaming thread read them. rtpjitterbuffer then measures
+   * jitter and clock skew without the scheduling delay of the receiver,
+   * which matters on a loaded host. The receive time is also attached as
+   * a timestamp/x-unix reference timestamp meta. udpsrc cannot read these
+   * timestamps, so this receives on io_uring when possible; with
+   * capture-iface the packet ring is used.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KERNEL_TIMESTAMPS,
+      g_param_spec_boolean ("kernel-timestamps", "Kernel Timestamps",
+          "Time the RTP packets on the receive time of the kernel",
+          DEFAULT_PROP_KERNEL_TIMESTAMPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::capture-iface
+   *
+   * Receive the RTP packets from a TPACKET_V3 packet ring on this
+   * interface instead of a socket. All rtpsrc elements capturing on the
+   * same interface share one ring, filtered in the kernel on their groups,
+   * which saves a system call per packet when monitoring many groups.
+   * Standby groups are captured as well. Needs CAP_NET_RAW, falls back to
+   * udpsrc without it. IPv4 only.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_CAPTURE_IFACE,
+      g_param_spec_string ("capture-iface", "Capture Interface",
+          "Capture RTP from a packet ring on this interface",
+          DEFAULT_PROP_CAPTURE_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::mdi-interval
+   *
+   * Probe mode for stream monitoring: when not 0, the packets are not
+   * depayloaded or handed to rtpbin and no src pad is created. Instead
+   * the RFC 4445 Media Delivery Index is measured and posted every
+   * mdi-interval ms as a GstRtpSrcMdi element message with the
+   * delay-factor and jitter in ms, the media-loss-rate in packets per
+   * second, the bitrate, and the packets, lost packets and sequence gaps
+   * of the interval. The jitter uses the clock-rate of the caps, 90000
+   * by default.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MDI_INTERVAL,
+      g_param_spec_uint ("mdi-interval", "MDI interval",
+          "Only measure the Media Delivery Index, posted every interval in ms"
+          " (0 = off)", 0, G_MAXUINT, DEFAULT_PROP_MDI_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::mp2t-latency
+   *
+   * When not 0, the stream is MPEG-TS (MP2T, pt 33) and is received
+   * without rtpbin: the TS packets are pushed as lists of 188 byte buffers
+   * of the received memory, timed on the PCR of the sender with this
+   * latency in ms instead of the latency of the jitterbuffer. There is
+   * no RTCP in this mode.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MP2T_LATENCY,
+      g_param_spec_uint ("mp2t-latency", "MPEG-TS latency",
+          "Receive MPEG-TS timed on the PCR with this latency in ms"
+          " (0 = through rtpbin)", 0, G_MAXUINT, DEFAULT_PROP_MP2T_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::cc-errors
+   *
+   * Number of MPEG-TS continuity counter errors with mp2t-latency.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_CC_ERRORS,
+      g_param_spec_uint64 ("cc-errors", "CC errors",
+          "Number of MPEG-TS continuity counter errors", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::pcr-jitter
+   *
+   * Arrival jitter of the MPEG-TS PCR in ns with mp2t-latency, over the
+   * last 2 s.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_PCR_JITTER,
+      g_param_spec_uint64 ("pcr-jitter", "PCR jitter",
+          "Arrival jitter of the MPEG-TS PCR in ns", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSrc::drops
+   *
+   * Number of RTP packets the kernel dropped because the receive buffer
+   * was full, checked every second. Read from SO_RXQ_OVFL with io-uring
+   * and from SO_MEMINFO with udpsrc.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_DROPS,
+      g_param_spec_uint64 ("drops", "Drops",
+          "Number of RTP packets dropped by the kernel on a full receive "
+          "buffer", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_template));
@@ -1251,7 +4425,7 @@ gst_rtp_src_init (GstRtpSrc * self)
 {
   self->uri = gst_uri_from_string (DEFAULT_PROP_URI);
   self->encoding_name = DEFAULT_PROP_ENCODING_NAME;
-  self->ghostpad = NULL;
+  self->no_more_pads = FALSE;
   self->n_ptdemux_pads = 0;
   self->n_rtpbin_pads = 0;
   self->enable_rtcp = DEFAULT_ENABLE_RTCP;
@@ -1264,9 +4438,34 @@ gst_rtp_src_init (GstRtpSrc * self)
   self->ssrc_select = GST_RTPPTCHANGE_DEFAULT_SSRC_SELECT;
   self->ssrc_select = GST_RTPPTCHANGE_DEFAULT_SSRC_SELECT;
   self->caps = NULL;
+  self->sdp = DEFAULT_PROP_SDP;
+  self->sdp_caps = NULL;
   self->ttl_mc = DEFAULT_PROP_TTL_MC;
+  self->rtx_pt = DEFAULT_PROP_RTX_PT;
 
   self->rtpheaderchange = NULL;
+  self->rtx_receive = NULL;
+  self->fec = DEFAULT_PROP_FEC;
+  self->fec_dec = NULL;
+  self->keyframe_request_interval = DEFAULT_PROP_KEYFRAME_REQUEST_INTERVAL;
+  self->keyframe_request_retries = DEFAULT_PROP_KEYFRAME_REQUEST_RETRIES;
+  self->redundant_uri = NULL;
+  self->redundant_multicast_iface = DEFAULT_PROP_MULTICAST_IFACE;
+  self->redundant_max_skew = DEFAULT_PROP_REDUNDANT_MAX_SKEW;
+  self->redundant_src = NULL;
+  self->merge = NULL;
+  self->standby_uris = NULL;
+  self->standby_cache_size = DEFAULT_PROP_STANDBY_CACHE_SIZE;
+  self->io_uring = DEFAULT_PROP_IO_URING;
+  self->capture_iface = DEFAULT_PROP_CAPTURE_IFACE;
+  self->kernel_timestamps = DEFAULT_PROP_KERNEL_TIMESTAMPS;
+  self->mdi_interval = DEFAULT_PROP_MDI_INTERVAL;
+  self->mp2t_latency = DEFAULT_PROP_MP2T_LATENCY;
+  self->stats_interval = DEFAULT_PROP_STATS_INTERVAL;
+  self->groups = NULL;
+  self->active_group = NULL;
+  g_mutex_init (&self->group_lock);
+  g_mutex_init (&self->mdi_lock);
 
   GST_DEBUG_OBJECT (self, "rtpsrc initialised");
 }
@@ -0,0 +1,594 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * UDP sender on io_uring, used by rtpsink instead of udpsink when the
+ * kernel supports it.
+ *
+ * A buffer list is sent as a chain of linked sendmsg submissions with a
+ * single system call, the link keeps the packets in order. The sends are
+ * not waited for: their completions are reaped on the next render, and
+ * the streaming thread only blocks when all slots are in flight. A chain
+ * submitted while an earlier one is still in flight drains it first, so
+ * the packets never overtake each other.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <liburing.h>
+#include <gio/gio.h>
+
+#include "gstrtpuringsink.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_uring_sink_debug);
+#define GST_CAT_DEFAULT rtp_uring_sink_debug
+
+/* Packets submitted at once, and in flight at most */
+#define GST_RTP_URING_SINK_DEPTH      (64)
+/* Buffers with more memories are merged */
+#define GST_RTP_URING_SINK_MAX_MEMS   (4)
+
+typedef struct
+{
+  GstBuffer *buffer;
+  guint n_maps;
+  gboolean merged;
+  GstMapInfo maps[GST_RTP_URING_SINK_MAX_MEMS];
+} GstRtpUringSinkPacket;
+
+struct _GstRtpUringSink
+{
+  GstBaseSink parent_instance;
+
+  gchar *host;
+  gint port;
+  gint ttl;
+  gint ttl_mc;
+  gint bind_port;
+  gchar *multicast_iface;
+
+  GSocket *socket;
+  struct io_uring ring;
+  gboolean have_ring;
+  struct sockaddr_storage dest;
+  socklen_t dest_len;
+
+  /* the slots of the packets in flight, the free ones are stacked */
+  guint in_flight;
+  guint free_slots[GST_RTP_URING_SINK_DEPTH];
+  guint n_free;
+  GstRtpUringSinkPacket packets[GST_RTP_URING_SINK_DEPTH];
+  struct iovec iov[GST_RTP_URING_SINK_DEPTH][GST_RTP_URING_SINK_MAX_MEMS];
+  struct msghdr msgs[GST_RTP_URING_SINK_DEPTH];
+};
+
+enum
+{
+  PROP_0,
+  PROP_BIND_PORT,
+  PROP_HOST,
+  PROP_MULTICAST_IFACE,
+  PROP_PORT,
+  PROP_TTL,
+  PROP_TTL_MC,
+  PROP_USED_SOCKET,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_BIND_PORT        (0)
+#define DEFAULT_PROP_HOST             "127.0.0.1"
+#define DEFAULT_PROP_PORT             (5004)
+#define DEFAULT_PROP_TTL              (64)
+#define DEFAULT_PROP_TTL_MC           (1)
+#define DEFAULT_PROP_MULTICAST_IFACE  (NULL)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_rtp_uring_sink_parent_class parent_class
+G_DEFINE_TYPE (GstRtpUringSink, gst_rtp_uring_sink, GST_TYPE_BASE_SINK);
+
+static void
+gst_rtp_uring_sink_map (GstRtpUringSink * self, guint i, GstBuffer * buffer)
+{
+  GstRtpUringSinkPacket *packet = &self->packets[i];
+  guint j, n = gst_buffer_n_memory (buffer);
+
+  packet->buffer = gst_buffer_ref (buffer);
+  packet->merged = n > GST_RTP_URING_SINK_MAX_MEMS;
+  packet->n_maps = 0;
+
+  if (packet->merged) {
+    if (gst_buffer_map (buffer, &packet->maps[0], GST_MAP_READ))
+      packet->n_maps = 1;
+  } else {
+    for (j = 0; j < n; j++) {
+      GstMemory *mem = gst_buffer_peek_memory (buffer, j);
+
+      if (gst_memory_map (mem, &packet->maps[packet->n_maps], GST_MAP_READ))
+        packet->n_maps++;
+    }
+  }
+
+  for (j = 0; j < packet->n_maps; j++) {
+    self->iov[i][j].iov_base = packet->maps[j].data;
+    self->iov[i][j].iov_len = packet->maps[j].size;
+  }
+
+  memset (&self->msgs[i], 0, sizeof (self->msgs[i]));
+  self->msgs[i].msg_name = &self->dest;
+  self->msgs[i].msg_namelen = self->dest_len;
+  self->msgs[i].msg_iov = self->iov[i];
+  self->msgs[i].msg_iovlen = packet->n_maps;
+}
+
+static void
+gst_rtp_uring_sink_unmap (GstRtpUringSink * self, guint i)
+{
+  GstRtpUringSinkPacket *packet = &self->packets[i];
+  guint j;
+
+  if (packet->merged) {
+    if (packet->n_maps)
+      gst_buffer_unmap (packet->buffer, &packet->maps[0]);
+  } else {
+    for (j = 0; j < packet->n_maps; j++)
+      gst_memory_unmap (packet->maps[j].memory, &packet->maps[j]);
+  }
+  gst_buffer_unref (packet->buffer);
+  packet->buffer = NULL;
+}
+
+/**
+ * gst_rtp_uring_sink_reap:
+ * @self: the #GstRtpUringSink
+ * @wait: the number of completions to wait for
+ *
+ * Release the packets that were sent. Send errors are not fatal for UDP,
+ * they are logged like udpsink does.
+ */
+static void
+gst_rtp_uring_sink_reap (GstRtpUringSink * self, guint wait)
+{
+  struct io_uring_cqe *cqe;
+  guint slot;
+  gint ret;
+
+  while (self->in_flight > 0) {
+    if (wait > 0)
+      ret = io_uring_wait_cqe (&self->ring, &cqe);
+    else
+      ret = io_uring_peek_cqe (&self->ring, &cqe);
+    if (ret == -EINTR)
+      continue;
+    if (ret < 0)
+      break;
+
+    slot = (guint) io_uring_cqe_get_data64 (cqe);
+    /* a failed send cancels the rest of the chain */
+    if (cqe->res < 0 && cqe->res != -ECANCELED)
+      GST_WARNING_OBJECT (self, "Error sending packet: %s",
+          g_strerror (-cqe->res));
+    io_uring_cqe_seen (&self->ring, cqe);
+
+    gst_rtp_uring_sink_unmap (self, slot);
+    self->free_slots[self->n_free++] = slot;
+    self->in_flight--;
+    if (wait > 0)
+      wait--;
+  }
+}
+
+/**
+ * gst_rtp_uring_sink_send:
+ * @self: the #GstRtpUringSink
+ * @buffers: the packets to send
+ * @n: the number of @buffers, at most GST_RTP_URING_SINK_DEPTH
+ *
+ * Send @buffers as one chain of linked sendmsg requests, without waiting
+ * for them.
+ */
+static void
+gst_rtp_uring_sink_send (GstRtpUringSink * self, GstBuffer ** buffers,
+    guint n)
+{
+  struct io_uring_sqe *sqe;
+  guint i, slot;
+  gint ret;
+
+  gst_rtp_uring_sink_reap (self, 0);
+  if (self->n_free < n)
+    gst_rtp_uring_sink_reap (self, n - self->n_free);
+
+  for (i = 0; i < n; i++) {
+    slot = self->free_slots[--self->n_free];
+    gst_rtp_uring_sink_map (self, slot, buffers[i]);
+
+    sqe = io_uring_get_sqe (&self->ring);
+    io_uring_prep_sendmsg (sqe, g_socket_get_fd (self->socket),
+        &self->msgs[slot], 0);
+    io_uring_sqe_set_data64 (sqe, slot);
+    if (i == 0 && self->in_flight > 0)
+      sqe->flags |= IOSQE_IO_DRAIN;
+    if (i + 1 < n)
+      sqe->flags |= IOSQE_IO_LINK;
+  }
+  self->in_flight += n;
+
+  /* on errors the requests stay queued for the next submit */
+  ret = io_uring_submit (&self->ring);
+  if (ret < 0)
+    GST_WARNING_OBJECT (self, "Could not submit: %s", g_strerror (-ret));
+}
+
+static GstFlowReturn
+gst_rtp_uring_sink_render (GstBaseSink * sink, GstBuffer * buffer)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (sink);
+
+  gst_rtp_uring_sink_send (self, &buffer, 1);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_rtp_uring_sink_render_list (GstBaseSink * sink, GstBufferList * list)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (sink);
+  GstBuffer *buffers[GST_RTP_URING_SINK_DEPTH];
+  guint i, n = gst_buffer_list_length (list), count = 0;
+
+  for (i = 0; i < n; i++) {
+    buffers[count++] = gst_buffer_list_get (list, i);
+    if (count == GST_RTP_URING_SINK_DEPTH || i + 1 == n) {
+      gst_rtp_uring_sink_send (self, buffers, count);
+      count = 0;
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_rtp_uring_sink_set_multicast_iface (GstRtpUringSink * self,
+    GSocketFamily family)
+{
+  guint index = if_nametoindex (self->multicast_iface);
+  gint fd = g_socket_get_fd (self->socket);
+
+  if (index == 0)
+    return FALSE;
+
+  if (family == G_SOCKET_FAMILY_IPV6)
+    return setsockopt (fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index,
+        sizeof (index)) == 0;
+  else {
+    struct ip_mreqn mreq;
+
+    memset (&mreq, 0, sizeof (mreq));
+    mreq.imr_ifindex = index;
+    return setsockopt (fd, IPPROTO_IP, IP_MULTICAST_IF, &mreq,
+        sizeof (mreq)) == 0;
+  }
+}
+
+static gboolean
+gst_rtp_uring_sink_start (GstBaseSink * sink)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (sink);
+  GSocketAddress *addr, *bind_addr;
+  GInetAddress *iaddr, *any;
+  GSocketFamily family;
+  GError *err = NULL;
+  gint ret;
+  guint i;
+
+  addr = g_inet_socket_address_new_from_string (self->host, self->port);
+  if (addr == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, SETTINGS, (NULL),
+        ("Invalid host %s", self->host));
+    return FALSE;
+  }
+  iaddr = g_inet_socket_address_get_address (G_INET_SOCKET_ADDRESS (addr));
+  family = g_socket_address_get_family (addr);
+  self->dest_len = g_socket_address_get_native_size (addr);
+  g_socket_address_to_native (addr, &self->dest, sizeof (self->dest), NULL);
+
+  self->socket = g_socket_new (family, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+  if (self->socket == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_WRITE, (NULL),
+        ("Could not create socket: %s", err->message));
+    g_clear_error (&err);
+    g_object_unref (addr);
+    return FALSE;
+  }
+
+  /* send from src-port of rtpsink */
+  if (self->bind_port > 0) {
+    any = g_inet_address_new_any (family);
+    bind_addr = g_inet_socket_address_new (any, self->bind_port);
+    g_object_unref (any);
+    if (!g_socket_bind (self->socket, bind_addr, TRUE, &err)) {
+      GST_ELEMENT_ERROR (self, RESOURCE, OPEN_WRITE, (NULL),
+          ("Could not bind to port %d: %s", self->bind_port, err->message));
+      g_clear_error (&err);
+      g_object_unref (bind_addr);
+      g_object_unref (addr);
+      g_clear_object (&self->socket);
+      return FALSE;
+    }
+    g_object_unref (bind_addr);
+  }
+
+  if (g_inet_address_get_is_multicast (iaddr)) {
+    g_socket_set_multicast_ttl (self->socket, self->ttl_mc);
+    g_socket_set_multicast_loopback (self->socket, TRUE);
+    if (self->multicast_iface &&
+        !gst_rtp_uring_sink_set_multicast_iface (self, family))
+      GST_WARNING_OBJECT (self, "Could not send on interface %s",
+          self->multicast_iface);
+  } else {
+    g_socket_set_ttl (self->socket, self->ttl);
+  }
+  g_object_unref (addr);
+
+  ret = io_uring_queue_init (GST_RTP_URING_SINK_DEPTH, &self->ring, 0);
+  if (ret < 0) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_WRITE, (NULL),
+        ("Could not set up io_uring: %s", g_strerror (-ret)));
+    g_clear_object (&self->socket);
+    return FALSE;
+  }
+  self->have_ring = TRUE;
+
+  self->in_flight = 0;
+  self->n_free = GST_RTP_URING_SINK_DEPTH;
+  for (i = 0; i < GST_RTP_URING_SINK_DEPTH; i++)
+    self->free_slots[i] = i;
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_uring_sink_stop (GstBaseSink * sink)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (sink);
+
+  if (self->have_ring) {
+    io_uring_submit (&self->ring);
+    gst_rtp_uring_sink_reap (self, self->in_flight);
+    io_uring_queue_exit (&self->ring);
+    self->have_ring = FALSE;
+  }
+
+  if (self->socket) {
+    g_socket_close (self->socket, NULL);
+    GST_OBJECT_LOCK (self);
+    g_clear_object (&self->socket);
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return TRUE;
+}
+
+static void
+gst_rtp_uring_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (object);
+
+  switch (prop_id) {
+    case PROP_BIND_PORT:
+      self->bind_port = g_value_get_int (value);
+      break;
+    case PROP_HOST:
+      g_free (self->host);
+      self->host = g_value_dup_string (value);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_free (self->multicast_iface);
+      self->multicast_iface = g_value_dup_string (value);
+      break;
+    case PROP_PORT:
+      self->port = g_value_get_int (value);
+      break;
+    case PROP_TTL:
+      self->ttl = g_value_get_int (value);
+      break;
+    case PROP_TTL_MC:
+      self->ttl_mc = g_value_get_int (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_uring_sink_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (object);
+
+  switch (prop_id) {
+    case PROP_BIND_PORT:
+      g_value_set_int (value, self->bind_port);
+      break;
+    case PROP_HOST:
+      g_value_set_string (value, self->host);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_value_set_string (value, self->multicast_iface);
+      break;
+    case PROP_PORT:
+      g_value_set_int (value, self->port);
+      break;
+    case PROP_TTL:
+      g_value_set_int (value, self->ttl);
+      break;
+    case PROP_TTL_MC:
+      g_value_set_int (value, self->ttl_mc);
+      break;
+    case PROP_USED_SOCKET:
+      GST_OBJECT_LOCK (self);
+      g_value_set_object (value, self->socket);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_uring_sink_finalize (GObject * gobject)
+{
+  GstRtpUringSink *self = GST_RTP_URING_SINK (gobject);
+
+  g_free (self->host);
+  g_free (self->multicast_iface);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_uring_sink_class_init (GstRtpUringSinkClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstBaseSinkClass *gstbasesink_class = GST_BASE_SINK_CLASS (klass);
+
+  oclass->set_property = gst_rtp_uring_sink_set_property;
+  oclass->get_property = gst_rtp_uring_sink_get_property;
+  oclass->finalize = gst_rtp_uring_sink_finalize;
+
+  /**
+   * GstRtpUringSink::host
+   *
+   * Address to send packets to.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_HOST,
+      g_param_spec_string ("host", "Host", "Address to send packets to",
+          DEFAULT_PROP_HOST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSink::port
+   *
+   * Port to send packets to.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_PORT,
+      g_param_spec_int ("port", "Port", "Port to send packets to",
+          0, G_MAXUINT16, DEFAULT_PROP_PORT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSink::bind-port
+   *
+   * Port to send packets from, 0 lets the kernel pick one.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_BIND_PORT,
+      g_param_spec_int ("bind-port", "Bind Port", "Port to send packets from",
+          0, G_MAXUINT16, DEFAULT_PROP_BIND_PORT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSink::ttl
+   *
+   * Time to live of unicast packets.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_TTL,
+      g_param_spec_int ("ttl", "Unicast TTL", "Time to live of unicast packets",
+          0, 255, DEFAULT_PROP_TTL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSink::ttl-mc
+   *
+   * Time to live of multicast packets.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_TTL_MC,
+      g_param_spec_int ("ttl-mc", "Multicast TTL",
+          "Time to live of multicast packets", 0, 255, DEFAULT_PROP_TTL_MC,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSink::used-socket
+   *
+   * Socket the packets are sent on while the element is started.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_USED_SOCKET,
+      g_param_spec_object ("used-socket", "Used socket",
+          "Socket the packets are sent on", G_TYPE_SOCKET,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSink::multicast-iface
+   *
+   * Network interface to send multicast packets on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MULTICAST_IFACE,
+      g_param_spec_string ("multicast-iface", "Multicast Interface",
+          "Network interface to send multicast packets on",
+          DEFAULT_PROP_MULTICAST_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sink_template));
+
+  gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_rtp_uring_sink_start);
+  gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_rtp_uring_sink_stop);
+  gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_rtp_uring_sink_render);
+  gstbasesink_class->render_list =
+      GST_DEBUG_FUNCPTR (gst_rtp_uring_sink_render_list);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpuringsink",
+      "Sink/Network",
+      "Barco UDP sender on io_uring",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_uring_sink_debug,
+      "barcortpuringsink", 0, "Barco UDP sender on io_uring");
+}
+
+static void
+gst_rtp_uring_sink_init (GstRtpUringSink * self)
+{
+  self->host = g_strdup (DEFAULT_PROP_HOST);
+  self->port = DEFAULT_PROP_PORT;
+  self->bind_port = DEFAULT_PROP_BIND_PORT;
+  self->ttl = DEFAULT_PROP_TTL;
+  self->ttl_mc = DEFAULT_PROP_TTL_MC;
+  self->multicast_iface = g_strdup (DEFAULT_PROP_MULTICAST_IFACE);
+}
+
+gboolean
+rtp_uring_sink_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpuringsink", GST_RANK_NONE, GST_TYPE_RTP_URING_SINK);
+}
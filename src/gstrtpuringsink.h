@@ -0,0 +1,16 @@
+#ifndef _GST_RTP_URING_SINK_H_
+#define _GST_RTP_URING_SINK_H_
+
+#include <gst/gst.h>
+#include <gst/base/gstbasesink.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_URING_SINK (gst_rtp_uring_sink_get_type ())
+G_DECLARE_FINAL_TYPE (GstRtpUringSink, gst_rtp_uring_sink, GST,
+    RTP_URING_SINK, GstBaseSink);
+
+gboolean rtp_uring_sink_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _GST_RTP_URING_SINK_H_ */
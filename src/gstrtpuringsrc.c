@@ -0,0 +1,856 @@
+/* ex: set tabstop=2 shiftwidth=2 expandtab: */
+/*
+ * GStreamer
+ * Copyright (C) 2009-2017 BARCO
+ *
+ * UDP receiver on io_uring, used by rtpsrc instead of udpsrc when the
+ * kernel supports it.
+ *
+ * A single multishot recvmsg keeps receiving into a ring of provided
+ * buffers; the packets are pushed downstream wrapping that memory and a
+ * buffer is given back to the kernel when downstream releases it. When
+ * downstream holds on to most of the ring, packets are copied instead so
+ * the kernel never runs out of buffers.
+ *
+ * With kernel-timestamps, the SO_TIMESTAMPNS receive time of every packet
+ * comes along in the control message and is used as its arrival time. The
+ * SO_RXQ_OVFL control message counts the packets the kernel dropped
+ * because the receive buffer was full.
+ *
+ * Next to the recvmsg, a read of an eventfd is always pending on the ring.
+ * unlock() writes to it, so create() waits on the ring without a timeout.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <liburing.h>
+#include <gio/gio.h>
+#include <gst/net/gstnet.h>
+
+#include "gstrtpuringsrc.h"
+#include "gstbarcomgs_common.h"
+
+GST_DEBUG_CATEGORY_STATIC (rtp_uring_src_debug);
+#define GST_CAT_DEFAULT rtp_uring_src_debug
+
+/* Provided buffers: big enough for jumbo frames, the number is a power
+ * of two as the kernel requires */
+#define GST_RTP_URING_SRC_PACKET_SIZE (9216)
+#define GST_RTP_URING_SRC_PACKETS     (512)
+/* Copy the packets when fewer buffers are left to the kernel */
+#define GST_RTP_URING_SRC_LOW_PACKETS (128)
+#define GST_RTP_URING_SRC_BGID        (0)
+/* user_data of the requests */
+#define GST_RTP_URING_SRC_RECV        (0)
+#define GST_RTP_URING_SRC_WAKE        (1)
+
+/* The ring is refcounted: the provided buffers live as long as downstream
+ * holds packets wrapping them, even after the element stopped */
+typedef struct
+{
+  gint refcount;
+  struct io_uring ring;
+  struct io_uring_buf_ring *br;
+  guint8 *bufs;
+  /* packets wrapped downstream, only touched from the streaming thread */
+  gint outstanding;
+  /* wakes up create(), the read of it completes into wake_value */
+  gint wake_fd;
+  guint64 wake_value;
+
+  /* buffers released by downstream, given back to the kernel from the
+   * streaming thread */
+  GMutex lock;
+  GArray *released;
+  gboolean closed;
+} GstRtpUringSrcRing;
+
+typedef struct
+{
+  GstRtpUringSrcRing *ring;
+  guint16 bid;
+} GstRtpUringSrcPacket;
+
+struct _GstRtpUringSrc
+{
+  GstPushSrc parent_instance;
+
+  gchar *address;
+  gint port;
+  gchar *multicast_iface;
+  gint buffer_size;
+  GstCaps *caps;
+  gboolean kernel_timestamps;
+
+  GSocket *socket;
+  guint drops;
+  GstRtpUringSrcRing *ring;
+  struct msghdr msg;
+  gboolean armed;
+  gboolean flushing;
+};
+
+enum
+{
+  PROP_0,
+  PROP_ADDRESS,
+  PROP_BUFFER_SIZE,
+  PROP_CAPS,
+  PROP_DROPS,
+  PROP_KERNEL_TIMESTAMPS,
+  PROP_MULTICAST_IFACE,
+  PROP_PORT,
+  PROP_URI,
+  PROP_USED_SOCKET,
+  PROP_LAST
+};
+
+#define DEFAULT_PROP_ADDRESS          "0.0.0.0"
+#define DEFAULT_PROP_PORT             (5004)
+#define DEFAULT_PROP_BUFFER_SIZE      (0)
+#define DEFAULT_PROP_MULTICAST_IFACE  (NULL)
+#define DEFAULT_PROP_KERNEL_TIMESTAMPS (FALSE)
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_rtp_uring_src_parent_class parent_class
+G_DEFINE_TYPE (GstRtpUringSrc, gst_rtp_uring_src, GST_TYPE_PUSH_SRC);
+
+static void
+gst_rtp_uring_src_ring_unref (GstRtpUringSrcRing * ring)
+{
+  if (!g_atomic_int_dec_and_test (&ring->refcount))
+    return;
+
+  if (ring->wake_fd >= 0)
+    close (ring->wake_fd);
+  g_array_free (ring->released, TRUE);
+  g_mutex_clear (&ring->lock);
+  g_free (ring->bufs);
+  g_slice_free (GstRtpUringSrcRing, ring);
+}
+
+static void
+gst_rtp_uring_src_ring_add (GstRtpUringSrcRing * ring, guint16 bid,
+    gint offset)
+{
+  io_uring_buf_ring_add (ring->br,
+      ring->bufs + (gsize) bid * GST_RTP_URING_SRC_PACKET_SIZE,
+      GST_RTP_URING_SRC_PACKET_SIZE, bid,
+      io_uring_buf_ring_mask (GST_RTP_URING_SRC_PACKETS), offset);
+}
+
+/**
+ * gst_rtp_uring_src_packet_release:
+ * @data: the #GstRtpUringSrcPacket of a wrapped memory
+ *
+ * Called from whatever thread frees the last ref to a packet.
+ */
+static void
+gst_rtp_uring_src_packet_release (gpointer data)
+{
+  GstRtpUringSrcPacket *packet = data;
+  GstRtpUringSrcRing *ring = packet->ring;
+
+  g_mutex_lock (&ring->lock);
+  if (!ring->closed)
+    g_array_append_val (ring->released, packet->bid);
+  g_mutex_unlock (&ring->lock);
+
+  g_slice_free (GstRtpUringSrcPacket, packet);
+  gst_rtp_uring_src_ring_unref (ring);
+}
+
+/**
+ * gst_rtp_uring_src_recycle:
+ * @self: the #GstRtpUringSrc
+ *
+ * Give the buffers released by downstream back to the kernel.
+ */
+static void
+gst_rtp_uring_src_recycle (GstRtpUringSrc * self)
+{
+  GstRtpUringSrcRing *ring = self->ring;
+  guint i;
+
+  g_mutex_lock (&ring->lock);
+  for (i = 0; i < ring->released->len; i++)
+    gst_rtp_uring_src_ring_add (ring,
+        g_array_index (ring->released, guint16, i), i);
+  io_uring_buf_ring_advance (ring->br, ring->released->len);
+  ring->outstanding -= ring->released->len;
+  g_array_set_size (ring->released, 0);
+  g_mutex_unlock (&ring->lock);
+}
+
+/**
+ * gst_rtp_uring_src_arm_wake:
+ * @ring: the #GstRtpUringSrcRing
+ *
+ * Queue the read of the eventfd, it is submitted with the next request
+ * or wait.
+ */
+static void
+gst_rtp_uring_src_arm_wake (GstRtpUringSrcRing * ring)
+{
+  struct io_uring_sqe *sqe = io_uring_get_sqe (&ring->ring);
+
+  io_uring_prep_read (sqe, ring->wake_fd, &ring->wake_value,
+      sizeof (ring->wake_value), 0);
+  io_uring_sqe_set_data64 (sqe, GST_RTP_URING_SRC_WAKE);
+}
+
+static void
+gst_rtp_uring_src_arm (GstRtpUringSrc * self)
+{
+  struct io_uring_sqe *sqe;
+
+  memset (&self->msg, 0, sizeof (self->msg));
+  self->msg.msg_namelen = sizeof (struct sockaddr_storage);
+  self->msg.msg_controllen = CMSG_SPACE (sizeof (guint32));
+  if (self->kernel_timestamps)
+    self->msg.msg_controllen += CMSG_SPACE (sizeof (struct timespec));
+
+  sqe = io_uring_get_sqe (&self->ring->ring);
+  io_uring_prep_recvmsg_multishot (sqe, g_socket_get_fd (self->socket),
+      &self->msg, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = GST_RTP_URING_SRC_BGID;
+  io_uring_sqe_set_data64 (sqe, GST_RTP_URING_SRC_RECV);
+  io_uring_submit (&self->ring->ring);
+
+  self->armed = TRUE;
+}
+
+/**
+ * gst_rtp_uring_src_cmsgs:
+ * @self: the #GstRtpUringSrc
+ * @out: the recvmsg header of a packet
+ *
+ * Update the drop counter from the SO_RXQ_OVFL control message, which
+ * the kernel only adds once it dropped packets.
+ *
+ * Returns: the SO_TIMESTAMPNS receive time of the packet, or
+ *   #GST_CLOCK_TIME_NONE
+ */
+static GstClockTime
+gst_rtp_uring_src_cmsgs (GstRtpUringSrc * self,
+    struct io_uring_recvmsg_out *out)
+{
+  GstClockTime arrival = GST_CLOCK_TIME_NONE;
+  struct cmsghdr *cmsg;
+  struct timespec ts;
+  guint32 drops;
+
+  for (cmsg = io_uring_recvmsg_cmsg_firsthdr (out, &self->msg); cmsg;
+      cmsg = io_uring_recvmsg_cmsg_nexthdr (out, &self->msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET)
+      continue;
+    if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      memcpy (&ts, CMSG_DATA (cmsg), sizeof (ts));
+      arrival = GST_TIMESPEC_TO_TIME (ts);
+    } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+      memcpy (&drops, CMSG_DATA (cmsg), sizeof (drops));
+      g_atomic_int_set (&self->drops, drops);
+    }
+  }
+
+  return arrival;
+}
+
+/**
+ * gst_rtp_uring_src_packet:
+ * @self: the #GstRtpUringSrc
+ * @bid: the provided buffer the packet was received in
+ * @res: the result of the recvmsg completion
+ *
+ * Returns: (transfer full) (nullable): a buffer with the packet
+ */
+static GstBuffer *
+gst_rtp_uring_src_packet (GstRtpUringSrc * self, guint16 bid, gint res)
+{
+  GstRtpUringSrcRing *ring = self->ring;
+  guint8 *base = ring->bufs + (gsize) bid * GST_RTP_URING_SRC_PACKET_SIZE;
+  struct io_uring_recvmsg_out *out;
+  GstRtpUringSrcPacket *packet;
+  GSocketAddress *addr;
+  GstClockTime arrival;
+  GstBuffer *buffer;
+  guint8 *payload;
+  guint len;
+
+  out = io_uring_recvmsg_validate (base, res, &self->msg);
+  if (out == NULL || (out->flags & MSG_TRUNC)) {
+    GST_WARNING_OBJECT (self, "Dropping truncated packet");
+    gst_rtp_uring_src_ring_add (ring, bid, 0);
+    io_uring_buf_ring_advance (ring->br, 1);
+    return NULL;
+  }
+
+  payload = io_uring_recvmsg_payload (out, &self->msg);
+  len = io_uring_recvmsg_payload_length (out, res, &self->msg);
+  addr = g_socket_address_new_from_native (io_uring_recvmsg_name (out),
+      out->namelen);
+  arrival = gst_rtp_uring_src_cmsgs (self, out);
+
+  if (ring->outstanding + GST_RTP_URING_SRC_LOW_PACKETS
+      >= GST_RTP_URING_SRC_PACKETS) {
+    buffer = gst_buffer_new_allocate (NULL, len, NULL);
+    gst_buffer_fill (buffer, 0, payload, len);
+    gst_rtp_uring_src_ring_add (ring, bid, 0);
+    io_uring_buf_ring_advance (ring->br, 1);
+  } else {
+    packet = g_slice_new (GstRtpUringSrcPacket);
+    packet->ring = ring;
+    packet->bid = bid;
+    g_atomic_int_inc (&ring->refcount);
+    ring->outstanding++;
+    buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY, base,
+        GST_RTP_URING_SRC_PACKET_SIZE, payload - base, len, packet,
+        gst_rtp_uring_src_packet_release);
+  }
+
+  if (addr) {
+    gst_buffer_add_net_address_meta (buffer, addr);
+    g_object_unref (addr);
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (arrival)) {
+    gst_barco_buffer_add_arrival (buffer, arrival);
+    buffer = gst_barco_buffer_stamp_arrival (GST_ELEMENT (self), buffer);
+  }
+
+  return buffer;
+}
+
+static GstFlowReturn
+gst_rtp_uring_src_create (GstPushSrc * src, GstBuffer ** outbuf)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (src);
+  GstRtpUringSrcRing *ring = self->ring;
+  struct io_uring_cqe *cqe;
+  guint64 data;
+  guint32 flags;
+  gint ret, res;
+
+  *outbuf = NULL;
+  while (*outbuf == NULL) {
+    if (g_atomic_int_get (&self->flushing))
+      return GST_FLOW_FLUSHING;
+
+    gst_rtp_uring_src_recycle (self);
+    if (!self->armed)
+      gst_rtp_uring_src_arm (self);
+
+    ret = io_uring_submit_and_wait (&ring->ring, 1);
+    if (ret >= 0)
+      ret = io_uring_peek_cqe (&ring->ring, &cqe);
+    if (ret == -EINTR || ret == -EAGAIN)
+      continue;
+    if (ret < 0) {
+      GST_ELEMENT_ERROR (self, RESOURCE, READ, (NULL),
+          ("io_uring wait failed: %s", g_strerror (-ret)));
+      return GST_FLOW_ERROR;
+    }
+
+    data = io_uring_cqe_get_data64 (cqe);
+    res = cqe->res;
+    flags = cqe->flags;
+    io_uring_cqe_seen (&ring->ring, cqe);
+
+    /* woken up by unlock(), read the eventfd again */
+    if (data == GST_RTP_URING_SRC_WAKE) {
+      gst_rtp_uring_src_arm_wake (ring);
+      continue;
+    }
+
+    /* the kernel ends a multishot request on errors and when it ran out
+     * of provided buffers, it is armed again on the next round */
+    if (!(flags & IORING_CQE_F_MORE))
+      self->armed = FALSE;
+
+    /* a burst took the buffers before they were handed back, packets
+     * are copied before downstream holds all of them so arming again
+     * finds free buffers */
+    if (res == -ENOBUFS)
+      continue;
+    if (res < 0) {
+      GST_ELEMENT_ERROR (self, RESOURCE, READ, (NULL),
+          ("recvmsg failed: %s", g_strerror (-res)));
+      return GST_FLOW_ERROR;
+    }
+    if (!(flags & IORING_CQE_F_BUFFER))
+      continue;
+
+    *outbuf = gst_rtp_uring_src_packet (self,
+        flags >> IORING_CQE_BUFFER_SHIFT, res);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_rtp_uring_src_open_socket (GstRtpUringSrc * self)
+{
+  GInetAddress *addr;
+  GSocketAddress *bind_addr;
+  GError *err = NULL;
+
+  addr = g_inet_address_new_from_string (self->address);
+  if (addr == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, SETTINGS, (NULL),
+        ("Invalid address %s", self->address));
+    return FALSE;
+  }
+
+  self->socket = g_socket_new (g_inet_address_get_family (addr),
+      G_SOCKET_TYPE_DATAGRAM, G_SOCKET_PROTOCOL_UDP, &err);
+  if (self->socket == NULL)
+    goto error;
+
+  /* bind to the group, like udpsrc, so other groups on the same port are
+   * not received */
+  bind_addr = g_inet_socket_address_new (addr, self->port);
+  if (!g_socket_bind (self->socket, bind_addr, TRUE, &err)) {
+    g_object_unref (bind_addr);
+    goto error;
+  }
+  g_object_unref (bind_addr);
+
+  if (g_inet_address_get_is_multicast (addr) &&
+      !g_socket_join_multicast_group (self->socket, addr, FALSE,
+          self->multicast_iface, &err))
+    goto error;
+
+  if (self->buffer_size > 0 &&
+      !g_socket_set_option (self->socket, SOL_SOCKET, SO_RCVBUF,
+          self->buffer_size, &err))
+    goto error;
+
+  if (self->kernel_timestamps &&
+      !g_socket_set_option (self->socket, SOL_SOCKET, SO_TIMESTAMPNS, 1,
+          &err))
+    goto error;
+
+  if (!g_socket_set_option (self->socket, SOL_SOCKET, SO_RXQ_OVFL, 1, &err))
+    goto error;
+
+  g_object_unref (addr);
+  return TRUE;
+
+error:
+  GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+      ("Could not open %s:%d: %s", self->address, self->port, err->message));
+  g_clear_error (&err);
+  g_clear_object (&self->socket);
+  g_object_unref (addr);
+  return FALSE;
+}
+
+static gboolean
+gst_rtp_uring_src_start (GstBaseSrc * src)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (src);
+  GstRtpUringSrcRing *ring;
+  gint ret;
+  guint i;
+
+  if (!gst_rtp_uring_src_open_socket (self))
+    return FALSE;
+
+  ring = g_slice_new0 (GstRtpUringSrcRing);
+  ring->refcount = 1;
+  g_mutex_init (&ring->lock);
+  ring->released = g_array_new (FALSE, FALSE, sizeof (guint16));
+
+  ring->wake_fd = eventfd (0, EFD_CLOEXEC);
+  if (ring->wake_fd < 0)
+    ret = -errno;
+  else
+    ret = io_uring_queue_init (8, &ring->ring, 0);
+  if (ret == 0) {
+    ring->br = io_uring_setup_buf_ring (&ring->ring, GST_RTP_URING_SRC_PACKETS,
+        GST_RTP_URING_SRC_BGID, 0, &ret);
+    if (ring->br == NULL)
+      io_uring_queue_exit (&ring->ring);
+  }
+  if (ret < 0 || ring->br == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+        ("Could not set up io_uring: %s", g_strerror (-ret)));
+    ring->closed = TRUE;
+    gst_rtp_uring_src_ring_unref (ring);
+    g_clear_object (&self->socket);
+    return FALSE;
+  }
+
+  ring->bufs = g_malloc ((gsize) GST_RTP_URING_SRC_PACKETS *
+      GST_RTP_URING_SRC_PACKET_SIZE);
+  for (i = 0; i < GST_RTP_URING_SRC_PACKETS; i++)
+    gst_rtp_uring_src_ring_add (ring, i, i);
+  io_uring_buf_ring_advance (ring->br, GST_RTP_URING_SRC_PACKETS);
+  gst_rtp_uring_src_arm_wake (ring);
+
+  self->ring = ring;
+  self->armed = FALSE;
+  g_atomic_int_set (&self->drops, 0);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_uring_src_stop (GstBaseSrc * src)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (src);
+  GstRtpUringSrcRing *ring = self->ring;
+
+  if (ring) {
+    g_mutex_lock (&ring->lock);
+    ring->closed = TRUE;
+    g_mutex_unlock (&ring->lock);
+
+    /* exiting the ring cancels the multishot request */
+    io_uring_free_buf_ring (&ring->ring, ring->br, GST_RTP_URING_SRC_PACKETS,
+        GST_RTP_URING_SRC_BGID);
+    io_uring_queue_exit (&ring->ring);
+    gst_rtp_uring_src_ring_unref (ring);
+    self->ring = NULL;
+  }
+
+  if (self->socket) {
+    g_socket_close (self->socket, NULL);
+    GST_OBJECT_LOCK (self);
+    g_clear_object (&self->socket);
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_uring_src_unlock (GstBaseSrc * src)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (src);
+
+  g_atomic_int_set (&self->flushing, TRUE);
+  if (self->ring)
+    eventfd_write (self->ring->wake_fd, 1);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_uring_src_unlock_stop (GstBaseSrc * src)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (src);
+
+  g_atomic_int_set (&self->flushing, FALSE);
+
+  return TRUE;
+}
+
+static GstCaps *
+gst_rtp_uring_src_get_caps (GstBaseSrc * src, GstCaps * filter)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (src);
+  GstCaps *caps;
+
+  GST_OBJECT_LOCK (self);
+  caps = self->caps ? gst_caps_ref (self->caps) : gst_caps_new_any ();
+  GST_OBJECT_UNLOCK (self);
+
+  if (filter) {
+    GstCaps *tmp = gst_caps_intersect_full (filter, caps,
+        GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = tmp;
+  }
+
+  return caps;
+}
+
+static void
+gst_rtp_uring_src_set_uri (GstRtpUringSrc * self, const gchar * str)
+{
+  GstUri *uri = gst_uri_from_string (str);
+
+  if (uri == NULL) {
+    GST_WARNING_OBJECT (self, "Invalid URI %s", str);
+    return;
+  }
+
+  g_free (self->address);
+  self->address = g_strdup (gst_uri_get_host (uri));
+  if (gst_uri_get_port (uri) != GST_URI_NO_PORT)
+    self->port = gst_uri_get_port (uri);
+  gst_uri_unref (uri);
+}
+
+static void
+gst_rtp_uring_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (object);
+
+  switch (prop_id) {
+    case PROP_ADDRESS:
+      g_free (self->address);
+      self->address = g_value_dup_string (value);
+      break;
+    case PROP_BUFFER_SIZE:
+      self->buffer_size = g_value_get_int (value);
+      break;
+    case PROP_CAPS:
+      GST_OBJECT_LOCK (self);
+      gst_caps_replace (&self->caps, (GstCaps *) gst_value_get_caps (value));
+      GST_OBJECT_UNLOCK (self);
+      gst_pad_mark_reconfigure (GST_BASE_SRC_PAD (self));
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      self->kernel_timestamps = g_value_get_boolean (value);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_free (self->multicast_iface);
+      self->multicast_iface = g_value_dup_string (value);
+      break;
+    case PROP_PORT:
+      self->port = g_value_get_int (value);
+      break;
+    case PROP_URI:
+      gst_rtp_uring_src_set_uri (self, g_value_get_string (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_uring_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (object);
+
+  switch (prop_id) {
+    case PROP_ADDRESS:
+      g_value_set_string (value, self->address);
+      break;
+    case PROP_BUFFER_SIZE:
+      g_value_set_int (value, self->buffer_size);
+      break;
+    case PROP_CAPS:
+      GST_OBJECT_LOCK (self);
+      gst_value_set_caps (value, self->caps);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DROPS:
+      g_value_set_uint64 (value, g_atomic_int_get (&self->drops));
+      break;
+    case PROP_KERNEL_TIMESTAMPS:
+      g_value_set_boolean (value, self->kernel_timestamps);
+      break;
+    case PROP_MULTICAST_IFACE:
+      g_value_set_string (value, self->multicast_iface);
+      break;
+    case PROP_PORT:
+      g_value_set_int (value, self->port);
+      break;
+    case PROP_URI:
+      g_value_take_string (value, g_strdup_printf ("udp://%s:%d",
+              self->address, self->port));
+      break;
+    case PROP_USED_SOCKET:
+      GST_OBJECT_LOCK (self);
+      g_value_set_object (value, self->socket);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_uring_src_finalize (GObject * gobject)
+{
+  GstRtpUringSrc *self = GST_RTP_URING_SRC (gobject);
+
+  g_free (self->address);
+  g_free (self->multicast_iface);
+  gst_caps_replace (&self->caps, NULL);
+
+  G_OBJECT_CLASS (parent_class)->finalize (gobject);
+}
+
+static void
+gst_rtp_uring_src_class_init (GstRtpUringSrcClass * klass)
+{
+  GObjectClass *oclass = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstBaseSrcClass *gstbasesrc_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *gstpushsrc_class = GST_PUSH_SRC_CLASS (klass);
+
+  oclass->set_property = gst_rtp_uring_src_set_property;
+  oclass->get_property = gst_rtp_uring_src_get_property;
+  oclass->finalize = gst_rtp_uring_src_finalize;
+
+  /**
+   * GstRtpUringSrc::address
+   *
+   * Address to receive packets on, a multicast group is joined.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_ADDRESS,
+      g_param_spec_string ("address", "Address",
+          "Address to receive packets on", DEFAULT_PROP_ADDRESS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::port
+   *
+   * Port to receive packets on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_PORT,
+      g_param_spec_int ("port", "Port", "Port to receive packets on",
+          0, G_MAXUINT16, DEFAULT_PROP_PORT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::uri
+   *
+   * udp://address:port to receive packets on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_URI,
+      g_param_spec_string ("uri", "URI", "udp:// URI to receive packets on",
+          NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::multicast-iface
+   *
+   * Network interface to join the multicast group on.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_MULTICAST_IFACE,
+      g_param_spec_string ("multicast-iface", "Multicast Interface",
+          "Network interface to join the multicast group on",
+          DEFAULT_PROP_MULTICAST_IFACE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::buffer-size
+   *
+   * Size of the kernel receive buffer in bytes, 0 keeps the default.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_BUFFER_SIZE,
+      g_param_spec_int ("buffer-size", "Buffer Size",
+          "Size of the kernel receive buffer in bytes", 0, G_MAXINT,
+          DEFAULT_PROP_BUFFER_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::caps
+   *
+   * Caps of the received packets.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_CAPS,
+      g_param_spec_boxed ("caps", "Caps", "Caps of the received packets",
+          GST_TYPE_CAPS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::kernel-timestamps
+   *
+   * Time the packets on the SO_TIMESTAMPNS receive time of the kernel
+   * instead of the time they are read.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_KERNEL_TIMESTAMPS,
+      g_param_spec_boolean ("kernel-timestamps", "Kernel Timestamps",
+          "Time the packets on the receive time of the kernel",
+          DEFAULT_PROP_KERNEL_TIMESTAMPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::drops
+   *
+   * Packets the kernel dropped because the receive buffer was full, from
+   * SO_RXQ_OVFL.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_DROPS,
+      g_param_spec_uint64 ("drops", "Drops",
+          "Packets dropped because the receive buffer was full", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpUringSrc::used-socket
+   *
+   * The socket packets are received on while running.
+   *
+   * Since: 1.14.0
+   */
+  g_object_class_install_property (oclass, PROP_USED_SOCKET,
+      g_param_spec_object ("used-socket", "Used Socket",
+          "Socket packets are received on", G_TYPE_SOCKET,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&src_template));
+
+  gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_rtp_uring_src_start);
+  gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_rtp_uring_src_stop);
+  gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR (gst_rtp_uring_src_unlock);
+  gstbasesrc_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_rtp_uring_src_unlock_stop);
+  gstbasesrc_class->get_caps = GST_DEBUG_FUNCPTR (gst_rtp_uring_src_get_caps);
+  gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_rtp_uring_src_create);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "barcortpuringsrc",
+      "Source/Network",
+      "Barco UDP receiver on io_uring",
+      "Marc Leeman <marc.leeman@barco.com>");
+
+  GST_DEBUG_CATEGORY_INIT (rtp_uring_src_debug,
+      "barcortpuringsrc", 0, "Barco UDP receiver on io_uring");
+}
+
+static void
+gst_rtp_uring_src_init (GstRtpUringSrc * self)
+{
+  self->address = g_strdup (DEFAULT_PROP_ADDRESS);
+  self->port = DEFAULT_PROP_PORT;
+  self->buffer_size = DEFAULT_PROP_BUFFER_SIZE;
+  self->multicast_iface = g_strdup (DEFAULT_PROP_MULTICAST_IFACE);
+  self->kernel_timestamps = DEFAULT_PROP_KERNEL_TIMESTAMPS;
+
+  gst_base_src_set_live (GST_BASE_SRC (self), TRUE);
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+  gst_base_src_set_do_timestamp (GST_BASE_SRC (self), TRUE);
+}
+
+gboolean
+rtp_uring_src_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin,
+      "barcortpuringsrc", GST_RANK_NONE, GST_TYPE_RTP_URING_SRC);
+}
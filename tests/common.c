@@ -0,0 +1,365 @@
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+#include "src/gstrtpgopcache.h"
+#include "src/gstrtpmdi.h"
+#include "src/gstrtppadstats.h"
+#include "src/gstrtpparameters.h"
+
+static GstBuffer *
+create_rtp (guint16 seq, guint32 ts, const guint8 * payload, gsize len)
+{
+  GstBuffer *buffer;
+  guint8 *data;
+
+  data = g_malloc0 (12 + len);
+  data[0] = 0x80;
+  data[1] = 96;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, ts);
+  GST_WRITE_UINT32_BE (data + 8, 0x12345678);
+  memcpy (data + 12, payload, len);
+  buffer = gst_buffer_new_wrapped (data, 12 + len);
+
+  return buffer;
+}
+
+static guint16
+get_seq (GstBuffer * buffer)
+{
+  guint8 header[4];
+
+  gst_buffer_extract (buffer, 0, header, 4);
+  return GST_READ_UINT16_BE (header + 2);
+}
+
+static void
+push_h264 (GstBarcoGopCache * cache, const gchar * encoding_name,
+    guint16 seq, guint32 ts, guint8 nal)
+{
+  GstBuffer *buffer;
+  guint8 payload[8] = { 0, };
+
+  payload[0] = 0x60 | nal;
+  buffer = create_rtp (seq, ts, payload, sizeof (payload));
+  gst_barco_gop_cache_push (cache, buffer, encoding_name);
+  gst_buffer_unref (buffer);
+}
+
+static void
+push_gop (GstBarcoGopCache * cache, const gchar * encoding_name)
+{
+  /* P slices, then SPS, PPS and IDR of the next GOP */
+  push_h264 (cache, encoding_name, 1, 1000, 1);
+  push_h264 (cache, encoding_name, 2, 2000, 1);
+  push_h264 (cache, encoding_name, 3, 3000, 7);
+  push_h264 (cache, encoding_name, 4, 3000, 8);
+  push_h264 (cache, encoding_name, 5, 3000, 5);
+  push_h264 (cache, encoding_name, 6, 4000, 1);
+}
+
+GST_START_TEST (test_gop_cache)
+{
+  GstBarcoGopCache cache;
+  GstBufferList *list;
+
+  /* no keyframe detector for a dynamic payload type without a name */
+  gst_barco_gop_cache_init (&cache, 64 * 1024);
+  push_gop (&cache, NULL);
+  fail_unless (gst_barco_gop_cache_get (&cache) == NULL);
+  gst_barco_gop_cache_clear (&cache);
+
+  /* starts at the parameter sets of the IDR */
+  push_gop (&cache, "H264");
+  list = gst_barco_gop_cache_get (&cache);
+  fail_unless (list != NULL);
+  fail_unless_equals_int (gst_buffer_list_length (list), 4);
+  fail_unless_equals_int (get_seq (gst_buffer_list_get (list, 0)), 3);
+  fail_unless_equals_int (get_seq (gst_buffer_list_get (list, 3)), 6);
+  gst_buffer_list_unref (list);
+
+  /* restarts at the next IDR */
+  push_h264 (&cache, "H264", 7, 5000, 5);
+  list = gst_barco_gop_cache_get (&cache);
+  fail_unless_equals_int (gst_buffer_list_length (list), 1);
+  fail_unless_equals_int (get_seq (gst_buffer_list_get (list, 0)), 7);
+  gst_buffer_list_unref (list);
+  gst_barco_gop_cache_clear (&cache);
+
+  /* a GOP larger than the cache is dropped as a whole */
+  gst_barco_gop_cache_init (&cache, 3 * 20);
+  push_gop (&cache, "H264");
+  fail_unless (gst_barco_gop_cache_get (&cache) == NULL);
+  gst_barco_gop_cache_clear (&cache);
+}
+
+GST_END_TEST;
+
+static void
+write_rtp (guint8 * data, guint16 seq, guint32 ts)
+{
+  data[0] = 0x80;
+  data[1] = 96;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, ts);
+  GST_WRITE_UINT32_BE (data + 8, 0x12345678);
+}
+
+GST_START_TEST (test_mdi)
+{
+  GstBarcoMdi mdi;
+  GstStructure *s;
+  guint8 data[1000] = { 0, };
+  GstClockTime arrival;
+  gdouble df, mlr;
+  guint64 bitrate, lost;
+  guint gaps, i;
+
+  gst_barco_mdi_init (&mdi, 90000);
+
+  /* 1000 byte packets every 10 ms give the drain rate */
+  for (i = 0; i < 100; i++) {
+    write_rtp (data, i, i * 900);
+    gst_barco_mdi_add (&mdi, data, sizeof (data), i * 10 * GST_MSECOND);
+  }
+  s = gst_barco_mdi_take (&mdi, GST_SECOND);
+  fail_unless (gst_structure_get_double (s, "delay-factor", &df));
+  fail_unless (gst_structure_get_uint64 (s, "bitrate", &bitrate));
+  fail_unless_equals_float (df, 0.0);
+  fail_unless_equals_uint64 (bitrate, 800000);
+  gst_structure_free (s);
+
+  /* four packets held up until the fifth: 5 packets in the buffer */
+  for (i = 0; i < 100; i++) {
+    arrival = GST_SECOND + (i >= 50 && i < 54 ? 54 : i) * 10 * GST_MSECOND;
+    write_rtp (data, 100 + i, (100 + i) * 900);
+    gst_barco_mdi_add (&mdi, data, sizeof (data), arrival);
+  }
+  s = gst_barco_mdi_take (&mdi, 2 * GST_SECOND);
+  fail_unless (gst_structure_get_double (s, "delay-factor", &df));
+  fail_unless (gst_structure_get_double (s, "media-loss-rate", &mlr));
+  fail_unless (ABS (df - 50.0) < 0.01);
+  fail_unless_equals_float (mlr, 0.0);
+  gst_structure_free (s);
+
+  /* two consecutive packets lost, a late duplicate is not */
+  for (i = 0; i < 100; i++) {
+    if (i == 50 || i == 51)
+      continue;
+    write_rtp (data, 200 + i, (200 + i) * 900);
+    gst_barco_mdi_add (&mdi, data, sizeof (data),
+        2 * GST_SECOND + i * 10 * GST_MSECOND);
+  }
+  write_rtp (data, 260, 260 * 900);
+  gst_barco_mdi_add (&mdi, data, sizeof (data), 3 * GST_SECOND);
+  s = gst_barco_mdi_take (&mdi, 3 * GST_SECOND);
+  fail_unless (gst_structure_get_double (s, "media-loss-rate", &mlr));
+  fail_unless (gst_structure_get_uint64 (s, "lost", &lost));
+  fail_unless (gst_structure_get_uint (s, "gaps", &gaps));
+  fail_unless (ABS (mlr - 2.0) < 0.01);
+  fail_unless_equals_uint64 (lost, 2);
+  fail_unless_equals_int (gaps, 1);
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pad_stats)
+{
+  static const guint16 seqs[] =
+      { 100, 101, 102, 105, 103, 103, 105, 99, 106, 300, 299, 200 };
+  GstBarcoPadStats stats;
+  GstStructure *s;
+  guint8 data[100] = { 0, };
+  guint64 packets, lost, reordered, duplicates;
+  guint i;
+
+  gst_barco_pad_stats_init (&stats, 0);
+  for (i = 0; i < G_N_ELEMENTS (seqs); i++) {
+    write_rtp (data, seqs[i], seqs[i] * 900);
+    gst_barco_pad_stats_add (&stats, data, sizeof (data),
+        GST_CLOCK_TIME_NONE);
+
+    switch (i) {
+      case 3:
+        /* 103 and 104 missing */
+        fail_unless_equals_uint64 (stats.lost, 2);
+        break;
+      case 4:
+        /* 103 late, no longer lost */
+        fail_unless_equals_uint64 (stats.lost, 1);
+        fail_unless_equals_uint64 (stats.reordered, 1);
+        break;
+      case 6:
+        /* 103 and 105 again */
+        fail_unless_equals_uint64 (stats.lost, 1);
+        fail_unless_equals_uint64 (stats.duplicates, 2);
+        break;
+      case 7:
+        /* 99 is before the first packet, it was never counted as lost */
+        fail_unless_equals_uint64 (stats.lost, 1);
+        fail_unless_equals_uint64 (stats.reordered, 2);
+        break;
+      default:
+        break;
+    }
+  }
+
+  /* 107 to 299 lost, 299 came late, 200 is too far back to tell */
+  s = gst_barco_pad_stats_to_structure (&stats, "stats", NULL);
+  fail_unless (gst_structure_get_uint64 (s, "packets", &packets));
+  fail_unless (gst_structure_get_uint64 (s, "lost", &lost));
+  fail_unless (gst_structure_get_uint64 (s, "reordered", &reordered));
+  fail_unless (gst_structure_get_uint64 (s, "duplicates", &duplicates));
+  fail_unless_equals_uint64 (packets, 12);
+  fail_unless_equals_uint64 (lost, 193);
+  fail_unless_equals_uint64 (reordered, 4);
+  fail_unless_equals_uint64 (duplicates, 2);
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+static gchar *
+write_parameters (const gchar * contents)
+{
+  gchar *path;
+  gint fd;
+
+  fd = g_file_open_tmp ("rtpparametersXXXXXX", &path, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+  fail_unless (g_file_set_contents (path, contents, -1, NULL));
+
+  return path;
+}
+
+GST_START_TEST (test_parameters)
+{
+  const RtpParameters *p;
+  GError *error = NULL;
+  gchar *path;
+
+  /* read on the first lookup */
+  path = write_parameters ("[AV1]\nmedia=video\nclock-rate=90000\n"
+      "[L24]\nmedia=audio\nclock-rate=48000\npayload=99\n");
+  g_setenv ("GST_BARCO_RTP_PARAMETERS", path, TRUE);
+
+  p = gst_rtp_parameters_lookup_pt (33);
+  fail_unless (p != NULL);
+  fail_unless_equals_string (p->encoding_name, "MP2T");
+  fail_unless (gst_rtp_parameters_lookup_pt (96) == NULL);
+  fail_unless (gst_rtp_parameters_lookup_pt (128) == NULL);
+
+  p = gst_rtp_parameters_lookup_name ("H264");
+  fail_unless (p != NULL);
+  fail_unless_equals_string (p->media, "video");
+  fail_unless_equals_int (p->clock_rate, 90000);
+  fail_unless (gst_rtp_parameters_lookup_name ("JPEG-XS") == NULL);
+  fail_unless (gst_rtp_parameters_lookup_name (NULL) == NULL);
+
+  p = gst_rtp_parameters_lookup_name ("AV1");
+  fail_unless (p != NULL);
+  fail_unless_equals_string (p->media, "video");
+  fail_unless_equals_int (p->clock_rate, 90000);
+  p = gst_rtp_parameters_lookup_pt (99);
+  fail_unless (p != NULL);
+  fail_unless_equals_string (p->encoding_name, "L24");
+  fail_unless_equals_string (p->media, "audio");
+  fail_unless_equals_int (p->clock_rate, 48000);
+  g_unsetenv ("GST_BARCO_RTP_PARAMETERS");
+  g_unlink (path);
+  g_free (path);
+
+  /* a new name, then an override of a built in one */
+  gst_rtp_parameters_register (-1, "JPEG-XS", NULL, 90000);
+  p = gst_rtp_parameters_lookup_name ("JPEG-XS");
+  fail_unless (p != NULL);
+  fail_unless_equals_string (p->media, "video");
+
+  p = gst_rtp_parameters_lookup_name ("H264");
+  gst_rtp_parameters_register (-1, "H264", "video", 45000);
+  fail_unless_equals_int (p->clock_rate, 90000);
+  fail_unless_equals_int (gst_rtp_parameters_lookup_name ("H264")->clock_rate,
+      45000);
+
+  /* and from a key file given later */
+  path = write_parameters ("[AV1]\nmedia=video\nclock-rate=1000\n"
+      "[MP2T]\nmedia=video\nclock-rate=27000000\npayload=33\n");
+  fail_unless (gst_rtp_parameters_load (path, &error));
+  fail_unless_equals_int (gst_rtp_parameters_lookup_name ("AV1")->clock_rate,
+      1000);
+  fail_unless_equals_int (gst_rtp_parameters_lookup_pt (33)->clock_rate,
+      27000000);
+  g_unlink (path);
+  g_free (path);
+
+  fail_if (gst_rtp_parameters_load ("/nonexistent/rtp-parameters", &error));
+  fail_unless (error != NULL);
+  g_clear_error (&error);
+}
+
+GST_END_TEST;
+
+static gpointer
+lookup_parameters (gpointer user_data)
+{
+  volatile gint *running = user_data;
+  while (g_atomic_int_get (running)) {
+    const RtpParameters *p = gst_rtp_parameters_lookup_name ("H264");
+
+    fail_unless (p != NULL);
+    fail_unless (p->clock_rate == 90000 || p->clock_rate == 45000);
+    fail_unless (gst_rtp_parameters_lookup_pt (33) != NULL);
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (test_parameters_concurrent)
+{
+  volatile gint running = 1;
+  GThread *threads[4];
+  gchar name[16];
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("lookup", lookup_parameters,
+        (gpointer) & running);
+
+  for (i = 0; i < 200; i++) {
+    g_snprintf (name, sizeof (name), "X-TEST-%u", i);
+    gst_rtp_parameters_register (-1, name, "video", 90000);
+    gst_rtp_parameters_register (-1, "H264", "video", i % 2 ? 45000 : 90000);
+  }
+  g_atomic_int_set (&running, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  for (i = 0; i < 200; i++) {
+    g_snprintf (name, sizeof (name), "X-TEST-%u", i);
+    fail_unless (gst_rtp_parameters_lookup_name (name) != NULL);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+common_suite (void)
+{
+  Suite *s = suite_create ("common");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_gop_cache);
+  tcase_add_test (tc_chain, test_mdi);
+  tcase_add_test (tc_chain, test_pad_stats);
+  tcase_add_test (tc_chain, test_parameters);
+  tcase_add_test (tc_chain, test_parameters_concurrent);
+
+  return s;
+}
+
+GST_CHECK_MAIN (common);
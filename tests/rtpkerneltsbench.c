@@ -0,0 +1,188 @@
+/* RFC 3550 interarrival jitter measured on the buffer timestamps of the
+ * receivers of rtpsrc, with and without kernel-timestamps, on an idle
+ * and on a loaded host. A paced L16 stream is sent over loopback; the
+ * load is two busy threads per CPU.
+ *
+ *   rtpkerneltsbench [--gst-plugin-path=...] [seconds]
+ */
+#include <gst/gst.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLOCK_RATE (8000)
+
+#define SENDER "audiotestsrc is-live=true samplesperbuffer=80 ! " \
+  "audio/x-raw,rate=8000,channels=1 ! rtpL16pay ! " \
+  "udpsink host=127.0.0.1 port=%u"
+
+static const gchar *receivers[] = {
+  "barcortpuringsrc address=127.0.0.1 port=%u kernel-timestamps=%s",
+  "barcortpcapturesrc iface=lo address=127.0.0.1 port=%u "
+      "kernel-timestamps=%s",
+};
+
+/* transit times in ns, the 8 kHz RTP clock is too coarse */
+typedef struct
+{
+  guint32 first_ts;
+  gboolean have_transit;
+  gint64 transit;
+  gdouble jitter;
+  gdouble max_d;
+  guint64 packets;
+} Run;
+
+static gint burning;
+
+static gpointer
+burn (gpointer data)
+{
+  volatile guint64 n = 0;
+
+  while (g_atomic_int_get (&burning))
+    n++;
+
+  return NULL;
+}
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  Run *run = user_data;
+  guint8 header[8];
+  gint64 transit, d;
+  guint32 ts;
+
+  if (!GST_BUFFER_DTS_IS_VALID (buffer) ||
+      gst_buffer_extract (buffer, 0, header, 8) < 8)
+    return;
+
+  ts = GST_READ_UINT32_BE (header + 4);
+  if (!run->have_transit)
+    run->first_ts = ts;
+  transit = GST_BUFFER_DTS (buffer) -
+      gst_util_uint64_scale ((guint32) (ts - run->first_ts), GST_SECOND,
+      CLOCK_RATE);
+  if (run->have_transit) {
+    d = ABS (transit - run->transit);
+    run->jitter += (d - run->jitter) / 16.0;
+    run->max_d = MAX (run->max_d, d);
+  }
+  run->have_transit = TRUE;
+  run->transit = transit;
+  run->packets++;
+}
+
+static gboolean
+quit_cb (gpointer user_data)
+{
+  g_main_loop_quit (user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Returns: FALSE if the receiver could not run */
+static gboolean
+run (const gchar * receiver_desc, gboolean kernel, gboolean load,
+    guint seconds, guint port, Run * r)
+{
+  GstElement *sender, *receiver, *sink;
+  GThread *threads[256];
+  GError *error = NULL;
+  GMainLoop *loop;
+  guint n = 0, i;
+  gchar *desc, *src;
+
+  memset (r, 0, sizeof (Run));
+  src = g_strdup_printf (receiver_desc, port, kernel ? "true" : "false");
+  desc = g_strdup_printf ("%s ! fakesink name=sink sync=false "
+      "signal-handoffs=true", src);
+  g_free (src);
+  receiver = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!receiver) {
+    g_printerr ("%s\n", error->message);
+    g_clear_error (&error);
+    return FALSE;
+  }
+
+  desc = g_strdup_printf (SENDER, port);
+  sender = gst_parse_launch (desc, NULL);
+  g_free (desc);
+
+  sink = gst_bin_get_by_name (GST_BIN (receiver), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), r);
+  gst_object_unref (sink);
+
+  if (gst_element_set_state (receiver,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    gst_element_set_state (receiver, GST_STATE_NULL);
+    gst_object_unref (receiver);
+    gst_object_unref (sender);
+    return FALSE;
+  }
+  gst_element_set_state (sender, GST_STATE_PLAYING);
+
+  if (load) {
+    g_atomic_int_set (&burning, TRUE);
+    n = MIN (2 * g_get_num_processors (), G_N_ELEMENTS (threads));
+    for (i = 0; i < n; i++)
+      threads[i] = g_thread_new ("burn", burn, NULL);
+  }
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_timeout_add_seconds (seconds, quit_cb, loop);
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+
+  g_atomic_int_set (&burning, FALSE);
+  for (i = 0; i < n; i++)
+    g_thread_join (threads[i]);
+
+  gst_element_set_state (sender, GST_STATE_NULL);
+  gst_element_set_state (receiver, GST_STATE_NULL);
+  gst_object_unref (sender);
+  gst_object_unref (receiver);
+
+  return r->packets > 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint seconds = 5, i, load, kernel, port = 5404;
+  gboolean ret = TRUE;
+  Run r;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = atoi (argv[1]);
+
+  g_print ("%-20s %-6s %-6s %10s %10s %8s\n", "receiver", "load", "kernel",
+      "jitter", "max |D|", "packets");
+  for (i = 0; i < G_N_ELEMENTS (receivers); i++) {
+    for (load = 0; load < 2; load++) {
+      for (kernel = 0; kernel < 2; kernel++) {
+        gchar **name = g_strsplit (receivers[i], " ", 2);
+
+        if (run (receivers[i], kernel, load, seconds, port, &r))
+          g_print ("%-20s %-6s %-6s %7.3f ms %7.3f ms %8" G_GUINT64_FORMAT
+              "\n", name[0], load ? "yes" : "no", kernel ? "yes" : "no",
+              r.jitter / GST_MSECOND, r.max_d / GST_MSECOND,
+              r.packets);
+        else
+          g_print ("%-20s %-6s %-6s %10s\n", name[0], load ? "yes" : "no",
+              kernel ? "yes" : "no", "n/a");
+        /* the capture ring needs CAP_NET_RAW, only io_uring must work */
+        if (i == 0)
+          ret &= r.packets > 0;
+        g_strfreev (name);
+        port += 2;
+      }
+    }
+  }
+
+  return ret ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/* Cost of the pt map of rtpsrc when bringing up many receivers: the first
+ * request of each payload type builds the caps, the next ones are served
+ * from the cache of the instance.
+ *
+ *   rtpptmapbench [--gst-plugin-path=...] [instances]
+ */
+#include <gst/gst.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+static const guint pts[] = { 96, 97, 33, 0, 8 };
+
+static GstElement *
+find_rtpbin (GstElement * rtpsrc)
+{
+  GstElement *rtpbin = NULL;
+  GstIterator *it;
+  GValue data = { 0, };
+
+  it = gst_bin_iterate_elements (GST_BIN (rtpsrc));
+  while (!rtpbin && gst_iterator_next (it, &data) == GST_ITERATOR_OK) {
+    GstElement *element = g_value_get_object (&data);
+    GstElementFactory *factory = gst_element_get_factory (element);
+
+    if (factory && g_strcmp0 (GST_OBJECT_NAME (factory), "rtpbin") == 0)
+      rtpbin = gst_object_ref (element);
+    g_value_unset (&data);
+  }
+  gst_iterator_free (it);
+
+  return rtpbin;
+}
+
+/* Returns: time in ns to map all pts on all rtpbins, counts the pts that
+ * got no caps in unmapped */
+static gint64
+map_all (GstElement ** rtpbins, guint n, guint * unmapped)
+{
+  gint64 start = g_get_monotonic_time ();
+  GstCaps *caps;
+  guint i, j;
+
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < G_N_ELEMENTS (pts); j++) {
+      caps = NULL;
+      g_signal_emit_by_name (rtpbins[i], "request-pt-map", 0, pts[j], &caps);
+      if (caps)
+        gst_caps_unref (caps);
+      else
+        (*unmapped)++;
+    }
+  }
+
+  return (g_get_monotonic_time () - start) * 1000;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GstElement **rtpsrcs, **rtpbins;
+  struct rlimit limit;
+  guint n = 1000, i, maps, unmapped = 0;
+  gint64 cold, warm;
+  gboolean ret = TRUE;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n = atoi (argv[1]);
+
+  /* every receiver has its RTP and RTCP sockets open */
+  if (getrlimit (RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit (RLIMIT_NOFILE, &limit);
+  }
+
+  rtpsrcs = g_new0 (GstElement *, n);
+  rtpbins = g_new0 (GstElement *, n);
+  for (i = 0; i < n; i++) {
+    gchar *uri = g_strdup_printf ("rtp://127.0.0.1:%u?encoding-name=H264",
+        20000 + 2 * i);
+
+    rtpsrcs[i] = gst_element_factory_make ("rtpsrc", NULL);
+    g_object_set (rtpsrcs[i], "uri", uri, NULL);
+    g_free (uri);
+    if (gst_element_set_state (rtpsrcs[i], GST_STATE_READY) ==
+        GST_STATE_CHANGE_FAILURE || !(rtpbins[i] = find_rtpbin (rtpsrcs[i]))) {
+      g_printerr ("Could not bring up rtpsrc %u\n", i);
+      gst_element_set_state (rtpsrcs[i], GST_STATE_NULL);
+      gst_object_unref (rtpsrcs[i]);
+      n = i;
+      ret = FALSE;
+      break;
+    }
+  }
+
+  maps = n * G_N_ELEMENTS (pts);
+  cold = map_all (rtpbins, n, &unmapped);
+  warm = map_all (rtpbins, n, &unmapped);
+  if (unmapped) {
+    g_printerr ("%u pt maps without caps\n", unmapped);
+    ret = FALSE;
+  }
+
+  g_print ("%u instances, %u pt maps: first %.1f ns/map, cached %.1f ns/map\n",
+      n, maps, maps ? (gdouble) cold / maps : 0.0,
+      maps ? (gdouble) warm / maps : 0.0);
+
+  for (i = 0; i < n; i++) {
+    gst_object_unref (rtpbins[i]);
+    gst_element_set_state (rtpsrcs[i], GST_STATE_NULL);
+    gst_object_unref (rtpsrcs[i]);
+  }
+  g_free (rtpbins);
+  g_free (rtpsrcs);
+
+  return ret ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/* Compare the CPU cost per packet of rtpsink ! rtpsrc on one host through
+ * shared memory (rtp+shm://) and through loopback UDP (rtp://).
+ *
+ *   rtpshmbench [--gst-plugin-path=...] [seconds]
+ */
+#include <gst/gst.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+/* 8 channels of 60 samples: 800 packets/s with 960 bytes of payload */
+#define SENDER "audiotestsrc is-live=true wave=silence samplesperbuffer=60 " \
+  "! audio/x-raw,format=S16BE,rate=48000,channels=8 ! rtpL16pay pt=96 " \
+  "! rtpsink uri=%s"
+#define RECEIVER "rtpsrc uri=%s?encoding-name=L16 " \
+  "! fakesink name=sink sync=false signal-handoffs=true"
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  guint64 *packets = user_data;
+
+  (*packets)++;
+}
+
+static gboolean
+quit_cb (gpointer user_data)
+{
+  g_main_loop_quit (user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gint64
+cpu_time (void)
+{
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+
+  return (gint64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+      G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static gboolean
+run (const gchar * uri, guint seconds)
+{
+  GstElement *sender, *receiver, *sink;
+  GMainLoop *loop;
+  GError *error = NULL;
+  guint64 packets = 0;
+  gint64 start;
+  gchar *desc;
+
+  desc = g_strdup_printf (RECEIVER, uri);
+  receiver = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!receiver) {
+    g_printerr ("%s: %s\n", uri, error->message);
+    g_clear_error (&error);
+    return FALSE;
+  }
+
+  desc = g_strdup_printf (SENDER, uri);
+  sender = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!sender) {
+    g_printerr ("%s: %s\n", uri, error->message);
+    g_clear_error (&error);
+    gst_object_unref (receiver);
+    return FALSE;
+  }
+
+  sink = gst_bin_get_by_name (GST_BIN (receiver), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), &packets);
+  gst_object_unref (sink);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_timeout_add_seconds (seconds, quit_cb, loop);
+
+  start = cpu_time ();
+  gst_element_set_state (receiver, GST_STATE_PLAYING);
+  gst_element_set_state (sender, GST_STATE_PLAYING);
+  g_main_loop_run (loop);
+  gst_element_set_state (sender, GST_STATE_NULL);
+  gst_element_set_state (receiver, GST_STATE_NULL);
+  start = cpu_time () - start;
+
+  g_print ("%-28s %10" G_GUINT64_FORMAT " packets %8.2f us cpu/packet\n",
+      uri, packets, packets ? (gdouble) start / packets : 0.0);
+
+  g_main_loop_unref (loop);
+  gst_object_unref (sender);
+  gst_object_unref (receiver);
+
+  return packets > 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint seconds = 10;
+  gboolean ret;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    seconds = atoi (argv[1]);
+
+  ret = run ("rtp+shm://127.0.0.1:5104", seconds);
+  ret &= run ("rtp://127.0.0.1:5204", seconds);
+
+  return ret ? 0 : 1;
+}
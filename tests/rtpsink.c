@@ -1,4 +1,6 @@
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/net/gstnet.h>
 
 GST_START_TEST (test_pads)
 {
@@ -55,6 +57,508 @@ GST_START_TEST (test_pads_localhost_3_slashes)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pads_fec)
+{
+  GstElement *element;
+  GstPad *sink_pad;
+
+  element = gst_check_setup_element ("rtpsink");
+  fail_if (element == NULL);
+  g_object_set (element, "uri",
+      "rtp://239.1.2.3:6000?fec=smpte-2022-1&fec-columns=5&fec-rows=4", NULL);
+
+  sink_pad = gst_element_get_request_pad (element, "sink_%u");
+  fail_if (sink_pad == NULL);
+  gst_element_release_request_pad (element, sink_pad);
+  gst_object_unref (sink_pad);
+
+  gst_check_teardown_element (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pads_redundant)
+{
+  GstElement *element;
+  GstPad *sink_pad;
+
+  element = gst_check_setup_element ("rtpsink");
+  fail_if (element == NULL);
+  g_object_set (element, "uri", "rtp://239.1.2.3:6000",
+      "redundant-uri", "rtp://239.4.5.6:6000", NULL);
+
+  sink_pad = gst_element_get_request_pad (element, "sink_%u");
+  fail_if (sink_pad == NULL);
+  gst_element_release_request_pad (element, sink_pad);
+  gst_object_unref (sink_pad);
+
+  gst_check_teardown_element (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pads_burst)
+{
+  GstElement *element;
+  GstPad *sink_pad;
+
+  element = gst_check_setup_element ("rtpsink");
+  fail_if (element == NULL);
+  g_object_set (element, "uri", "rtp://239.1.2.3:6000?burst=true", NULL);
+
+  sink_pad = gst_element_get_request_pad (element, "sink_%u");
+  fail_if (sink_pad == NULL);
+  gst_element_release_request_pad (element, sink_pad);
+  gst_object_unref (sink_pad);
+
+  gst_check_teardown_element (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pads_mp2t_pacing)
+{
+  GstElement *element;
+  GstPad *sink_pad;
+  gboolean pacing = FALSE;
+
+  element = gst_check_setup_element ("rtpsink");
+  fail_if (element == NULL);
+  g_object_set (element, "uri", "rtp://239.1.2.3:6000?mp2t-pacing=true",
+      NULL);
+  g_object_get (element, "mp2t-pacing", &pacing, NULL);
+  fail_unless (pacing);
+
+  sink_pad = gst_element_get_request_pad (element, "sink_%u");
+  fail_if (sink_pad == NULL);
+  gst_element_release_request_pad (element, sink_pad);
+  gst_object_unref (sink_pad);
+
+  gst_check_teardown_element (element);
+}
+
+GST_END_TEST;
+
+/* an RTP packet of 14 TS packets, the first with a PCR, as a muxer
+ * pushes them every 40 ms */
+static GstBuffer *
+create_mp2t_burst (guint k)
+{
+  GstBuffer *buffer;
+  guint8 *data, *ts;
+  guint64 pcr = k * 3600;
+  guint i;
+
+  data = g_malloc (12 + 14 * 188);
+  data[0] = 0x80;
+  data[1] = 33;
+  GST_WRITE_UINT16_BE (data + 2, k);
+  GST_WRITE_UINT32_BE (data + 4, k * 3600);
+  GST_WRITE_UINT32_BE (data + 8, 0x12345678);
+  for (i = 0; i < 14; i++) {
+    ts = data + 12 + i * 188;
+    memset (ts, 0xff, 188);
+    ts[0] = 0x47;
+    ts[1] = 0x00;
+    ts[2] = 100;
+    ts[3] = 0x10 | ((k * 14 + i) & 0x0f);
+  }
+  ts = data + 12;
+  ts[3] |= 0x20;
+  ts[4] = 7;
+  ts[5] = 0x10;
+  GST_WRITE_UINT32_BE (ts + 6, (guint32) (pcr >> 1));
+  ts[10] = ((pcr & 1) << 7) | 0x7e;
+  ts[11] = 0;
+  buffer = gst_buffer_new_wrapped (data, 12 + 14 * 188);
+  GST_BUFFER_PTS (buffer) = k * 40 * GST_MSECOND;
+
+  return buffer;
+}
+
+GST_START_TEST (test_mp2t_pacing)
+{
+  GstHarness *h;
+  GstBuffer *buffer;
+  GstClockTime pts;
+  guint k;
+
+  h = gst_harness_new ("barcortpmp2tpace");
+  g_object_set (h->element, "latency", 100, NULL);
+  gst_harness_set_src_caps_str (h,
+      "application/x-rtp, encoding-name=MP2T, payload=33");
+
+  /* every PCR interval goes out when the next PCR comes in */
+  for (k = 0; k < 5; k++)
+    fail_unless_equals_int (gst_harness_push (h, create_mp2t_burst (k)),
+        GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 8);
+
+  /* two packets of 7 TS packets per 40 ms, 20 ms apart */
+  for (k = 0; k < 8; k++) {
+    buffer = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 12 + 7 * 188);
+    pts = GST_BUFFER_PTS (buffer);
+    fail_unless (pts + GST_USECOND >= (100 + k * 20) * GST_MSECOND);
+    fail_unless (pts <= (100 + k * 20) * GST_MSECOND + GST_USECOND);
+    gst_buffer_unref (buffer);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_keyframe_request_aggregation)
+{
+  GstElement *element;
+  GstPad *sink_pad, *src_pad;
+  guint64 received = 0, forwarded = 0;
+  gint i;
+
+  element = gst_check_setup_element ("rtpsink");
+  fail_if (element == NULL);
+  g_object_set (element, "uri", "rtp://239.1.2.3:6000",
+      "keyframe-request-interval", 10000, NULL);
+
+  sink_pad = gst_element_get_request_pad (element, "sink_%u");
+  fail_if (sink_pad == NULL);
+  src_pad = gst_pad_new ("src", GST_PAD_SRC);
+  gst_pad_set_active (src_pad, TRUE);
+  fail_unless (gst_pad_link (src_pad, sink_pad) == GST_PAD_LINK_OK);
+
+  for (i = 0; i < 2; i++)
+    gst_pad_push_event (sink_pad, gst_event_new_custom
+        (GST_EVENT_CUSTOM_UPSTREAM, gst_structure_new_empty
+            ("GstForceKeyUnit")));
+
+  g_object_get (element, "keyframe-requests-received", &received,
+      "keyframe-requests-forwarded", &forwarded, NULL);
+  fail_unless_equals_uint64 (received, 2);
+  fail_unless_equals_uint64 (forwarded, 1);
+
+  gst_pad_unlink (src_pad, sink_pad);
+  gst_object_unref (src_pad);
+  gst_element_release_request_pad (element, sink_pad);
+  gst_object_unref (sink_pad);
+
+  gst_check_teardown_element (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stats)
+{
+  GstElement *element;
+  GstPad *sink_pad;
+  GstStructure *stats;
+  const GValue *streams;
+  guint interval = 1;
+
+  element = gst_check_setup_element ("rtpsink");
+  fail_if (element == NULL);
+  g_object_set (element, "uri", "rtp://239.1.2.3:6000", NULL);
+  g_object_get (element, "stats-interval", &interval, NULL);
+  fail_unless_equals_int (interval, 0);
+
+  sink_pad = gst_element_get_request_pad (element, "sink_%u");
+  fail_if (sink_pad == NULL);
+
+  g_object_get (element, "stats", &stats, NULL);
+  fail_unless (gst_structure_has_name (stats, "GstRtpSinkStats"));
+  streams = gst_structure_get_value (stats, "streams");
+  fail_unless_equals_int (gst_value_array_get_size (streams), 1);
+  gst_structure_free (stats);
+
+  gst_element_release_request_pad (element, sink_pad);
+  gst_object_unref (sink_pad);
+
+  gst_check_teardown_element (element);
+}
+
+GST_END_TEST;
+
+/* an H.264 packet of the stream sent to the burst server */
+static GstBuffer *
+create_h264 (guint16 seq, guint8 nal)
+{
+  guint8 *data = g_malloc0 (12 + 100);
+
+  data[0] = 0x80;
+  data[1] = 96;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, 3000);
+  GST_WRITE_UINT32_BE (data + 8, 0x11223344);
+  data[12] = nal;
+
+  return gst_buffer_new_wrapped (data, 12 + 100);
+}
+
+/* an RFC 6285 RAMS-R request for @ssrc from 127.0.0.1:@port */
+static GstBuffer *
+create_rams (guint32 ssrc, guint16 port)
+{
+  guint8 *data = g_malloc0 (16);
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GstBuffer *buffer;
+
+  data[0] = 0x80 | 6;
+  data[1] = 205;
+  GST_WRITE_UINT16_BE (data + 2, 3);
+  GST_WRITE_UINT32_BE (data + 4, 0xcafe);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+  data[12] = 1;
+  buffer = gst_buffer_new_wrapped (data, 16);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, port);
+  gst_buffer_add_net_address_meta (buffer, addr);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  return buffer;
+}
+
+static GSocket *
+create_loopback_socket (void)
+{
+  GSocket *socket;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  fail_unless (g_socket_bind (socket, addr, TRUE, NULL));
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+  g_socket_set_timeout (socket, 5);
+
+  return socket;
+}
+
+static guint16
+get_local_port (GSocket * socket)
+{
+  GSocketAddress *addr = g_socket_get_local_address (socket, NULL);
+  guint16 port;
+
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  return port;
+}
+
+/* receive a burst of the 3 cached packets and wait for it to be over */
+static void
+receive_burst (GstElement * burst, GSocket * receiver, guint16 from_port,
+    guint64 bursts)
+{
+  GSocketAddress *from;
+  guint8 data[1500];
+  guint64 sent = 0;
+  guint i;
+
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_int (g_socket_receive_from (receiver, &from,
+            (gchar *) data, sizeof (data), NULL, NULL), 12 + 100);
+    fail_unless_equals_int (GST_READ_UINT16_BE (data + 2), i);
+    /* sent on the socket of the stream */
+    fail_unless_equals_int (g_inet_socket_address_get_port
+        (G_INET_SOCKET_ADDRESS (from)), from_port);
+    g_object_unref (from);
+  }
+
+  while (sent < bursts) {
+    g_usleep (G_USEC_PER_SEC / 100);
+    g_object_get (burst, "bursts", &sent, NULL);
+  }
+}
+
+GST_START_TEST (test_burst_policy)
+{
+  GstHarness *h, *rtcp;
+  GSocket *sender, *receiver;
+  guint64 refused = 0;
+  guint16 port;
+  guint i;
+
+  sender = create_loopback_socket ();
+  receiver = create_loopback_socket ();
+  port = get_local_port (receiver);
+
+  h = gst_harness_new_with_padnames ("barcortpburst", "sink", "src");
+  rtcp = gst_harness_new_with_element (h->element, "rtcp_sink", "rtcp_src");
+  /* the receiver gets the burst on its RTCP port shifted like the ports
+   * of the stream */
+  g_object_set (h->element, "socket", sender, "rtp-port", port,
+      "rtcp-port", 5171, "cooldown", 200, NULL);
+  gst_harness_set_src_caps_str (h,
+      "application/x-rtp, encoding-name=H264, payload=96");
+  gst_harness_set_src_caps_str (rtcp, "application/x-rtcp");
+
+  /* a keyframe and two slices */
+  fail_unless_equals_int (gst_harness_push (h, create_h264 (0, 0x65)),
+      GST_FLOW_OK);
+  for (i = 1; i < 3; i++)
+    fail_unless_equals_int (gst_harness_push (h, create_h264 (i, 0x41)),
+        GST_FLOW_OK);
+
+  /* another SSRC */
+  fail_unless_equals_int (gst_harness_push (rtcp, create_rams (0xdead, 5171)),
+      GST_FLOW_OK);
+  g_object_get (h->element, "refused", &refused, NULL);
+  fail_unless_equals_uint64 (refused, 1);
+
+  fail_unless_equals_int (gst_harness_push (rtcp,
+          create_rams (0x11223344, 5171)), GST_FLOW_OK);
+  receive_burst (h->element, receiver, get_local_port (sender), 1);
+
+  /* the address is in its cooldown, also from another port */
+  fail_unless_equals_int (gst_harness_push (rtcp,
+          create_rams (0x11223344, 5172)), GST_FLOW_OK);
+  g_object_get (h->element, "refused", &refused, NULL);
+  fail_unless_equals_uint64 (refused, 2);
+
+  /* the cooldown starts when the burst is over */
+  g_usleep (300 * 1000);
+  fail_unless_equals_int (gst_harness_push (rtcp,
+          create_rams (0x11223344, 5171)), GST_FLOW_OK);
+  receive_burst (h->element, receiver, get_local_port (sender), 2);
+
+  /* no bursts allowed */
+  g_object_set (h->element, "max-bursts", 0, NULL);
+  fail_unless_equals_int (gst_harness_push (rtcp,
+          create_rams (0x11223344, 5171)), GST_FLOW_OK);
+  g_object_get (h->element, "refused", &refused, NULL);
+  fail_unless_equals_uint64 (refused, 3);
+
+  /* the requests go on to rtpbin */
+  fail_unless_equals_int (gst_harness_buffers_received (rtcp), 5);
+
+  gst_harness_teardown (rtcp);
+  gst_harness_teardown (h);
+  g_object_unref (receiver);
+  g_object_unref (sender);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+create_byte (guint8 value)
+{
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, 1, NULL);
+
+  gst_buffer_memset (buffer, 0, value, 1);
+  return buffer;
+}
+
+GST_START_TEST (test_uring_loopback)
+{
+  GstElementFactory *factory;
+  GstHarness *src, *sink;
+  GstStateChangeReturn ret;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GstNetAddressMeta *meta;
+  GstMapInfo map;
+  guint8 i;
+
+  /* only built with liburing */
+  factory = gst_element_factory_find ("barcortpuringsrc");
+  if (factory == NULL)
+    return;
+  gst_object_unref (factory);
+
+  src = gst_harness_new ("barcortpuringsrc");
+  g_object_set (src->element, "address", "127.0.0.1", "port", 5160, NULL);
+  ret = gst_element_set_state (src->element, GST_STATE_PLAYING);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    /* the kernel does not support io_uring */
+    gst_harness_teardown (src);
+    return;
+  }
+
+  sink = gst_harness_new ("barcortpuringsink");
+  g_object_set (sink->element, "host", "127.0.0.1", "port", 5160,
+      "bind-port", 5161, "sync", FALSE, NULL);
+  fail_unless (gst_element_set_state (sink->element, GST_STATE_PLAYING)
+      != GST_STATE_CHANGE_FAILURE);
+  gst_harness_set_src_caps_str (sink, "application/x-rtp");
+
+  /* single buffers, then a list sent as one chain */
+  for (i = 0; i < 4; i++)
+    fail_unless_equals_int (gst_harness_push (sink, create_byte (i)),
+        GST_FLOW_OK);
+  list = gst_buffer_list_new ();
+  for (i = 4; i < 10; i++)
+    gst_buffer_list_add (list, create_byte (i));
+  fail_unless_equals_int (gst_pad_push_list (sink->srcpad, list),
+      GST_FLOW_OK);
+
+  for (i = 0; i < 10; i++) {
+    buffer = gst_harness_pull (src);
+    fail_unless (buffer != NULL);
+    fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+    fail_unless_equals_int (map.size, 1);
+    fail_unless_equals_int (map.data[0], i);
+    gst_buffer_unmap (buffer, &map);
+    meta = gst_buffer_get_net_address_meta (buffer);
+    fail_unless (meta != NULL);
+    fail_unless_equals_int (g_inet_socket_address_get_port
+        (G_INET_SOCKET_ADDRESS (meta->addr)), 5161);
+    gst_buffer_unref (buffer);
+  }
+
+  /* stopping an idle receiver wakes it up */
+  fail_unless_equals_int (gst_element_set_state (src->element,
+          GST_STATE_NULL), GST_STATE_CHANGE_SUCCESS);
+
+  gst_harness_teardown (sink);
+  gst_harness_teardown (src);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stats_redundant)
+{
+  GstHarness *h;
+  GstStructure *stats;
+  const GstStructure *stream;
+  const GValue *streams;
+  guint64 packets = 0, sent = 0;
+  guint i;
+
+  h = gst_harness_new_with_padnames ("rtpsink", "sink_%u", NULL);
+  g_object_set (h->element, "uri", "rtp://127.0.0.1:5180",
+      "redundant-uri", "rtp://127.0.0.1:5182", NULL);
+  gst_harness_set_src_caps_str (h, "application/x-rtp, media=video, "
+      "clock-rate=90000, encoding-name=H264, payload=96");
+
+  /* without timestamps the sockets send right away */
+  for (i = 0; i < 5; i++)
+    fail_unless_equals_int (gst_harness_push (h, create_h264 (i, 0x41)),
+        GST_FLOW_OK);
+
+  /* every path counts what it sent */
+  g_object_get (h->element, "stats", &stats, NULL);
+  streams = gst_structure_get_value (stats, "streams");
+  fail_unless_equals_int (gst_value_array_get_size (streams), 1);
+  stream = gst_value_get_structure (gst_value_array_get_value (streams, 0));
+  fail_unless (gst_structure_get_uint64 (stream, "packets", &packets));
+  fail_unless (gst_structure_get_uint64 (stream, "sent", &sent));
+  fail_unless_equals_uint64 (packets, 5);
+  fail_unless_equals_uint64 (sent, 10);
+  gst_structure_free (stats);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpsink_suite (void)
 {
@@ -65,6 +569,16 @@ rtpsink_suite (void)
   tcase_add_test (tc_chain, test_pads);
   tcase_add_test (tc_chain, test_pads_localhost);
   tcase_add_test (tc_chain, test_pads_localhost_3_slashes);
+  tcase_add_test (tc_chain, test_pads_fec);
+  tcase_add_test (tc_chain, test_pads_redundant);
+  tcase_add_test (tc_chain, test_pads_burst);
+  tcase_add_test (tc_chain, test_pads_mp2t_pacing);
+  tcase_add_test (tc_chain, test_mp2t_pacing);
+  tcase_add_test (tc_chain, test_keyframe_request_aggregation);
+  tcase_add_test (tc_chain, test_stats);
+  tcase_add_test (tc_chain, test_burst_policy);
+  tcase_add_test (tc_chain, test_uring_loopback);
+  tcase_add_test (tc_chain, test_stats_redundant);
 
   return s;
 }
@@ -0,0 +1,166 @@
+/* Time to the first decoded frame of rtpsrc ! decodebin for streams with
+ * and without an encoding-name, the latter sniffed from their payload.
+ *
+ *   rtpsniffbench [--gst-plugin-path=...] [runs]
+ */
+#include <gst/gst.h>
+#include <stdlib.h>
+
+typedef struct
+{
+  const gchar *encoding_name;
+  const gchar *sender;
+} Stream;
+
+static const Stream streams[] = {
+  {"H264", "videotestsrc is-live=true ! x264enc tune=zerolatency "
+        "key-int-max=30 ! rtph264pay config-interval=-1 pt=96"},
+  {"H265", "videotestsrc is-live=true ! x265enc tune=zerolatency "
+        "key-int-max=30 ! rtph265pay config-interval=-1 pt=96"},
+  {"VP8", "videotestsrc is-live=true ! vp8enc deadline=1 "
+        "keyframe-max-dist=30 ! rtpvp8pay pt=96"},
+  {"VP9", "videotestsrc is-live=true ! vp9enc deadline=1 "
+        "keyframe-max-dist=30 ! rtpvp9pay pt=96"},
+  {"OPUS", "audiotestsrc is-live=true ! opusenc ! rtpopuspay pt=96"},
+  {"MP2T", "videotestsrc is-live=true ! x264enc tune=zerolatency "
+        "key-int-max=30 ! mpegtsmux ! rtpmp2tpay pt=96"},
+};
+
+#define RECEIVER "rtpsrc uri=%s ! decodebin ! fakesink name=sink " \
+  "sync=false signal-handoffs=true"
+
+typedef struct
+{
+  GMainLoop *loop;
+  gint64 first;
+} Run;
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  Run *run = user_data;
+
+  if (run->first == 0) {
+    run->first = g_get_monotonic_time ();
+    g_main_loop_quit (run->loop);
+  }
+}
+
+static gboolean
+quit_cb (gpointer user_data)
+{
+  g_main_loop_quit (user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Returns: time to the first frame in us, -1 on failure or -2 when the
+ * encoder of the stream is not installed */
+static gint64
+run (const Stream * stream, gboolean labelled, guint port)
+{
+  GstElement *sender, *receiver, *sink;
+  GError *error = NULL;
+  Run r = { NULL, 0 };
+  gint64 start;
+  gchar *uri, *desc;
+  guint timeout;
+
+  uri = labelled ?
+      g_strdup_printf ("rtp://127.0.0.1:%u?encoding-name=%s", port,
+      stream->encoding_name) : g_strdup_printf ("rtp://127.0.0.1:%u", port);
+  desc = g_strdup_printf (RECEIVER, uri);
+  g_free (uri);
+  receiver = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!receiver) {
+    g_printerr ("%s: %s\n", stream->encoding_name, error->message);
+    g_clear_error (&error);
+    return -1;
+  }
+
+  desc = g_strdup_printf ("%s ! udpsink host=127.0.0.1 port=%u",
+      stream->sender, port);
+  sender = gst_parse_launch (desc, &error);
+  g_free (desc);
+  if (!sender || error) {
+    gint64 ret = g_error_matches (error, GST_PARSE_ERROR,
+        GST_PARSE_ERROR_NO_SUCH_ELEMENT) ? -2 : -1;
+
+    g_printerr ("%s: %s\n", stream->encoding_name, error->message);
+    g_clear_error (&error);
+    if (sender)
+      gst_object_unref (sender);
+    gst_object_unref (receiver);
+    return ret;
+  }
+
+  /* start sending first: the receiver joins a running stream */
+  gst_element_set_state (sender, GST_STATE_PLAYING);
+  g_usleep (G_USEC_PER_SEC / 2);
+
+  sink = gst_bin_get_by_name (GST_BIN (receiver), "sink");
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), &r);
+  gst_object_unref (sink);
+
+  r.loop = g_main_loop_new (NULL, FALSE);
+  timeout = g_timeout_add_seconds (10, quit_cb, r.loop);
+
+  start = g_get_monotonic_time ();
+  gst_element_set_state (receiver, GST_STATE_PLAYING);
+  g_main_loop_run (r.loop);
+  if (r.first)
+    g_source_remove (timeout);
+  gst_element_set_state (receiver, GST_STATE_NULL);
+  gst_element_set_state (sender, GST_STATE_NULL);
+
+  g_main_loop_unref (r.loop);
+  gst_object_unref (sender);
+  gst_object_unref (receiver);
+
+  return r.first ? r.first - start : -1;
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint runs = 5, i, n, port = 5304;
+  gboolean ret = TRUE;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    runs = atoi (argv[1]);
+
+  g_print ("%-6s %12s %12s\n", "", "labelled", "sniffed");
+  for (i = 0; i < G_N_ELEMENTS (streams); i++) {
+    gint64 t[2] = { 0, 0 }, us;
+    guint ok[2] = { 0, 0 }, l;
+    gboolean skipped = FALSE;
+
+    for (n = 0; n < runs && !skipped; n++) {
+      for (l = 0; l < 2 && !skipped; l++) {
+        us = run (&streams[i], l == 0, port);
+        port += 2;
+        if (us >= 0) {
+          t[l] += us;
+          ok[l]++;
+        }
+        skipped = us == -2;
+      }
+    }
+
+    if (skipped) {
+      g_print ("%-6s %12s %12s\n", streams[i].encoding_name, "n/a", "n/a");
+      continue;
+    }
+
+    g_print ("%-6s %9.1f ms %9.1f ms\n", streams[i].encoding_name,
+        ok[0] ? t[0] / 1000.0 / ok[0] : -1.0,
+        ok[1] ? t[1] / 1000.0 / ok[1] : -1.0);
+    ret &= ok[0] == runs && ok[1] == runs;
+  }
+
+  return ret ? 0 : 1;
+}
@@ -1,4 +1,6 @@
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gio/gio.h>
 
 GST_START_TEST (test_pads)
 {
@@ -12,6 +14,1048 @@ GST_START_TEST (test_pads)
 
 GST_END_TEST;
 
+static GstBuffer *
+create_rtp (guint16 seq, guint32 ts, guint8 fill, gsize len)
+{
+  GstBuffer *buffer;
+  guint8 *data;
+
+  data = g_malloc (12 + len);
+  data[0] = 0x80;
+  data[1] = 96;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, ts);
+  GST_WRITE_UINT32_BE (data + 8, 0x12345678);
+  memset (data + 12, fill, len);
+  buffer = gst_buffer_new_wrapped (data, 12 + len);
+
+  return buffer;
+}
+
+static guint16
+get_seq (GstBuffer * buffer)
+{
+  guint8 header[4];
+
+  gst_buffer_extract (buffer, 0, header, 4);
+  return GST_READ_UINT16_BE (header + 2);
+}
+
+GST_START_TEST (test_fec_recovery)
+{
+  GstHarness *enc, *enc_fec, *dec, *dec_fec;
+  GstBuffer *media[8], *buffer;
+  guint64 recovered = 0;
+  GstMapInfo map;
+  guint i;
+
+  enc = gst_harness_new ("barcortpfecenc");
+  gst_util_set_object_arg (G_OBJECT (enc->element), "mode", "flexfec");
+  g_object_set (enc->element, "columns", 4, "rows", 0, "row", TRUE, NULL);
+  enc_fec = gst_harness_new_with_element (enc->element, NULL, "fec_1");
+  gst_harness_set_src_caps_str (enc, "application/x-rtp");
+
+  dec = gst_harness_new ("barcortpfecdec");
+  gst_util_set_object_arg (G_OBJECT (dec->element), "mode", "flexfec");
+  dec_fec = gst_harness_new_with_element (dec->element, "fec_1", NULL);
+  gst_harness_set_src_caps_str (dec, "application/x-rtp");
+  gst_harness_set_src_caps_str (dec_fec, "application/x-rtp");
+
+  /* two rows of four packets, each protected by a row FEC packet */
+  for (i = 0; i < 8; i++) {
+    fail_unless_equals_int (gst_harness_push (enc, create_rtp (i, i * 3000,
+                i, 100 + i)), GST_FLOW_OK);
+    media[i] = gst_harness_pull (enc);
+  }
+  fail_unless_equals_int (gst_harness_buffers_received (enc_fec), 2);
+
+  /* lose the third packet on the way */
+  for (i = 0; i < 8; i++)
+    if (i != 2)
+      fail_unless_equals_int (gst_harness_push (dec,
+              gst_buffer_ref (media[i])), GST_FLOW_OK);
+  for (i = 0; i < 2; i++)
+    fail_unless_equals_int (gst_harness_push (dec_fec,
+            gst_harness_pull (enc_fec)), GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_harness_buffers_received (dec), 8);
+  for (i = 0; i < 7; i++)
+    gst_buffer_unref (gst_harness_pull (dec));
+  buffer = gst_harness_pull (dec);
+  fail_unless_equals_int (get_seq (buffer), 2);
+  fail_unless_equals_int (gst_buffer_get_size (buffer),
+      gst_buffer_get_size (media[2]));
+  gst_buffer_map (media[2], &map, GST_MAP_READ);
+  fail_unless (gst_buffer_memcmp (buffer, 12, map.data + 12,
+          map.size - 12) == 0);
+  gst_buffer_unmap (media[2], &map);
+  gst_buffer_unref (buffer);
+
+  g_object_get (dec->element, "recovered", &recovered, NULL);
+  fail_unless_equals_uint64 (recovered, 1);
+
+  for (i = 0; i < 8; i++)
+    gst_buffer_unref (media[i]);
+  gst_harness_teardown (dec_fec);
+  gst_harness_teardown (dec);
+  gst_harness_teardown (enc_fec);
+  gst_harness_teardown (enc);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fec_column_interleave)
+{
+  GstHarness *enc, *enc_fec;
+  GstBuffer *buffer;
+  guint i;
+
+  enc = gst_harness_new ("barcortpfecenc");
+  gst_util_set_object_arg (G_OBJECT (enc->element), "mode", "smpte-2022-1");
+  g_object_set (enc->element, "columns", 4, "rows", 2, "row", FALSE, NULL);
+  enc_fec = gst_harness_new_with_element (enc->element, NULL, "fec_0");
+  gst_harness_set_src_caps_str (enc, "application/x-rtp, payload=96");
+
+  /* the column FEC of the first matrix waits for the second one */
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (gst_harness_push (enc, create_rtp (i, i * 3000,
+                i, 100)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (enc_fec), 0);
+
+  /* and goes out one packet every D = 2 media packets */
+  for (i = 8; i < 16; i++) {
+    fail_unless_equals_int (gst_harness_push (enc, create_rtp (i, i * 3000,
+                i, 100)), GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_buffers_received (enc_fec),
+        (i - 7) / 2);
+  }
+  for (i = 0; i < 4; i++) {
+    buffer = gst_harness_pull (enc_fec);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 12 + 16 + 100);
+    gst_buffer_unref (buffer);
+  }
+
+  /* the second matrix is protected on EOS */
+  fail_unless (gst_harness_push_event (enc, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_received (enc_fec), 8);
+
+  gst_harness_teardown (enc_fec);
+  gst_harness_teardown (enc);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fec_pt_clash)
+{
+  GstHarness *enc, *enc_fec;
+  guint i;
+
+  enc = gst_harness_new ("barcortpfecenc");
+  g_object_set (enc->element, "columns", 4, "rows", 0, "row", TRUE,
+      "pt", 96, NULL);
+  enc_fec = gst_harness_new_with_element (enc->element, NULL, "fec_1");
+  gst_harness_set_src_caps_str (enc, "application/x-rtp, payload=96");
+
+  /* the media goes on without FEC */
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (gst_harness_push (enc, create_rtp (i, i * 3000,
+                i, 100)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (enc), 8);
+  fail_unless_equals_int (gst_harness_buffers_received (enc_fec), 0);
+
+  gst_harness_teardown (enc_fec);
+  gst_harness_teardown (enc);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_redundant_merge)
+{
+  GstHarness *h0, *h1;
+  guint64 duplicates = 0, lost = 0;
+  guint16 expected[] = { 0, 1, 2, 4, 5 };
+  guint i;
+
+  h0 = gst_harness_new_with_padnames ("barcortpmerge", "sink_0", "src");
+  h1 = gst_harness_new_with_element (h0->element, "sink_1", NULL);
+  g_object_set (h0->element, "max-skew", 10, NULL);
+  gst_harness_set_src_caps_str (h0, "application/x-rtp");
+  gst_harness_set_src_caps_str (h1, "application/x-rtp");
+
+  /* the same packet on both paths goes out once */
+  fail_unless_equals_int (gst_harness_push (h0, create_rtp (0, 0, 0, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h1, create_rtp (0, 0, 0, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h0), 1);
+
+  /* a gap on one path is filled by the other, in order */
+  fail_unless_equals_int (gst_harness_push (h1, create_rtp (2, 0, 2, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h0), 1);
+  fail_unless_equals_int (gst_harness_push (h0, create_rtp (1, 0, 1, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h0, create_rtp (2, 0, 2, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h0), 3);
+
+  /* a packet lost on both paths is skipped after max-skew, also when
+   * nothing else arrives */
+  fail_unless_equals_int (gst_harness_push (h0, create_rtp (4, 0, 4, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h0), 3);
+  g_usleep (50 * G_TIME_SPAN_MILLISECOND);
+  fail_unless_equals_int (gst_harness_buffers_received (h0), 4);
+  fail_unless_equals_int (gst_harness_push (h1, create_rtp (5, 0, 5, 100)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h0), 5);
+
+  for (i = 0; i < G_N_ELEMENTS (expected); i++) {
+    GstBuffer *buffer = gst_harness_pull (h0);
+
+    fail_unless_equals_int (get_seq (buffer), expected[i]);
+    gst_buffer_unref (buffer);
+  }
+
+  g_object_get (h0->element, "duplicates", &duplicates, "lost", &lost, NULL);
+  fail_unless_equals_uint64 (duplicates, 2);
+  fail_unless_equals_uint64 (lost, 1);
+
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h0);
+}
+
+GST_END_TEST;
+
+static guint
+count_events (GstHarness * h, GstEventType type)
+{
+  GstEvent *event;
+  guint n = 0;
+
+  while ((event = gst_harness_try_pull_event (h))) {
+    if (GST_EVENT_TYPE (event) == type)
+      n++;
+    gst_event_unref (event);
+  }
+
+  return n;
+}
+
+GST_START_TEST (test_redundant_merge_events)
+{
+  GstHarness *h0, *h1;
+  GstSegment segment;
+
+  h0 = gst_harness_new_with_padnames ("barcortpmerge", "sink_0", "src");
+  h1 = gst_harness_new_with_element (h0->element, "sink_1", NULL);
+  gst_harness_set_src_caps_str (h0, "application/x-rtp, payload=96");
+  gst_harness_set_src_caps_str (h1, "application/x-rtp, payload=96");
+
+  /* the start of the second path changes nothing */
+  fail_unless_equals_int (count_events (h0, GST_EVENT_CAPS), 1);
+
+  /* a change is forwarded once, from whichever path is first */
+  fail_unless (gst_harness_push_event (h1, gst_event_new_caps
+          (gst_caps_from_string ("application/x-rtp, payload=97"))));
+  fail_unless (gst_harness_push_event (h0, gst_event_new_caps
+          (gst_caps_from_string ("application/x-rtp, payload=97"))));
+  fail_unless_equals_int (count_events (h0, GST_EVENT_CAPS), 1);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.base = GST_SECOND;
+  fail_unless (gst_harness_push_event (h0, gst_event_new_segment (&segment)));
+  fail_unless (gst_harness_push_event (h1, gst_event_new_segment (&segment)));
+  fail_unless_equals_int (count_events (h0, GST_EVENT_SEGMENT), 1);
+
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_keyframe_request)
+{
+  GstElement *element;
+  guint interval = 0, retries = 0;
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_set (element,
+      "uri", "rtp://239.1.2.3:4321?keyframe-request-interval=250", NULL);
+
+  g_object_get (element, "keyframe-request-interval", &interval,
+      "keyframe-request-retries", &retries, NULL);
+  fail_unless_equals_int (interval, 250);
+  fail_unless (retries > 0);
+
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_capture_iface)
+{
+  GstElement *element;
+  gchar *iface = NULL;
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_get (element, "capture-iface", &iface, NULL);
+  fail_unless (iface == NULL);
+
+  g_object_set (element, "uri", "rtp://239.1.2.3:4321?capture-iface=lo", NULL);
+  g_object_get (element, "capture-iface", &iface, NULL);
+  fail_unless_equals_string (iface, "lo");
+  g_free (iface);
+
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mp2t_latency)
+{
+  GstElement *element;
+  guint latency = 1;
+  guint64 cc_errors = 1;
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_get (element, "mp2t-latency", &latency, "cc-errors", &cc_errors,
+      NULL);
+  fail_unless_equals_int (latency, 0);
+  fail_unless_equals_uint64 (cc_errors, 0);
+
+  g_object_set (element, "uri",
+      "rtp://239.1.2.3:4321?encoding-name=MP2T&mp2t-latency=40", NULL);
+  g_object_get (element, "mp2t-latency", &latency, NULL);
+  fail_unless_equals_int (latency, 40);
+
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+/* an RTP packet of 7 TS packets on PID 100 with continuity counters
+ * from cc on */
+static GstBuffer *
+create_mp2t (guint16 seq, guint32 ssrc, guint8 cc)
+{
+  GstBuffer *buffer;
+  guint8 *data, *ts;
+  guint i;
+
+  data = g_malloc (12 + 7 * 188);
+  data[0] = 0x80;
+  data[1] = 33;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, seq * 3000);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+  for (i = 0; i < 7; i++) {
+    ts = data + 12 + i * 188;
+    memset (ts, 0xff, 188);
+    ts[0] = 0x47;
+    ts[1] = 0x00;
+    ts[2] = 100;
+    ts[3] = 0x10 | ((cc + i) & 0x0f);
+  }
+  buffer = gst_buffer_new_wrapped (data, 12 + 7 * 188);
+
+  return buffer;
+}
+
+GST_START_TEST (test_mp2t_resync)
+{
+  GstHarness *h;
+  guint64 cc_errors = 1;
+
+  h = gst_harness_new ("barcortpmp2t");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (1000, 1, 0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (1001, 1, 7)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 14);
+
+  /* a late packet is dropped */
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (990, 1, 14)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 14);
+
+  /* a restarted sender is followed, with new continuity counters */
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (10, 1, 3)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (11, 1, 10)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 28);
+
+  /* so is a new sender */
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (5, 2, 0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 35);
+
+  g_object_get (h->element, "cc-errors", &cc_errors, NULL);
+  fail_unless_equals_uint64 (cc_errors, 0);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mp2t_cc_errors)
+{
+  GstHarness *h;
+  GstBuffer *buffer;
+  guint64 cc_errors = 0;
+
+  h = gst_harness_new ("barcortpmp2t");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (0, 1, 0)),
+      GST_FLOW_OK);
+  /* the TS packets between 7 and 9 were lost in the sender */
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (1, 1, 10)),
+      GST_FLOW_OK);
+  g_object_get (h->element, "cc-errors", &cc_errors, NULL);
+  fail_unless_equals_uint64 (cc_errors, 1);
+
+  /* a repeated TS packet keeps the counter */
+  fail_unless_equals_int (gst_harness_push (h, create_mp2t (2, 1, 16)),
+      GST_FLOW_OK);
+  g_object_get (h->element, "cc-errors", &cc_errors, NULL);
+  fail_unless_equals_uint64 (cc_errors, 1);
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), 21);
+  buffer = gst_harness_pull (h);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 188);
+  gst_buffer_unref (buffer);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstElement *
+find_rtpbin (GstElement * rtpsrc)
+{
+  GstElement *rtpbin = NULL;
+  GstIterator *it;
+  GValue data = { 0, };
+
+  it = gst_bin_iterate_elements (GST_BIN (rtpsrc));
+  while (!rtpbin && gst_iterator_next (it, &data) == GST_ITERATOR_OK) {
+    GstElement *element = g_value_get_object (&data);
+    GstElementFactory *factory = gst_element_get_factory (element);
+
+    if (factory && g_strcmp0 (GST_OBJECT_NAME (factory), "rtpbin") == 0)
+      rtpbin = gst_object_ref (element);
+    g_value_unset (&data);
+  }
+  gst_iterator_free (it);
+
+  return rtpbin;
+}
+
+GST_START_TEST (test_sdp)
+{
+  GstElement *element, *rtpbin;
+  GstStructure *s;
+  GstCaps *caps = NULL;
+  gchar *uri = NULL;
+  gint clock_rate = 0;
+  static const gchar *text = "v=0\r\n"
+      "o=- 0 0 IN IP4 127.0.0.1\r\n"
+      "s=test\r\n"
+      "c=IN IP4 127.0.0.1\r\n"
+      "t=0 0\r\n"
+      "m=video 5004 RTP/AVP 96\r\n"
+      "a=rtpmap:96 H264/90000\r\n"
+      "a=fmtp:96 packetization-mode=1;sprop-parameter-sets=Z0LAHtkDxWhAAAADAEAAAAwDxYuS,aMuMsg==\r\n";
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_set (element, "sdp", text, NULL);
+  fail_unless_equals_int (gst_element_set_state (element, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* the address comes from the SDP when the uri has none */
+  g_object_get (element, "uri", &uri, NULL);
+  fail_unless_equals_string (uri, "rtp://127.0.0.1:5004");
+  g_free (uri);
+
+  /* rtpbin gets the caps of the SDP for its payload type */
+  rtpbin = find_rtpbin (element);
+  fail_unless (rtpbin != NULL);
+  g_signal_emit_by_name (rtpbin, "request-pt-map", 0, 96, &caps);
+  fail_unless (caps != NULL);
+  s = gst_caps_get_structure (caps, 0);
+  fail_unless_equals_string (gst_structure_get_string (s, "encoding-name"),
+      "H264");
+  fail_unless (gst_structure_get_int (s, "clock-rate", &clock_rate));
+  fail_unless_equals_int (clock_rate, 90000);
+  fail_unless_equals_string (gst_structure_get_string (s,
+          "sprop-parameter-sets"), "Z0LAHtkDxWhAAAADAEAAAAwDxYuS,aMuMsg==");
+  gst_caps_unref (caps);
+  gst_object_unref (rtpbin);
+
+  gst_element_set_state (element, GST_STATE_NULL);
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+/* the only element of the bin of an auxiliary sender or receiver */
+static GstElement *
+aux_element (GstElement * bin)
+{
+  GstElement *element = NULL;
+  GstIterator *it = gst_bin_iterate_elements (GST_BIN (bin));
+  GValue data = { 0, };
+
+  if (gst_iterator_next (it, &data) == GST_ITERATOR_OK) {
+    element = gst_object_ref (g_value_get_object (&data));
+    g_value_unset (&data);
+  }
+  gst_iterator_free (it);
+
+  return element;
+}
+
+static guint
+pt_map_get (GstElement * element, const gchar * pt)
+{
+  GstStructure *pt_map = NULL;
+  guint mapped = 0;
+
+  g_object_get (element, "payload-type-map", &pt_map, NULL);
+  fail_unless (pt_map != NULL);
+  gst_structure_get_uint (pt_map, pt, &mapped);
+  gst_structure_free (pt_map);
+
+  return mapped;
+}
+
+static GstEvent *
+create_rtx_request (guint seqnum)
+{
+  return gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstRTPRetransmissionRequest",
+          "seqnum", G_TYPE_UINT, seqnum,
+          "ssrc", G_TYPE_UINT, 0x12345678, NULL));
+}
+
+GST_START_TEST (test_rtx_recovery)
+{
+  GstElement *rtpsink, *rtpsrc, *rtpbin, *send_bin = NULL, *recv_bin = NULL;
+  GstElement *rtx;
+  GstHarness *send, *recv;
+  GstBuffer *media[10], *buffer;
+  GstCaps *caps = NULL;
+  guint8 header[12];
+  GstMapInfo map;
+  guint i;
+
+  /* the retransmission sender of rtpsink */
+  rtpsink = gst_element_factory_make ("rtpsink", NULL);
+  g_object_set (rtpsink, "uri", "rtp://127.0.0.1:5150", "rtx-pt", 97, NULL);
+  rtpbin = find_rtpbin (rtpsink);
+  fail_unless (rtpbin != NULL);
+  g_signal_emit_by_name (rtpbin, "request-aux-sender", 0, &send_bin);
+  gst_object_unref (rtpbin);
+  if (send_bin == NULL) {
+    /* no rtprtxsend */
+    gst_object_unref (rtpsink);
+    return;
+  }
+
+  /* and the receiver of rtpsrc */
+  rtpsrc = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_set (rtpsrc, "uri", "rtp://127.0.0.1:5150", "encoding-name",
+      "H264", "rtx-pt", 97, NULL);
+  fail_unless_equals_int (gst_element_set_state (rtpsrc, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+  rtpbin = find_rtpbin (rtpsrc);
+  fail_unless (rtpbin != NULL);
+  g_signal_emit_by_name (rtpbin, "request-aux-receiver", 0, &recv_bin);
+  fail_unless (recv_bin != NULL);
+
+  /* every payload type gets its own retransmission payload type */
+  send = gst_harness_new_with_element (send_bin, "sink_0", "src_0");
+  gst_harness_set_src_caps_str (send, "application/x-rtp, media=video, "
+      "clock-rate=90000, encoding-name=H264, payload=98");
+  gst_harness_set_src_caps_str (send, "application/x-rtp, media=video, "
+      "clock-rate=90000, encoding-name=H264, payload=96");
+  rtx = aux_element (send_bin);
+  fail_unless_equals_int (pt_map_get (rtx, "96"), 97);
+  fail_unless_equals_int (pt_map_get (rtx, "98"), 99);
+  gst_object_unref (rtx);
+
+  g_signal_emit_by_name (rtpbin, "request-pt-map", 0, 98, &caps);
+  gst_caps_unref (caps);
+  g_signal_emit_by_name (rtpbin, "request-pt-map", 0, 96, &caps);
+  gst_caps_unref (caps);
+  g_signal_emit_by_name (rtpbin, "request-pt-map", 0, 99, &caps);
+  fail_unless_equals_string (gst_structure_get_string
+      (gst_caps_get_structure (caps, 0), "encoding-name"), "RTX");
+  gst_caps_unref (caps);
+  gst_object_unref (rtpbin);
+  rtx = aux_element (recv_bin);
+  fail_unless_equals_int (pt_map_get (rtx, "97"), 96);
+  fail_unless_equals_int (pt_map_get (rtx, "99"), 98);
+  gst_object_unref (rtx);
+
+  for (i = 0; i < 10; i++) {
+    fail_unless_equals_int (gst_harness_push (send, create_rtp (i, i * 3000,
+                i, 100 + i)), GST_FLOW_OK);
+    media[i] = gst_harness_pull (send);
+  }
+
+  /* the fifth packet is lost and NACKed */
+  recv = gst_harness_new_with_element (recv_bin, "sink_0", "src_0");
+  gst_harness_set_src_caps_str (recv, "application/x-rtp, media=video, "
+      "clock-rate=90000, encoding-name=H264, payload=96");
+  for (i = 0; i < 10; i++) {
+    if (i == 5)
+      continue;
+    fail_unless_equals_int (gst_harness_push (recv,
+            gst_buffer_ref (media[i])), GST_FLOW_OK);
+    gst_buffer_unref (gst_harness_pull (recv));
+  }
+  fail_unless (gst_harness_push_upstream_event (recv, create_rtx_request (5)));
+  fail_unless (gst_harness_push_upstream_event (send, create_rtx_request (5)));
+
+  buffer = gst_harness_pull (send);
+  fail_unless (buffer != NULL);
+  gst_buffer_extract (buffer, 0, header, sizeof (header));
+  fail_unless_equals_int (header[1] & 0x7f, 97);
+  fail_unless_equals_int (gst_harness_push (recv, buffer), GST_FLOW_OK);
+
+  /* it comes out as the original packet */
+  buffer = gst_harness_pull (recv);
+  fail_unless (buffer != NULL);
+  fail_unless_equals_int (get_seq (buffer), 5);
+  fail_unless_equals_int (gst_buffer_get_size (buffer),
+      gst_buffer_get_size (media[5]));
+  gst_buffer_extract (buffer, 0, header, sizeof (header));
+  fail_unless_equals_int (header[1] & 0x7f, 96);
+  fail_unless_equals_int (GST_READ_UINT32_BE (header + 8), 0x12345678);
+  gst_buffer_map (media[5], &map, GST_MAP_READ);
+  fail_unless (gst_buffer_memcmp (buffer, 12, map.data + 12,
+          map.size - 12) == 0);
+  gst_buffer_unmap (media[5], &map);
+  gst_buffer_unref (buffer);
+
+  for (i = 0; i < 10; i++)
+    gst_buffer_unref (media[i]);
+  gst_harness_teardown (recv);
+  gst_harness_teardown (send);
+  gst_object_unref (recv_bin);
+  gst_object_unref (send_bin);
+  gst_element_set_state (rtpsrc, GST_STATE_NULL);
+  gst_object_unref (rtpsrc);
+  gst_object_unref (rtpsink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_kernel_timestamps)
+{
+  GstElement *element;
+  gboolean kernel_timestamps = TRUE;
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_get (element, "kernel-timestamps", &kernel_timestamps, NULL);
+  fail_unless (!kernel_timestamps);
+
+  g_object_set (element, "uri",
+      "rtp://239.1.2.3:4321?kernel-timestamps=true", NULL);
+  g_object_get (element, "kernel-timestamps", &kernel_timestamps, NULL);
+  fail_unless (kernel_timestamps);
+
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_buffer_size)
+{
+  GstElement *element;
+  guint buffer_size = 1;
+  guint64 drops = 1;
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_get (element, "buffer-size", &buffer_size, "drops", &drops, NULL);
+  fail_unless_equals_int (buffer_size, 0);
+  fail_unless_equals_uint64 (drops, 0);
+
+  g_object_set (element, "uri", "rtp://239.1.2.3:4321?buffer-size=2097152",
+      NULL);
+  g_object_get (element, "buffer-size", &buffer_size, NULL);
+  fail_unless_equals_int (buffer_size, 2097152);
+
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+/* a receiver of loopback RTP with a fakesink on every pad */
+static void
+pad_added_cb (GstElement * element, GstPad * pad, GstElement * pipeline)
+{
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+  GstPad *sinkpad = gst_element_get_static_pad (sink, "sink");
+
+  g_object_set (sink, "async", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  gst_element_sync_state_with_parent (sink);
+  fail_unless_equals_int (gst_pad_link (pad, sinkpad), GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+}
+
+static GstElement *
+create_receiver (const gchar * uri, GstElement ** rtpsrc)
+{
+  GstElement *pipeline = gst_pipeline_new (NULL);
+
+  *rtpsrc = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_set (*rtpsrc, "uri", uri, NULL);
+  gst_bin_add (GST_BIN (pipeline), *rtpsrc);
+  g_signal_connect (*rtpsrc, "pad-added", G_CALLBACK (pad_added_cb),
+      pipeline);
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+
+  return pipeline;
+}
+
+static void
+send_to (GSocket * socket, guint port, const guint8 * data, gsize size)
+{
+  GInetAddress *addr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  GSocketAddress *sa = g_inet_socket_address_new (addr, port);
+
+  fail_unless_equals_int (g_socket_send_to (socket, sa, (const gchar *) data,
+          size, NULL, NULL), size);
+  g_object_unref (sa);
+  g_object_unref (addr);
+}
+
+/* an RTP packet of pt 96, a keyframe of H264 when key is set */
+static void
+send_rtp (GSocket * socket, guint port, guint32 ssrc, guint16 seq,
+    gboolean key)
+{
+  guint8 data[112] = { 0, };
+
+  data[0] = 0x80;
+  data[1] = 96;
+  GST_WRITE_UINT16_BE (data + 2, seq);
+  GST_WRITE_UINT32_BE (data + 4, seq * 3000);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+  /* an IDR or a non-IDR slice NAL unit */
+  data[12] = key ? 0x65 : 0x41;
+  send_to (socket, port, data, sizeof (data));
+}
+
+/* an RR followed by a BYE of ssrc, on the RTCP port */
+static void
+send_bye (GSocket * socket, guint port, guint32 ssrc)
+{
+  guint8 data[16];
+
+  data[0] = 0x80;
+  data[1] = 201;
+  GST_WRITE_UINT16_BE (data + 2, 1);
+  GST_WRITE_UINT32_BE (data + 4, ssrc);
+  data[8] = 0x81;
+  data[9] = 203;
+  GST_WRITE_UINT16_BE (data + 10, 1);
+  GST_WRITE_UINT32_BE (data + 12, ssrc);
+  send_to (socket, port + 1, data, sizeof (data));
+}
+
+/* wait for the stats to have n streams, returns their SSRCs OR-ed */
+static guint32
+wait_streams (GstElement * rtpsrc, guint n)
+{
+  const GValue *streams;
+  GstStructure *stats;
+  guint32 ssrcs = 0;
+  guint i, ssrc, tries;
+
+  for (tries = 0; tries < 500; tries++) {
+    g_object_get (rtpsrc, "stats", &stats, NULL);
+    streams = gst_structure_get_value (stats, "streams");
+    if (gst_value_array_get_size (streams) == n) {
+      for (i = 0; i < n; i++) {
+        gst_structure_get_uint (gst_value_get_structure
+            (gst_value_array_get_value (streams, i)), "ssrc", &ssrc);
+        ssrcs |= ssrc;
+      }
+      gst_structure_free (stats);
+      return ssrcs;
+    }
+    gst_structure_free (stats);
+    g_usleep (10 * G_TIME_SPAN_MILLISECOND);
+  }
+  fail ("no %u streams in the stats", n);
+
+  return 0;
+}
+
+GST_START_TEST (test_stats)
+{
+  GstElement *element;
+  GstStructure *stats;
+  guint interval = 1;
+  guint64 drops = 1;
+
+  element = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_set (element, "uri", "rtp://239.1.2.3:4321?stats-interval=1000",
+      NULL);
+  g_object_get (element, "stats-interval", &interval, "stats", &stats, NULL);
+  fail_unless_equals_int (interval, 1000);
+  fail_unless (gst_structure_has_name (stats, "GstRtpSrcStats"));
+  fail_unless (gst_structure_get_uint64 (stats, "drops", &drops));
+  fail_unless_equals_uint64 (drops, 0);
+  fail_unless_equals_int (gst_value_array_get_size (gst_structure_get_value
+          (stats, "streams")), 0);
+  gst_structure_free (stats);
+
+  gst_object_unref (element);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stats_ssrc_churn)
+{
+  GstElement *pipeline, *rtpsrc;
+  GSocket *socket;
+  guint32 ssrcs;
+  guint i, seq;
+
+  pipeline = create_receiver ("rtp://127.0.0.1:5110?encoding-name=H264",
+      &rtpsrc);
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+
+  /* twelve senders, one bit each */
+  for (seq = 0; seq < 10; seq++)
+    for (i = 0; i < 12; i++)
+      send_rtp (socket, 5110, 1 << i, seq, seq == 0);
+  fail_unless_equals_int (wait_streams (rtpsrc, 12), 0xfff);
+
+  /* half of them leave, as many new ones come */
+  for (i = 0; i < 6; i++)
+    send_bye (socket, 5110, 1 << i);
+  fail_unless_equals_int (wait_streams (rtpsrc, 6), 0xfc0);
+  for (seq = 0; seq < 10; seq++)
+    for (i = 12; i < 18; i++)
+      send_rtp (socket, 5110, 1 << i, seq, seq == 0);
+  fail_unless_equals_int (wait_streams (rtpsrc, 12), 0x3ffc0);
+
+  g_object_unref (socket);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* the sequence numbers and NAL types going out of the pads of rtpsrc */
+typedef struct
+{
+  GMutex lock;
+  gint pads;
+  GArray *seqs;
+  GArray *nals;
+} Received;
+
+static GstPadProbeReturn
+received_probe (GstPad * pad, GstPadProbeInfo * info, Received * received)
+{
+  guint8 header[13];
+  guint16 seq;
+
+  if (gst_buffer_extract (GST_PAD_PROBE_INFO_BUFFER (info), 0, header,
+          sizeof (header)) == sizeof (header)) {
+    seq = GST_READ_UINT16_BE (header + 2);
+    g_mutex_lock (&received->lock);
+    g_array_append_val (received->seqs, seq);
+    g_array_append_val (received->nals, header[12]);
+    g_mutex_unlock (&received->lock);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+received_pad_added_cb (GstElement * element, GstPad * pad,
+    Received * received)
+{
+  g_atomic_int_inc (&received->pads);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) received_probe, received, NULL);
+}
+
+static guint
+wait_received (Received * received, guint n)
+{
+  guint tries, len = 0;
+
+  for (tries = 0; tries < 500 && len < n; tries++) {
+    g_usleep (10 * G_TIME_SPAN_MILLISECOND);
+    g_mutex_lock (&received->lock);
+    len = received->seqs->len;
+    g_mutex_unlock (&received->lock);
+  }
+
+  return len;
+}
+
+GST_START_TEST (test_ssrc_switch)
+{
+  GstPluginFeature *feature;
+  GstElement *pipeline, *rtpsrc;
+  Received received = { {0,}, 0, NULL, NULL };
+  GSocket *socket;
+  guint i, seq;
+
+  /* ssrc-change needs rtpheaderchange */
+  feature = gst_registry_lookup_feature (gst_registry_get (),
+      "rtpheaderchange");
+  if (feature == NULL)
+    return;
+  gst_object_unref (feature);
+
+  g_mutex_init (&received.lock);
+  received.seqs = g_array_new (FALSE, FALSE, sizeof (guint16));
+  received.nals = g_array_new (FALSE, FALSE, sizeof (guint8));
+
+  pipeline = create_receiver
+      ("rtp://127.0.0.1:5120?encoding-name=H264&ssrc-change=1234", &rtpsrc);
+  g_signal_connect (rtpsrc, "pad-added", G_CALLBACK (received_pad_added_cb),
+      &received);
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+
+  for (seq = 0; seq < 20; seq++)
+    send_rtp (socket, 5120, 0x1111, seq, seq == 0);
+  fail_unless_equals_int (wait_received (&received, 20), 20);
+
+  /* the new sender starts between two keyframes */
+  for (seq = 20; seq < 40; seq++)
+    send_rtp (socket, 5120, 0x2222, seq, seq == 25);
+  wait_received (&received, 35);
+
+  g_object_unref (socket);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  /* one pad, the old stream then the new one from its keyframe on */
+  fail_unless_equals_int (received.pads, 1);
+  fail_unless_equals_int (received.seqs->len, 35);
+  for (i = 0; i < received.seqs->len; i++)
+    fail_unless_equals_int (g_array_index (received.seqs, guint16, i),
+        i < 20 ? i : i + 5);
+  fail_unless_equals_int (g_array_index (received.nals, guint8, 20), 0x65);
+
+  g_array_unref (received.seqs);
+  g_array_unref (received.nals);
+  g_mutex_clear (&received.lock);
+}
+
+GST_END_TEST;
+
+static void
+count_pad_cb (GstElement * element, GstPad * pad, gint * count)
+{
+  g_atomic_int_inc (count);
+}
+
+/* wait for count to reach n, sending packets of each of the SSRCs in
+ * keep meanwhile so they do not time out */
+static gint
+wait_count (gint * count, gint n, GSocket * socket, guint port, guint32 keep)
+{
+  static guint seq = 100;
+  guint tries, i;
+
+  for (tries = 0; tries < 1000 && g_atomic_int_get (count) < n; tries++) {
+    for (i = 0; i < 32; i++)
+      if (keep & (1 << i))
+        send_rtp (socket, port, 1 << i, seq, FALSE);
+    seq++;
+    g_usleep (10 * G_TIME_SPAN_MILLISECOND);
+  }
+
+  return g_atomic_int_get (count);
+}
+
+GST_START_TEST (test_ssrc_pads)
+{
+  GstElement *pipeline, *rtpsrc, *rtpbin;
+  GObject *session = NULL;
+  GSocket *socket;
+  gint added = 0, removed = 0;
+  guint i, seq;
+
+  pipeline = create_receiver ("rtp://127.0.0.1:5130?encoding-name=H264",
+      &rtpsrc);
+  g_signal_connect (rtpsrc, "pad-added", G_CALLBACK (count_pad_cb), &added);
+  g_signal_connect (rtpsrc, "pad-removed", G_CALLBACK (count_pad_cb),
+      &removed);
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+
+  /* time the silent sources out in about a second */
+  rtpbin = find_rtpbin (rtpsrc);
+  fail_unless (rtpbin != NULL);
+  g_signal_emit_by_name (rtpbin, "get-internal-session", 0, &session);
+  fail_unless (session != NULL);
+  g_object_set (session, "rtcp-min-interval", 100 * GST_MSECOND, NULL);
+  g_object_unref (session);
+  gst_object_unref (rtpbin);
+
+  /* a pad per SSRC as they arrive */
+  for (seq = 0; seq < 10; seq++)
+    for (i = 0; i < 4; i++)
+      send_rtp (socket, 5130, 1 << i, seq, seq == 0);
+  fail_unless_equals_int (wait_count (&added, 4, socket, 5130, 0), 4);
+  fail_unless_equals_int (wait_streams (rtpsrc, 4), 0xf);
+
+  /* two leave with a BYE while two others join */
+  send_bye (socket, 5130, 1 << 0);
+  send_bye (socket, 5130, 1 << 1);
+  fail_unless_equals_int (wait_count (&removed, 2, socket, 5130, 0xc), 2);
+  for (seq = 0; seq < 10; seq++)
+    for (i = 4; i < 6; i++)
+      send_rtp (socket, 5130, 1 << i, seq, seq == 0);
+  fail_unless_equals_int (wait_count (&added, 6, socket, 5130, 0x3c), 6);
+  fail_unless_equals_int (wait_streams (rtpsrc, 4), 0x3c);
+
+  /* two go silent and time out, the others keep sending */
+  fail_unless_equals_int (wait_count (&removed, 4, socket, 5130, 0x30), 4);
+  fail_unless_equals_int (wait_streams (rtpsrc, 2), 0x30);
+  fail_unless_equals_int (g_atomic_int_get (&added), 6);
+
+  g_object_unref (socket);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_latency_tracer)
+{
+  GstPluginFeature *feature;
+
+  feature = gst_registry_lookup_feature (gst_registry_get (),
+      "barcortplatency");
+  fail_unless (feature != NULL);
+  fail_unless (GST_IS_TRACER_FACTORY (feature));
+  gst_object_unref (feature);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpsrc_suite (void)
 {
@@ -20,6 +1064,25 @@ rtpsrc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_pads);
+  tcase_add_test (tc_chain, test_fec_recovery);
+  tcase_add_test (tc_chain, test_fec_column_interleave);
+  tcase_add_test (tc_chain, test_fec_pt_clash);
+  tcase_add_test (tc_chain, test_redundant_merge);
+  tcase_add_test (tc_chain, test_redundant_merge_events);
+  tcase_add_test (tc_chain, test_keyframe_request);
+  tcase_add_test (tc_chain, test_capture_iface);
+  tcase_add_test (tc_chain, test_mp2t_latency);
+  tcase_add_test (tc_chain, test_mp2t_resync);
+  tcase_add_test (tc_chain, test_mp2t_cc_errors);
+  tcase_add_test (tc_chain, test_sdp);
+  tcase_add_test (tc_chain, test_rtx_recovery);
+  tcase_add_test (tc_chain, test_kernel_timestamps);
+  tcase_add_test (tc_chain, test_buffer_size);
+  tcase_add_test (tc_chain, test_stats);
+  tcase_add_test (tc_chain, test_stats_ssrc_churn);
+  tcase_add_test (tc_chain, test_ssrc_switch);
+  tcase_add_test (tc_chain, test_ssrc_pads);
+  tcase_add_test (tc_chain, test_latency_tracer);
 
   return s;
 }